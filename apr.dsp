@@ -202,6 +202,10 @@ SOURCE=.\buckets\apr_buckets_simple.c
 
 SOURCE=.\buckets\apr_buckets_socket.c
 # End Source File
+# Begin Source File
+
+SOURCE=.\buckets\apr_buckets_zerocopy.c
+# End Source File
 # End Group
 # Begin Group "crypto"
 
@@ -736,6 +740,10 @@ SOURCE=.\util-misc\apr_date.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\util-misc\apr_file_aio.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\util-misc\apu_dso.c
 # End Source File
 # Begin Source File
@@ -979,6 +987,10 @@ InputPath=.\include\apr_escape.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\include\apr_file_aio.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\include\apr_file_info.h
 # End Source File
 # Begin Source File
@@ -44,3 +44,18 @@ APR_DECLARE_NONSTD(void) apr_bucket_destroy_noop(void *data)
 {
     return;
 }
+
+APR_DECLARE(apr_status_t) apr_bucket_splice(apr_bucket *b,
+                                            apr_socket_t *sock,
+                                            apr_size_t *len,
+                                            apr_read_type_e block)
+{
+    if (APR_BUCKET_IS_SOCKET(b)) {
+        return apr_bucket_socket_splice(b, sock, len, block);
+    }
+    if (APR_BUCKET_IS_PIPE(b)) {
+        return apr_bucket_pipe_splice(b, sock, len, block);
+    }
+    *len = 0;
+    return APR_ENOTIMPL;
+}
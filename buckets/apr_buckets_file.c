@@ -29,6 +29,14 @@
 
 #endif /* APR_HAS_MMAP */
 
+/* The prefetched chunks end on page boundaries of the file (4096 is small
+ * enough for the page size of most systems)
+ */
+#define FILE_PREFETCH_ALIGN 4096
+
+/* The size of the file advised to be read ahead at once */
+#define FILE_READAHEAD_WINDOW (4 * 1024 * 1024)
+
 static void file_bucket_destroy(void *data)
 {
     apr_bucket_file *f = data;
@@ -36,6 +44,9 @@ static void file_bucket_destroy(void *data)
     if (apr_bucket_shared_destroy(f)) {
         /* no need to close the file here; it will get
          * done automatically when the pool gets cleaned up */
+        if (f->prefetch) {
+            apr_bucket_type_heap.destroy(f->prefetch);
+        }
         apr_bucket_free(f);
     }
 }
@@ -72,25 +83,27 @@ static int file_make_mmap(apr_bucket *e, apr_size_t filelength,
 }
 #endif
 
-static apr_status_t file_bucket_read(apr_bucket *e, const char **str,
-                                     apr_size_t *len, apr_read_type_e block)
+/* Read at the given offset, positionally unless not supported */
+static apr_status_t file_read_at(apr_bucket_file *a, char *buf,
+                                 apr_size_t *len, apr_off_t fileoffset)
 {
-    apr_bucket_file *a = e->data;
     apr_file_t *f = a->fd;
-    apr_bucket *b = NULL;
-    char *buf;
     apr_status_t rv;
-    apr_size_t filelength = e->length;  /* bytes remaining in file past offset */
-    apr_off_t fileoffset = e->start;
 #if APR_HAS_THREADS && !APR_HAS_XTHREAD_FILES
     apr_int32_t flags;
 #endif
 
-#if APR_HAS_MMAP
-    if (file_make_mmap(e, filelength, fileoffset, a->readpool)) {
-        return apr_bucket_read(e, str, len, block);
+    if (a->can_pread) {
+        apr_size_t size = *len;
+
+        rv = apr_file_pread(f, buf, len, fileoffset);
+        if (rv != APR_ENOTIMPL) {
+            return rv;
+        }
+        /* Not again, and read the whole size below */
+        a->can_pread = 0;
+        *len = size;
     }
-#endif
 
 #if APR_HAS_THREADS && !APR_HAS_XTHREAD_FILES
     if ((flags = apr_file_flags_get(f)) & APR_FOPEN_XTHREAD) {
@@ -108,27 +121,176 @@ static apr_status_t file_bucket_read(apr_bucket *e, const char **str,
     }
 #endif
 
-    *str = NULL;  /* in case we die prematurely */
-    *len = (filelength > a->read_size) ? a->read_size : filelength;
-    buf = apr_bucket_alloc(*len, e->list);
-
     /* Handle offset ... */
     rv = apr_file_seek(f, APR_SET, &fileoffset);
     if (rv != APR_SUCCESS) {
-        apr_bucket_free(buf);
         return rv;
     }
-    rv = apr_file_read(f, buf, len);
+    return apr_file_read(f, buf, len);
+}
+
+/* Advise the kernel to read ahead the next window of the file, so that it's
+ * in the cache by the time the next buckets are read. The window is renewed
+ * only once the reader went half-way through it, thus this costs a system
+ * call every FILE_READAHEAD_WINDOW / 2 bytes rather than on every read.
+ */
+static void file_readahead(apr_bucket_file *a, apr_off_t offset,
+                           apr_size_t remaining)
+{
+    apr_off_t end;
+    apr_status_t rv;
+
+    if (a->readahead < 0
+            || a->readahead - offset > FILE_READAHEAD_WINDOW / 2) {
+        return;
+    }
+    end = offset + ((remaining > FILE_READAHEAD_WINDOW) ? FILE_READAHEAD_WINDOW
+                                                        : remaining);
+    if (end <= a->readahead) {
+        return;
+    }
+    if (offset < a->readahead) {
+        /* Not advised twice */
+        offset = a->readahead;
+    }
+
+    rv = apr_file_advise(a->fd, offset, end - offset, APR_FADVISE_WILLNEED);
+    if (rv != APR_SUCCESS) {
+        /* Not supported by the system or for this file (ESPIPE, EINVAL..),
+         * don't try again.
+         */
+        a->readahead = -1;
+        return;
+    }
+    a->readahead = end;
+}
+
+/* Size of the first chunk prefetched, and after a non sequential read */
+static apr_size_t file_prefetch_min(apr_bucket_file *a)
+{
+    apr_size_t size = APR_ALIGN(a->read_size, FILE_PREFETCH_ALIGN);
+
+    return (size < a->prefetch_max) ? size : a->prefetch_max;
+}
+
+/* Make the bucket a slice of the prefetched chunk containing its data,
+ * reading the chunk first if needed.
+ */
+static apr_status_t file_prefetch(apr_bucket *e, apr_size_t filelength,
+                                  apr_off_t fileoffset)
+{
+    apr_bucket_file *a = e->data;
+    apr_bucket_heap *h = a->prefetch;
+    apr_off_t end;
+    apr_size_t len;
+    char *buf;
+    apr_status_t rv;
+
+    if (h && fileoffset >= a->prefetch_offset
+          && fileoffset < a->prefetch_offset + (apr_off_t)h->alloc_len) {
+        e->data = h;
+        e->start = fileoffset - a->prefetch_offset;
+        e->length = h->alloc_len - (apr_size_t)e->start;
+        if (e->length > filelength) {
+            e->length = filelength;
+        }
+        e->type = &apr_bucket_type_heap;
+        h->refcount.refcount++;
+        return APR_SUCCESS;
+    }
+
+    /* Grow the chunks while they are consumed sequentially */
+    if (!h) {
+        a->prefetch_size = file_prefetch_min(a);
+    }
+    else if (fileoffset == a->prefetch_offset + (apr_off_t)h->alloc_len) {
+        if (a->prefetch_size <= a->prefetch_max / 2) {
+            a->prefetch_size *= 2;
+        }
+        else {
+            a->prefetch_size = a->prefetch_max;
+        }
+    }
+    else {
+        a->prefetch_size = file_prefetch_min(a);
+    }
+
+    /* The chunk size is at least two pages, so rounding down its end
+     * still reads something.  Data past the bucket is worth reading only
+     * for the other buckets of the file, if any.
+     */
+    end = (fileoffset + a->prefetch_size) & ~(apr_off_t)(FILE_PREFETCH_ALIGN - 1);
+    len = (apr_size_t)(end - fileoffset);
+    if (len > filelength && a->refcount.refcount == 1) {
+        len = filelength;
+    }
+    buf = apr_bucket_alloc(len, e->list);
+
+    rv = file_read_at(a, buf, &len, fileoffset);
     if (rv != APR_SUCCESS && rv != APR_EOF) {
         apr_bucket_free(buf);
         return rv;
     }
+    apr_bucket_heap_make(e, buf, len, apr_bucket_free);
+    if (len == 0) {
+        /* nothing to share */
+        return rv;
+    }
+    if (e->length > filelength) {
+        e->length = filelength;
+    }
+
+    if (h) {
+        apr_bucket_type_heap.destroy(h);
+    }
+    a->prefetch = h = e->data;
+    a->prefetch_offset = fileoffset;
+    h->refcount.refcount++;
+    return rv;
+}
+
+static apr_status_t file_bucket_read(apr_bucket *e, const char **str,
+                                     apr_size_t *len, apr_read_type_e block)
+{
+    apr_bucket_file *a = e->data;
+    apr_bucket *b = NULL;
+    char *buf;
+    apr_status_t rv;
+    apr_size_t filelength = e->length;  /* bytes remaining in file past offset */
+    apr_off_t fileoffset = e->start;
+
+#if APR_HAS_MMAP
+    if (file_make_mmap(e, filelength, fileoffset, a->readpool)) {
+        return apr_bucket_read(e, str, len, block);
+    }
+#endif
+
+    *str = NULL;  /* in case we die prematurely */
+    if (a->prefetch_max) {
+        /* Changes the current bucket to refer to (a slice of) the chunk */
+        rv = file_prefetch(e, filelength, fileoffset);
+        if (rv != APR_SUCCESS && rv != APR_EOF) {
+            return rv;
+        }
+        buf = ((apr_bucket_heap *)e->data)->base + e->start;
+        *len = e->length;
+    }
+    else {
+        *len = (filelength > a->read_size) ? a->read_size : filelength;
+        buf = apr_bucket_alloc(*len, e->list);
+
+        rv = file_read_at(a, buf, len, fileoffset);
+        if (rv != APR_SUCCESS && rv != APR_EOF) {
+            apr_bucket_free(buf);
+            return rv;
+        }
+        /*
+         * Change the current bucket to refer to what we read,
+         * even if we read nothing because we hit EOF.
+         */
+        apr_bucket_heap_make(e, buf, *len, apr_bucket_free);
+    }
     filelength -= *len;
-    /*
-     * Change the current bucket to refer to what we read,
-     * even if we read nothing because we hit EOF.
-     */
-    apr_bucket_heap_make(e, buf, *len, apr_bucket_free);
 
     /* If we have more to read from the file, then create another bucket */
     if (filelength > 0 && rv != APR_EOF) {
@@ -142,6 +304,8 @@ static apr_status_t file_bucket_read(apr_bucket *e, const char **str,
         b->free   = apr_bucket_free;
         b->list   = e->list;
         APR_BUCKET_INSERT_AFTER(e, b);
+
+        file_readahead(a, b->start, filelength);
     }
     else {
         file_bucket_destroy(a);
@@ -164,6 +328,13 @@ APR_DECLARE(apr_bucket *) apr_bucket_file_make(apr_bucket *b, apr_file_t *fd,
     f->can_mmap = 1;
 #endif
     f->read_size = APR_BUCKET_BUFF_SIZE;
+    f->can_pread = 1;
+    /* No read ahead for files accessed randomly */
+    f->readahead = (apr_file_flags_get(fd) & APR_FOPEN_RANDOM) ? -1 : 0;
+    f->prefetch_max = 0;
+    f->prefetch_size = 0;
+    f->prefetch_offset = 0;
+    f->prefetch = NULL;
 
     b = apr_bucket_shared_make(b, f, offset, len);
     b->type = &apr_bucket_type_file;
@@ -212,6 +383,24 @@ APR_DECLARE(apr_status_t) apr_bucket_file_set_buf_size(apr_bucket *e,
     return APR_SUCCESS;
 }
 
+APR_DECLARE(apr_status_t) apr_bucket_file_set_prefetch(apr_bucket *e,
+                                                       apr_size_t max_size)
+{
+    apr_bucket_file *a = e->data;
+
+    if (max_size) {
+        /* Whole pages, and at least two */
+        max_size &= ~(apr_size_t)(FILE_PREFETCH_ALIGN - 1);
+        if (max_size < 2 * FILE_PREFETCH_ALIGN) {
+            max_size = 2 * FILE_PREFETCH_ALIGN;
+        }
+    }
+    a->prefetch_max = max_size;
+    a->prefetch_size = file_prefetch_min(a);
+
+    return APR_SUCCESS;
+}
+
 static apr_status_t file_bucket_setaside(apr_bucket *b, apr_pool_t *reqpool)
 {
     apr_bucket_file *a = b->data;
@@ -239,6 +428,9 @@ static apr_status_t file_bucket_setaside(apr_bucket *b, apr_pool_t *reqpool)
         new = apr_bucket_alloc(sizeof(*new), b->list);
         memcpy(new, a, sizeof(*new));
         new->refcount.refcount = 1;
+        if (new->prefetch) {
+            new->prefetch->refcount.refcount++;
+        }
 
         a->refcount.refcount--;
         a = b->data = new;
@@ -75,6 +75,35 @@ static apr_status_t pipe_bucket_read(apr_bucket *a, const char **str,
     return APR_SUCCESS;
 }
 
+APR_DECLARE(apr_status_t) apr_bucket_pipe_splice(apr_bucket *a,
+                                                 apr_socket_t *sock,
+                                                 apr_size_t *len,
+                                                 apr_read_type_e block)
+{
+    apr_file_t *p = a->data;
+    apr_status_t rv;
+    apr_interval_time_t timeout;
+
+    if (block == APR_NONBLOCK_READ) {
+        apr_file_pipe_timeout_get(p, &timeout);
+        apr_file_pipe_timeout_set(p, 0);
+    }
+
+    rv = apr_socket_splice_out(sock, p, len, 0);
+
+    if (block == APR_NONBLOCK_READ) {
+        apr_file_pipe_timeout_set(p, timeout);
+    }
+
+    if (rv == APR_EOF) {
+        /* Same as pipe_bucket_read() at the end of the pipe */
+        a = apr_bucket_immortal_make(a, "", 0);
+        apr_file_close(p);
+        rv = APR_SUCCESS;
+    }
+    return rv;
+}
+
 APR_DECLARE(apr_bucket *) apr_bucket_pipe_make(apr_bucket *b, apr_file_t *p)
 {
     /*
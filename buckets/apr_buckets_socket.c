@@ -15,6 +15,7 @@
  */
 
 #include "apr_buckets.h"
+#include "apr_thread_proc.h" /* for APR_FULL_BLOCK */
 
 static apr_status_t socket_bucket_read(apr_bucket *a, const char **str,
                                        apr_size_t *len, apr_read_type_e block)
@@ -75,6 +76,105 @@ static apr_status_t socket_bucket_read(apr_bucket *a, const char **str,
     return APR_SUCCESS;
 }
 
+/* The pipe through which a socket's data get spliced, bound to the socket */
+typedef struct {
+    apr_file_t *in;
+    apr_file_t *out;
+} socket_splice_pipe_t;
+
+#define SOCKET_SPLICE_KEY "apr_bucket_socket_splice"
+
+static apr_status_t socket_splice_pipe_get(socket_splice_pipe_t **sp,
+                                           apr_socket_t *p)
+{
+    apr_pool_t *pool = apr_socket_pool_get(p);
+    apr_status_t rv;
+
+    rv = apr_socket_data_get((void **)sp, SOCKET_SPLICE_KEY, p);
+    if (rv != APR_SUCCESS || *sp) {
+        return rv;
+    }
+
+    *sp = apr_palloc(pool, sizeof(**sp));
+    rv = apr_file_pipe_create_pools(&(*sp)->in, &(*sp)->out, APR_FULL_BLOCK,
+                                    pool, pool);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+    apr_file_inherit_unset((*sp)->in);
+    apr_file_inherit_unset((*sp)->out);
+
+    return apr_socket_data_set(p, *sp, SOCKET_SPLICE_KEY, NULL);
+}
+
+APR_DECLARE(apr_status_t) apr_bucket_socket_splice(apr_bucket *a,
+                                                   apr_socket_t *sock,
+                                                   apr_size_t *len,
+                                                   apr_read_type_e block)
+{
+    apr_socket_t *p = a->data;
+    socket_splice_pipe_t *sp;
+    apr_size_t spliced, sent;
+    apr_status_t rv;
+    apr_interval_time_t timeout;
+
+    rv = socket_splice_pipe_get(&sp, p);
+    if (rv != APR_SUCCESS) {
+        *len = 0;
+        return rv;
+    }
+
+    if (block == APR_NONBLOCK_READ) {
+        apr_socket_timeout_get(p, &timeout);
+        apr_socket_timeout_set(p, 0);
+    }
+
+    /* The pipe is empty, so this won't block on it */
+    spliced = *len;
+    rv = apr_socket_splice_in(p, sp->out, &spliced, 0);
+
+    if (block == APR_NONBLOCK_READ) {
+        apr_socket_timeout_set(p, timeout);
+    }
+
+    *len = 0;
+    if (rv == APR_EOF) {
+        /* Same as socket_bucket_read() at the end of the data */
+        a = apr_bucket_immortal_make(a, "", 0);
+        return APR_SUCCESS;
+    }
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+
+    while (*len < spliced) {
+        sent = spliced - *len;
+        rv = apr_socket_splice_out(sock, sp->in, &sent, 0);
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+        *len += sent;
+    }
+    if (*len < spliced) {
+        /* Don't leave anything in the pipe, the rest of the data is read
+         * into a HEAP bucket placed before this one so that it comes next.
+         */
+        apr_size_t rest = spliced - *len;
+        char *buf = apr_bucket_alloc(rest, a->list);
+        apr_status_t arv;
+
+        arv = apr_file_read_full(sp->in, buf, rest, NULL);
+        if (arv != APR_SUCCESS) {
+            apr_bucket_free(buf);
+            return arv;
+        }
+        APR_BUCKET_INSERT_BEFORE(a, apr_bucket_heap_create(buf, rest,
+                                                           apr_bucket_free,
+                                                           a->list));
+    }
+    return rv;
+}
+
 APR_DECLARE(apr_bucket *) apr_bucket_socket_make(apr_bucket *b, apr_socket_t *p)
 {
     /*
@@ -0,0 +1,147 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apr_buckets.h"
+
+/* The buckets released once the given number of sends completed */
+typedef struct zerocopy_batch_t zerocopy_batch_t;
+struct zerocopy_batch_t {
+    zerocopy_batch_t *next;
+    apr_uint32_t sent;
+    apr_size_t count;
+    apr_bucket_brigade *bb;
+};
+
+struct apr_bucket_zerocopy_t {
+    apr_socket_t *sock;
+    apr_pool_t *pool;
+    apr_bucket_alloc_t *list;
+    /* held, oldest first */
+    zerocopy_batch_t *head;
+    zerocopy_batch_t *tail;
+    /* recycled */
+    zerocopy_batch_t *free;
+    apr_size_t held;
+};
+
+APR_DECLARE(apr_bucket_zerocopy_t *) apr_bucket_zerocopy_create(
+                                             apr_socket_t *sock,
+                                             apr_pool_t *p,
+                                             apr_bucket_alloc_t *list)
+{
+    apr_bucket_zerocopy_t *zc = apr_pcalloc(p, sizeof(*zc));
+
+    zc->sock = sock;
+    zc->pool = p;
+    zc->list = list;
+    return zc;
+}
+
+static void zerocopy_release(apr_bucket_zerocopy_t *zc,
+                             apr_uint32_t completed)
+{
+    zerocopy_batch_t *batch;
+
+    /* Sequence numbers wrap */
+    while ((batch = zc->head)
+           && (apr_int32_t)(completed - batch->sent) >= 0) {
+        apr_brigade_cleanup(batch->bb);
+        zc->held -= batch->count;
+
+        zc->head = batch->next;
+        if (!zc->head) {
+            zc->tail = NULL;
+        }
+        batch->next = zc->free;
+        zc->free = batch;
+    }
+}
+
+APR_DECLARE(apr_status_t) apr_bucket_zerocopy_hold(apr_bucket_zerocopy_t *zc,
+                                                   apr_bucket *b)
+{
+    zerocopy_batch_t *batch;
+    apr_uint32_t sent, completed;
+    apr_status_t rv;
+
+    if (APR_BUCKET_IS_TRANSIENT(b)) {
+        return APR_EINVAL;
+    }
+    APR_BUCKET_REMOVE(b);
+
+    rv = apr_socket_zerocopy_reap(zc->sock, &sent, &completed, 0);
+    if (rv == APR_ENOTIMPL) {
+        /* The data were copied */
+        apr_bucket_destroy(b);
+        return APR_SUCCESS;
+    }
+    if (rv != APR_SUCCESS) {
+        apr_bucket_destroy(b);
+        return rv;
+    }
+    zerocopy_release(zc, completed);
+    if (sent == completed) {
+        apr_bucket_destroy(b);
+        return APR_SUCCESS;
+    }
+
+    batch = zc->tail;
+    if (!batch || batch->sent != sent) {
+        batch = zc->free;
+        if (batch) {
+            zc->free = batch->next;
+        }
+        else {
+            batch = apr_palloc(zc->pool, sizeof(*batch));
+            batch->bb = apr_brigade_create(zc->pool, zc->list);
+        }
+        batch->next = NULL;
+        batch->sent = sent;
+        batch->count = 0;
+        if (zc->tail) {
+            zc->tail->next = batch;
+        }
+        else {
+            zc->head = batch;
+        }
+        zc->tail = batch;
+    }
+    APR_BRIGADE_INSERT_TAIL(batch->bb, b);
+    batch->count++;
+    zc->held++;
+
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_bucket_zerocopy_reap(apr_bucket_zerocopy_t *zc,
+                                                   int block,
+                                                   apr_size_t *held)
+{
+    apr_uint32_t sent, completed;
+    apr_status_t rv = APR_SUCCESS;
+
+    if (zc->head) {
+        rv = apr_socket_zerocopy_reap(zc->sock, &sent, &completed, block);
+        if (rv == APR_SUCCESS || APR_STATUS_IS_EAGAIN(rv)
+                              || APR_STATUS_IS_TIMEUP(rv)) {
+            zerocopy_release(zc, completed);
+        }
+    }
+    if (held) {
+        *held = zc->held;
+    }
+    return rv;
+}
@@ -208,6 +208,757 @@ static const char base32hex[] =
 static const char base16[] = "0123456789ABCDEF";
 static const char base16lower[] = "0123456789abcdef";
 
+
+/*
+ * Vector kernels, for the bulk of the data; the functions below finish
+ * with their scalar loops. Each returns how much of the input it handled.
+ */
+
+#if !APR_CHARSET_EBCDIC && defined(__GNUC__) \
+    && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ >= 5)
+#include <immintrin.h>
+#define ENCODE_X86 1
+#elif !APR_CHARSET_EBCDIC && defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ENCODE_NEON 1
+#endif
+
+#if ENCODE_X86 || ENCODE_NEON
+
+typedef struct encode_simd_t {
+    apr_size_t (*base64_encode)(char *out, const unsigned char *in,
+                                apr_size_t n, int url);
+    /* the number of leading bytes of the base64 (or base64url) alphabet */
+    apr_size_t (*base64_valid)(const unsigned char *in, apr_size_t n);
+    apr_size_t (*base64_decode)(unsigned char *out, const unsigned char *in,
+                                apr_size_t n);
+    apr_size_t (*base16_encode)(char *out, const unsigned char *in,
+                                apr_size_t n, int lower);
+    /* the number of leading hex digits, or colons */
+    apr_size_t (*base16_valid)(const unsigned char *in, apr_size_t n,
+                               int colon);
+    apr_size_t (*base16_decode)(unsigned char *out, const unsigned char *in,
+                                apr_size_t n);
+} encode_simd_t;
+
+static APR_INLINE apr_size_t mask_first(apr_uint64_t mask)
+{
+    return (apr_size_t)__builtin_ctzll(mask);
+}
+
+#endif /* ENCODE_X86 || ENCODE_NEON */
+
+#if ENCODE_X86
+
+/* Compiled for SSSE3 and AVX2, used if the CPU has them */
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+/* lo <= x <= hi, unsigned */
+#define IN_RANGE_128(x, lo, hi) \
+    _mm_cmpeq_epi8(_mm_min_epu8(_mm_sub_epi8(x, _mm_set1_epi8(lo)), \
+                                _mm_set1_epi8((hi) - (lo))), \
+                   _mm_sub_epi8(x, _mm_set1_epi8(lo)))
+#define IN_RANGE_256(x, lo, hi) \
+    _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_sub_epi8(x, _mm256_set1_epi8(lo)), \
+                                      _mm256_set1_epi8((hi) - (lo))), \
+                      _mm256_sub_epi8(x, _mm256_set1_epi8(lo)))
+
+/* Offsets from the 6 bit values to the chars, by range: 26-51, 52-61 (ten
+ * times), 62, 63, 0-25.
+ */
+#define BASE64_OFFSETS(url) \
+    'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, \
+    '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, \
+    (url) ? '-' - 62 : '+' - 62, (url) ? '_' - 63 : '/' - 63, 'A', 0, 0
+
+static TARGET_SSSE3 apr_size_t base64_encode_ssse3(char *out,
+                                                   const unsigned char *in,
+                                                   apr_size_t n, int url)
+{
+    const __m128i offsets = _mm_setr_epi8(BASE64_OFFSETS(url));
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                          7, 6, 8, 7, 10, 9, 11, 10);
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 12) {
+        __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + i)),
+                                     shuffle);
+        /* the four 6 bit values of each 3 bytes, in 4 bytes */
+        __m128i hi = _mm_mulhi_epu16(_mm_and_si128(x,
+                                         _mm_set1_epi32(0x0fc0fc00)),
+                                     _mm_set1_epi32(0x04000040));
+        __m128i lo = _mm_mullo_epi16(_mm_and_si128(x,
+                                         _mm_set1_epi32(0x003f03f0)),
+                                     _mm_set1_epi32(0x01000010));
+        __m128i v = _mm_or_si128(hi, lo);
+        __m128i r = _mm_subs_epu8(v, _mm_set1_epi8(51));
+
+        r = _mm_or_si128(r, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), v),
+                                          _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i *)out,
+                         _mm_add_epi8(_mm_shuffle_epi8(offsets, r), v));
+        out += 16;
+    }
+    return i;
+}
+
+static TARGET_AVX2 apr_size_t base64_encode_avx2(char *out,
+                                                 const unsigned char *in,
+                                                 apr_size_t n, int url)
+{
+    const __m256i offsets = _mm256_setr_epi8(BASE64_OFFSETS(url),
+                                             BASE64_OFFSETS(url));
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                             7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4,
+                                             7, 6, 8, 7, 10, 9, 11, 10);
+    apr_size_t i;
+
+    for (i = 0; i + 28 <= n; i += 24) {
+        __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                        _mm_loadu_si128((const __m128i *)(in + i))),
+                        _mm_loadu_si128((const __m128i *)(in + i + 12)), 1);
+        __m256i hi, lo, v, r;
+
+        x = _mm256_shuffle_epi8(x, shuffle);
+        hi = _mm256_mulhi_epu16(_mm256_and_si256(x,
+                                    _mm256_set1_epi32(0x0fc0fc00)),
+                                _mm256_set1_epi32(0x04000040));
+        lo = _mm256_mullo_epi16(_mm256_and_si256(x,
+                                    _mm256_set1_epi32(0x003f03f0)),
+                                _mm256_set1_epi32(0x01000010));
+        v = _mm256_or_si256(hi, lo);
+        r = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+        r = _mm256_or_si256(r, _mm256_and_si256(
+                                   _mm256_cmpgt_epi8(_mm256_set1_epi8(26), v),
+                                   _mm256_set1_epi8(13)));
+        _mm256_storeu_si256((__m256i *)out,
+                            _mm256_add_epi8(_mm256_shuffle_epi8(offsets, r),
+                                            v));
+        out += 32;
+    }
+    return i + base64_encode_ssse3(out, in + i, n - i, url);
+}
+
+/* The 6 bit values of the chars of both alphabets, and which are valid */
+static APR_INLINE TARGET_SSSE3 __m128i base64_values_ssse3(__m128i x,
+                                                          __m128i *valid)
+{
+    __m128i upper = IN_RANGE_128(x, 'A', 'Z');
+    __m128i lower = IN_RANGE_128(x, 'a', 'z');
+    __m128i digit = IN_RANGE_128(x, '0', '9');
+    __m128i v62 = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('+')),
+                               _mm_cmpeq_epi8(x, _mm_set1_epi8('-')));
+    __m128i v63 = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('/')),
+                               _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+
+    *valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                          _mm_or_si128(digit, _mm_or_si128(v62, v63)));
+    return _mm_or_si128(
+        _mm_or_si128(
+            _mm_and_si128(upper, _mm_sub_epi8(x, _mm_set1_epi8('A'))),
+            _mm_and_si128(lower, _mm_sub_epi8(x, _mm_set1_epi8('a' - 26)))),
+        _mm_or_si128(
+            _mm_and_si128(digit, _mm_add_epi8(x, _mm_set1_epi8(52 - '0'))),
+            _mm_or_si128(_mm_and_si128(v62, _mm_set1_epi8(62)),
+                         _mm_and_si128(v63, _mm_set1_epi8(63)))));
+}
+
+static APR_INLINE TARGET_AVX2 __m256i base64_values_avx2(__m256i x,
+                                                        __m256i *valid)
+{
+    __m256i upper = IN_RANGE_256(x, 'A', 'Z');
+    __m256i lower = IN_RANGE_256(x, 'a', 'z');
+    __m256i digit = IN_RANGE_256(x, '0', '9');
+    __m256i v62 = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('+')),
+                                  _mm256_cmpeq_epi8(x, _mm256_set1_epi8('-')));
+    __m256i v63 = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('/')),
+                                  _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+
+    *valid = _mm256_or_si256(_mm256_or_si256(upper, lower),
+                             _mm256_or_si256(digit, _mm256_or_si256(v62, v63)));
+    return _mm256_or_si256(
+        _mm256_or_si256(
+            _mm256_and_si256(upper, _mm256_sub_epi8(x, _mm256_set1_epi8('A'))),
+            _mm256_and_si256(lower,
+                             _mm256_sub_epi8(x, _mm256_set1_epi8('a' - 26)))),
+        _mm256_or_si256(
+            _mm256_and_si256(digit,
+                             _mm256_add_epi8(x, _mm256_set1_epi8(52 - '0'))),
+            _mm256_or_si256(_mm256_and_si256(v62, _mm256_set1_epi8(62)),
+                            _mm256_and_si256(v63, _mm256_set1_epi8(63)))));
+}
+
+static TARGET_SSSE3 apr_size_t base64_valid_ssse3(const unsigned char *in,
+                                                  apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m128i valid;
+        unsigned int mask;
+
+        base64_values_ssse3(_mm_loadu_si128((const __m128i *)(in + i)),
+                            &valid);
+        mask = (unsigned int)_mm_movemask_epi8(valid) ^ 0xffff;
+        if (mask) {
+            return i + mask_first(mask);
+        }
+    }
+    return i;
+}
+
+static TARGET_AVX2 apr_size_t base64_valid_avx2(const unsigned char *in,
+                                                apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        __m256i valid;
+        unsigned int mask;
+
+        base64_values_avx2(_mm256_loadu_si256((const __m256i *)(in + i)),
+                           &valid);
+        mask = ~(unsigned int)_mm256_movemask_epi8(valid);
+        if (mask) {
+            return i + mask_first(mask);
+        }
+    }
+    return i + base64_valid_ssse3(in + i, n - i);
+}
+
+/* Four 6 bit values to three bytes, in each 4 bytes */
+static APR_INLINE TARGET_SSSE3 __m128i base64_pack_ssse3(__m128i v)
+{
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                             14, 13, 12, -1, -1, -1, -1));
+}
+
+static TARGET_SSSE3 apr_size_t base64_decode_ssse3(unsigned char *out,
+                                                   const unsigned char *in,
+                                                   apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m128i valid, r;
+        apr_uint32_t last;
+
+        r = base64_pack_ssse3(base64_values_ssse3(
+                _mm_loadu_si128((const __m128i *)(in + i)), &valid));
+        /* twelve bytes, no more */
+        _mm_storel_epi64((__m128i *)out, r);
+        last = (apr_uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(r, 8));
+        memcpy(out + 8, &last, 4);
+        out += 12;
+    }
+    return i;
+}
+
+static TARGET_AVX2 apr_size_t base64_decode_avx2(unsigned char *out,
+                                                 const unsigned char *in,
+                                                 apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        __m256i valid, v;
+
+        v = base64_values_avx2(_mm256_loadu_si256((const __m256i *)(in + i)),
+                               &valid);
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        /* the twelve bytes of each lane together, then 24 bytes stored */
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6,
+                                                             3, 7));
+        _mm_storeu_si128((__m128i *)out, _mm256_castsi256_si128(v));
+        _mm_storel_epi64((__m128i *)(out + 16), _mm256_extracti128_si256(v, 1));
+        out += 24;
+    }
+    return i + base64_decode_ssse3(out, in + i, n - i);
+}
+
+static TARGET_SSSE3 apr_size_t base16_encode_ssse3(char *out,
+                                                   const unsigned char *in,
+                                                   apr_size_t n, int lower)
+{
+    const __m128i digits = _mm_loadu_si128((const __m128i *)(lower ?
+                                           base16lower : base16));
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(
+                                          _mm_srli_epi16(x, 4), nibble));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(x, nibble));
+
+        _mm_storeu_si128((__m128i *)out, _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *)(out + 16), _mm_unpackhi_epi8(hi, lo));
+        out += 32;
+    }
+    return i;
+}
+
+static TARGET_AVX2 apr_size_t base16_encode_avx2(char *out,
+                                                 const unsigned char *in,
+                                                 apr_size_t n, int lower)
+{
+    const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                               (const __m128i *)(lower ? base16lower : base16)));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    apr_size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(
+                                             _mm256_srli_epi16(x, 4), nibble));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(x, nibble));
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+
+        /* unpacking is by lane */
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute2x128_si256(a, b,
+                                                                      0x20));
+        _mm256_storeu_si256((__m256i *)(out + 32),
+                            _mm256_permute2x128_si256(a, b, 0x31));
+        out += 64;
+    }
+    return i + base16_encode_ssse3(out, in + i, n - i, lower);
+}
+
+static APR_INLINE TARGET_SSSE3 __m128i base16_values_ssse3(__m128i x,
+                                                          __m128i *digit,
+                                                          __m128i *alpha)
+{
+    __m128i folded = _mm_or_si128(x, _mm_set1_epi8(0x20));
+
+    *digit = IN_RANGE_128(x, '0', '9');
+    *alpha = IN_RANGE_128(folded, 'a', 'f');
+    return _mm_or_si128(
+        _mm_and_si128(*digit, _mm_sub_epi8(x, _mm_set1_epi8('0'))),
+        _mm_and_si128(*alpha, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10))));
+}
+
+static APR_INLINE TARGET_AVX2 __m256i base16_values_avx2(__m256i x,
+                                                        __m256i *digit,
+                                                        __m256i *alpha)
+{
+    __m256i folded = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+
+    *digit = IN_RANGE_256(x, '0', '9');
+    *alpha = IN_RANGE_256(folded, 'a', 'f');
+    return _mm256_or_si256(
+        _mm256_and_si256(*digit, _mm256_sub_epi8(x, _mm256_set1_epi8('0'))),
+        _mm256_and_si256(*alpha, _mm256_sub_epi8(folded,
+                                                 _mm256_set1_epi8('a' - 10))));
+}
+
+static TARGET_SSSE3 apr_size_t base16_valid_ssse3(const unsigned char *in,
+                                                  apr_size_t n, int colon)
+{
+    const __m128i colons = _mm_set1_epi8(colon ? ':' : '0');
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i digit, alpha;
+        unsigned int mask;
+
+        base16_values_ssse3(x, &digit, &alpha);
+        mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+                   _mm_or_si128(digit, alpha), _mm_cmpeq_epi8(x, colons)))
+               ^ 0xffff;
+        if (mask) {
+            return i + mask_first(mask);
+        }
+    }
+    return i;
+}
+
+static TARGET_AVX2 apr_size_t base16_valid_avx2(const unsigned char *in,
+                                                apr_size_t n, int colon)
+{
+    const __m256i colons = _mm256_set1_epi8(colon ? ':' : '0');
+    apr_size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i digit, alpha;
+        unsigned int mask;
+
+        base16_values_avx2(x, &digit, &alpha);
+        mask = ~(unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+                   _mm256_or_si256(digit, alpha), _mm256_cmpeq_epi8(x, colons)));
+        if (mask) {
+            return i + mask_first(mask);
+        }
+    }
+    return i + base16_valid_ssse3(in + i, n - i, colon);
+}
+
+static TARGET_SSSE3 apr_size_t base16_decode_ssse3(unsigned char *out,
+                                                   const unsigned char *in,
+                                                   apr_size_t n)
+{
+    /* the first of each two nibbles times 16, plus the second */
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    apr_size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        __m128i digit, alpha, a, b;
+
+        a = base16_values_ssse3(_mm_loadu_si128((const __m128i *)(in + i)),
+                                &digit, &alpha);
+        b = base16_values_ssse3(_mm_loadu_si128((const __m128i *)(in + i + 16)),
+                                &digit, &alpha);
+        _mm_storeu_si128((__m128i *)out, _mm_packus_epi16(
+                             _mm_maddubs_epi16(a, weights),
+                             _mm_maddubs_epi16(b, weights)));
+        out += 16;
+    }
+    return i;
+}
+
+static TARGET_AVX2 apr_size_t base16_decode_avx2(unsigned char *out,
+                                                 const unsigned char *in,
+                                                 apr_size_t n)
+{
+    const __m256i weights = _mm256_set1_epi16(0x0110);
+    apr_size_t i;
+
+    for (i = 0; i + 64 <= n; i += 64) {
+        __m256i digit, alpha, a, b;
+
+        a = base16_values_avx2(_mm256_loadu_si256((const __m256i *)(in + i)),
+                               &digit, &alpha);
+        b = base16_values_avx2(_mm256_loadu_si256(
+                                   (const __m256i *)(in + i + 32)),
+                               &digit, &alpha);
+        /* packing is by lane */
+        _mm256_storeu_si256((__m256i *)out, _mm256_permute4x64_epi64(
+                                _mm256_packus_epi16(
+                                    _mm256_maddubs_epi16(a, weights),
+                                    _mm256_maddubs_epi16(b, weights)),
+                                0xd8));
+        out += 32;
+    }
+    return i + base16_decode_ssse3(out, in + i, n - i);
+}
+
+static const encode_simd_t encode_ssse3 = {
+    base64_encode_ssse3,
+    base64_valid_ssse3,
+    base64_decode_ssse3,
+    base16_encode_ssse3,
+    base16_valid_ssse3,
+    base16_decode_ssse3
+};
+
+static const encode_simd_t encode_avx2 = {
+    base64_encode_avx2,
+    base64_valid_avx2,
+    base64_decode_avx2,
+    base16_encode_avx2,
+    base16_valid_avx2,
+    base16_decode_avx2
+};
+
+static const encode_simd_t *encode_simd(void)
+{
+    if (__builtin_cpu_supports("avx2")) {
+        return &encode_avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return &encode_ssse3;
+    }
+    return NULL;
+}
+
+#endif /* ENCODE_X86 */
+
+#if ENCODE_NEON
+
+/* Four bits per lane, the narrowing shift is cheaper than a movemask */
+static APR_INLINE apr_uint64_t mask_neon(uint8x16_t m)
+{
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0)
+           & APR_UINT64_C(0x8888888888888888);
+}
+
+#define IN_RANGE_NEON(x, lo, hi) \
+    vcleq_u8(vsubq_u8(x, vdupq_n_u8(lo)), vdupq_n_u8((hi) - (lo)))
+
+static apr_size_t base64_encode_neon(char *out, const unsigned char *in,
+                                     apr_size_t n, int url)
+{
+    const char *base = url ? base64url : base64;
+    uint8x16x4_t table;
+    apr_size_t i;
+
+    table.val[0] = vld1q_u8((const unsigned char *)base);
+    table.val[1] = vld1q_u8((const unsigned char *)base + 16);
+    table.val[2] = vld1q_u8((const unsigned char *)base + 32);
+    table.val[3] = vld1q_u8((const unsigned char *)base + 48);
+
+    for (i = 0; i + 48 <= n; i += 48) {
+        uint8x16x3_t x = vld3q_u8(in + i);
+        uint8x16x4_t r;
+
+        r.val[0] = vshrq_n_u8(x.val[0], 2);
+        r.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(x.val[0], vdupq_n_u8(0x03)), 4),
+                            vshrq_n_u8(x.val[1], 4));
+        r.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(x.val[1], vdupq_n_u8(0x0f)), 2),
+                            vshrq_n_u8(x.val[2], 6));
+        r.val[3] = vandq_u8(x.val[2], vdupq_n_u8(0x3f));
+        r.val[0] = vqtbl4q_u8(table, r.val[0]);
+        r.val[1] = vqtbl4q_u8(table, r.val[1]);
+        r.val[2] = vqtbl4q_u8(table, r.val[2]);
+        r.val[3] = vqtbl4q_u8(table, r.val[3]);
+        vst4q_u8((unsigned char *)out, r);
+        out += 64;
+    }
+    return i;
+}
+
+static APR_INLINE uint8x16_t base64_values_neon(uint8x16_t x,
+                                                uint8x16_t *valid)
+{
+    uint8x16_t upper = IN_RANGE_NEON(x, 'A', 'Z');
+    uint8x16_t lower = IN_RANGE_NEON(x, 'a', 'z');
+    uint8x16_t digit = IN_RANGE_NEON(x, '0', '9');
+    uint8x16_t v62 = vorrq_u8(vceqq_u8(x, vdupq_n_u8('+')),
+                              vceqq_u8(x, vdupq_n_u8('-')));
+    uint8x16_t v63 = vorrq_u8(vceqq_u8(x, vdupq_n_u8('/')),
+                              vceqq_u8(x, vdupq_n_u8('_')));
+
+    *valid = vorrq_u8(vorrq_u8(upper, lower),
+                      vorrq_u8(digit, vorrq_u8(v62, v63)));
+    return vorrq_u8(
+        vorrq_u8(vandq_u8(upper, vsubq_u8(x, vdupq_n_u8('A'))),
+                 vandq_u8(lower, vsubq_u8(x, vdupq_n_u8('a' - 26)))),
+        vorrq_u8(vandq_u8(digit, vaddq_u8(x, vdupq_n_u8(52 - '0'))),
+                 vorrq_u8(vandq_u8(v62, vdupq_n_u8(62)),
+                          vandq_u8(v63, vdupq_n_u8(63)))));
+}
+
+static apr_size_t base64_valid_neon(const unsigned char *in, apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        uint8x16_t valid;
+        apr_uint64_t mask;
+
+        base64_values_neon(vld1q_u8(in + i), &valid);
+        mask = mask_neon(vmvnq_u8(valid));
+        if (mask) {
+            return i + (mask_first(mask) >> 2);
+        }
+    }
+    return i;
+}
+
+static apr_size_t base64_decode_neon(unsigned char *out,
+                                     const unsigned char *in, apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 64 <= n; i += 64) {
+        uint8x16x4_t x = vld4q_u8(in + i);
+        uint8x16x3_t r;
+        uint8x16_t valid;
+
+        x.val[0] = base64_values_neon(x.val[0], &valid);
+        x.val[1] = base64_values_neon(x.val[1], &valid);
+        x.val[2] = base64_values_neon(x.val[2], &valid);
+        x.val[3] = base64_values_neon(x.val[3], &valid);
+        r.val[0] = vorrq_u8(vshlq_n_u8(x.val[0], 2), vshrq_n_u8(x.val[1], 4));
+        r.val[1] = vorrq_u8(vshlq_n_u8(x.val[1], 4), vshrq_n_u8(x.val[2], 2));
+        r.val[2] = vorrq_u8(vshlq_n_u8(x.val[2], 6), x.val[3]);
+        vst3q_u8(out, r);
+        out += 48;
+    }
+    return i;
+}
+
+static apr_size_t base16_encode_neon(char *out, const unsigned char *in,
+                                     apr_size_t n, int lower)
+{
+    const uint8x16_t digits = vld1q_u8((const unsigned char *)(lower ?
+                                       base16lower : base16));
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        uint8x16_t x = vld1q_u8(in + i);
+        uint8x16x2_t r;
+
+        r.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(x, 4));
+        r.val[1] = vqtbl1q_u8(digits, vandq_u8(x, vdupq_n_u8(0x0f)));
+        vst2q_u8((unsigned char *)out, r);
+        out += 32;
+    }
+    return i;
+}
+
+static APR_INLINE uint8x16_t base16_values_neon(uint8x16_t x,
+                                                uint8x16_t *valid)
+{
+    uint8x16_t folded = vorrq_u8(x, vdupq_n_u8(0x20));
+    uint8x16_t digit = IN_RANGE_NEON(x, '0', '9');
+    uint8x16_t alpha = IN_RANGE_NEON(folded, 'a', 'f');
+
+    *valid = vorrq_u8(digit, alpha);
+    return vorrq_u8(vandq_u8(digit, vsubq_u8(x, vdupq_n_u8('0'))),
+                    vandq_u8(alpha, vsubq_u8(folded, vdupq_n_u8('a' - 10))));
+}
+
+static apr_size_t base16_valid_neon(const unsigned char *in, apr_size_t n,
+                                    int colon)
+{
+    const uint8x16_t colons = vdupq_n_u8(colon ? ':' : '0');
+    apr_size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        uint8x16_t x = vld1q_u8(in + i);
+        uint8x16_t valid;
+        apr_uint64_t mask;
+
+        base16_values_neon(x, &valid);
+        mask = mask_neon(vmvnq_u8(vorrq_u8(valid, vceqq_u8(x, colons))));
+        if (mask) {
+            return i + (mask_first(mask) >> 2);
+        }
+    }
+    return i;
+}
+
+static apr_size_t base16_decode_neon(unsigned char *out,
+                                     const unsigned char *in, apr_size_t n)
+{
+    apr_size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        uint8x16x2_t x = vld2q_u8(in + i);
+        uint8x16_t valid;
+
+        vst1q_u8(out, vorrq_u8(
+                     vshlq_n_u8(base16_values_neon(x.val[0], &valid), 4),
+                     base16_values_neon(x.val[1], &valid)));
+        out += 16;
+    }
+    return i;
+}
+
+static const encode_simd_t encode_neon = {
+    base64_encode_neon,
+    base64_valid_neon,
+    base64_decode_neon,
+    base16_encode_neon,
+    base16_valid_neon,
+    base16_decode_neon
+};
+
+static const encode_simd_t *encode_simd(void)
+{
+    return &encode_neon;
+}
+
+#endif /* ENCODE_NEON */
+
+/* The vector kernels, doing nothing where not available */
+
+static APR_INLINE apr_size_t simd_base64_encode(char *out,
+                                                const unsigned char *in,
+                                                apr_size_t n, int flags)
+{
+#if ENCODE_X86 || ENCODE_NEON
+    const encode_simd_t *simd = encode_simd();
+
+    if (simd) {
+        return simd->base64_encode(out, in, n, flags & APR_ENCODE_BASE64URL);
+    }
+#endif
+    return 0;
+}
+
+static APR_INLINE apr_size_t simd_base64_valid(const unsigned char *in,
+                                               apr_size_t n)
+{
+#if ENCODE_X86 || ENCODE_NEON
+    const encode_simd_t *simd = encode_simd();
+
+    if (simd) {
+        return simd->base64_valid(in, n);
+    }
+#endif
+    return 0;
+}
+
+static APR_INLINE apr_size_t simd_base64_decode(unsigned char *out,
+                                                const unsigned char *in,
+                                                apr_size_t n)
+{
+#if ENCODE_X86 || ENCODE_NEON
+    const encode_simd_t *simd = encode_simd();
+
+    if (simd) {
+        return simd->base64_decode(out, in, n);
+    }
+#endif
+    return 0;
+}
+
+static APR_INLINE apr_size_t simd_base16_encode(char *out,
+                                                const unsigned char *in,
+                                                apr_size_t n, int flags)
+{
+#if ENCODE_X86 || ENCODE_NEON
+    const encode_simd_t *simd = encode_simd();
+
+    if (simd && !(flags & APR_ENCODE_COLON)) {
+        return simd->base16_encode(out, in, n, flags & APR_ENCODE_LOWER);
+    }
+#endif
+    return 0;
+}
+
+static APR_INLINE apr_size_t simd_base16_valid(const unsigned char *in,
+                                               apr_size_t n, int flags)
+{
+#if ENCODE_X86 || ENCODE_NEON
+    const encode_simd_t *simd = encode_simd();
+
+    if (simd) {
+        return simd->base16_valid(in, n, flags & APR_ENCODE_COLON);
+    }
+#endif
+    return 0;
+}
+
+static APR_INLINE apr_size_t simd_base16_decode(unsigned char *out,
+                                                const unsigned char *in,
+                                                apr_size_t n, int flags)
+{
+#if ENCODE_X86 || ENCODE_NEON
+    const encode_simd_t *simd = encode_simd();
+
+    if (simd && !(flags & APR_ENCODE_COLON)) {
+        return simd->base16_decode(out, in, n);
+    }
+#endif
+    return 0;
+}
+
 APR_DECLARE(apr_status_t) apr_encode_base64(char *dest, const char *src,
                               apr_ssize_t slen, int flags, apr_size_t * len)
 {
@@ -233,6 +984,10 @@ APR_DECLARE(apr_status_t) apr_encode_base64(char *dest, const char *src,
             base = base64url;
         }
 
+        i = simd_base64_encode(bufout, (const unsigned char *)src, count,
+                               flags);
+        bufout += i / 3 * 4;
+
         if (count > 2) {
             for (; i < count - 2; i += 3) {
                 *bufout++ = base[(TO_ASCII(src[i]) >> 2) & 0x3F];
@@ -299,6 +1054,9 @@ APR_DECLARE(apr_status_t) apr_encode_base64_binary(char *dest, const unsigned ch
             base = base64url;
         }
 
+        i = simd_base64_encode(bufout, src, count, flags);
+        bufout += i / 3 * 4;
+
         if (count > 2) {
             for (; i < count - 2; i += 3) {
                 *bufout++ = base[(src[i] >> 2) & 0x3F];
@@ -410,6 +1168,8 @@ APR_DECLARE(apr_status_t) apr_decode_base64(char *dest, const char *src,
         const unsigned char *bufin;
 
         bufin = (const unsigned char *)src;
+        bufin += simd_base64_valid(bufin, count);
+        count -= bufin - (const unsigned char *)src;
         while (count) {
             if (pr2six[*bufin] >= 64) {
                 if (!(flags & APR_ENCODE_RELAXED)) {
@@ -432,10 +1192,16 @@ APR_DECLARE(apr_status_t) apr_decode_base64(char *dest, const char *src,
 
         if (dest) {
             unsigned char *bufout;
+            apr_size_t i;
 
             bufout = (unsigned char *)dest;
             bufin = (const unsigned char *)src;
 
+            i = simd_base64_decode(bufout, bufin, count);
+            bufin += i;
+            bufout += i / 4 * 3;
+            count -= i;
+
             while (count >= 4) {
                 *(bufout++) = TO_NATIVE(pr2six[bufin[0]] << 2 |
                                         pr2six[bufin[1]] >> 4);
@@ -502,6 +1268,8 @@ APR_DECLARE(apr_status_t) apr_decode_base64_binary(unsigned char *dest,
         const unsigned char *bufin;
 
         bufin = (const unsigned char *)src;
+        bufin += simd_base64_valid(bufin, count);
+        count -= bufin - (const unsigned char *)src;
         while (count) {
             if (pr2six[*bufin] >= 64) {
                 if (!(flags & APR_ENCODE_RELAXED)) {
@@ -524,10 +1292,16 @@ APR_DECLARE(apr_status_t) apr_decode_base64_binary(unsigned char *dest,
 
         if (dest) {
             unsigned char *bufout;
+            apr_size_t i;
 
             bufout = (unsigned char *)dest;
             bufin = (const unsigned char *)src;
 
+            i = simd_base64_decode(bufout, bufin, count);
+            bufin += i;
+            bufout += i / 4 * 3;
+            count -= i;
+
             while (count >= 4) {
                 *(bufout++) = (pr2six[bufin[0]] << 2 |
                                pr2six[bufin[1]] >> 4);
@@ -1235,7 +2009,10 @@ APR_DECLARE(apr_status_t) apr_encode_base16(char *dest,
             base = base16;
         }
 
-        for (i = 0; i < count; i++) {
+        i = simd_base16_encode(bufout, (const unsigned char *)src, count, flags);
+        bufout += i * 2;
+
+        for (; i < count; i++) {
             if ((flags & APR_ENCODE_COLON) && i) {
                 *(bufout++) = ':';
             }
@@ -1288,7 +2065,10 @@ APR_DECLARE(apr_status_t) apr_encode_base16_binary(char *dest,
             base = base16;
         }
 
-        for (i = 0; i < count; i++) {
+        i = simd_base16_encode(bufout, src, count, flags);
+        bufout += i * 2;
+
+        for (; i < count; i++) {
             if ((flags & APR_ENCODE_COLON) && i) {
                 *(bufout++) = ':';
             }
@@ -1387,6 +2167,8 @@ APR_DECLARE(apr_status_t) apr_decode_base16(char *dest,
         const unsigned char *bufin;
 
         bufin = (const unsigned char *)src;
+        bufin += simd_base16_valid(bufin, count, flags);
+        count -= bufin - (const unsigned char *)src;
         while (count) {
             if (pr2two[*bufin] >= 16
                 && (!(flags & APR_ENCODE_COLON)
@@ -1403,10 +2185,16 @@ APR_DECLARE(apr_status_t) apr_decode_base16(char *dest,
 
         if (dest) {
             unsigned char *bufout;
+            apr_size_t i;
 
             bufout = (unsigned char *)dest;
             bufin = (const unsigned char *)src;
 
+            i = simd_base16_decode(bufout, bufin, count, flags);
+            bufin += i;
+            bufout += i / 2;
+            count -= i;
+
             while (count >= 2) {
                 if (pr2two[bufin[0]] == 32 /* ':' */) {
                     bufin += 1;
@@ -1465,6 +2253,8 @@ APR_DECLARE(apr_status_t) apr_decode_base16_binary(unsigned char *dest,
         const unsigned char *bufin;
 
         bufin = (const unsigned char *)src;
+        bufin += simd_base16_valid(bufin, count, flags);
+        count -= bufin - (const unsigned char *)src;
         while (count) {
             if (pr2two[*bufin] >= 16
                 && (!(flags & APR_ENCODE_COLON)
@@ -1481,10 +2271,16 @@ APR_DECLARE(apr_status_t) apr_decode_base16_binary(unsigned char *dest,
 
         if (dest) {
             unsigned char *bufout;
+            apr_size_t i;
 
             bufout = (unsigned char *)dest;
             bufin = (const unsigned char *)src;
 
+            i = simd_base16_decode(bufout, bufin, count, flags);
+            bufin += i;
+            bufout += i / 2;
+            count -= i;
+
             while (count >= 2) {
                 if (pr2two[bufin[0]] == 32 /* ':' */) {
                     bufin += 1;
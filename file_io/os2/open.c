@@ -38,7 +38,7 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new, const char *fname, apr
     ULONG action;
     apr_file_t *dafile = (apr_file_t *)apr_pcalloc(pool, sizeof(apr_file_t));
 
-    if (flag & APR_FOPEN_NONBLOCK) {
+    if (flag & (APR_FOPEN_NONBLOCK | APR_FOPEN_DIRECT)) {
         return APR_ENOTIMPL;
     }
 
@@ -220,6 +220,13 @@ APR_DECLARE(apr_status_t) apr_os_file_put(apr_file_t **file, apr_os_file_t *thef
 }
 
 
+APR_DECLARE(apr_status_t) apr_file_alignment_get(apr_size_t *align,
+                                                 apr_file_t *thefile)
+{
+    *align = 1;
+    return APR_SUCCESS;
+}
+
 APR_DECLARE(apr_status_t) apr_file_eof(apr_file_t *fptr)
 {
     if (!fptr->isopen || fptr->eof_hit == 1) {
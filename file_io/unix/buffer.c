@@ -24,6 +24,11 @@ APR_DECLARE(apr_status_t) apr_file_buffer_set(apr_file_t *file,
 {
     apr_status_t rv;
 
+    if (file->direct_align && bufsize) {
+        /* The buffer would make the transfers unaligned */
+        return APR_EINVAL;
+    }
+
     file_lock(file);
 
     if(file->buffered) {
@@ -17,10 +17,107 @@
 #include "apr_arch_file_io.h"
 #include "apr_file_io.h"
 
+#if defined(HAVE_LINUX_FS_H) && defined(HAVE_SYS_IOCTL_H)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#if defined(__linux__) && defined(HAVE_SYS_SENDFILE_H)
+#include <sys/sendfile.h>
+#define USE_SENDFILE_COPY
+#endif
+
+#if defined(FICLONE) || defined(HAVE_COPY_FILE_RANGE) \
+    || defined(USE_SENDFILE_COPY)
+
+/* The amount of data copied by each system call */
+#define COPY_CHUNK 0x40000000
+
+/* Whether a method does not work for these files (or this system), and
+ * the next one should be tried.
+ */
+#define COPY_FALLBACK(err) ((err) == EXDEV || (err) == EINVAL \
+                            || (err) == ENOSYS || (err) == EOPNOTSUPP \
+                            || (err) == ENOTTY || (err) == EBADF \
+                            || (err) == ETXTBSY)
+
+/* Copy using the system methods, the file offsets are advanced by what's
+ * copied so that the next method can take over from there.  Some files
+ * (procfs, sysfs, FUSE...) report a size but look empty to the system
+ * methods, so nothing copied is not the end of the file.
+ */
+static apr_status_t transfer_contents_fast(apr_file_t *s, apr_file_t *d,
+                                           int truncated,
+                                           apr_int32_t methods,
+                                           apr_int32_t *used, int *done)
+{
+    ssize_t rv;
+    int copied = 0;
+
+#ifdef FICLONE
+    /* The whole file only, into an empty one */
+    if ((methods & APR_FILE_COPY_CLONE) && truncated) {
+        if (ioctl(d->filedes, FICLONE, s->filedes) == 0) {
+            *used |= APR_FILE_COPY_CLONE;
+            *done = 1;
+            return APR_SUCCESS;
+        }
+        if (!COPY_FALLBACK(errno)) {
+            return errno;
+        }
+    }
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+    if (methods & APR_FILE_COPY_RANGE) {
+        do {
+            rv = copy_file_range(s->filedes, NULL, d->filedes, NULL,
+                                 COPY_CHUNK, 0);
+            if (rv > 0) {
+                *used |= APR_FILE_COPY_RANGE;
+                copied = 1;
+            }
+        } while (rv > 0 || (rv < 0 && errno == EINTR));
+        if (rv == 0 && copied) {
+            *done = 1;
+            return APR_SUCCESS;
+        }
+        if (rv < 0 && !COPY_FALLBACK(errno)) {
+            return errno;
+        }
+    }
+#endif
+
+#ifdef USE_SENDFILE_COPY
+    if (methods & APR_FILE_COPY_SENDFILE) {
+        do {
+            rv = sendfile(d->filedes, s->filedes, NULL, COPY_CHUNK);
+            if (rv > 0) {
+                *used |= APR_FILE_COPY_SENDFILE;
+                copied = 1;
+            }
+        } while (rv > 0 || (rv < 0 && errno == EINTR));
+        if (rv == 0 && copied) {
+            *done = 1;
+            return APR_SUCCESS;
+        }
+        if (rv < 0 && !COPY_FALLBACK(errno)) {
+            return errno;
+        }
+    }
+#endif
+
+    return APR_SUCCESS;
+}
+
+#define HAVE_TRANSFER_CONTENTS_FAST
+#endif
+
 static apr_status_t apr_file_transfer_contents(const char *from_path,
                                                const char *to_path,
                                                apr_int32_t flags,
                                                apr_fileperms_t to_perms,
+                                               apr_int32_t methods,
+                                               apr_int32_t *used,
                                                apr_pool_t *pool)
 {
     apr_file_t *s, *d;
@@ -28,18 +125,22 @@ static apr_status_t apr_file_transfer_contents(const char *from_path,
     apr_finfo_t finfo;
     apr_fileperms_t perms;
 
+    *used = 0;
+
     /* Open source file. */
     status = apr_file_open(&s, from_path, APR_FOPEN_READ, APR_FPROT_OS_DEFAULT, pool);
     if (status)
         return status;
 
-    /* Maybe get its permissions. */
+    /* Get its type and size, and maybe its permissions. */
+    status = apr_file_info_get(&finfo, APR_FINFO_TYPE | APR_FINFO_SIZE
+                               | ((to_perms == APR_FPROT_FILE_SOURCE_PERMS)
+                                  ? APR_FINFO_PROT : 0), s);
+    if (status != APR_SUCCESS && status != APR_INCOMPLETE) {
+        apr_file_close(s);  /* toss any error */
+        return status;
+    }
     if (to_perms == APR_FPROT_FILE_SOURCE_PERMS) {
-        status = apr_file_info_get(&finfo, APR_FINFO_PROT, s);
-        if (status != APR_SUCCESS && status != APR_INCOMPLETE) {
-            apr_file_close(s);  /* toss any error */
-            return status;
-        }
         perms = finfo.protection;
         apr_file_perms_set(to_path, perms);  /* ignore any failure */
     }
@@ -53,6 +154,34 @@ static apr_status_t apr_file_transfer_contents(const char *from_path,
         return status;
     }
 
+#ifdef HAVE_TRANSFER_CONTENTS_FAST
+    /* Special files may not report their size, nor work with the system
+     * methods which would see them empty.
+     */
+    if ((finfo.valid & APR_FINFO_TYPE) && finfo.filetype == APR_REG
+            && (finfo.valid & APR_FINFO_SIZE) && finfo.size > 0) {
+        int done = 0;
+
+        status = transfer_contents_fast(s, d, flags & APR_FOPEN_TRUNCATE,
+                                        methods, used, &done);
+        if (status || done) {
+            apr_file_close(s);  /* toss any error */
+            if (status) {
+                apr_file_close(d);  /* toss any error */
+                return status;
+            }
+            return apr_file_close(d);
+        }
+    }
+#endif
+
+    if (!(methods & APR_FILE_COPY_BUFFERED)) {
+        apr_file_close(s);  /* toss any error */
+        apr_file_close(d);  /* toss any error */
+        return APR_ENOTIMPL;
+    }
+    *used |= APR_FILE_COPY_BUFFERED;
+
 #if BUFSIZ > APR_FILE_DEFAULT_BUFSIZE
 #define COPY_BUFSIZ BUFSIZ
 #else
@@ -101,9 +230,26 @@ APR_DECLARE(apr_status_t) apr_file_copy(const char *from_path,
                                         apr_fileperms_t perms,
                                         apr_pool_t *pool)
 {
+    apr_int32_t used;
+
     return apr_file_transfer_contents(from_path, to_path,
                                       (APR_FOPEN_WRITE | APR_FOPEN_CREATE | APR_FOPEN_TRUNCATE),
-                                      perms,
+                                      perms, APR_FILE_COPY_ALL, &used,
+                                      pool);
+}
+
+APR_DECLARE(apr_status_t) apr_file_copy_ex(const char *from_path,
+                                           const char *to_path,
+                                           apr_fileperms_t perms,
+                                           apr_int32_t methods,
+                                           apr_int32_t *used,
+                                           apr_pool_t *pool)
+{
+    apr_int32_t dummy;
+
+    return apr_file_transfer_contents(from_path, to_path,
+                                      (APR_FOPEN_WRITE | APR_FOPEN_CREATE | APR_FOPEN_TRUNCATE),
+                                      perms, methods, used ? used : &dummy,
                                       pool);
 }
 
@@ -112,8 +258,11 @@ APR_DECLARE(apr_status_t) apr_file_append(const char *from_path,
                                           apr_fileperms_t perms,
                                           apr_pool_t *pool)
 {
+    apr_int32_t used;
+
+    /* The system methods don't write in append mode, so it's buffered */
     return apr_file_transfer_contents(from_path, to_path,
                                       (APR_FOPEN_WRITE | APR_FOPEN_CREATE | APR_FOPEN_APPEND),
-                                      perms,
+                                      perms, APR_FILE_COPY_BUFFERED, &used,
                                       pool);
 }
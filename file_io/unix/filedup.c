@@ -74,6 +74,8 @@ static apr_status_t file_dup(apr_file_t **new_file,
 
     (*new_file)->fname = apr_pstrdup(p, old_file->fname);
     (*new_file)->buffered = old_file->buffered;
+    /* O_DIRECT is shared by the duplicates */
+    (*new_file)->direct_align = old_file->direct_align;
 
     /* If the existing socket in a dup2 is already buffered, we
      * have an existing and valid (hopefully) mutex, so we don't
@@ -88,6 +88,22 @@ apr_status_t apr_unix_child_file_cleanup(void *thefile)
     return file_cleanup(thefile, 1);
 }
 
+/* The alignment of direct I/O on the file, both in memory and on disk */
+static apr_size_t file_direct_align(int fd)
+{
+#if defined(HAVE_STATX) && defined(STATX_DIOALIGN)
+    struct statx stx;
+
+    if (statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0
+            && (stx.stx_mask & STATX_DIOALIGN)
+            && stx.stx_dio_offset_align) {
+        return (stx.stx_dio_mem_align > stx.stx_dio_offset_align)
+               ? stx.stx_dio_mem_align : stx.stx_dio_offset_align;
+    }
+#endif
+    return APR_FILE_DIRECT_ALIGN;
+}
+
 APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new,
                                         const char *fname,
                                         apr_int32_t flag,
@@ -144,6 +160,18 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new,
 #endif
     }
 
+    if (flag & APR_FOPEN_DIRECT) {
+        /* The user buffer would make the transfers unaligned */
+        if (flag & APR_FOPEN_BUFFERED) {
+            return APR_EINVAL;
+        }
+#ifdef O_DIRECT
+        oflags |= O_DIRECT;
+#elif !defined(F_NOCACHE)
+        return APR_ENOTIMPL;
+#endif
+    }
+
 #ifdef O_CLOEXEC
     /* Introduced in Linux 2.6.23. Silently ignored on earlier Linux kernels.
      */
@@ -179,6 +207,13 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new,
     if (fd < 0) {
        return errno;
     }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    if ((flag & APR_FOPEN_DIRECT) && fcntl(fd, F_NOCACHE, 1) == -1) {
+        rv = errno;
+        close(fd);
+        return rv;
+    }
+#endif
     if (!(flag & APR_FOPEN_NOCLEANUP)) {
 #ifdef O_CLOEXEC
         static int has_o_cloexec = 0;
@@ -215,6 +250,9 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new,
 
     (*new)->blocking = BLK_ON;
     (*new)->buffered = (flag & APR_FOPEN_BUFFERED) > 0;
+    if (flag & APR_FOPEN_DIRECT) {
+        (*new)->direct_align = file_direct_align(fd);
+    }
 
     if ((*new)->buffered) {
         (*new)->buffer = apr_palloc(pool, APR_FILE_DEFAULT_BUFSIZE);
@@ -248,6 +286,14 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new,
                                   apr_unix_child_file_cleanup);
     }
 
+    /* Advisory only, failures are ignored */
+    if (flag & APR_FOPEN_SEQUENTIAL) {
+        (void)apr_file_advise(*new, 0, 0, APR_FADVISE_SEQUENTIAL);
+    }
+    else if (flag & APR_FOPEN_RANDOM) {
+        (void)apr_file_advise(*new, 0, 0, APR_FADVISE_RANDOM);
+    }
+
     if ((flag & APR_FOPEN_ROTATING) || (flag & APR_FOPEN_MANUAL_ROTATE)) {
         (*new)->rotating = (apr_rotating_info_t *)apr_pcalloc(pool,
                                                               sizeof(apr_rotating_info_t));
@@ -314,6 +360,10 @@ APR_DECLARE(apr_status_t) apr_os_file_put(apr_file_t **file,
 {
     int *dafile = thefile;
 
+    if ((flags & APR_FOPEN_DIRECT) && (flags & APR_FOPEN_BUFFERED)) {
+        return APR_EINVAL;
+    }
+
     (*file) = apr_pcalloc(pool, sizeof(apr_file_t));
     (*file)->pool = pool;
     (*file)->eof_hit = 0;
@@ -323,6 +373,9 @@ APR_DECLARE(apr_status_t) apr_os_file_put(apr_file_t **file,
     (*file)->filedes = *dafile;
     (*file)->flags = flags | APR_FOPEN_NOCLEANUP;
     (*file)->buffered = (flags & APR_FOPEN_BUFFERED) > 0;
+    if (flags & APR_FOPEN_DIRECT) {
+        (*file)->direct_align = file_direct_align(*dafile);
+    }
 
 #ifndef WAITIO_USES_POLL
     /* Start out with no pollset.  apr_wait_for_io_or_timeout() will
@@ -348,6 +401,13 @@ APR_DECLARE(apr_status_t) apr_os_file_put(apr_file_t **file,
     return APR_SUCCESS;
 }
 
+APR_DECLARE(apr_status_t) apr_file_alignment_get(apr_size_t *align,
+                                                 apr_file_t *thefile)
+{
+    *align = thefile->direct_align ? thefile->direct_align : 1;
+    return APR_SUCCESS;
+}
+
 APR_DECLARE(apr_status_t) apr_file_eof(apr_file_t *fptr)
 {
     if (fptr->eof_hit == 1) {
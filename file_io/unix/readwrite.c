@@ -27,6 +27,33 @@
 #define USE_WAIT_FOR_IO
 #endif
 
+/* APR_FOPEN_DIRECT transfers need aligned buffers, lengths and offsets,
+ * the system fails them with EINVAL otherwise (or when the current offset
+ * is not aligned, which only it knows).
+ */
+#define file_direct_misaligned(f, buf, len, off) \
+    ((f)->direct_align \
+     && (((apr_uintptr_t)(buf) | (apr_uintptr_t)(len) \
+          | (apr_uintptr_t)(off)) & ((f)->direct_align - 1)))
+
+#define file_direct_error(f, err) \
+    (((f)->direct_align && (err) == EINVAL) ? APR_EMISALIGNED : (err))
+
+static int file_direct_misaligned_vec(apr_file_t *thefile,
+                                      const struct iovec *vec,
+                                      apr_size_t nvec, apr_off_t offset)
+{
+    apr_size_t i;
+
+    for (i = 0; i < nvec; i++) {
+        if (file_direct_misaligned(thefile, vec[i].iov_base,
+                                   vec[i].iov_len, offset)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 static apr_status_t file_read_buffered(apr_file_t *thefile, void *buf,
                                        apr_size_t *nbytes)
 {
@@ -101,6 +128,11 @@ APR_DECLARE(apr_status_t) apr_file_read(apr_file_t *thefile, void *buf, apr_size
         return rv;
     }
     else {
+        if (file_direct_misaligned(thefile, buf, *nbytes, 0)) {
+            *nbytes = 0;
+            return APR_EMISALIGNED;
+        }
+
         bytes_read = 0;
         if (thefile->ungetchar != -1) {
             bytes_read = 1;
@@ -142,7 +174,7 @@ APR_DECLARE(apr_status_t) apr_file_read(apr_file_t *thefile, void *buf, apr_size
             *nbytes += rv;
             return APR_SUCCESS;
         }
-        return errno;
+        return file_direct_error(thefile, errno);
     }
 }
 
@@ -269,6 +301,11 @@ APR_DECLARE(apr_status_t) apr_file_write(apr_file_t *thefile, const void *buf, a
         return rv;
     }
     else {
+        if (file_direct_misaligned(thefile, buf, *nbytes, 0)) {
+            *nbytes = 0;
+            return APR_EMISALIGNED;
+        }
+
         do {
             rv = write(thefile->filedes, buf, *nbytes);
         } while (rv == (apr_size_t)-1 && errno == EINTR);
@@ -301,7 +338,7 @@ APR_DECLARE(apr_status_t) apr_file_write(apr_file_t *thefile, const void *buf, a
 #endif
         if (rv == (apr_size_t)-1) {
             (*nbytes) = 0;
-            return errno;
+            return file_direct_error(thefile, errno);
         }
         *nbytes = rv;
         return APR_SUCCESS;
@@ -345,9 +382,14 @@ APR_DECLARE(apr_status_t) apr_file_writev(apr_file_t *thefile, const struct iove
         return rv;
     }
 
+    if (file_direct_misaligned_vec(thefile, vec, nvec, 0)) {
+        *nbytes = 0;
+        return APR_EMISALIGNED;
+    }
+
     if ((bytes = writev(thefile->filedes, vec, nvec)) < 0) {
         *nbytes = 0;
-        rv = errno;
+        rv = file_direct_error(thefile, errno);
     }
     else {
         *nbytes = bytes;
@@ -374,6 +416,266 @@ APR_DECLARE(apr_status_t) apr_file_writev(apr_file_t *thefile, const struct iove
 #endif
 }
 
+#if defined(HAVE_PREAD) && defined(HAVE_PWRITE)
+
+/* Positional I/O bypasses the user buffer, what is pending there is
+ * written first, and what was read ahead is discarded before writing.
+ */
+static apr_status_t file_positional_prepare(apr_file_t *thefile, int writing)
+{
+    apr_status_t rv = APR_SUCCESS;
+
+    if (thefile->buffered) {
+        file_lock(thefile);
+        if (thefile->direction == 1) {
+            rv = apr_file_flush_locked(thefile);
+        }
+        else if (writing && thefile->dataRead) {
+            /* Position file pointer at the offset we are logically
+             * reading from
+             */
+            apr_off_t offset = thefile->filePtr - thefile->dataRead +
+                               thefile->bufpos;
+            if (lseek(thefile->filedes, offset, SEEK_SET) == -1) {
+                rv = errno;
+            }
+            else {
+                thefile->filePtr = offset;
+                thefile->bufpos = thefile->dataRead = 0;
+            }
+        }
+        file_unlock(thefile);
+    }
+    return rv;
+}
+
+APR_DECLARE(apr_status_t) apr_file_pread(apr_file_t *thefile, void *buf,
+                                         apr_size_t *nbytes,
+                                         apr_off_t offset)
+{
+    apr_status_t rv;
+    apr_ssize_t bytes;
+
+    if (*nbytes == 0) {
+        return APR_SUCCESS;
+    }
+    if (file_direct_misaligned(thefile, buf, *nbytes, offset)) {
+        *nbytes = 0;
+        return APR_EMISALIGNED;
+    }
+
+    rv = file_positional_prepare(thefile, 0);
+    if (rv != APR_SUCCESS) {
+        *nbytes = 0;
+        return rv;
+    }
+
+    do {
+        bytes = pread(thefile->filedes, buf, *nbytes, offset);
+    } while (bytes == -1 && errno == EINTR);
+    if (bytes == -1) {
+        *nbytes = 0;
+        return file_direct_error(thefile, errno);
+    }
+    *nbytes = bytes;
+    return bytes ? APR_SUCCESS : APR_EOF;
+}
+
+APR_DECLARE(apr_status_t) apr_file_pwrite(apr_file_t *thefile,
+                                          const void *buf,
+                                          apr_size_t *nbytes,
+                                          apr_off_t offset)
+{
+    apr_status_t rv;
+    apr_ssize_t bytes;
+
+    if (file_direct_misaligned(thefile, buf, *nbytes, offset)) {
+        *nbytes = 0;
+        return APR_EMISALIGNED;
+    }
+
+    rv = file_positional_prepare(thefile, 1);
+    if (rv == APR_SUCCESS) {
+        rv = file_rotating_check(thefile);
+    }
+    if (rv != APR_SUCCESS) {
+        *nbytes = 0;
+        return rv;
+    }
+
+    do {
+        bytes = pwrite(thefile->filedes, buf, *nbytes, offset);
+    } while (bytes == -1 && errno == EINTR);
+    if (bytes == -1) {
+        *nbytes = 0;
+        return file_direct_error(thefile, errno);
+    }
+    *nbytes = bytes;
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_file_preadv(apr_file_t *thefile,
+                                          const struct iovec *vec,
+                                          apr_size_t nvec, apr_off_t offset,
+                                          apr_size_t *nbytes)
+{
+#ifdef HAVE_PREADV
+    apr_status_t rv;
+    apr_ssize_t bytes;
+    apr_size_t i;
+
+    *nbytes = 0;
+    if (nvec > APR_MAX_IOVEC_SIZE) {
+        return APR_EINVAL;
+    }
+    if (file_direct_misaligned_vec(thefile, vec, nvec, offset)) {
+        return APR_EMISALIGNED;
+    }
+
+    rv = file_positional_prepare(thefile, 0);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+
+    do {
+        bytes = preadv(thefile->filedes, vec, (int)nvec, offset);
+    } while (bytes == -1 && errno == EINTR);
+    if (bytes == -1) {
+        return file_direct_error(thefile, errno);
+    }
+    *nbytes = bytes;
+    if (bytes == 0) {
+        for (i = 0; i < nvec; i++) {
+            if (vec[i].iov_len) {
+                return APR_EOF;
+            }
+        }
+    }
+    return APR_SUCCESS;
+#else
+    /* One pread() per buffer, up to the first short read */
+    apr_status_t rv = APR_SUCCESS;
+    apr_size_t i, n;
+
+    *nbytes = 0;
+    if (nvec > APR_MAX_IOVEC_SIZE) {
+        return APR_EINVAL;
+    }
+
+    for (i = 0; i < nvec; i++) {
+        n = vec[i].iov_len;
+        rv = apr_file_pread(thefile, vec[i].iov_base, &n, offset);
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+        *nbytes += n;
+        offset += n;
+        if (n < vec[i].iov_len) {
+            break;
+        }
+    }
+    return *nbytes ? APR_SUCCESS : rv;
+#endif
+}
+
+APR_DECLARE(apr_status_t) apr_file_pwritev(apr_file_t *thefile,
+                                           const struct iovec *vec,
+                                           apr_size_t nvec, apr_off_t offset,
+                                           apr_size_t *nbytes)
+{
+#ifdef HAVE_PWRITEV
+    apr_status_t rv;
+    apr_ssize_t bytes;
+
+    *nbytes = 0;
+    if (nvec > APR_MAX_IOVEC_SIZE) {
+        return APR_EINVAL;
+    }
+    if (file_direct_misaligned_vec(thefile, vec, nvec, offset)) {
+        return APR_EMISALIGNED;
+    }
+
+    rv = file_positional_prepare(thefile, 1);
+    if (rv == APR_SUCCESS) {
+        rv = file_rotating_check(thefile);
+    }
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+
+    do {
+        bytes = pwritev(thefile->filedes, vec, (int)nvec, offset);
+    } while (bytes == -1 && errno == EINTR);
+    if (bytes == -1) {
+        return file_direct_error(thefile, errno);
+    }
+    *nbytes = bytes;
+    return APR_SUCCESS;
+#else
+    /* One pwrite() per buffer, up to the first short write */
+    apr_status_t rv = APR_SUCCESS;
+    apr_size_t i, n;
+
+    *nbytes = 0;
+    if (nvec > APR_MAX_IOVEC_SIZE) {
+        return APR_EINVAL;
+    }
+
+    for (i = 0; i < nvec; i++) {
+        n = vec[i].iov_len;
+        rv = apr_file_pwrite(thefile, vec[i].iov_base, &n, offset);
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+        *nbytes += n;
+        offset += n;
+        if (n < vec[i].iov_len) {
+            break;
+        }
+    }
+    return *nbytes ? APR_SUCCESS : rv;
+#endif
+}
+
+#else /* !HAVE_PREAD || !HAVE_PWRITE */
+
+APR_DECLARE(apr_status_t) apr_file_pread(apr_file_t *thefile, void *buf,
+                                         apr_size_t *nbytes,
+                                         apr_off_t offset)
+{
+    *nbytes = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_file_pwrite(apr_file_t *thefile,
+                                          const void *buf,
+                                          apr_size_t *nbytes,
+                                          apr_off_t offset)
+{
+    *nbytes = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_file_preadv(apr_file_t *thefile,
+                                          const struct iovec *vec,
+                                          apr_size_t nvec, apr_off_t offset,
+                                          apr_size_t *nbytes)
+{
+    *nbytes = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_file_pwritev(apr_file_t *thefile,
+                                           const struct iovec *vec,
+                                           apr_size_t nvec, apr_off_t offset,
+                                           apr_size_t *nbytes)
+{
+    *nbytes = 0;
+    return APR_ENOTIMPL;
+}
+
+#endif /* HAVE_PREAD && HAVE_PWRITE */
+
 APR_DECLARE(apr_status_t) apr_file_putc(char ch, apr_file_t *thefile)
 {
     apr_size_t nbytes = 1;
@@ -499,6 +801,40 @@ APR_DECLARE(apr_status_t) apr_file_datasync(apr_file_t *thefile)
     return rv;
 }
 
+APR_DECLARE(apr_status_t) apr_file_advise(apr_file_t *thefile,
+                                          apr_off_t offset, apr_off_t len,
+                                          int advice)
+{
+#ifdef HAVE_POSIX_FADVISE
+    int native;
+
+    switch (advice) {
+    case APR_FADVISE_NORMAL:
+        native = POSIX_FADV_NORMAL;
+        break;
+    case APR_FADVISE_SEQUENTIAL:
+        native = POSIX_FADV_SEQUENTIAL;
+        break;
+    case APR_FADVISE_RANDOM:
+        native = POSIX_FADV_RANDOM;
+        break;
+    case APR_FADVISE_WILLNEED:
+        native = POSIX_FADV_WILLNEED;
+        break;
+    case APR_FADVISE_DONTNEED:
+        native = POSIX_FADV_DONTNEED;
+        break;
+    default:
+        return APR_EINVAL;
+    }
+
+    /* Returns the error rather than setting errno */
+    return posix_fadvise(thefile->filedes, offset, len, native);
+#else
+    return APR_ENOTIMPL;
+#endif
+}
+
 APR_DECLARE(apr_status_t) apr_file_gets(char *str, int len, apr_file_t *thefile)
 {
     apr_status_t rv = APR_SUCCESS; /* get rid of gcc warning */
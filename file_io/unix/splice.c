@@ -0,0 +1,254 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apr_arch_file_io.h"
+#include "apr_arch_networkio.h"
+#include "apr_network_io.h"
+
+#if defined(HAVE_SPLICE) && defined(HAVE_TEE) && defined(HAVE_POLL)
+
+#if HAVE_POLL_H
+#include <poll.h>
+#elif HAVE_SYS_POLL_H
+#include <sys/poll.h>
+#endif
+
+/* The shortest of two timeouts, negative ones meaning forever */
+static apr_interval_time_t splice_timeout(apr_interval_time_t t1,
+                                          apr_interval_time_t t2)
+{
+    if (t1 < 0) {
+        return t2;
+    }
+    if (t2 < 0) {
+        return t1;
+    }
+    return (t1 < t2) ? t1 : t2;
+}
+
+/* splice() tells EAGAIN without saying which side would block, so wait
+ * for both sides to be ready (or in error, for splice() to report it).
+ */
+static apr_status_t splice_wait(int infd, int outfd,
+                                apr_interval_time_t timeout)
+{
+    struct pollfd pfd[2];
+    apr_time_t deadline = 0;
+    int rc, i, pending = 2;
+
+    pfd[0].fd = infd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = outfd;
+    pfd[1].events = POLLOUT;
+
+    if (timeout > 0) {
+        deadline = apr_time_now() + timeout;
+    }
+    while (pending) {
+        int ms = -1;
+
+        if (timeout > 0) {
+            apr_interval_time_t left = deadline - apr_time_now();
+            if (left <= 0) {
+                return APR_TIMEUP;
+            }
+            ms = (int)((left + 999) / 1000);
+        }
+
+        pfd[0].revents = pfd[1].revents = 0;
+        rc = poll(pfd, 2, ms);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (rc == 0) {
+            return APR_TIMEUP;
+        }
+        for (i = 0; i < 2; i++) {
+            if (pfd[i].fd >= 0 && pfd[i].revents) {
+                /* Ready, stop polling it */
+                pfd[i].fd = -1;
+                pending--;
+            }
+        }
+    }
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t do_splice(int infd, int outfd, apr_size_t *len,
+                              apr_int32_t flags, int nonblock,
+                              apr_interval_time_t timeout, int tee_only)
+{
+    unsigned int sflags = SPLICE_F_MOVE;
+    ssize_t rv;
+
+    if (flags & APR_SPLICE_MORE) {
+        sflags |= SPLICE_F_MORE;
+    }
+    if (nonblock) {
+        sflags |= SPLICE_F_NONBLOCK;
+    }
+
+    for (;;) {
+        if (tee_only) {
+            rv = tee(infd, outfd, *len, sflags);
+        }
+        else {
+            rv = splice(infd, NULL, outfd, NULL, *len, sflags);
+        }
+        if (rv >= 0) {
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && timeout != 0) {
+            apr_status_t arv = splice_wait(infd, outfd, timeout);
+            if (arv != APR_SUCCESS) {
+                *len = 0;
+                return arv;
+            }
+            continue;
+        }
+        *len = 0;
+        return errno;
+    }
+
+    *len = rv;
+    if (rv == 0) {
+        return APR_EOF;
+    }
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_file_splice(apr_file_t *out, apr_file_t *in,
+                                          apr_size_t *len, apr_int32_t flags)
+{
+    apr_interval_time_t timeout = -1;
+    apr_status_t rv;
+    int nonblock = 0;
+
+    if ((!in->is_pipe && !out->is_pipe) || in->buffered || out->buffered) {
+        *len = 0;
+        return APR_EINVAL;
+    }
+    if (in->is_pipe) {
+        timeout = in->timeout;
+    }
+    if (out->is_pipe) {
+        timeout = splice_timeout(timeout, out->timeout);
+    }
+    if (timeout >= 0) {
+        nonblock = 1;
+    }
+
+    rv = do_splice(in->filedes, out->filedes, len, flags, nonblock,
+                   timeout, 0);
+    if (rv == APR_EOF) {
+        in->eof_hit = 1;
+    }
+    return rv;
+}
+
+APR_DECLARE(apr_status_t) apr_file_tee(apr_file_t *out, apr_file_t *in,
+                                       apr_size_t *len, apr_int32_t flags)
+{
+    apr_interval_time_t timeout;
+
+    if (!in->is_pipe || !out->is_pipe) {
+        *len = 0;
+        return APR_EINVAL;
+    }
+    timeout = splice_timeout(in->timeout, out->timeout);
+
+    return do_splice(in->filedes, out->filedes, len, flags, timeout >= 0,
+                     timeout, 1);
+}
+
+APR_DECLARE(apr_status_t) apr_socket_splice_in(apr_socket_t *sock,
+                                               apr_file_t *pipe,
+                                               apr_size_t *len,
+                                               apr_int32_t flags)
+{
+    apr_interval_time_t timeout;
+
+    if (!pipe->is_pipe) {
+        *len = 0;
+        return APR_EINVAL;
+    }
+    /* Either side having a timeout makes the whole splice non-blocking */
+    timeout = splice_timeout(sock->timeout, pipe->timeout);
+
+    return do_splice(sock->socketdes, pipe->filedes, len, flags, timeout >= 0,
+                     timeout, 0);
+}
+
+APR_DECLARE(apr_status_t) apr_socket_splice_out(apr_socket_t *sock,
+                                                apr_file_t *pipe,
+                                                apr_size_t *len,
+                                                apr_int32_t flags)
+{
+    apr_interval_time_t timeout;
+
+    if (!pipe->is_pipe) {
+        *len = 0;
+        return APR_EINVAL;
+    }
+    /* Either side having a timeout makes the whole splice non-blocking */
+    timeout = splice_timeout(sock->timeout, pipe->timeout);
+
+    return do_splice(pipe->filedes, sock->socketdes, len, flags, timeout >= 0,
+                     timeout, 0);
+}
+
+#else /* !HAVE_SPLICE || !HAVE_TEE || !HAVE_POLL */
+
+APR_DECLARE(apr_status_t) apr_file_splice(apr_file_t *out, apr_file_t *in,
+                                          apr_size_t *len, apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_file_tee(apr_file_t *out, apr_file_t *in,
+                                       apr_size_t *len, apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_socket_splice_in(apr_socket_t *sock,
+                                               apr_file_t *pipe,
+                                               apr_size_t *len,
+                                               apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_socket_splice_out(apr_socket_t *sock,
+                                                apr_file_t *pipe,
+                                                apr_size_t *len,
+                                                apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+#endif /* HAVE_SPLICE && HAVE_TEE && HAVE_POLL */
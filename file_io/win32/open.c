@@ -273,7 +273,7 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new, const char *fname,
     apr_wchar_t wfname[APR_PATH_MAX];
 
 
-    if (flag & APR_FOPEN_NONBLOCK) {
+    if (flag & (APR_FOPEN_NONBLOCK | APR_FOPEN_DIRECT)) {
         return APR_ENOTIMPL;
     }
     if (flag & APR_FOPEN_READ) {
@@ -335,6 +335,13 @@ APR_DECLARE(apr_status_t) apr_file_open(apr_file_t **new, const char *fname,
             oflags |= READ_CONTROL;
     }
 
+    if (flag & APR_FOPEN_SEQUENTIAL) {
+        attributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+    }
+    else if (flag & APR_FOPEN_RANDOM) {
+        attributes |= FILE_FLAG_RANDOM_ACCESS;
+    }
+
     if (flag & APR_FOPEN_XTHREAD) {
         /* This win32 specific feature is required
          * to allow multiple threads to work with the file.
@@ -534,6 +541,13 @@ APR_DECLARE(apr_status_t) apr_os_file_put(apr_file_t **file,
     return APR_SUCCESS;
 }
 
+APR_DECLARE(apr_status_t) apr_file_alignment_get(apr_size_t *align,
+                                                 apr_file_t *thefile)
+{
+    *align = 1;
+    return APR_SUCCESS;
+}
+
 APR_DECLARE(apr_status_t) apr_file_eof(apr_file_t *fptr)
 {
     if (fptr->eof_hit == 1) {
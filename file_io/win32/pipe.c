@@ -16,6 +16,7 @@
 
 #include "apr_arch_file_io.h"
 #include "apr_file_io.h"
+#include "apr_network_io.h"
 #include "apr_general.h"
 #include "apr_strings.h"
 #include "apr_escape.h"
@@ -274,3 +275,35 @@ APR_DECLARE(apr_status_t) apr_os_pipe_put(apr_file_t **file,
 {
     return apr_os_pipe_put_ex(file, thefile, 0, pool);
 }
+
+APR_DECLARE(apr_status_t) apr_file_splice(apr_file_t *out, apr_file_t *in,
+                                          apr_size_t *len, apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_file_tee(apr_file_t *out, apr_file_t *in,
+                                       apr_size_t *len, apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_socket_splice_in(apr_socket_t *sock,
+                                               apr_file_t *pipe,
+                                               apr_size_t *len,
+                                               apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_socket_splice_out(apr_socket_t *sock,
+                                                apr_file_t *pipe,
+                                                apr_size_t *len,
+                                                apr_int32_t flags)
+{
+    *len = 0;
+    return APR_ENOTIMPL;
+}
@@ -163,6 +163,27 @@ APR_DECLARE(void) apr_allocator_max_free_set(apr_allocator_t *allocator,
                                              apr_size_t size)
                   __attribute__((nonnull(1)));
 
+/**
+ * Set the maximum amount of memory the allocator may keep in each of its
+ * per-thread caches (magazines), in front of the shared free lists.
+ * @param allocator The allocator to set the cache size on
+ * @param size The maximum size cached per thread.  0 disables the caches
+ *        and gives the cached memory back to the free lists.
+ * @return APR_SUCCESS, APR_ENOMEM if the caches could not be allocated,
+ *         or APR_ENOTIMPL if APR is built without threads.
+ * @remark The caches avoid taking the allocator's mutex on most
+ *         allocations and frees when many threads share the allocator,
+ *         which is worthwhile only if a mutex is set for it.
+ * @remark Memory held in the caches is not accounted by
+ *         apr_allocator_max_free_set(), and is only given back to the
+ *         system when the caches are disabled or the allocator destroyed.
+ * @remark Should be called before the allocator is shared by threads,
+ *         never concurrently with allocations.
+ */
+APR_DECLARE(apr_status_t) apr_allocator_cache_set(apr_allocator_t *allocator,
+                                                  apr_size_t size)
+                          __attribute__((nonnull(1)));
+
 #include "apr_thread_mutex.h"
 
 #if APR_HAS_THREADS
@@ -632,6 +632,22 @@ struct apr_bucket_file {
     apr_pool_t *readpool;
     /** File read block size */
     apr_size_t read_size;
+    /** Whether the file may be read positionally (apr_file_pread()),
+     *  rather than with apr_file_seek() and apr_file_read() */
+    int can_pread;
+    /** The end of the part of the file advised to be read ahead, or -1
+     *  if the file takes no advice */
+    apr_off_t readahead;
+    /** Maximum size of the chunks prefetched, or 0 if not prefetching
+     *  (@see apr_bucket_file_set_prefetch) */
+    apr_size_t prefetch_max;
+    /** Size of the next chunk prefetched */
+    apr_size_t prefetch_size;
+    /** The offset in the file of the last chunk prefetched */
+    apr_off_t prefetch_offset;
+    /** The last chunk prefetched, shared with the heap buckets sliced
+     *  from it, or NULL */
+    apr_bucket_heap *prefetch;
 };
 
 /** @see apr_bucket_structs */
@@ -1601,6 +1617,29 @@ APR_DECLARE(apr_bucket *) apr_bucket_socket_make(apr_bucket *b,
                                                  apr_socket_t *thissock)
                           __attribute__((nonnull(1,2)));
 
+/**
+ * Forward the data of a SOCKET bucket to a socket without copying it
+ * through user space, for a consumer which would otherwise read the
+ * bucket only to write the data to @a sock.
+ * @param b The SOCKET bucket
+ * @param sock The socket to write the data to
+ * @param len On entry, the maximum number of bytes to forward; on exit,
+ *            the number of bytes forwarded
+ * @param block Whether the read from the bucket's socket should block
+ * @return APR_SUCCESS, APR_ENOTIMPL if splicing is not supported (the
+ *         bucket can still be read), or the error that occurred
+ * @remark Like apr_bucket_read(), the bucket is made an empty bucket at
+ *         the end of the data, with @a len set to zero.
+ * @remark The data is moved through a pipe bound to the bucket's socket.
+ *         If it cannot be fully written to @a sock, what remains is put
+ *         in a HEAP bucket inserted before @a b and the error is returned.
+ */
+APR_DECLARE(apr_status_t) apr_bucket_socket_splice(apr_bucket *b,
+                                                   apr_socket_t *sock,
+                                                   apr_size_t *len,
+                                                   apr_read_type_e block)
+                          __attribute__((nonnull(1,2,3)));
+
 /**
  * Create a bucket referring to a pipe.
  * @param thispipe The pipe to put in the bucket
@@ -1621,6 +1660,94 @@ APR_DECLARE(apr_bucket *) apr_bucket_pipe_make(apr_bucket *b,
                                                apr_file_t *thispipe)
                           __attribute__((nonnull(1,2)));
 
+/**
+ * Forward the data of a PIPE bucket to a socket without copying it
+ * through user space, for a consumer which would otherwise read the
+ * bucket only to write the data to @a sock.
+ * @param b The PIPE bucket
+ * @param sock The socket to write the data to
+ * @param len On entry, the maximum number of bytes to forward; on exit,
+ *            the number of bytes forwarded
+ * @param block Whether the read from the bucket's pipe should block, a
+ *              non-blocking read does not wait for @a sock either
+ * @return APR_SUCCESS, APR_ENOTIMPL if splicing is not supported (the
+ *         bucket can still be read), or the error that occurred
+ * @remark Like apr_bucket_read(), the bucket is made an empty bucket at
+ *         the end of the data, with @a len set to zero, and the pipe is
+ *         closed.
+ */
+APR_DECLARE(apr_status_t) apr_bucket_pipe_splice(apr_bucket *b,
+                                                 apr_socket_t *sock,
+                                                 apr_size_t *len,
+                                                 apr_read_type_e block)
+                          __attribute__((nonnull(1,2,3)));
+
+/**
+ * Forward the data of a bucket to a socket without copying it through
+ * user space, if the bucket type allows for it.
+ * @param b The bucket
+ * @param sock The socket to write the data to
+ * @param len On entry, the maximum number of bytes to forward; on exit,
+ *            the number of bytes forwarded
+ * @param block Whether the read from the bucket should block
+ * @return APR_ENOTIMPL if the bucket cannot be spliced, which should
+ *         then be read, otherwise as apr_bucket_socket_splice() or
+ *         apr_bucket_pipe_splice() for SOCKET and PIPE buckets.
+ */
+APR_DECLARE(apr_status_t) apr_bucket_splice(apr_bucket *b,
+                                            apr_socket_t *sock,
+                                            apr_size_t *len,
+                                            apr_read_type_e block)
+                          __attribute__((nonnull(1,2,3)));
+
+/**
+ * The buckets held until the sends of their data without copying it, by
+ * apr_socket_sendv() with the APR_SO_ZEROCOPY option, complete.
+ */
+typedef struct apr_bucket_zerocopy_t apr_bucket_zerocopy_t;
+
+/**
+ * Create a holder for the buckets sent without copying their data.
+ * @param sock The socket the buckets are sent to
+ * @param p The pool to allocate from, the buckets still held when it is
+ *          cleared are destroyed
+ * @param list The freelist the buckets are allocated from
+ * @return The new holder
+ */
+APR_DECLARE(apr_bucket_zerocopy_t *) apr_bucket_zerocopy_create(
+                                             apr_socket_t *sock,
+                                             apr_pool_t *p,
+                                             apr_bucket_alloc_t *list)
+                          __attribute__((nonnull(1,2,3)));
+
+/**
+ * Hold a bucket whose data were sent by apr_socket_sendv() until the sends
+ * done so far on the socket complete, instead of destroying it.
+ * @param zc The holder
+ * @param b The bucket, removed from its brigade
+ * @return APR_SUCCESS, APR_EINVAL if @a b is a TRANSIENT bucket whose
+ *         data could not be held anyway, or the error of
+ *         apr_socket_zerocopy_reap()
+ * @remark The bucket is destroyed immediately if the sends completed or
+ *         if the platform does not support APR_SO_ZEROCOPY.
+ */
+APR_DECLARE(apr_status_t) apr_bucket_zerocopy_hold(apr_bucket_zerocopy_t *zc,
+                                                   apr_bucket *b)
+                          __attribute__((nonnull(1,2)));
+
+/**
+ * Destroy the held buckets whose sends completed.
+ * @param zc The holder
+ * @param block Whether to wait for a completion if buckets are held, see
+ *              apr_socket_zerocopy_reap()
+ * @param held If not NULL, set to the number of buckets still held
+ * @return APR_SUCCESS or the error of apr_socket_zerocopy_reap()
+ */
+APR_DECLARE(apr_status_t) apr_bucket_zerocopy_reap(apr_bucket_zerocopy_t *zc,
+                                                   int block,
+                                                   apr_size_t *held)
+                          __attribute__((nonnull(1)));
+
 /**
  * Create a bucket referring to a file.
  * @param fd The file to put in the bucket
@@ -1682,6 +1809,23 @@ APR_DECLARE(apr_status_t) apr_bucket_file_enable_mmap(apr_bucket *b,
 APR_DECLARE(apr_status_t) apr_bucket_file_set_buf_size(apr_bucket *b,
                                                        apr_size_t size);
 
+/**
+ * Enable or disable prefetching for a FILE bucket (default is disabled)
+ * @param b The bucket
+ * @param max_size Maximum size of the chunks prefetched, or 0 to disable
+ * @return APR_SUCCESS normally, or an error code if the operation fails
+ * @remark When prefetching, the file is read in page aligned chunks whose
+ * size starts at the buffer size (@see apr_bucket_file_set_buf_size) and
+ * doubles up to @a max_size as long as the file is consumed sequentially.
+ * Reads hand out the data of the current chunk as HEAP buckets sharing it,
+ * without copying, which also saves the file buckets split or copied from
+ * @a b from reading the data again.
+ * @remark Relevant/used only when memory-mapping is disabled (@see
+ * apr_bucket_file_enable_mmap)
+ */
+APR_DECLARE(apr_status_t) apr_bucket_file_set_prefetch(apr_bucket *b,
+                                                       apr_size_t max_size);
+
 /** @} */
 #ifdef __cplusplus
 }
@@ -248,6 +248,8 @@ APR_DECLARE(char *) apr_strerror(apr_status_t statcode, char *buf,
  * APR_EBADMASK     The specified netmask is invalid
  * APR_ESYMNOTFOUND Could not find the requested symbol
  * APR_ENOTENOUGHENTROPY Not enough entropy to continue
+ * APR_EMISALIGNED  The buffer, offset or length of a direct I/O is not
+ *                  aligned as required
  * </PRE>
  *
  * <PRE>
@@ -338,6 +340,8 @@ APR_DECLARE(char *) apr_strerror(apr_status_t statcode, char *buf,
 #define APR_EPROC_UNKNOWN  (APR_OS_START_ERROR + 27)
 /** @see APR_STATUS_IS_ENOTENOUGHENTROPY */
 #define APR_ENOTENOUGHENTROPY (APR_OS_START_ERROR + 28)
+/** @see APR_STATUS_IS_EMISALIGNED */
+#define APR_EMISALIGNED    (APR_OS_START_ERROR + 29)
 /** @} */
 
 /**
@@ -433,6 +437,9 @@ APR_DECLARE(char *) apr_strerror(apr_status_t statcode, char *buf,
 #define APR_STATUS_IS_EPROC_UNKNOWN(s)  ((s) == APR_EPROC_UNKNOWN)
 /** APR could not gather enough entropy to continue. */
 #define APR_STATUS_IS_ENOTENOUGHENTROPY(s) ((s) == APR_ENOTENOUGHENTROPY)
+/** The buffer, offset or length of a direct I/O is not aligned as required,
+ *  see apr_file_alignment_get(). */
+#define APR_STATUS_IS_EMISALIGNED(s)    ((s) == APR_EMISALIGNED)
 
 /** @} */
 
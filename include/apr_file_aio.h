@@ -0,0 +1,212 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APR_FILE_AIO_H
+#define APR_FILE_AIO_H
+
+/**
+ * @file apr_file_aio.h
+ * @brief APR Asynchronous File I/O
+ */
+
+#include "apr.h"
+#include "apr_pools.h"
+#include "apr_errno.h"
+#include "apr_file_io.h"
+#include "apr_time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * @defgroup apr_file_aio Asynchronous File I/O
+ * @ingroup APR
+ *
+ * Reads, writes and syncs of files are submitted to an apr_file_aio_t and
+ * performed in the background, by the kernel with io_uring on Linux or else
+ * by a pool of threads.  Their completions are reaped with
+ * apr_file_aio_reap(), which runs the callbacks of the completed operations
+ * in the calling thread.  A file signaling pending completions can be
+ * polled with the other descriptors of an apr_pollset_t or apr_pollcb_t.
+ *
+ * An apr_file_aio_t is not thread safe, operations should be submitted and
+ * reaped by one thread at a time.
+ *
+ * Without positional I/O (apr_file_pread() and apr_file_pwrite() returning
+ * APR_ENOTIMPL), the reads and writes seek the file and move its file
+ * pointer, the operations of an engine taking turns; the file should not
+ * be used otherwise while they are in flight.
+ * @{
+ */
+
+/** Opaque asynchronous I/O engine */
+typedef struct apr_file_aio_t apr_file_aio_t;
+
+/** Flag for apr_file_aio_create(): use the threads even if io_uring is
+ *  available */
+#define APR_FILE_AIO_THREADS   0x1
+
+/** Asynchronous file operations */
+typedef enum {
+    APR_FILE_AIO_READ,      /**< Read, as apr_file_pread() */
+    APR_FILE_AIO_WRITE,     /**< Write, as apr_file_pwrite() */
+    APR_FILE_AIO_SYNC,      /**< Sync, as apr_file_sync() */
+    APR_FILE_AIO_DATASYNC   /**< Sync the data, as apr_file_datasync() */
+} apr_file_aio_type_e;
+
+/** @see apr_file_aio_op_t */
+typedef struct apr_file_aio_op_t apr_file_aio_op_t;
+
+/**
+ * Completion callback of an asynchronous operation.
+ * @param op The operation, whose status and nbytes are set.
+ */
+typedef void (apr_file_aio_cb_t)(apr_file_aio_op_t *op);
+
+/** An asynchronous file operation, filled by the caller and submitted
+ *  with apr_file_aio_submit(); it must stay valid until completed. */
+struct apr_file_aio_op_t {
+    /** The operation */
+    apr_file_aio_type_e type;
+    /** The file, whose buffer (if #APR_FOPEN_BUFFERED) is flushed on
+     *  submission and should not be used until completion */
+    apr_file_t *file;
+    /** The data read or written */
+    void *buf;
+    /** The number of bytes to read or write */
+    apr_size_t len;
+    /** The offset in the file to read from or write at */
+    apr_off_t offset;
+    /** The index of the registered buffer containing @a buf, or -1
+     *  (see apr_file_aio_buffers_register()) */
+    int buf_index;
+    /** Called on completion by apr_file_aio_reap(), if not NULL */
+    apr_file_aio_cb_t *cb;
+    /** Allows app to associate context with the operation */
+    void *baton;
+    /** On completion, APR_SUCCESS, APR_EOF if a read is at or past the end
+     *  of the file, or the error that occurred */
+    apr_status_t status;
+    /** On completion, the number of bytes read or written */
+    apr_size_t nbytes;
+    /** Private, the engine the operation was submitted to */
+    apr_file_aio_t *aio;
+    /** Private, the next completed operation */
+    apr_file_aio_op_t *next;
+};
+
+/**
+ * Create an asynchronous I/O engine.
+ * @param aio The engine created.
+ * @param size The number of operations expected in flight, it's not a
+ *        limit but sizes the io_uring or the number of threads.
+ * @param flags Zero or #APR_FILE_AIO_THREADS.
+ * @param p The pool to allocate the engine from, and whose destruction
+ *        waits for the operations in flight (discarding their completion).
+ * @return APR_SUCCESS, or the error that occurred.
+ * @remark Without io_uring nor threads, operations are performed
+ *         synchronously when submitted and completed when reaped.
+ */
+APR_DECLARE(apr_status_t) apr_file_aio_create(apr_file_aio_t **aio,
+                                              apr_uint32_t size,
+                                              apr_uint32_t flags,
+                                              apr_pool_t *p);
+
+/**
+ * Destroy an asynchronous I/O engine, waiting for the operations in flight
+ * (discarding their completion).
+ * @param aio The engine to destroy.
+ * @remark With the threads, the operations queued and not started yet are
+ *         cancelled; the callbacks are never run, for them nor for the
+ *         other operations not reaped yet.
+ */
+APR_DECLARE(apr_status_t) apr_file_aio_destroy(apr_file_aio_t *aio);
+
+/**
+ * Return the name of the method used by an engine: "io_uring", "threads"
+ * or "sync".
+ * @param aio The engine.
+ */
+APR_DECLARE(const char *) apr_file_aio_method_name(apr_file_aio_t *aio);
+
+/**
+ * Register buffers with an engine, the reads and writes whose buffer lies
+ * in one of them are given its index and save the kernel from mapping the
+ * pages each time (IORING_REGISTER_BUFFERS).
+ * @param aio The engine.
+ * @param vec The buffers, allocated from a pool that outlives @a aio; they
+ *        replace the ones registered before, if any.
+ * @param nvec The number of buffers, zero to unregister them.
+ * @return APR_SUCCESS, or the error that occurred (e.g. APR_ENOMEM if
+ *         the buffers exceed the process' locked memory limit).
+ */
+APR_DECLARE(apr_status_t) apr_file_aio_buffers_register(apr_file_aio_t *aio,
+                                                  const struct iovec *vec,
+                                                  apr_size_t nvec);
+
+/**
+ * Submit an asynchronous operation.
+ * @param aio The engine.
+ * @param op The operation, which must stay valid until completed.
+ * @return APR_SUCCESS, APR_EINVAL if @a op is invalid, or the error that
+ *         occurred, in which case the operation won't complete.
+ * @remark Reads and writes may transfer less than asked for, like
+ *         apr_file_pread() and apr_file_pwrite().
+ */
+APR_DECLARE(apr_status_t) apr_file_aio_submit(apr_file_aio_t *aio,
+                                              apr_file_aio_op_t *op);
+
+/**
+ * Reap the completed operations, running their callbacks.
+ * @param aio The engine.
+ * @param timeout The time to wait for at least one completion, if none is
+ *        ready already and operations are in flight; 0 means do not wait,
+ *        negative values mean wait forever.
+ * @param num If not NULL, the number of operations completed.
+ * @return APR_SUCCESS, APR_TIMEUP if no operation completed in time, or
+ *         the error that occurred.
+ * @remark The callbacks can submit operations.
+ */
+APR_DECLARE(apr_status_t) apr_file_aio_reap(apr_file_aio_t *aio,
+                                            apr_interval_time_t timeout,
+                                            apr_uint32_t *num);
+
+/**
+ * Return the number of operations submitted and not reaped yet.
+ * @param aio The engine.
+ */
+APR_DECLARE(apr_uint32_t) apr_file_aio_pending(apr_file_aio_t *aio);
+
+/**
+ * Get a file which is readable when operations completed, for polling
+ * with #APR_POLLIN in an apr_pollset_t or apr_pollcb_t, and then calling
+ * apr_file_aio_reap() with no timeout.
+ * @param notifier The file, owned by @a aio.
+ * @param aio The engine.
+ * @return APR_SUCCESS, APR_ENOTIMPL without io_uring nor threads, or the
+ *         error that occurred.
+ */
+APR_DECLARE(apr_status_t) apr_file_aio_notifier_get(apr_file_t **notifier,
+                                                    apr_file_aio_t *aio);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ! APR_FILE_AIO_H */
@@ -48,8 +48,11 @@ extern "C" {
  * @{
  */
 
-/* Note to implementors: Values in the range 0x00100000--0x80000000
-   are reserved for platform-specific values. */
+/* Note to implementors: Values in the range 0x00100000--0x08000000
+   are reserved for platform-specific values (the private flags of
+   include/arch/win32/apr_arch_file_io.h and APR_INHERIT of the
+   apr_arch_inherit.h headers), those from 0x10000000 are public again
+   once 0x00001--0x80000 are all taken. */
 
 #define APR_FOPEN_READ       0x00001  /**< Open the file for reading */
 #define APR_FOPEN_WRITE      0x00002  /**< Open the file for writing */
@@ -79,6 +82,9 @@ extern "C" {
 #define APR_FOPEN_SENDFILE_ENABLED 0x01000 /**< Advisory flag that this
                                              file should support
                                              apr_socket_sendfile operation */
+#define APR_FOPEN_RANDOM      0x02000 /**< Advisory flag that the file will
+                                       * be accessed randomly, see
+                                       * apr_file_advise() */
 #define APR_FOPEN_LARGEFILE   0x04000 /**< Platform dependent flag to enable
                                        * large file support, see WARNING below
                                        */
@@ -94,6 +100,16 @@ extern "C" {
 #define APR_FOPEN_NONBLOCK    0x40000 /**< Platform dependent flag to enable
                                        * non blocking file io */
 
+#define APR_FOPEN_SEQUENTIAL  0x80000 /**< Advisory flag that the file will
+                                       * be read sequentially, see
+                                       * apr_file_advise() */
+
+#define APR_FOPEN_DIRECT   0x10000000 /**< Platform dependent flag to
+                                       * transfer the data directly between
+                                       * the caller's buffers and the disk,
+                                       * bypassing the system's cache, see
+                                       * WARNING below */
+
 
 
 /* backcompat */
@@ -135,6 +151,15 @@ extern "C" {
  * On platforms which do not understand, or on file systems which
  * cannot handle sparse files, the flag is ignored by apr_file_open().
  *
+ * @def APR_FOPEN_DIRECT
+ * @warning APR_FOPEN_DIRECT is not implemented on all platforms, nor
+ * supported by all file systems, and can't be combined with
+ * APR_FOPEN_BUFFERED.  The buffers, lengths and offsets of the reads and
+ * writes must be multiples of apr_file_alignment_get(), otherwise they
+ * fail with APR_EMISALIGNED; apr_palloc_aligned() allocates such buffers.
+ * Writing a last partial block requires padding it and truncating the
+ * file afterwards.
+ *
  * @def APR_FOPEN_NONBLOCK
  * @warning APR_FOPEN_NONBLOCK is not implemented on all platforms.
  * Callers should be prepared for it to fail with #APR_ENOTIMPL.
@@ -248,6 +273,12 @@ typedef struct apr_file_t         apr_file_t;
  * @li #APR_FOPEN_MANUAL_ROTATE  Enable Manual rotation
  * @li #APR_FOPEN_NONBLOCK       Platform dependent flag to enable
  *                               non blocking file io
+ * @li #APR_FOPEN_SEQUENTIAL     Advise that the file will be read
+ *                               sequentially (read ahead more)
+ * @li #APR_FOPEN_RANDOM         Advise that the file will be accessed
+ *                               randomly (do not read ahead)
+ * @li #APR_FOPEN_DIRECT         Platform dependent flag to bypass the
+ *                               system's cache, see WARNING above
  * @param perm Access permissions for file.
  * @param pool The pool to use.
  * @remark If perm is #APR_FPROT_OS_DEFAULT and the file is being created,
@@ -307,6 +338,7 @@ APR_DECLARE(apr_status_t) apr_file_link(const char *from_path,
  *     file's permissions are copied.
  * @param pool The pool to use.
  * @remark The new file does not need to exist, it will be created if required.
+ * @remark The fastest method supported is used, see apr_file_copy_ex().
  * @warning If the new file already exists, its contents will be overwritten.
  */
 APR_DECLARE(apr_status_t) apr_file_copy(const char *from_path,
@@ -314,6 +346,45 @@ APR_DECLARE(apr_status_t) apr_file_copy(const char *from_path,
                                         apr_fileperms_t perms,
                                         apr_pool_t *pool);
 
+/**
+ * @defgroup apr_file_copy_methods File copy methods
+ * @{
+ */
+#define APR_FILE_COPY_CLONE    0x1  /**< Share the data blocks (reflink),
+                                     *   FICLONE on Linux */
+#define APR_FILE_COPY_RANGE    0x2  /**< Copy in the kernel, possibly
+                                     *   offloaded, copy_file_range() */
+#define APR_FILE_COPY_SENDFILE 0x4  /**< Copy in the kernel, sendfile() */
+#define APR_FILE_COPY_BUFFERED 0x8  /**< Read and write through a buffer */
+#define APR_FILE_COPY_ALL      0xf  /**< Any of the above, best first */
+/** @} */
+
+/**
+ * Copy the specified file to another file, choosing how.
+ * @param from_path The full path to the original file (using / on all systems)
+ * @param to_path The full path to the new file (using / on all systems)
+ * @param perms Access permissions for the new file if it is created.
+ *     In place of the usual or'd combination of file permissions, the
+ *     value #APR_FPROT_FILE_SOURCE_PERMS may be given, in which case the source
+ *     file's permissions are copied.
+ * @param methods The allowed @ref apr_file_copy_methods, tried in the
+ *     order they are listed above until one is supported for these files.
+ * @param used If not NULL, set to the methods which were used, usually
+ *     one but a method failing midway is taken over by the next one.
+ * @param pool The pool to use.
+ * @return APR_SUCCESS, APR_ENOTIMPL if none of the @a methods could be
+ *     used, or the error that occurred.
+ * @remark apr_file_copy() allows #APR_FILE_COPY_ALL.
+ * @remark The system methods are used for regular files only.
+ * @warning If the new file already exists, its contents will be overwritten.
+ */
+APR_DECLARE(apr_status_t) apr_file_copy_ex(const char *from_path,
+                                           const char *to_path,
+                                           apr_fileperms_t perms,
+                                           apr_int32_t methods,
+                                           apr_int32_t *used,
+                                           apr_pool_t *pool);
+
 /**
  * Append the specified file to another file.
  * @param from_path The full path to the source file (use / on all systems)
@@ -566,6 +637,92 @@ APR_DECLARE(apr_status_t) apr_file_writev_full(apr_file_t *thefile,
                                                const struct iovec *vec,
                                                apr_size_t nvec,
                                                apr_size_t *nbytes);
+
+/**
+ * Read data from the specified file at the given offset, without using
+ * nor changing the file's current offset (pread() on Unix).
+ * @param thefile The file to read from.
+ * @param buf The buffer to store the data to.
+ * @param nbytes On entry, the number of bytes to read; on exit, the number
+ *        of bytes read.
+ * @param offset The offset in the file to read from.
+ * @return APR_SUCCESS, APR_EOF if @a offset is at or past the end of the
+ *         file, APR_ENOTIMPL if not supported on this platform, or the
+ *         error that occurred.
+ * @remark Like apr_file_read(), apr_file_pread() may read less than asked
+ *         for, but it is not possible for both bytes to be read and an
+ *         error to be returned.  #APR_EINTR is never returned.
+ * @remark The user buffer of an #APR_FOPEN_BUFFERED file is bypassed,
+ *         data pending in it are written first.  Several threads can read
+ *         the same file at their own offsets without locking.
+ */
+APR_DECLARE(apr_status_t) apr_file_pread(apr_file_t *thefile, void *buf,
+                                         apr_size_t *nbytes,
+                                         apr_off_t offset);
+
+/**
+ * Write data to the specified file at the given offset, without using
+ * nor changing the file's current offset (pwrite() on Unix).
+ * @param thefile The file to write to.
+ * @param buf The buffer which contains the data.
+ * @param nbytes On entry, the number of bytes to write; on exit, the number
+ *        of bytes written.
+ * @param offset The offset in the file to write at.
+ * @return APR_SUCCESS, APR_ENOTIMPL if not supported on this platform, or
+ *         the error that occurred.
+ * @remark Like apr_file_write(), apr_file_pwrite() may write less than
+ *         asked for.  #APR_EINTR is never returned.
+ * @remark The user buffer of an #APR_FOPEN_BUFFERED file is bypassed,
+ *         data pending in it are written first and data read ahead are
+ *         discarded.
+ * @remark The data of a file opened with #APR_FOPEN_APPEND may be
+ *         appended regardless of @a offset (Linux).
+ */
+APR_DECLARE(apr_status_t) apr_file_pwrite(apr_file_t *thefile,
+                                          const void *buf,
+                                          apr_size_t *nbytes,
+                                          apr_off_t offset);
+
+/**
+ * Read data from the specified file at the given offset into an iovec
+ * array, without using nor changing the file's current offset (preadv()
+ * on Unix).
+ * @param thefile The file to read from.
+ * @param vec The array of buffers to store the data to, filled in order.
+ * @param nvec The number of elements in the struct iovec array. This must
+ *             be smaller than #APR_MAX_IOVEC_SIZE.  If it isn't, the function
+ *             will fail with #APR_EINVAL.
+ * @param offset The offset in the file to read from.
+ * @param nbytes The number of bytes read.
+ * @return As apr_file_pread().
+ * @remark apr_file_preadv() is available even if the underlying operating
+ *         system doesn't provide preadv(), when it provides pread().
+ */
+APR_DECLARE(apr_status_t) apr_file_preadv(apr_file_t *thefile,
+                                          const struct iovec *vec,
+                                          apr_size_t nvec, apr_off_t offset,
+                                          apr_size_t *nbytes);
+
+/**
+ * Write data from an iovec array to the specified file at the given
+ * offset, without using nor changing the file's current offset (pwritev()
+ * on Unix).
+ * @param thefile The file to write to.
+ * @param vec The array from which to get the data to write to the file.
+ * @param nvec The number of elements in the struct iovec array. This must
+ *             be smaller than #APR_MAX_IOVEC_SIZE.  If it isn't, the function
+ *             will fail with #APR_EINVAL.
+ * @param offset The offset in the file to write at.
+ * @param nbytes The number of bytes written.
+ * @return As apr_file_pwrite().
+ * @remark apr_file_pwritev() is available even if the underlying operating
+ *         system doesn't provide pwritev(), when it provides pwrite().
+ */
+APR_DECLARE(apr_status_t) apr_file_pwritev(apr_file_t *thefile,
+                                           const struct iovec *vec,
+                                           apr_size_t nvec, apr_off_t offset,
+                                           apr_size_t *nbytes);
+
 /**
  * Write a character into the specified file.
  * @param ch The character to write.
@@ -633,6 +790,49 @@ APR_DECLARE(apr_status_t) apr_file_sync(apr_file_t *thefile);
  */
 APR_DECLARE(apr_status_t) apr_file_datasync(apr_file_t *thefile);
 
+/**
+ * @defgroup apr_file_advice File Access Advice
+ * @{
+ */
+
+#define APR_FADVISE_NORMAL     0 /**< No particular access pattern */
+#define APR_FADVISE_SEQUENTIAL 1 /**< Sequential access, read ahead more */
+#define APR_FADVISE_RANDOM     2 /**< Random access, do not read ahead */
+#define APR_FADVISE_WILLNEED   3 /**< The data will be accessed soon, start
+                                  *   reading it into the cache */
+#define APR_FADVISE_DONTNEED   4 /**< The data won't be accessed soon, evict
+                                  *   it from the cache */
+
+/** @} */
+
+/**
+ * Advise the system of how a part of a file will be accessed.
+ * @param thefile The file.
+ * @param offset The start of the part.
+ * @param len The length of the part, zero for up to the end of the file.
+ * @param advice One of the APR_FADVISE_* values.
+ * @return APR_SUCCESS, APR_EINVAL for an unknown @a advice, APR_ENOTIMPL
+ *         if the system takes no advice, or the error that occurred.
+ * @remark Advices are hints and don't change the semantics of the
+ *         accesses.  #APR_FADVISE_DONTNEED does not evict modified data
+ *         which are not written to disk yet.
+ * @remark Files opened with #APR_FOPEN_SEQUENTIAL or #APR_FOPEN_RANDOM are
+ *         advised #APR_FADVISE_SEQUENTIAL or #APR_FADVISE_RANDOM when opened.
+ */
+APR_DECLARE(apr_status_t) apr_file_advise(apr_file_t *thefile,
+                                          apr_off_t offset, apr_off_t len,
+                                          int advice);
+
+/**
+ * Get the alignment required for the buffers, lengths and offsets of the
+ * reads and writes of a file opened with #APR_FOPEN_DIRECT.
+ * @param align The alignment, a power of two, or 1 if the file was not
+ *        opened with #APR_FOPEN_DIRECT.
+ * @param thefile The file.
+ */
+APR_DECLARE(apr_status_t) apr_file_alignment_get(apr_size_t *align,
+                                                 apr_file_t *thefile);
+
 /**
  * Duplicate the specified file descriptor.
  * @param new_file The structure to duplicate into.
@@ -681,6 +881,8 @@ APR_DECLARE(apr_status_t) apr_file_setaside(apr_file_t **new_file,
  *         the file handle's flags. Likewise, with buffer=NULL and
  *         bufsize=0 arguments it is possible to make a previously
  *         buffered file handle unbuffered.
+ * @remark Files opened with #APR_FOPEN_DIRECT can't be buffered, the
+ *         function returns APR_EINVAL for them unless bufsize=0.
  */
 APR_DECLARE(apr_status_t) apr_file_buffer_set(apr_file_t *thefile,
                                               char * buffer,
@@ -803,6 +1005,46 @@ APR_DECLARE(apr_status_t) apr_file_pipe_timeout_get(apr_file_t *thepipe,
 APR_DECLARE(apr_status_t) apr_file_pipe_timeout_set(apr_file_t *thepipe,
                                                   apr_interval_time_t timeout);
 
+/** Flag for apr_file_splice() and friends: more data is coming, like
+ *  #APR_TCP_NOPUSH for the call only */
+#define APR_SPLICE_MORE 0x1
+
+/**
+ * Move data from a file or pipe to another one without copying it through
+ * user space (splice() on Linux).
+ * @param out The file or pipe to write to.
+ * @param in The file or pipe to read from.
+ * @param len On entry, the maximum number of bytes to move; on exit, the
+ *        number of bytes moved.
+ * @param flags Zero or #APR_SPLICE_MORE.
+ * @return APR_SUCCESS, APR_EOF if @a in is at its end, APR_EINVAL if
+ *         neither @a in nor @a out is a pipe or if a file is buffered,
+ *         APR_ENOTIMPL if not supported on this platform, or the error
+ *         that occurred.
+ * @remark At least one of @a in and @a out must be a pipe, files are read
+ *         or written at their current offset which is advanced.
+ * @remark Waits as the pipe's timeout says, see apr_file_pipe_timeout_set().
+ */
+APR_DECLARE(apr_status_t) apr_file_splice(apr_file_t *out, apr_file_t *in,
+                                          apr_size_t *len, apr_int32_t flags);
+
+/**
+ * Duplicate the data of a pipe into another pipe, without consuming it
+ * from the former (tee() on Linux).
+ * @param out The pipe to write to.
+ * @param in The pipe to duplicate the data from.
+ * @param len On entry, the maximum number of bytes to duplicate; on exit,
+ *        the number of bytes duplicated.
+ * @param flags Zero or #APR_SPLICE_MORE.
+ * @return APR_SUCCESS, APR_EOF if the writing end of @a in is closed and
+ *         it is empty, APR_EINVAL if one of the files is not a pipe,
+ *         APR_ENOTIMPL if not supported on this platform, or the error
+ *         that occurred.
+ * @remark Waits as the pipes' timeout says, see apr_file_pipe_timeout_set().
+ */
+APR_DECLARE(apr_status_t) apr_file_tee(apr_file_t *out, apr_file_t *in,
+                                       apr_size_t *len, apr_int32_t flags);
+
 /** file (un)locking functions. */
 
 /**
@@ -86,6 +86,53 @@ APR_DECLARE(apr_hash_t *) apr_hash_make(apr_pool_t *pool);
 APR_DECLARE(apr_hash_t *) apr_hash_make_custom(apr_pool_t *pool,
                                                apr_hashfunc_t hash_func);
 
+/**
+ * @defgroup apr_hash_make_flags Flags for apr_hash_make_ex()
+ * @{
+ */
+/** Flat table, see apr_hash_make_flat() */
+#define APR_HASH_FLAT   0x1
+/** Hash the keys a word at a time (with a per-table seed) rather than a
+ *  byte at a time with apr_hashfunc_default(), notably faster for long keys
+ */
+#define APR_HASH_FAST   0x2
+/** Expand the table incrementally, migrating a few buckets on each
+ *  apr_hash_set() (or apr_hash_get_or_set() with a value) after the new
+ *  array is allocated, rather than all the entries at once (ignored for
+ *  flat tables).  apr_hash_get() does not migrate, so concurrent lookups
+ *  need no more locking than without this flag.
+ */
+#define APR_HASH_INCREMENTAL 0x4
+/** @} */
+
+/**
+ * Create a hash table with the given flags
+ * @param pool The pool to allocate the hash table out of
+ * @param flags A bitmask of @ref apr_hash_make_flags
+ * @return The hash table just created
+ * @remark The hash of each key is computed once when set, apr_hash_copy()
+ *         and the resizing of the table reuse it, and so does
+ *         apr_hash_merge() for the overlay if it hashes like the base (same
+ *         hash function, and same seed as for tables copied from another).
+ */
+APR_DECLARE(apr_hash_t *) apr_hash_make_ex(apr_pool_t *pool,
+                                           apr_uint32_t flags);
+
+/**
+ * Create a flat hash table, using open addressing rather than chaining
+ * entries, so that setting a new key allocates nothing (but when the
+ * table grows) and looking up a key mostly touches contiguous memory.
+ * @param pool The pool to allocate the hash table out of
+ * @return The hash table just created
+ * @remark The table is used with the same functions as any other, and
+ *         apr_hash_copy() or apr_hash_merge() of a flat table (as base)
+ *         return a flat table.
+ * @remark Deleted keys leave a tombstone behind until the table is
+ *         rehashed, which happens in place if there are enough of them
+ *         when a new key is set.
+ */
+APR_DECLARE(apr_hash_t *) apr_hash_make_flat(apr_pool_t *pool);
+
 /**
  * Make a copy of a hash table
  * @param pool The pool from which to allocate the new hash table
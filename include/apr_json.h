@@ -82,6 +82,18 @@ extern "C" {
  */
 #define APR_JSON_FLAGS_STRICT 2
 
+/**
+ * Flag indicating objects of a few keys keep them in a list only, without
+ * a hash (see apr_json_object_create_ex()).
+ */
+#define APR_JSON_FLAGS_FLAT 4
+
+/**
+ * The number of keys of an object created with APR_JSON_FLAGS_FLAT past
+ * which the hash is built.
+ */
+#define APR_JSON_OBJECT_FLAT_MAX 8
+
 /**
  * A structure to hold a JSON object.
  */
@@ -168,7 +180,8 @@ typedef struct apr_json_kv_t {
 struct apr_json_object_t {
     /** The key value pairs in the object are in this list */
     APR_RING_HEAD(apr_json_object_list_t, apr_json_kv_t) list;
-    /** JSON object */
+    /** JSON object, or NULL for objects with APR_JSON_FLAGS_FLAT of up to
+     * APR_JSON_OBJECT_FLAT_MAX keys: use apr_json_object_get() */
     apr_hash_t *hash;
 };
 
@@ -225,6 +238,19 @@ APR_DECLARE(apr_json_value_t *)
 APR_DECLARE(apr_json_value_t *) apr_json_object_create(apr_pool_t *pool)
         __attribute__((nonnull(1)));
 
+/**
+ * Allocate and return a JSON object, with flags.
+ *
+ * @param pool The pool to allocate from.
+ * @param flags APR_JSON_FLAGS_FLAT to search the keys in order instead of
+ *   hashing them, until the object has more than APR_JSON_OBJECT_FLAT_MAX
+ *   keys. This saves the memory and time of a hash for small objects.
+ * @return The apr_json_value_t structure.
+ */
+APR_DECLARE(apr_json_value_t *) apr_json_object_create_ex(apr_pool_t *pool,
+        int flags)
+        __attribute__((nonnull(1)));
+
 /**
  * Allocate and return a JSON long.
  *
@@ -390,7 +416,8 @@ APR_DECLARE(apr_json_value_t *) apr_json_array_next(const apr_json_value_t *arr,
  * @param size length of the input string.
  * @param offset number of characters processed.
  * @param flags set to APR_JSON_FLAGS_WHITESPACE to preserve whitespace,
- *   or APR_JSON_FLAGS_NONE to filter whitespace.
+ *   or APR_JSON_FLAGS_NONE to filter whitespace. Add APR_JSON_FLAGS_FLAT
+ *   to decode small objects without a hash.
  * @param level maximum nesting level we are prepared to decode.
  * @param pool pool used to allocate the result from.
  * @return APR_SUCCESS on success, APR_EOF if the JSON text is truncated.
@@ -403,6 +430,91 @@ APR_DECLARE(apr_status_t) apr_json_decode(apr_json_value_t ** retval,
         int flags, int level, apr_pool_t * pool)
         __attribute__((nonnull(1, 2, 7)));
 
+/**
+ * A push parser, decoding JSON given by parts.
+ */
+typedef struct apr_json_parser_t apr_json_parser_t;
+
+/**
+ * The callbacks of a push parser, called as the JSON text is decoded
+ * (SAX-style).  Any of them can be NULL, and any status other than
+ * APR_SUCCESS that they return stops the parsing and is returned.
+ */
+typedef struct apr_json_callbacks_t {
+    /** Called at the start of an object */
+    apr_status_t (*object_start)(void *ctx);
+    /** Called for each key of an object, before its value */
+    apr_status_t (*object_key)(void *ctx, const apr_json_string_t *key);
+    /** Called at the end of an object */
+    apr_status_t (*object_end)(void *ctx);
+    /** Called at the start of an array */
+    apr_status_t (*array_start)(void *ctx);
+    /** Called at the end of an array */
+    apr_status_t (*array_end)(void *ctx);
+    /** Called for each string, number, boolean or null value */
+    apr_status_t (*value)(void *ctx, const apr_json_value_t *value);
+} apr_json_callbacks_t;
+
+/**
+ * Create a push parser, which either builds the apr_json_value_t tree like
+ * apr_json_decode(), or calls the given callbacks.
+ * @param parser the new parser
+ * @param callbacks the callbacks, or NULL to build the tree.
+ * @param ctx the context passed to the callbacks.
+ * @param flags set to APR_JSON_FLAGS_WHITESPACE to preserve whitespace,
+ *   or APR_JSON_FLAGS_NONE to filter whitespace (whitespace is never given
+ *   to callbacks). Add APR_JSON_FLAGS_FLAT to decode small objects without
+ *   a hash.
+ * @param level maximum nesting level we are prepared to decode.
+ * @param pool pool used to allocate the parser and the tree from.
+ * @return APR_SUCCESS, or APR_ENOTIMPL on platforms where not implemented.
+ * @remark With callbacks, the keys and values given to them are valid
+ *   during the call only, so that the memory used by the parser is bounded
+ *   by the nesting level and the size of the longest token split between
+ *   parts.
+ */
+APR_DECLARE(apr_status_t) apr_json_parser_create(apr_json_parser_t **parser,
+        const apr_json_callbacks_t *callbacks, void *ctx, int flags,
+        int level, apr_pool_t *pool)
+        __attribute__((nonnull(1, 6)));
+
+/**
+ * Decode the next part of the JSON text, which may split tokens anywhere.
+ * @param parser the parser.
+ * @param injson the next part of the utf8-encoded JSON text.
+ * @param size length of the part.
+ * @return APR_SUCCESS on success, APR_BADCH when a decoding error has
+ *   occurred, APR_EINVAL if the level has been exceeded, or the status
+ *   returned by a callback. Errors stick to the parser.
+ */
+APR_DECLARE(apr_status_t) apr_json_parser_feed(apr_json_parser_t *parser,
+        const char *injson, apr_size_t size)
+        __attribute__((nonnull(1)));
+
+/**
+ * Decode the data buckets of a brigade, until it's empty.
+ * @param parser the parser.
+ * @param bb the brigade, whose buckets are deleted once decoded (metadata
+ *   buckets are just deleted).
+ * @return As apr_json_parser_feed(), or the error of a bucket read.
+ */
+APR_DECLARE(apr_status_t) apr_json_parser_feed_brigade(
+        apr_json_parser_t *parser, apr_bucket_brigade *bb)
+        __attribute__((nonnull(1, 2)));
+
+/**
+ * Finish decoding the JSON text.
+ * @param parser the parser.
+ * @param retval the result, if building the tree. Can be NULL.
+ * @param offset number of characters processed, or the location of the
+ *   error. Can be NULL.
+ * @return APR_SUCCESS on success, APR_EOF if the JSON text is truncated,
+ *   or the error that stopped the parser.
+ */
+APR_DECLARE(apr_status_t) apr_json_parser_finish(apr_json_parser_t *parser,
+        apr_json_value_t **retval, apr_off_t *offset)
+        __attribute__((nonnull(1)));
+
 /**
  * Encode data represented as apr_json_value_t to utf8-encoded JSON string
  * and append it to the specified brigade.
@@ -47,6 +47,24 @@ extern "C" {
 /** MMap opened for writing */
 #define APR_MMAP_WRITE   2
 
+/**
+ * @defgroup apr_mmap_advice MMap Access Advice
+ * @{
+ */
+
+#define APR_MADVISE_NORMAL     0 /**< No particular access pattern */
+#define APR_MADVISE_SEQUENTIAL 1 /**< Sequential access, read ahead more */
+#define APR_MADVISE_RANDOM     2 /**< Random access, do not read ahead */
+#define APR_MADVISE_WILLNEED   3 /**< The pages will be accessed soon, start
+                                  *   reading them */
+#define APR_MADVISE_DONTNEED   4 /**< The pages won't be accessed soon, they
+                                  *   can be released (and read back from
+                                  *   the file if accessed again) */
+#define APR_MADVISE_HUGEPAGE   5 /**< Back the pages with huge pages, if the
+                                  *   system and file system support it */
+
+/** @} */
+
 /** @see apr_mmap_t */
 typedef struct apr_mmap_t            apr_mmap_t;
 
@@ -157,6 +175,23 @@ APR_DECLARE(apr_status_t) apr_mmap_delete(apr_mmap_t *mm);
 APR_DECLARE(apr_status_t) apr_mmap_offset(void **addr, apr_mmap_t *mm,
                                           apr_off_t offset);
 
+/**
+ * Advise the system of how a part of an mmap'ed file will be accessed.
+ * @param mm The mmap'ed file.
+ * @param offset The offset of the part in the mmap, rounded down to the
+ *        page it's in.
+ * @param len The length of the part, zero for up to the end of the mmap.
+ * @param advice One of the APR_MADVISE_* values.
+ * @return APR_SUCCESS, APR_EINVAL for an unknown @a advice or a part
+ *         outside of the mmap, APR_ENOTIMPL if the system does not take
+ *         this advice, or the error that occurred.
+ * @remark The mmap of a file opened with #APR_FOPEN_SEQUENTIAL or
+ *         #APR_FOPEN_RANDOM is advised #APR_MADVISE_SEQUENTIAL or
+ *         #APR_MADVISE_RANDOM when created.
+ */
+APR_DECLARE(apr_status_t) apr_mmap_advise(apr_mmap_t *mm, apr_off_t offset,
+                                          apr_size_t len, int advice);
+
 #endif /* APR_HAS_MMAP */
 
 /** @} */
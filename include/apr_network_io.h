@@ -108,6 +108,18 @@ extern "C" {
 #define APR_SO_FREEBIND     131072 /**< Allow binding to addresses not owned
                                     * by any interface
                                     */
+#define APR_SO_UDP_SEGMENT  262144 /**< Size of the segments a datagram is
+                                    * split into by the kernel on send
+                                    * (UDP GSO), 0 to disable
+                                    */
+#define APR_SO_UDP_GRO      524288 /**< Allow the kernel to coalesce the
+                                    * received datagrams (UDP GRO)
+                                    * @see apr_socket_recvmmsg
+                                    */
+#define APR_SO_ZEROCOPY    1048576 /**< Send without copying the data
+                                    * (MSG_ZEROCOPY) with apr_socket_sendv
+                                    * @see apr_socket_zerocopy_reap
+                                    */
 
 /** @} */
 
@@ -221,6 +233,11 @@ typedef struct apr_socket_t     apr_socket_t;
  * A structure to encapsulate headers and trailers for apr_socket_sendfile
  */
 typedef struct apr_hdtr_t       apr_hdtr_t;
+/**
+ * A structure to encapsulate a datagram for apr_socket_sendmmsg and
+ * apr_socket_recvmmsg
+ */
+typedef struct apr_sockmsg_t    apr_sockmsg_t;
 /** A structure to represent in_addr */
 typedef struct in_addr          apr_in_addr_t;
 /** A structure to represent an IP subnet */
@@ -296,6 +313,25 @@ struct apr_hdtr_t {
     int numtrailers;
 };
 
+/** A structure to encapsulate a datagram for apr_socket_sendmmsg and
+ * apr_socket_recvmmsg */
+struct apr_sockmsg_t {
+    /** The address to send the datagram to, or updated with the address
+     *  it was received from; NULL for a connected socket, or if the
+     *  source is not needed. */
+    apr_sockaddr_t *addr;
+    /** The datagram */
+    char *buf;
+    /** On send, the length of the datagram, updated with the number of
+     *  bytes sent; on receive, the size of the buffer, updated with the
+     *  number of bytes received. */
+    apr_size_t len;
+    /** On send, if not 0, the datagram is split into segments of this
+     *  size (overriding APR_SO_UDP_SEGMENT); on receive, the size of the
+     *  datagrams coalesced into the buffer with APR_SO_UDP_GRO, or 0. */
+    apr_size_t segsize;
+};
+
 /* function definitions */
 
 /**
@@ -578,6 +614,8 @@ APR_DECLARE(apr_status_t) apr_socket_send(apr_socket_t *sock, const char *buf,
  *
  * APR_EINTR is never returned.
  * </PRE>
+ * @remark With the APR_SO_ZEROCOPY option, the buffers must not be modified
+ *         until the send completes, see apr_socket_zerocopy_reap().
  */
 APR_DECLARE(apr_status_t) apr_socket_sendv(apr_socket_t *sock,
                                            const struct iovec *vec,
@@ -613,6 +651,51 @@ APR_DECLARE(apr_status_t) apr_socket_recvfrom(apr_sockaddr_t *from,
                                               apr_int32_t flags, char *buf,
                                               apr_size_t *len);
 
+/**
+ * Send multiple datagrams over a socket, in a single system call where
+ * supported (sendmmsg() on Linux).
+ * @param sock The socket to send the datagrams over
+ * @param msgs The datagrams, the len field of each one sent is updated
+ *             with the number of bytes sent.
+ * @param nmsgs The number of datagrams in @a msgs
+ * @param flags The flags to use
+ * @param nsent The number of datagrams sent
+ * @remark This functions acts like a blocking write by default.  It's
+ *         possible that fewer than @a nmsgs datagrams are sent with
+ *         APR_SUCCESS returned, an error is returned only if none could
+ *         be sent.
+ * @remark Where not natively supported, the datagrams are sent one at a
+ *         time.  A datagram with a segsize requires UDP GSO support,
+ *         APR_ENOTIMPL is returned otherwise.
+ */
+APR_DECLARE(apr_status_t) apr_socket_sendmmsg(apr_socket_t *sock,
+                                              apr_sockmsg_t *msgs,
+                                              apr_size_t nmsgs,
+                                              apr_int32_t flags,
+                                              apr_size_t *nsent);
+
+/**
+ * Receive multiple datagrams from a socket, in a single system call where
+ * supported (recvmmsg() on Linux).
+ * @param sock The socket to receive the datagrams from
+ * @param msgs The buffers for the datagrams, the len and segsize fields
+ *             (and addr if not NULL) of each one received are updated.
+ * @param nmsgs The number of buffers in @a msgs
+ * @param flags The flags to use
+ * @param nrecv The number of datagrams received
+ * @remark This functions acts like a blocking read by default, but only
+ *         until the first datagram is received: the next ones are only
+ *         received if they are available already.
+ * @remark With APR_SO_UDP_GRO, a buffer may receive several datagrams of
+ *         the same source coalesced by the kernel, all of segsize bytes
+ *         but the last one which can be shorter.
+ */
+APR_DECLARE(apr_status_t) apr_socket_recvmmsg(apr_socket_t *sock,
+                                              apr_sockmsg_t *msgs,
+                                              apr_size_t nmsgs,
+                                              apr_int32_t flags,
+                                              apr_size_t *nrecv);
+
 #if APR_HAS_SENDFILE || defined(DOXYGEN)
 
 /**
@@ -643,6 +726,68 @@ APR_DECLARE(apr_status_t) apr_socket_sendfile(apr_socket_t *sock,
 
 #endif /* APR_HAS_SENDFILE */
 
+/**
+ * Move data received on a socket into a pipe, without copying it through
+ * user space (splice() on Linux).
+ * @param sock The socket to read the data from
+ * @param pipe The writing end of the pipe
+ * @param len On entry, the maximum number of bytes to move; on exit, the
+ *            number of bytes moved
+ * @param flags Zero or #APR_SPLICE_MORE
+ * @return APR_SUCCESS, APR_EOF if the peer closed the connection,
+ *         APR_EINVAL if @a pipe is not a pipe, APR_ENOTIMPL if not
+ *         supported on this platform, or the error that occurred.
+ * @remark Waits for the shortest of the socket's and the pipe's timeouts.
+ * @remark Along with apr_socket_splice_out() this allows to forward the
+ *         data from a socket to another through the pipe.
+ */
+APR_DECLARE(apr_status_t) apr_socket_splice_in(apr_socket_t *sock,
+                                               apr_file_t *pipe,
+                                               apr_size_t *len,
+                                               apr_int32_t flags);
+
+/**
+ * Send the data of a pipe over a socket, without copying it through user
+ * space (splice() on Linux).
+ * @param sock The socket to write the data to
+ * @param pipe The reading end of the pipe
+ * @param len On entry, the maximum number of bytes to move; on exit, the
+ *            number of bytes moved
+ * @param flags Zero or #APR_SPLICE_MORE
+ * @return APR_SUCCESS, APR_EOF if the writing end of the pipe is closed
+ *         and it is empty, APR_EINVAL if @a pipe is not a pipe,
+ *         APR_ENOTIMPL if not supported on this platform, or the error
+ *         that occurred.
+ * @remark Waits for the shortest of the socket's and the pipe's timeouts.
+ */
+APR_DECLARE(apr_status_t) apr_socket_splice_out(apr_socket_t *sock,
+                                                apr_file_t *pipe,
+                                                apr_size_t *len,
+                                                apr_int32_t flags);
+
+/**
+ * Reap the completion notifications of the sends done without copying the
+ * data, with apr_socket_sendv() and the APR_SO_ZEROCOPY option.
+ * @param sock The socket
+ * @param sent Set to the number of such sends so far (modulo 2^32)
+ * @param completed Set to the number of those completed: the data of the
+ *                  first @a completed sends are released by the system
+ *                  and their buffers can be reused or freed
+ * @param block Whether to wait, according to the socket's timeout, for
+ *              one notification at least if some sends are pending
+ * @return APR_SUCCESS, APR_ENOTIMPL if not supported on this platform, or
+ *         the error that occurred (APR_EAGAIN or APR_TIMEUP for @a block).
+ * @remark Each apr_socket_sendv() call which sends some data counts as
+ *         one send, so its buffers can be reused once @a completed reaches
+ *         the @a sent value read after that call.
+ * @remark Pending notifications make the socket report APR_POLLERR when
+ *         polled, calling this function then is needed.
+ */
+APR_DECLARE(apr_status_t) apr_socket_zerocopy_reap(apr_socket_t *sock,
+                                                   apr_uint32_t *sent,
+                                                   apr_uint32_t *completed,
+                                                   int block);
+
 /**
  * Read data from a network.
  * @param sock The socket to read the data from.
@@ -695,6 +840,12 @@ APR_DECLARE(apr_status_t) apr_socket_wait(apr_socket_t *sock,
  *            APR_SO_SNDBUF     --  Set the SendBufferSize
  *            APR_SO_RCVBUF     --  Set the ReceiveBufferSize
  *            APR_SO_FREEBIND   --  Allow binding to non-local IP address.
+ *            APR_SO_UDP_SEGMENT -- Set the size of the segments sent
+ *                                  datagrams are split into (UDP GSO).
+ *            APR_SO_UDP_GRO    --  Allow received datagrams to be
+ *                                  coalesced (UDP GRO).
+ *            APR_SO_ZEROCOPY   --  Have apr_socket_sendv() not copy the
+ *                                  data, TCP only.
  * </PRE>
  * @param on Value for the option.
  */
@@ -731,6 +882,8 @@ APR_DECLARE(apr_status_t) apr_socket_timeout_set(apr_socket_t *sock,
  *            APR_SO_RCVBUF     --  Set the ReceiveBufferSize
  *            APR_SO_DISCONNECTED -- Query the disconnected state of the socket.
  *                                  (Currently only used on Windows)
+ *            APR_SO_UDP_SEGMENT -- The size of the segments sent
+ *                                  datagrams are split into (UDP GSO).
  * </PRE>
  * @param on Socket option returned on the call.
  */
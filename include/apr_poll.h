@@ -53,6 +53,10 @@ extern "C" {
 #define APR_POLLHUP   0x020     /**< Hangup occurred */
 #define APR_POLLNVAL  0x040     /**< Descriptor invalid */
 #define APR_POLLEXCL  0x080     /**< Exclusive wake up */
+#define APR_POLLET    0x100     /**< Edge triggered (requested only) */
+#define APR_POLLONESHOT 0x200   /**< Disabled once signalled, until re-armed
+                                 *   (requested only)
+                                 */
 /** @} */
 
 /**
@@ -85,7 +89,8 @@ typedef enum {
     APR_POLLSET_PORT,           /**< Poll uses Solaris event port method */
     APR_POLLSET_EPOLL,          /**< Poll uses epoll method */
     APR_POLLSET_POLL,           /**< Poll uses poll method */
-    APR_POLLSET_AIO_MSGQ        /**< Poll uses z/OS asio method */
+    APR_POLLSET_AIO_MSGQ,       /**< Poll uses z/OS asio method */
+    APR_POLLSET_IO_URING        /**< Poll uses Linux io_uring method */
 } apr_pollset_method_e;
 
 /** Used in apr_pollfd_t to determine what the apr_descriptor is */
@@ -188,6 +193,14 @@ APR_DECLARE(apr_status_t) apr_pollset_create(apr_pollset_t **pollset,
  *         the size parameter controls the maximum number of
  *         descriptors that will be returned by a single call to
  *         apr_pollset_poll().
+ * @remark APR_POLLSET_IO_URING is never the default method, it's used on
+ *         Linux when asked for explicitly and supported by the running
+ *         kernel (5.11 or later, 5.13 for APR_POLLET); it does not support
+ *         APR_POLLSET_THREADSAFE.  Descriptors must be removed from such a
+ *         pollset before they are closed, since the pending poll request
+ *         holds a reference on the underlying file (and keeps it open) until
+ *         the removal is submitted by the next apr_pollset_poll() or
+ *         apr_pollset_destroy().
  */
 APR_DECLARE(apr_status_t) apr_pollset_create_ex(apr_pollset_t **pollset,
                                                 apr_uint32_t size,
@@ -220,12 +233,16 @@ APR_DECLARE(apr_status_t) apr_pollset_destroy(apr_pollset_t *pollset);
  * @remark If the pollset has been created with APR_POLLSET_NOCOPY, the
  *         apr_pollfd_t structure referenced by descriptor will not be copied
  *         and must have a lifetime at least as long as the pollset.
+ * @remark APR_POLLET (edge triggered) is supported by APR_POLLSET_EPOLL,
+ *         APR_POLLSET_KQUEUE and APR_POLLSET_IO_URING only, other methods
+ *         return APR_ENOTIMPL.
+ *         APR_POLLONESHOT is supported by all the methods, the descriptor
+ *         is then not signalled anymore by apr_pollset_poll() until it is
+ *         re-armed with apr_pollset_rearm().
  * @remark Do not add the same socket or file descriptor to the same pollset
  *         multiple times, even if the requested events differ for the
  *         different calls to apr_pollset_add().  If the events of interest
- *         for a descriptor change, you must first remove the descriptor
- *         from the pollset with apr_pollset_remove(), then add it again
- *         specifying all requested events.
+ *         for a descriptor change, use apr_pollset_modify().
  */
 APR_DECLARE(apr_status_t) apr_pollset_add(apr_pollset_t *pollset,
                                           const apr_pollfd_t *descriptor);
@@ -251,6 +268,34 @@ APR_DECLARE(apr_status_t) apr_pollset_add(apr_pollset_t *pollset,
 APR_DECLARE(apr_status_t) apr_pollset_remove(apr_pollset_t *pollset,
                                              const apr_pollfd_t *descriptor);
 
+/**
+ * Change the requested events of a descriptor in a pollset
+ * @param pollset The pollset in which to modify the descriptor
+ * @param descriptor The descriptor to modify, with the new requested events
+ * @remark The descriptor is matched against the one previously added by
+ *         its socket or file, and replaces it (including the client_data
+ *         which will be returned by apr_pollset_poll()).
+ * @remark If the descriptor is not found, APR_NOTFOUND is returned.
+ * @remark Methods with native support (APR_POLLSET_EPOLL, APR_POLLSET_KQUEUE,
+ *         APR_POLLSET_PORT, APR_POLLSET_POLL) update the descriptor in place,
+ *         otherwise it is removed and added again.
+ * @remark APR_POLLEXCL can only be requested by apr_pollset_add() with
+ *         APR_POLLSET_EPOLL, modifying such a descriptor fails.
+ */
+APR_DECLARE(apr_status_t) apr_pollset_modify(apr_pollset_t *pollset,
+                                             const apr_pollfd_t *descriptor);
+
+/**
+ * Re-arm a descriptor added with APR_POLLONESHOT after it was signalled
+ * @param pollset The pollset in which to re-arm the descriptor
+ * @param descriptor The descriptor to re-arm, with the requested events
+ * @remark This is equivalent to apr_pollset_modify(), so the requested
+ *         events may change (including APR_POLLONESHOT itself).
+ * @remark If the descriptor is not found, APR_NOTFOUND is returned.
+ */
+APR_DECLARE(apr_status_t) apr_pollset_rearm(apr_pollset_t *pollset,
+                                            const apr_pollfd_t *descriptor);
+
 /**
  * Block for activity on the descriptor(s) in a pollset
  * @param pollset The pollset to use
@@ -352,6 +397,8 @@ APR_DECLARE(apr_status_t) apr_pollcb_create(apr_pollcb_t **pollcb,
  *         in that case @a size + 1.
  * @remark Pollcb is only supported on some platforms; the apr_pollcb_create_ex()
  *         call will fail with APR_ENOTIMPL on platforms where it is not supported.
+ * @remark See apr_pollset_create_ex() for the restrictions of
+ *         APR_POLLSET_IO_URING.
  */
 APR_DECLARE(apr_status_t) apr_pollcb_create_ex(apr_pollcb_t **pollcb,
                                                apr_uint32_t size,
@@ -369,12 +416,16 @@ APR_DECLARE(apr_status_t) apr_pollcb_create_ex(apr_pollcb_t **pollcb,
  * @remark Unlike the apr_pollset API, the descriptor is not copied, and users
  *         must retain the memory used by descriptor, as the same pointer will
  *         be returned to them from apr_pollcb_poll.
+ * @remark APR_POLLET (edge triggered) is supported by APR_POLLSET_EPOLL,
+ *         APR_POLLSET_KQUEUE and APR_POLLSET_IO_URING only, other methods
+ *         return APR_ENOTIMPL.
+ *         APR_POLLONESHOT is supported by all the methods, the descriptor
+ *         is then not signalled anymore by apr_pollcb_poll() until it is
+ *         re-armed with apr_pollcb_rearm().
  * @remark Do not add the same socket or file descriptor to the same pollcb
  *         multiple times, even if the requested events differ for the
  *         different calls to apr_pollcb_add().  If the events of interest
- *         for a descriptor change, you must first remove the descriptor
- *         from the pollcb with apr_pollcb_remove(), then add it again
- *         specifying all requested events.
+ *         for a descriptor change, use apr_pollcb_modify().
  */
 APR_DECLARE(apr_status_t) apr_pollcb_add(apr_pollcb_t *pollcb,
                                          apr_pollfd_t *descriptor);
@@ -390,6 +441,32 @@ APR_DECLARE(apr_status_t) apr_pollcb_add(apr_pollcb_t *pollcb,
 APR_DECLARE(apr_status_t) apr_pollcb_remove(apr_pollcb_t *pollcb,
                                             apr_pollfd_t *descriptor);
 
+/**
+ * Change the requested events of a descriptor in a pollcb
+ * @param pollcb The pollcb in which to modify the descriptor
+ * @param descriptor The descriptor to modify, with the new requested events
+ * @remark The descriptor is matched against the one previously added by
+ *         its socket or file, and replaces it: this pointer is the one
+ *         returned by apr_pollcb_poll() from now on.
+ * @remark If the descriptor is not found, APR_NOTFOUND is returned.
+ * @remark Methods with native support (APR_POLLSET_EPOLL, APR_POLLSET_KQUEUE,
+ *         APR_POLLSET_PORT, APR_POLLSET_POLL) update the descriptor in place,
+ *         otherwise it is removed and added again.
+ */
+APR_DECLARE(apr_status_t) apr_pollcb_modify(apr_pollcb_t *pollcb,
+                                            apr_pollfd_t *descriptor);
+
+/**
+ * Re-arm a descriptor added with APR_POLLONESHOT after it was signalled
+ * @param pollcb The pollcb in which to re-arm the descriptor
+ * @param descriptor The descriptor to re-arm, with the requested events
+ * @remark This is equivalent to apr_pollcb_modify(), so the requested
+ *         events may change (including APR_POLLONESHOT itself).
+ * @remark If the descriptor is not found, APR_NOTFOUND is returned.
+ */
+APR_DECLARE(apr_status_t) apr_pollcb_rearm(apr_pollcb_t *pollcb,
+                                           apr_pollfd_t *descriptor);
+
 /**
  * Function prototype for pollcb handlers
  * @param baton Opaque baton passed into apr_pollcb_poll()
@@ -454,6 +454,20 @@ APR_DECLARE(void *) apr_pcalloc_debug(apr_pool_t *p, apr_size_t size,
     apr_pcalloc_debug(p, size, APR_POOL__FILE_LINE__)
 #endif
 
+/**
+ * Allocate a block of memory from a pool, aligned as requested
+ * @param p The pool to allocate from
+ * @param size The amount of memory to allocate
+ * @param align The alignment of the memory, a power of two
+ * @return The allocated memory, or NULL if @a align is not a power of two
+ * @remark Up to @a align - 1 bytes are wasted, it's meant for buffers
+ *         whose alignment matters, e.g. for files opened with
+ *         #APR_FOPEN_DIRECT (see apr_file_alignment_get()).
+ */
+APR_DECLARE(void *) apr_palloc_aligned(apr_pool_t *p, apr_size_t size,
+                                       apr_size_t align)
+                    __attribute__((nonnull(1)));
+
 
 /*
  * Pool Properties
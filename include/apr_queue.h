@@ -57,6 +57,30 @@ APR_DECLARE(apr_status_t) apr_queue_create(apr_queue_t **queue,
                                            unsigned int queue_capacity,
                                            apr_pool_t *a);
 
+/**
+ * Flag for apr_queue_create_ex(): use a lock-free ring, where pushing to
+ * and popping from a queue that is neither full nor empty never takes a
+ * lock, so that producers and consumers don't serialize. Threads only wait
+ * (on a condition variable) when the queue stays full or empty after they
+ * yielded the CPU a few times.
+ * @remark The capacity is rounded up to the next power of two.
+ */
+#define APR_QUEUE_LOCKFREE 0x1
+
+/**
+ * create a FIFO queue with the given flags
+ * @param queue The new queue
+ * @param queue_capacity maximum size of the queue
+ * @param flags 0 or APR_QUEUE_LOCKFREE
+ * @param a pool to allocate queue from
+ * @returns APR_EINVAL if the capacity is 0 or above 2^31 with
+ *          APR_QUEUE_LOCKFREE
+ */
+APR_DECLARE(apr_status_t) apr_queue_create_ex(apr_queue_t **queue,
+                                              unsigned int queue_capacity,
+                                              apr_uint32_t flags,
+                                              apr_pool_t *a);
+
 /**
  * push/add an object to the queue, blocking if the queue is already full
  *
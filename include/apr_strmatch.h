@@ -73,6 +73,106 @@ APR_DECLARE(const char *) apr_strmatch(const apr_strmatch_pattern *pattern,
  */
 APR_DECLARE(const apr_strmatch_pattern *) apr_strmatch_precompile(apr_pool_t *p, const char *s, int case_sensitive);
 
+/** @see apr_strmatch_precompile_set */
+typedef struct apr_strmatch_set apr_strmatch_set;
+
+/** @see apr_strmatch_stream_create */
+typedef struct apr_strmatch_stream apr_strmatch_stream;
+
+/**
+ * Callback for each match of a set of patterns
+ * @param baton The baton given to the matching function
+ * @param pattern The index of the matching pattern in the set
+ * @param offset The offset of the match in the string, or stream
+ * @return Non-zero to continue matching, zero to stop
+ */
+typedef int (apr_strmatch_set_fn_t)(void *baton, apr_size_t pattern,
+                                    apr_off_t offset);
+
+/**
+ * Precompile a set of patterns for matching them all at once, using the
+ * Aho-Corasick algorithm
+ * @param p The pool from which to allocate the set
+ * @param patterns The pattern strings
+ * @param npatterns The number of patterns
+ * @param case_sensitive Whether the matching should be case-sensitive
+ * @return a pointer to the compiled set, or NULL if compilation fails
+ * @remark The patterns are compiled to a DFA whose transitions are given
+ *         for the bytes found in the patterns only, all the other bytes
+ *         being handled alike, so the matching time does not depend on
+ *         the number of patterns.  Empty patterns never match.
+ */
+APR_DECLARE(const apr_strmatch_set *) apr_strmatch_precompile_set(
+                                              apr_pool_t *p,
+                                              const char * const *patterns,
+                                              apr_size_t npatterns,
+                                              int case_sensitive);
+
+/**
+ * Search for the first match of a set of patterns within a string
+ * @param set The set of patterns
+ * @param s The string in which to search for the patterns
+ * @param slen The length of s (excluding null terminator)
+ * @param pattern If not NULL, set to the index of the matching pattern
+ * @return A pointer to the first match in s, or NULL if not found
+ * @remark The first match is the one that ends first in s, and the longest
+ *         of those ending there.
+ */
+APR_DECLARE(const char *) apr_strmatch_set_first(const apr_strmatch_set *set,
+                                                 const char *s,
+                                                 apr_size_t slen,
+                                                 apr_size_t *pattern);
+
+/**
+ * Search for all the matches of a set of patterns within a string
+ * @param set The set of patterns
+ * @param s The string in which to search for the patterns
+ * @param slen The length of s (excluding null terminator)
+ * @param fn The function called for each match, in the order where they
+ *        end in s (the longest first for those ending at the same place)
+ * @param baton The baton passed to fn
+ * @return Zero if fn stopped the search, non-zero otherwise
+ */
+APR_DECLARE(int) apr_strmatch_set_do(const apr_strmatch_set *set,
+                                     const char *s, apr_size_t slen,
+                                     apr_strmatch_set_fn_t *fn, void *baton);
+
+/**
+ * Create a stream for searching a set of patterns within data given by
+ * parts, where matches may span parts
+ * @param p The pool from which to allocate the stream
+ * @param set The set of patterns
+ * @return The stream
+ */
+APR_DECLARE(apr_strmatch_stream *) apr_strmatch_stream_create(
+                                              apr_pool_t *p,
+                                              const apr_strmatch_set *set);
+
+/**
+ * Search for all the matches of a set of patterns within the next part
+ * of a stream
+ * @param stream The stream
+ * @param s The next part of the stream
+ * @param slen The length of s
+ * @param fn The function called for each match, given the offset of the
+ *        match from the start of the stream (which may be before s)
+ * @param baton The baton passed to fn
+ * @return Zero if fn stopped the search, non-zero otherwise
+ * @remark If fn stopped the search, the stream stops after the end of the
+ *         match (other matches ending there are not reported), so the rest
+ *         of s can be given to the next call to continue.
+ */
+APR_DECLARE(int) apr_strmatch_stream_do(apr_strmatch_stream *stream,
+                                        const char *s, apr_size_t slen,
+                                        apr_strmatch_set_fn_t *fn,
+                                        void *baton);
+
+/**
+ * Reset a stream to its start
+ * @param stream The stream
+ */
+APR_DECLARE(void) apr_strmatch_stream_reset(apr_strmatch_stream *stream);
+
 /** @} */
 #ifdef __cplusplus
 }
@@ -79,6 +79,39 @@ APR_DECLARE(apr_status_t) apr_thread_pool_create(apr_thread_pool_t **me,
                                                  apr_size_t max_threads,
                                                  apr_pool_t *pool);
 
+/**
+ * Flag for apr_thread_pool_create_ex(): give each thread its own queue of
+ * tasks, with its own lock, rather than sharing one, such that short tasks
+ * pushed by many threads don't contend on the pool's lock. A thread runs the
+ * tasks of its queue first and then steals the ones of the other queues.
+ * @remark Tasks pushed from a task of the pool go to the queue of the thread
+ * running it (if the compiler supports APR_THREAD_LOCAL), otherwise the
+ * queues are filled in turn.
+ * @remark Priorities are honored per queue only, a thread runs the tasks of
+ * its queue before stealing higher priority ones. Scheduled tasks are shared
+ * by all the threads still.
+ */
+#define APR_THREAD_POOL_WORK_STEALING 0x1
+
+/**
+ * Create a thread pool with the given flags
+ * @param me The pointer in which to return the newly created apr_thread_pool
+ * object, or NULL if thread pool creation fails.
+ * @param init_threads The number of threads to be created initially, this number
+ * will also be used as the initial value for the maximum number of idle threads.
+ * @param max_threads The maximum number of threads that can be created, and
+ * the number of queues with APR_THREAD_POOL_WORK_STEALING
+ * @param flags 0 or APR_THREAD_POOL_WORK_STEALING
+ * @param pool The pool to use
+ * @return APR_SUCCESS if the thread pool was created successfully. Otherwise,
+ * the error code.
+ */
+APR_DECLARE(apr_status_t) apr_thread_pool_create_ex(apr_thread_pool_t **me,
+                                                    apr_size_t init_threads,
+                                                    apr_size_t max_threads,
+                                                    apr_uint32_t flags,
+                                                    apr_pool_t *pool);
+
 /**
  * Destroy the thread pool and stop all the threads
  * @return APR_SUCCESS if all threads are stopped.
@@ -218,6 +251,50 @@ APR_DECLARE(apr_size_t)
 APR_DECLARE(apr_size_t)
     apr_thread_pool_threads_idle_timeout_count(apr_thread_pool_t * me);
 
+/**
+ * Get number of tasks that have been stolen from another thread's queue
+ * @param me The thread pool
+ * @return Number of tasks stolen, 0 without APR_THREAD_POOL_WORK_STEALING
+ */
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_tasks_stolen_count(apr_thread_pool_t * me);
+
+/**
+ * Get number of queues of tasks
+ * @param me The thread pool
+ * @return Number of queues, 0 without APR_THREAD_POOL_WORK_STEALING
+ */
+APR_DECLARE(apr_size_t) apr_thread_pool_queues_count(apr_thread_pool_t *me);
+
+/**
+ * Get number of tasks in a queue
+ * @param me The thread pool
+ * @param n The queue, from 0 to apr_thread_pool_queues_count() excluded
+ * @return Number of tasks waiting to run in the queue
+ */
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_queue_tasks_count(apr_thread_pool_t *me, apr_size_t n);
+
+/**
+ * Get high water mark of the number of tasks in a queue
+ * @param me The thread pool
+ * @param n The queue, from 0 to apr_thread_pool_queues_count() excluded
+ * @return High water mark of tasks waiting to run in the queue
+ */
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_queue_tasks_high_count(apr_thread_pool_t *me,
+                                           apr_size_t n);
+
+/**
+ * Get number of tasks that have been stolen from a queue
+ * @param me The thread pool
+ * @param n The queue, from 0 to apr_thread_pool_queues_count() excluded
+ * @return Number of tasks stolen from the queue by other threads
+ */
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_queue_tasks_stolen_count(apr_thread_pool_t *me,
+                                             apr_size_t n);
+
 /**
  * Access function for the maximum number of idle threads
  * @param me The thread pool
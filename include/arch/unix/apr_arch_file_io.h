@@ -92,6 +92,11 @@
 /* For backwards-compat */
 #define APR_FILE_BUFSIZE  APR_FILE_DEFAULT_BUFSIZE
 
+/* The alignment of APR_FOPEN_DIRECT I/O when the system can't tell, a
+ * multiple of the logical block size of any disk.
+ */
+#define APR_FILE_DIRECT_ALIGN 4096
+
 typedef struct apr_rotating_info_t {
     apr_finfo_t finfo;
     apr_interval_time_t timeout;
@@ -123,6 +128,7 @@ struct apr_file_t {
     unsigned long dataRead;   /* amount of valid data read into buffer */
     int direction;            /* buffer being used for 0 = read, 1 = write */
     apr_off_t filePtr;        /* position in file of handle */
+    apr_size_t direct_align;  /* alignment of APR_FOPEN_DIRECT I/O, or 0 */
 #if APR_HAS_THREADS
     struct apr_thread_mutex_t *thlock;
 #endif
@@ -52,6 +52,9 @@
 #if APR_HAVE_NETINET_TCP_H
 #include <netinet/tcp.h>
 #endif
+#ifdef HAVE_NETINET_UDP_H
+#include <netinet/udp.h>
+#endif
 #if APR_HAVE_NETINET_SCTP_UIO_H
 #include <netinet/sctp_uio.h>
 #endif
@@ -82,8 +85,16 @@
 #if APR_HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
 #endif
+#ifdef HAVE_LINUX_ERRQUEUE_H
+#include <linux/errqueue.h>
+#endif
 /* End System Headers */
 
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) \
+    && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY 1
+#endif
+
 #ifndef HAVE_POLLIN
 #define POLLIN   1
 #define POLLPRI  2
@@ -119,7 +130,14 @@ struct apr_socket_t {
     int remote_addr_unknown;
     apr_int32_t options;
     apr_int32_t inherit;
+    /* The APR_SO_UDP_SEGMENT size */
+    apr_int32_t udp_segment;
     sock_userdata_t *userdata;
+#ifdef HAVE_MSG_ZEROCOPY
+    /* Number of APR_SO_ZEROCOPY sends, and how many completed */
+    apr_uint32_t zc_sent;
+    apr_uint32_t zc_completed;
+#endif
 #ifndef WAITIO_USES_POLL
     /* if there is a timeout set, then this pollset is used */
     apr_pollset_t *pollset;
@@ -150,6 +150,9 @@ typedef union {
 #endif
 #if defined(HAVE_POLL)
     struct pollfd *ps;
+#endif
+#if defined(HAVE_IO_URING)
+    struct uring_poll_t *uring;
 #endif
     void *undef;
 } apr_pollcb_pset;
@@ -177,6 +180,7 @@ struct apr_pollset_provider_t {
     apr_status_t (*create)(apr_pollset_t *, apr_uint32_t, apr_pool_t *, apr_uint32_t);
     apr_status_t (*add)(apr_pollset_t *, const apr_pollfd_t *);
     apr_status_t (*remove)(apr_pollset_t *, const apr_pollfd_t *);
+    apr_status_t (*modify)(apr_pollset_t *, const apr_pollfd_t *);
     apr_status_t (*poll)(apr_pollset_t *, apr_interval_time_t, apr_int32_t *, const apr_pollfd_t **);
     apr_status_t (*cleanup)(apr_pollset_t *);
     const char *name;
@@ -186,6 +190,7 @@ struct apr_pollcb_provider_t {
     apr_status_t (*create)(apr_pollcb_t *, apr_uint32_t, apr_pool_t *, apr_uint32_t);
     apr_status_t (*add)(apr_pollcb_t *, apr_pollfd_t *);
     apr_status_t (*remove)(apr_pollcb_t *, apr_pollfd_t *);
+    apr_status_t (*modify)(apr_pollcb_t *, apr_pollfd_t *);
     apr_status_t (*poll)(apr_pollcb_t *, apr_interval_time_t, apr_pollcb_cb_t, void *);
     apr_status_t (*cleanup)(apr_pollcb_t *);
     const char *name;
@@ -37,6 +37,12 @@ APR_DECLARE(apr_json_value_t *) apr_json_value_create(apr_pool_t *pool)
 }
 
 APR_DECLARE(apr_json_value_t *) apr_json_object_create(apr_pool_t *pool)
+{
+    return apr_json_object_create_ex(pool, APR_JSON_FLAGS_NONE);
+}
+
+APR_DECLARE(apr_json_value_t *) apr_json_object_create_ex(apr_pool_t *pool,
+                                                          int flags)
 {
     apr_json_object_t *object;
 
@@ -45,11 +51,95 @@ APR_DECLARE(apr_json_value_t *) apr_json_object_create(apr_pool_t *pool)
     json->type = APR_JSON_OBJECT;
     json->value.object = object = apr_pcalloc(pool, sizeof(apr_json_object_t));
     APR_RING_INIT(&object->list, apr_json_kv_t, link);
-    object->hash = apr_hash_make(pool);
+    if (!(flags & APR_JSON_FLAGS_FLAT)) {
+        object->hash = apr_hash_make(pool);
+    }
 
     return json;
 }
 
+/* Flat objects have no hash, their few keys are searched in order */
+static apr_json_kv_t *object_find(apr_json_object_t *object, const char *key,
+                                  apr_ssize_t klen)
+{
+    apr_json_kv_t *kv;
+
+    if (object->hash) {
+        return apr_hash_get(object->hash, key, klen);
+    }
+
+    if (klen == APR_JSON_VALUE_STRING) {
+        klen = strlen(key);
+    }
+    for (kv = APR_RING_FIRST(&object->list);
+         kv != APR_RING_SENTINEL(&object->list, apr_json_kv_t, link);
+         kv = APR_RING_NEXT(kv, link)) {
+        const apr_json_string_t *k = &kv->k->value.string;
+        apr_ssize_t len = k->len == APR_JSON_VALUE_STRING ? strlen(k->p)
+                                                           : k->len;
+
+        if (len == klen && !memcmp(k->p, key, klen)) {
+            return kv;
+        }
+    }
+    return NULL;
+}
+
+static int object_count(apr_json_object_t *object)
+{
+    apr_json_kv_t *kv;
+    int count = 0;
+
+    if (object->hash) {
+        return apr_hash_count(object->hash);
+    }
+
+    for (kv = APR_RING_FIRST(&object->list);
+         kv != APR_RING_SENTINEL(&object->list, apr_json_kv_t, link);
+         kv = APR_RING_NEXT(kv, link)) {
+        count++;
+    }
+    return count;
+}
+
+static void object_remove(apr_json_object_t *object, apr_json_kv_t *kv)
+{
+    if (object->hash) {
+        apr_hash_set(object->hash, kv->k->value.string.p,
+                     kv->k->value.string.len, NULL);
+    }
+    APR_RING_REMOVE(kv, link);
+}
+
+/* A new kv pair for the key, the hash of flat objects is built past
+ * APR_JSON_OBJECT_FLAT_MAX keys.
+ */
+static apr_json_kv_t *object_insert(apr_json_object_t *object,
+                                    const char *key, apr_ssize_t klen,
+                                    apr_pool_t *pool)
+{
+    apr_json_kv_t *kv;
+
+    if (!object->hash && object_count(object) >= APR_JSON_OBJECT_FLAT_MAX) {
+        object->hash = apr_hash_make(pool);
+        for (kv = APR_RING_FIRST(&object->list);
+             kv != APR_RING_SENTINEL(&object->list, apr_json_kv_t, link);
+             kv = APR_RING_NEXT(kv, link)) {
+            apr_hash_set(object->hash, kv->k->value.string.p,
+                         kv->k->value.string.len, kv);
+        }
+    }
+
+    kv = apr_palloc(pool, sizeof(apr_json_kv_t));
+    APR_RING_ELEM_INIT(kv, link);
+    APR_JSON_OBJECT_INSERT_TAIL(object, kv);
+    if (object->hash) {
+        apr_hash_set(object->hash, key, klen, kv);
+    }
+
+    return kv;
+}
+
 APR_DECLARE(apr_json_value_t *) apr_json_string_create(apr_pool_t *pool,
                                                        const char *val,
                                                        apr_ssize_t len)
@@ -136,7 +226,6 @@ APR_DECLARE(apr_status_t) apr_json_object_set(apr_json_value_t *object,
         apr_pool_t *pool)
 {
     apr_json_kv_t *kv;
-    apr_hash_t *hash;
 
     if (object->type != APR_JSON_OBJECT) {
         return APR_EINVAL;
@@ -146,24 +235,17 @@ APR_DECLARE(apr_status_t) apr_json_object_set(apr_json_value_t *object,
         klen = strlen(key);
     }
 
-    hash = object->value.object->hash;
-
-    kv = apr_hash_get(hash, key, klen);
+    kv = object_find(object->value.object, key, klen);
 
     if (!val) {
         if (kv) {
-            apr_hash_set(hash, key, klen, NULL);
-            APR_RING_REMOVE((kv), link);
+            object_remove(object->value.object, kv);
         }
         return APR_SUCCESS;
     }
 
     if (!kv) {
-        kv = apr_palloc(pool, sizeof(apr_json_kv_t));
-        APR_RING_ELEM_INIT(kv, link);
-        APR_JSON_OBJECT_INSERT_TAIL(object->value.object, kv);
-        apr_hash_set(hash, key, klen,
-                kv);
+        kv = object_insert(object->value.object, key, klen, pool);
     }
 
     kv->k = apr_json_string_create(pool, key, klen);
@@ -178,32 +260,25 @@ APR_DECLARE(apr_status_t) apr_json_object_set_ex(apr_json_value_t *object,
                                                  apr_pool_t *pool)
 {
     apr_json_kv_t *kv;
-    apr_hash_t *hash;
 
     if (object->type != APR_JSON_OBJECT
             || key->type != APR_JSON_STRING) {
         return APR_EINVAL;
     }
 
-    hash = object->value.object->hash;
-
-    kv = apr_hash_get(hash, key->value.string.p, key->value.string.len);
+    kv = object_find(object->value.object, key->value.string.p,
+                     key->value.string.len);
 
     if (!val) {
         if (kv) {
-            apr_hash_set(hash, key->value.string.p, key->value.string.len,
-                    NULL);
-            APR_RING_REMOVE((kv), link);
+            object_remove(object->value.object, kv);
         }
         return APR_SUCCESS;
     }
 
     if (!kv) {
-        kv = apr_palloc(pool, sizeof(apr_json_kv_t));
-        APR_RING_ELEM_INIT(kv, link);
-        APR_JSON_OBJECT_INSERT_TAIL(object->value.object, kv);
-        apr_hash_set(hash, key->value.string.p, key->value.string.len,
-                kv);
+        kv = object_insert(object->value.object, key->value.string.p,
+                           key->value.string.len, pool);
     }
 
     kv->k = key;
@@ -220,7 +295,7 @@ APR_DECLARE(apr_json_kv_t *) apr_json_object_get(apr_json_value_t *object,
         return NULL;
     }
 
-    return apr_hash_get(object->value.object->hash, key, klen);
+    return object_find(object->value.object, key, klen);
 }
 
 APR_DECLARE(apr_json_kv_t *) apr_json_object_first(apr_json_value_t *obj)
@@ -348,11 +423,11 @@ APR_DECLARE(apr_json_value_t *) apr_json_overlay(apr_pool_t *p,
         return overlay;
     }
 
-    oc = apr_hash_count(overlay->value.object->hash);
+    oc = object_count(overlay->value.object);
     if (!oc) {
         return base;
     }
-    bc = apr_hash_count(base->value.object->hash);
+    bc = object_count(base->value.object);
     if (!bc) {
         return overlay;
     }
@@ -363,7 +438,7 @@ APR_DECLARE(apr_json_value_t *) apr_json_overlay(apr_pool_t *p,
          kv != APR_RING_SENTINEL(&(base->value.object)->list, apr_json_kv_t, link);
          kv = APR_RING_NEXT((kv), link)) {
 
-        if (!apr_hash_get(overlay->value.object->hash, kv->k->value.string.p,
+        if (!object_find(overlay->value.object, kv->k->value.string.p,
                 kv->k->value.string.len)) {
 
             apr_json_object_set_ex(res, kv->k, kv->v, p);
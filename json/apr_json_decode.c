@@ -21,19 +21,270 @@
 
 #if !APR_CHARSET_EBCDIC
 
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SSE2 1
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ >= 5)
+#include <immintrin.h>
+#define JSON_AVX2 1
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JSON_NEON 1
+#endif
+
 typedef struct _json_link_t {
     apr_json_value_t *value;
     struct _json_link_t *next;
 } json_link_t;
 
+/* Scanning a block at a time, with the best vector compares available */
+typedef struct json_scan_t {
+    /* the first '"', '\\' or non ASCII byte from p, or e */
+    const char *(*string)(const char *p, const char *e);
+    /* the first non whitespace byte from p, or e */
+    const char *(*space)(const char *p, const char *e);
+} json_scan_t;
+
 typedef struct apr_json_scanner_t {
     apr_pool_t *pool;
     const char *p;
     const char *e;
     int flags;
     int level;
+    const json_scan_t *scan;
 } apr_json_scanner_t;
 
+static const char *scan_string_scalar(const char *p, const char *e)
+{
+    while (p < e && *p != '"' && *p != '\\' && !(*p & 0x80)) {
+        p++;
+    }
+    return p;
+}
+
+static const char *scan_space_scalar(const char *p, const char *e)
+{
+    while (p < e && isspace(*(unsigned char *)p)) {
+        p++;
+    }
+    return p;
+}
+
+#if JSON_SSE2 || JSON_NEON
+
+static APR_INLINE unsigned int mask_first(apr_uint64_t mask)
+{
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctzll(mask);
+#else
+    unsigned int n = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+#endif /* JSON_SSE2 || JSON_NEON */
+
+#if JSON_SSE2
+
+static const char *scan_string_sse2(const char *p, const char *e)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+
+    for (; e - p >= 16; p += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)p);
+        /* the high bit of non ASCII bytes is set already */
+        __m128i m = _mm_or_si128(b, _mm_or_si128(_mm_cmpeq_epi8(b, quote),
+                                        _mm_cmpeq_epi8(b, backslash)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(m);
+
+        if (mask) {
+            return p + mask_first(mask);
+        }
+    }
+    return scan_string_scalar(p, e);
+}
+
+static const char *scan_space_sse2(const char *p, const char *e)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i four = _mm_set1_epi8(4);
+
+    /* mostly no or little whitespace between tokens */
+    if (p < e && !isspace(*(unsigned char *)p)) {
+        return p;
+    }
+    for (; e - p >= 16; p += 16) {
+        __m128i b = _mm_loadu_si128((const __m128i *)p);
+        /* '\t' to '\r', or ' ' */
+        __m128i d = _mm_sub_epi8(b, tab);
+        __m128i m = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(d, four), d),
+                                 _mm_cmpeq_epi8(b, space));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(m) ^ 0xffff;
+
+        if (mask) {
+            return p + mask_first(mask);
+        }
+    }
+    return scan_space_scalar(p, e);
+}
+
+static const json_scan_t scan_sse2 = {
+    scan_string_sse2,
+    scan_space_sse2
+};
+
+#endif /* JSON_SSE2 */
+
+#if JSON_AVX2
+
+/* Compiled for AVX2, used if the CPU has it */
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+static TARGET_AVX2 const char *scan_string_avx2(const char *p, const char *e)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+
+    for (; e - p >= 32; p += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)p);
+        __m256i m = _mm256_or_si256(b, _mm256_or_si256(
+                                        _mm256_cmpeq_epi8(b, quote),
+                                        _mm256_cmpeq_epi8(b, backslash)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(m);
+
+        if (mask) {
+            return p + mask_first(mask);
+        }
+    }
+    return scan_string_sse2(p, e);
+}
+
+static TARGET_AVX2 const char *scan_space_avx2(const char *p, const char *e)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i four = _mm256_set1_epi8(4);
+
+    if (p < e && !isspace(*(unsigned char *)p)) {
+        return p;
+    }
+    for (; e - p >= 32; p += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)p);
+        __m256i d = _mm256_sub_epi8(b, tab);
+        __m256i m = _mm256_or_si256(
+                        _mm256_cmpeq_epi8(_mm256_min_epu8(d, four), d),
+                        _mm256_cmpeq_epi8(b, space));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(m);
+
+        if (mask) {
+            return p + mask_first(mask);
+        }
+    }
+    return scan_space_sse2(p, e);
+}
+
+static const json_scan_t scan_avx2 = {
+    scan_string_avx2,
+    scan_space_avx2
+};
+
+#endif /* JSON_AVX2 */
+
+#if JSON_NEON
+
+/* Four bits per lane, the narrowing shift is cheaper than a movemask */
+static APR_INLINE apr_uint64_t mask_neon(uint8x16_t m)
+{
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(m), 4);
+
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0)
+           & APR_UINT64_C(0x8888888888888888);
+}
+
+static const char *scan_string_neon(const char *p, const char *e)
+{
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t ascii = vdupq_n_u8(0x80);
+
+    for (; e - p >= 16; p += 16) {
+        uint8x16_t b = vld1q_u8((const unsigned char *)p);
+        uint8x16_t m = vorrq_u8(vcgeq_u8(b, ascii),
+                                vorrq_u8(vceqq_u8(b, quote),
+                                         vceqq_u8(b, backslash)));
+        apr_uint64_t mask = mask_neon(m);
+
+        if (mask) {
+            return p + (mask_first(mask) >> 2);
+        }
+    }
+    return scan_string_scalar(p, e);
+}
+
+static const char *scan_space_neon(const char *p, const char *e)
+{
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t four = vdupq_n_u8(4);
+
+    if (p < e && !isspace(*(unsigned char *)p)) {
+        return p;
+    }
+    for (; e - p >= 16; p += 16) {
+        uint8x16_t b = vld1q_u8((const unsigned char *)p);
+        uint8x16_t m = vorrq_u8(vcleq_u8(vsubq_u8(b, tab), four),
+                                vceqq_u8(b, space));
+        apr_uint64_t mask = mask_neon(vmvnq_u8(m));
+
+        if (mask) {
+            return p + (mask_first(mask) >> 2);
+        }
+    }
+    return scan_space_scalar(p, e);
+}
+
+static const json_scan_t scan_neon = {
+    scan_string_neon,
+    scan_space_neon
+};
+
+#endif /* JSON_NEON */
+
+#if !JSON_SSE2 && !JSON_NEON
+
+static const json_scan_t scan_scalar = {
+    scan_string_scalar,
+    scan_space_scalar
+};
+
+#endif
+
+static const json_scan_t *json_scan_select(void)
+{
+#if JSON_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return &scan_avx2;
+    }
+#endif
+#if JSON_SSE2
+    return &scan_sse2;
+#elif JSON_NEON
+    return &scan_neon;
+#else
+    return &scan_scalar;
+#endif
+}
+
 static apr_status_t apr_json_decode_space(apr_json_scanner_t * self,
                                           const char **space);
 static apr_status_t apr_json_decode_value(apr_json_scanner_t * self,
@@ -95,10 +346,14 @@ static apr_status_t apr_json_decode_string(apr_json_scanner_t * self, apr_json_s
 
     self->p++; /* eat the leading '"' */
 
-    /* advance past the \ " */
+    /* advance past the \ ", a run of plain chars at a time */
     len = 0;
     for (p = self->p, e = self->e; p < e;) {
-        if (*p == '"')
+        const char *s = self->scan->string(p, e);
+
+        len += s - p;
+        p = s;
+        if (p >= e || *p == '"')
             break;
         else if (*p == '\\') {
             p++;
@@ -335,7 +590,14 @@ static apr_status_t apr_json_decode_string(apr_json_scanner_t * self, apr_json_s
             goto out;
 
         default:
-            *q++ = *p++;
+            {
+                /* and the plain chars that follow, ASCII is valid UTF-8 */
+                const char *s = self->scan->string(p + 1, e);
+
+                memcpy(q, p, s - p);
+                q += s - p;
+                p = s;
+            }
             break;
         }
     }
@@ -436,7 +698,9 @@ static apr_status_t apr_json_decode_object(apr_json_scanner_t * self,
     apr_json_object_t *object = apr_pcalloc(self->pool,
             sizeof(apr_json_object_t));
     APR_RING_INIT(&object->list, apr_json_kv_t, link);
-    object->hash = apr_hash_make(self->pool);
+    if (!(self->flags & APR_JSON_FLAGS_FLAT)) {
+        object->hash = apr_hash_make(self->pool);
+    }
 
     *retval = object;
 
@@ -687,9 +951,7 @@ static apr_status_t apr_json_decode_null(apr_json_scanner_t * self)
 static apr_status_t apr_json_decode_space(apr_json_scanner_t * self,
         const char **space)
 {
-    const char *p = self->p;
-    char *s;
-    int len = 0;
+    const char *p;
 
     *space = NULL;
 
@@ -697,24 +959,12 @@ static apr_status_t apr_json_decode_space(apr_json_scanner_t * self,
         return APR_SUCCESS;
     }
 
-    while (p < self->e && isspace(*(unsigned char *)p)) {
-        p++;
-        len++;
-    }
-
-    if (self->flags & APR_JSON_FLAGS_WHITESPACE) {
-        if (len) {
-            *space = s = apr_palloc(self->pool, len + 1);
+    p = self->scan->space(self->p, self->e);
 
-            while (self->p < self->e && isspace(*(unsigned char *) self->p)) {
-                *s++ = *self->p++;
-            }
-            *s = 0;
-
-        }
-    } else {
-        self->p = p;
+    if ((self->flags & APR_JSON_FLAGS_WHITESPACE) && p > self->p) {
+        *space = apr_pstrmemdup(self->pool, self->p, p - self->p);
     }
+    self->p = p;
 
     return APR_SUCCESS;
 }
@@ -794,6 +1044,7 @@ APR_DECLARE(apr_status_t) apr_json_decode(apr_json_value_t ** retval,
     scanner.pool = pool;
     scanner.flags = flags;
     scanner.level = level;
+    scanner.scan = json_scan_select();
 
     if (APR_SUCCESS == (status = apr_json_decode_value(&scanner, retval))) {
         if (scanner.p != scanner.e) {
@@ -809,6 +1060,554 @@ APR_DECLARE(apr_status_t) apr_json_decode(apr_json_value_t ** retval,
     return status;
 }
 
+/* What the push parser expects next */
+#define PARSE_VALUE         0   /* a value, at the top or after ':' or ',' */
+#define PARSE_VALUE_OR_END  1   /* after '[' */
+#define PARSE_KEY           2   /* after ',' in an object */
+#define PARSE_KEY_OR_END    3   /* after '{' */
+#define PARSE_COLON         4   /* after a key */
+#define PARSE_NEXT          5   /* ',' or the end, after a value in a container */
+#define PARSE_DONE          6   /* nothing but whitespace */
+
+/* The token in progress, possibly split between parts */
+#define TOKEN_NONE          0
+#define TOKEN_STRING        1
+#define TOKEN_NUMBER        2
+#define TOKEN_LITERAL       3
+#define TOKEN_SPACE         4
+
+typedef struct json_frame_t {
+    /* the container, when building the tree */
+    apr_json_value_t *value;
+    /* the key of the next value, in objects */
+    apr_json_value_t *key;
+    apr_json_type_e type;
+} json_frame_t;
+
+struct apr_json_parser_t {
+    apr_pool_t *pool;
+    /* where the values given to the callbacks live, cleared after each */
+    apr_pool_t *scratch;
+    const apr_json_callbacks_t *cb;
+    void *ctx;
+    const json_scan_t *scan;
+    int flags;
+    int level;
+    /* the open containers, of json_frame_t */
+    apr_array_header_t *stack;
+    int state;
+    int token;
+    /* the last char of the string token was a backslash */
+    int escape;
+    /* no more parts, the token in progress ends */
+    int eof;
+    /* the beginning of the token in progress, from previous parts */
+    char *buf;
+    apr_size_t buf_len;
+    apr_size_t buf_size;
+    /* where the token in progress starts, and where the part starts */
+    apr_off_t token_offset;
+    apr_off_t offset;
+    /* where the error stopped the parser */
+    apr_off_t error_offset;
+    apr_status_t status;
+    apr_json_value_t *root;
+    /* with APR_JSON_FLAGS_WHITESPACE, where the next whitespace goes */
+    const char **post;
+    const char *pre;
+};
+
+APR_DECLARE(apr_status_t) apr_json_parser_create(apr_json_parser_t **parser,
+        const apr_json_callbacks_t *callbacks, void *ctx, int flags,
+        int level, apr_pool_t *pool)
+{
+    apr_json_parser_t *self = apr_pcalloc(pool, sizeof(apr_json_parser_t));
+    apr_status_t status;
+
+    self->pool = pool;
+    self->cb = callbacks;
+    self->ctx = ctx;
+    self->scan = json_scan_select();
+    self->flags = flags;
+    self->level = level;
+    self->stack = apr_array_make(pool, 8, sizeof(json_frame_t));
+    self->state = PARSE_VALUE;
+    self->token = TOKEN_NONE;
+
+    if (callbacks) {
+        if ((status = apr_pool_create(&self->scratch, pool))) {
+            return status;
+        }
+        apr_pool_tag(self->scratch, "apr_json_parser_scratch");
+        /* no whitespace for the callbacks */
+        self->flags &= ~APR_JSON_FLAGS_WHITESPACE;
+    }
+
+    *parser = self;
+    return APR_SUCCESS;
+}
+
+/* The end of the token in progress, or NULL if it goes on past e */
+static const char *parse_token_end(apr_json_parser_t *self,
+                                   const char *p, const char *e)
+{
+    switch (self->token) {
+    case TOKEN_STRING:
+        while (p < e) {
+            if (self->escape) {
+                self->escape = 0;
+                p++;
+                continue;
+            }
+            p = self->scan->string(p, e);
+            if (p >= e) {
+                break;
+            }
+            if (*p == '"') {
+                return p + 1;
+            }
+            self->escape = (*p++ == '\\');
+        }
+        return NULL;
+    case TOKEN_NUMBER:
+        while (p < e && (isdigit(*(unsigned char *)p) || *p == '-'
+                         || *p == '+' || *p == '.' || *p == 'e' || *p == 'E')) {
+            p++;
+        }
+        break;
+    case TOKEN_LITERAL:
+        while (p < e && isalpha(*(unsigned char *)p)) {
+            p++;
+        }
+        break;
+    case TOKEN_SPACE:
+        p = self->scan->space(p, e);
+        break;
+    }
+    return p < e ? p : NULL;
+}
+
+/* Keep the token in progress for the next part, NUL terminated for
+ * strtod() and strtol().
+ */
+static void parse_buffer(apr_json_parser_t *self, const char *p, apr_size_t len)
+{
+    if (self->buf_len + len >= self->buf_size) {
+        apr_size_t size = self->buf_size ? self->buf_size * 2 : 64;
+        char *buf;
+
+        while (self->buf_len + len >= size) {
+            size *= 2;
+        }
+        buf = apr_palloc(self->pool, size);
+        memcpy(buf, self->buf, self->buf_len);
+        self->buf = buf;
+        self->buf_size = size;
+    }
+    memcpy(self->buf + self->buf_len, p, len);
+    self->buf_len += len;
+    self->buf[self->buf_len] = 0;
+}
+
+static void parse_next(apr_json_parser_t *self)
+{
+    self->state = self->stack->nelts ? PARSE_NEXT : PARSE_DONE;
+}
+
+/* Link a new value in the tree */
+static apr_status_t parse_attach(apr_json_parser_t *self,
+                                 apr_json_value_t *value)
+{
+    json_frame_t *frame;
+
+    value->pre = self->pre;
+    self->pre = NULL;
+
+    if (!self->stack->nelts) {
+        self->root = value;
+        return APR_SUCCESS;
+    }
+    frame = &APR_ARRAY_IDX(self->stack, self->stack->nelts - 1, json_frame_t);
+    if (frame->type == APR_JSON_ARRAY) {
+        return apr_json_array_add(frame->value, value);
+    }
+    return apr_json_object_set_ex(frame->value, frame->key, value, self->pool);
+}
+
+static apr_status_t parse_open(apr_json_parser_t *self, apr_json_type_e type)
+{
+    json_frame_t *frame;
+    apr_json_value_t *value = NULL;
+    apr_status_t status = APR_SUCCESS;
+
+    if (self->stack->nelts >= self->level) {
+        return APR_EINVAL;
+    }
+
+    if (self->cb) {
+        if (type == APR_JSON_OBJECT && self->cb->object_start) {
+            status = self->cb->object_start(self->ctx);
+        }
+        else if (type == APR_JSON_ARRAY && self->cb->array_start) {
+            status = self->cb->array_start(self->ctx);
+        }
+    }
+    else {
+        if (type == APR_JSON_OBJECT) {
+            value = apr_json_object_create_ex(self->pool, self->flags);
+        }
+        else {
+            value = apr_json_array_create(self->pool, 0);
+        }
+        status = parse_attach(self, value);
+    }
+    if (status) {
+        return status;
+    }
+
+    frame = apr_array_push(self->stack);
+    frame->value = value;
+    frame->key = NULL;
+    frame->type = type;
+
+    self->state = type == APR_JSON_OBJECT ? PARSE_KEY_OR_END
+                                          : PARSE_VALUE_OR_END;
+    return APR_SUCCESS;
+}
+
+static apr_status_t parse_close(apr_json_parser_t *self)
+{
+    json_frame_t *frame = apr_array_pop(self->stack);
+    apr_status_t status = APR_SUCCESS;
+
+    if (self->cb) {
+        if (frame->type == APR_JSON_OBJECT && self->cb->object_end) {
+            status = self->cb->object_end(self->ctx);
+        }
+        else if (frame->type == APR_JSON_ARRAY && self->cb->array_end) {
+            status = self->cb->array_end(self->ctx);
+        }
+    }
+    else {
+        self->post = &frame->value->post;
+    }
+
+    parse_next(self);
+    return status;
+}
+
+/* Decode the whole token from p to e, using the decoder's scanner */
+static apr_status_t parse_token(apr_json_parser_t *self,
+                                const char *p, const char *e)
+{
+    apr_json_scanner_t scanner;
+    apr_json_value_t value, *key;
+    apr_status_t status;
+    int token = self->token;
+
+    self->token = TOKEN_NONE;
+    self->escape = 0;
+
+    if (token == TOKEN_SPACE) {
+        const char *space = apr_pstrmemdup(self->pool, p, e - p);
+
+        if (self->post) {
+            *self->post = space;
+            self->post = NULL;
+        }
+        else {
+            self->pre = space;
+        }
+        return APR_SUCCESS;
+    }
+
+    scanner.pool = self->cb ? self->scratch : self->pool;
+    scanner.p = p;
+    scanner.e = e;
+    scanner.flags = self->flags;
+    scanner.level = 0;
+    scanner.scan = self->scan;
+
+    value.pre = NULL;
+    value.post = NULL;
+
+    if (token == TOKEN_STRING && (self->state == PARSE_KEY
+                                  || self->state == PARSE_KEY_OR_END)) {
+        key = self->cb ? &value : apr_json_value_create(self->pool);
+        key->type = APR_JSON_STRING;
+        status = apr_json_decode_string(&scanner, &key->value.string);
+    }
+    else {
+        key = NULL;
+        switch (token) {
+        case TOKEN_STRING:
+            value.type = APR_JSON_STRING;
+            status = apr_json_decode_string(&scanner, &value.value.string);
+            break;
+        case TOKEN_NUMBER:
+            status = apr_json_decode_number(&scanner, &value);
+            break;
+        default:
+            if (*p == 'n') {
+                value.type = APR_JSON_NULL;
+                status = apr_json_decode_null(&scanner);
+            }
+            else {
+                value.type = APR_JSON_BOOLEAN;
+                status = apr_json_decode_boolean(&scanner, &value.value.boolean);
+            }
+        }
+    }
+
+    if (status == APR_SUCCESS && scanner.p != e) {
+        status = APR_BADCH;
+    }
+    else if (status == APR_EOF && !self->eof) {
+        /* the token is complete, nothing more comes */
+        status = APR_BADCH;
+    }
+    if (status) {
+        self->error_offset = self->token_offset + (scanner.p - p);
+        return status;
+    }
+
+    if (key) {
+        if (self->cb) {
+            if (self->cb->object_key) {
+                status = self->cb->object_key(self->ctx, &key->value.string);
+            }
+            apr_pool_clear(self->scratch);
+        }
+        else {
+            key->pre = self->pre;
+            self->pre = NULL;
+            APR_ARRAY_IDX(self->stack, self->stack->nelts - 1,
+                          json_frame_t).key = key;
+            self->post = &key->post;
+        }
+        self->state = PARSE_COLON;
+    }
+    else {
+        if (self->cb) {
+            if (self->cb->value) {
+                status = self->cb->value(self->ctx, &value);
+            }
+            apr_pool_clear(self->scratch);
+        }
+        else {
+            apr_json_value_t *v = apr_pmemdup(self->pool, &value,
+                                              sizeof(value));
+
+            status = parse_attach(self, v);
+            self->post = &v->post;
+        }
+        parse_next(self);
+    }
+
+    if (status) {
+        self->error_offset = self->token_offset + (e - p);
+    }
+    return status;
+}
+
+APR_DECLARE(apr_status_t) apr_json_parser_feed(apr_json_parser_t *self,
+        const char *injson, apr_size_t size)
+{
+    const char *p = injson, *e = injson + size, *end;
+    apr_size_t len;
+    apr_status_t status = self->status;
+
+    if (status) {
+        return status;
+    }
+
+    /* the token split from the previous parts */
+    if (self->token != TOKEN_NONE) {
+        end = parse_token_end(self, p, e);
+        if (!end) {
+            parse_buffer(self, p, e - p);
+            self->offset += size;
+            return APR_SUCCESS;
+        }
+        parse_buffer(self, p, end - p);
+        len = self->buf_len;
+        self->buf_len = 0;
+        if ((status = parse_token(self, self->buf, self->buf + len))) {
+            goto out;
+        }
+        p = end;
+    }
+
+    while (p < e) {
+        unsigned char c = *(unsigned char *)p;
+        int token = TOKEN_NONE;
+
+        if (isspace(c)) {
+            if (!(self->flags & APR_JSON_FLAGS_WHITESPACE)) {
+                p++;
+                continue;
+            }
+            token = TOKEN_SPACE;
+        }
+        else {
+            /* whitespace before separators and ends is not kept */
+            if (c == ',' || c == ':' || c == ']' || c == '}') {
+                self->pre = NULL;
+                self->post = NULL;
+            }
+            switch (self->state) {
+            case PARSE_VALUE:
+            case PARSE_VALUE_OR_END:
+                if (c == '"') {
+                    token = TOKEN_STRING;
+                }
+                else if (c == '-' || isdigit(c)) {
+                    token = TOKEN_NUMBER;
+                }
+                else if (c == 't' || c == 'f' || c == 'n') {
+                    token = TOKEN_LITERAL;
+                }
+                else if (c == '{') {
+                    status = parse_open(self, APR_JSON_OBJECT);
+                }
+                else if (c == '[') {
+                    status = parse_open(self, APR_JSON_ARRAY);
+                }
+                else if (c == ']' && self->state == PARSE_VALUE_OR_END) {
+                    status = parse_close(self);
+                }
+                else {
+                    status = APR_BADCH;
+                }
+                break;
+            case PARSE_KEY:
+            case PARSE_KEY_OR_END:
+                if (c == '"') {
+                    token = TOKEN_STRING;
+                }
+                else if (c == '}' && self->state == PARSE_KEY_OR_END) {
+                    status = parse_close(self);
+                }
+                else {
+                    status = APR_BADCH;
+                }
+                break;
+            case PARSE_COLON:
+                if (c == ':') {
+                    self->state = PARSE_VALUE;
+                }
+                else {
+                    status = APR_BADCH;
+                }
+                break;
+            case PARSE_NEXT: {
+                apr_json_type_e type = APR_ARRAY_IDX(self->stack,
+                        self->stack->nelts - 1, json_frame_t).type;
+
+                if (c == ',') {
+                    self->state = type == APR_JSON_ARRAY ? PARSE_VALUE
+                                                         : PARSE_KEY;
+                }
+                else if ((c == ']' && type == APR_JSON_ARRAY)
+                         || (c == '}' && type == APR_JSON_OBJECT)) {
+                    status = parse_close(self);
+                }
+                else {
+                    status = APR_BADCH;
+                }
+                break;
+            }
+            default:
+                /* trailing craft */
+                status = APR_BADCH;
+            }
+        }
+
+        if (token == TOKEN_NONE) {
+            if (status) {
+                self->error_offset = self->offset + (p - injson);
+                goto out;
+            }
+            p++;
+            continue;
+        }
+
+        self->token = token;
+        self->token_offset = self->offset + (p - injson);
+        end = parse_token_end(self, token == TOKEN_STRING ? p + 1 : p, e);
+        if (!end) {
+            parse_buffer(self, p, e - p);
+            break;
+        }
+        if ((status = parse_token(self, p, end))) {
+            goto out;
+        }
+        p = end;
+    }
+
+out:
+    self->offset += size;
+    self->status = status;
+    return status;
+}
+
+APR_DECLARE(apr_status_t) apr_json_parser_feed_brigade(
+        apr_json_parser_t *self, apr_bucket_brigade *bb)
+{
+    apr_bucket *b;
+    const char *data;
+    apr_size_t len;
+    apr_status_t status;
+
+    while (!APR_BRIGADE_EMPTY(bb)) {
+        b = APR_BRIGADE_FIRST(bb);
+
+        if (!APR_BUCKET_IS_METADATA(b)) {
+            if ((status = apr_bucket_read(b, &data, &len, APR_BLOCK_READ))) {
+                return status;
+            }
+            if ((status = apr_json_parser_feed(self, data, len))) {
+                return status;
+            }
+        }
+        apr_bucket_delete(b);
+    }
+
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_json_parser_finish(apr_json_parser_t *self,
+        apr_json_value_t **retval, apr_off_t *offset)
+{
+    apr_status_t status = self->status;
+
+    if (status == APR_SUCCESS && self->token == TOKEN_STRING) {
+        /* unterminated */
+        self->error_offset = self->offset;
+        status = APR_EOF;
+    }
+    else if (status == APR_SUCCESS && self->token != TOKEN_NONE) {
+        apr_size_t len = self->buf_len;
+
+        self->eof = 1;
+        self->buf_len = 0;
+        status = parse_token(self, self->buf, self->buf + len);
+    }
+    if (status == APR_SUCCESS && self->state != PARSE_DONE) {
+        self->error_offset = self->offset;
+        status = APR_EOF;
+    }
+    self->status = status;
+
+    if (retval) {
+        *retval = status == APR_SUCCESS ? self->root : NULL;
+    }
+    if (offset) {
+        *offset = status == APR_SUCCESS ? self->offset : self->error_offset;
+    }
+    return status;
+}
+
 #else
 /* we do not yet support JSON on EBCDIC platforms, but will do in future */
 apr_status_t apr_json_decode(apr_json_value_t ** retval, const char *injson,
@@ -816,4 +1615,29 @@ apr_status_t apr_json_decode(apr_json_value_t ** retval, const char *injson,
 {
     return APR_ENOTIMPL;
 }
+
+APR_DECLARE(apr_status_t) apr_json_parser_create(apr_json_parser_t **parser,
+        const apr_json_callbacks_t *callbacks, void *ctx, int flags,
+        int level, apr_pool_t *pool)
+{
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_json_parser_feed(apr_json_parser_t *parser,
+        const char *injson, apr_size_t size)
+{
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_json_parser_feed_brigade(
+        apr_json_parser_t *parser, apr_bucket_brigade *bb)
+{
+    return APR_ENOTIMPL;
+}
+
+APR_DECLARE(apr_status_t) apr_json_parser_finish(apr_json_parser_t *parser,
+        apr_json_value_t **retval, apr_off_t *offset)
+{
+    return APR_ENOTIMPL;
+}
 #endif
@@ -25,6 +25,7 @@
 #include "apr_allocator.h"
 #include "apr_lib.h"
 #include "apr_thread_mutex.h"
+#include "apr_thread_proc.h" /* for APR_THREAD_LOCAL */
 #include "apr_hash.h"
 #include "apr_time.h"
 #include "apr_support.h"
@@ -105,6 +106,35 @@ static unsigned int boundary_size;
 #define TIMEOUT_USECS    3000000
 #define TIMEOUT_INTERVAL   46875
 
+/*
+ * Allocator magazines (per-thread caches)
+ *
+ * When enabled with apr_allocator_cache_set(), each thread is bound to
+ * one of MAGAZINE_COUNT magazines holding free nodes per size index,
+ * which it owns with a single CAS instead of taking the allocator mutex.
+ * Misses refill up to MAGAZINE_BATCH nodes from the global free lists,
+ * in the same critical section as the regular allocation, and overflows
+ * flush as many back.  A magazine which is busy (another thread mapped
+ * to the same slot) is simply bypassed.
+ */
+#if APR_HAS_THREADS
+#define MAGAZINE_COUNT  64
+#define MAGAZINE_BATCH  8
+#define MAGAZINE_ALIGN  64 /* avoid false sharing between magazines */
+
+typedef struct allocator_magazine_t {
+    /** non-zero while a thread owns the magazine */
+    apr_uint32_t      busy;
+    /** Total size (in BOUNDARY_SIZE multiples) of the cached nodes */
+    apr_size_t        size;
+    /** Lists of cached nodes, same slots as allocator->free[] */
+    apr_memnode_t    *free[MAX_INDEX];
+} allocator_magazine_t;
+
+#define SIZEOF_MAGAZINE_T   APR_ALIGN(sizeof(allocator_magazine_t), \
+                                      MAGAZINE_ALIGN)
+#endif /* APR_HAS_THREADS */
+
 /*
  * Allocator
  *
@@ -128,6 +158,12 @@ struct apr_allocator_t {
     apr_size_t        current_free_index;
 #if APR_HAS_THREADS
     apr_thread_mutex_t *mutex;
+    /** Per-thread magazines, NULL unless enabled by
+     * apr_allocator_cache_set().
+     */
+    char               *magazines;
+    /** Maximum size (in BOUNDARY_SIZE multiples) cached per magazine */
+    apr_size_t          max_magazine_index;
 #endif /* APR_HAS_THREADS */
     apr_pool_t         *owner;
     /**
@@ -191,6 +227,27 @@ APR_DECLARE(void) apr_allocator_destroy(apr_allocator_t *allocator)
     apr_size_t index;
     apr_memnode_t *node, **ref;
 
+#if APR_HAS_THREADS
+    if (allocator->magazines) {
+        apr_size_t i;
+
+        /* Hand the cached nodes back to the free lists, freed below */
+        for (i = 0; i < MAGAZINE_COUNT; i++) {
+            allocator_magazine_t *mag = (allocator_magazine_t *)
+                (allocator->magazines + i * SIZEOF_MAGAZINE_T);
+
+            for (index = 0; index < MAX_INDEX; index++) {
+                while ((node = mag->free[index]) != NULL) {
+                    mag->free[index] = node->next;
+                    node->next = allocator->free[index];
+                    allocator->free[index] = node;
+                }
+            }
+        }
+        free(allocator->magazines);
+    }
+#endif /* APR_HAS_THREADS */
+
     for (index = 0; index <= MAX_INDEX; index++) {
         ref = &allocator->free[index];
         while ((node = *ref) != NULL) {
@@ -276,9 +333,153 @@ APR_DECLARE(apr_size_t) apr_allocator_align(apr_allocator_t *allocator,
     return allocator_align(size);
 }
 
+#if APR_HAS_THREADS
+#if APR_HAS_THREAD_LOCAL
+static APR_THREAD_LOCAL apr_uint32_t magazine_slot = 0;
+static apr_uint32_t magazine_next_slot = 0;
+#endif
+
+static APR_INLINE
+allocator_magazine_t *magazine_acquire(apr_allocator_t *allocator)
+{
+    allocator_magazine_t *mag;
+    apr_size_t slot;
+
+#if APR_HAS_THREAD_LOCAL
+    /* Threads are bound to the magazines round-robin, on first use */
+    if (!magazine_slot) {
+        magazine_slot = apr_atomic_inc32(&magazine_next_slot) + 1;
+    }
+    slot = magazine_slot - 1;
+#else
+    slot = (unsigned long)apr_os_thread_current();
+    slot ^= slot >> 16;
+#endif
+    mag = (allocator_magazine_t *)(allocator->magazines
+                                   + (slot % MAGAZINE_COUNT)
+                                     * SIZEOF_MAGAZINE_T);
+
+    if (apr_atomic_cas32(&mag->busy, 1, 0) != 0) {
+        return NULL;
+    }
+    return mag;
+}
+
+static APR_INLINE
+void magazine_release(allocator_magazine_t *mag)
+{
+    apr_atomic_set32(&mag->busy, 0);
+}
+
+/* Take a node of exactly the given index from the magazine, if any */
+static APR_INLINE
+apr_memnode_t *magazine_alloc(allocator_magazine_t *mag, apr_size_t index)
+{
+    apr_memnode_t *node;
+
+    if ((node = mag->free[index]) != NULL) {
+        mag->free[index] = node->next;
+        mag->size -= index + 1;
+    }
+
+    return node;
+}
+
+/* Move up to a batch of nodes of the given index from the global free
+ * lists to the magazine, for the next allocations of this size.  Called
+ * with the allocator locked, by the allocation which missed in the
+ * magazine and found a node of this size in the free lists.
+ */
+static APR_INLINE
+void magazine_refill(apr_allocator_t *allocator, allocator_magazine_t *mag,
+                     apr_size_t index)
+{
+    apr_memnode_t *node;
+    apr_size_t n;
+
+    for (n = 1; n < MAGAZINE_BATCH; n++) {
+        if ((node = allocator->free[index]) == NULL
+            || mag->size + index + 1 > allocator->max_magazine_index) {
+            break;
+        }
+        allocator->free[index] = node->next;
+        node->next = mag->free[index];
+        mag->free[index] = node;
+        mag->size += index + 1;
+
+        allocator->current_free_index += index + 1;
+        if (allocator->current_free_index > allocator->max_free_index)
+            allocator->current_free_index = allocator->max_free_index;
+    }
+}
+
+/* Cache the given list of nodes into the thread's magazine, flushing a
+ * batch of the same index when it is full.  Returns the nodes which did
+ * not fit (or all of them if the magazine is busy), for the caller to
+ * give back to the global free lists.
+ */
+static APR_INLINE
+apr_memnode_t *magazine_free(apr_allocator_t *allocator, apr_memnode_t *node)
+{
+    allocator_magazine_t *mag;
+    apr_memnode_t *next, *overflow = NULL;
+    apr_size_t index, n;
+
+    if ((mag = magazine_acquire(allocator)) == NULL) {
+        return node;
+    }
+
+    do {
+        next = node->next;
+        index = node->index;
+
+        if (index >= MAX_INDEX
+            || index + 1 > allocator->max_magazine_index) {
+            node->next = overflow;
+            overflow = node;
+            continue;
+        }
+
+        if (mag->size + index + 1 > allocator->max_magazine_index) {
+            apr_memnode_t *flush;
+
+            /* Full, flush a batch of this size to make room */
+            for (n = 0; n < MAGAZINE_BATCH; n++) {
+                if ((flush = mag->free[index]) == NULL) {
+                    break;
+                }
+                mag->free[index] = flush->next;
+                mag->size -= index + 1;
+                flush->next = overflow;
+                overflow = flush;
+            }
+            if (mag->size + index + 1 > allocator->max_magazine_index) {
+                node->next = overflow;
+                overflow = node;
+                continue;
+            }
+        }
+
+        APR_VALGRIND_NOACCESS((char *)node + APR_MEMNODE_T_SIZE,
+                              (node->index+1) << BOUNDARY_INDEX);
+
+        node->next = mag->free[index];
+        mag->free[index] = node;
+        mag->size += index + 1;
+    } while ((node = next) != NULL);
+
+    magazine_release(mag);
+
+    return overflow;
+}
+#endif /* APR_HAS_THREADS */
+
 static APR_INLINE
 apr_memnode_t *allocator_alloc(apr_allocator_t *allocator, apr_size_t in_size)
 {
+#if APR_HAS_THREADS
+    allocator_magazine_t *mag;
+#endif
     apr_memnode_t *node, **ref;
     apr_size_t max_index, upper_index;
     apr_size_t size, i, index;
@@ -300,6 +501,19 @@ apr_memnode_t *allocator_alloc(apr_allocator_t *allocator, apr_size_t in_size)
         return NULL;
     }
 
+#if APR_HAS_THREADS
+    /* Try the thread's magazine first, if any (and not busy), it's then
+     * refilled below while the allocator is locked anyway.
+     */
+    mag = NULL;
+    if (allocator->magazines && index < MAX_INDEX
+        && (mag = magazine_acquire(allocator)) != NULL
+        && (node = magazine_alloc(mag, index)) != NULL) {
+        magazine_release(mag);
+        goto have_node;
+    }
+#endif /* APR_HAS_THREADS */
+
     /* First see if there are any nodes in the area we know
      * our node will fit into.
      */
@@ -331,12 +545,19 @@ apr_memnode_t *allocator_alloc(apr_allocator_t *allocator, apr_size_t in_size)
         }
 
         if ((node = *ref) != NULL) {
+            *ref = node->next;
+#if APR_HAS_THREADS
+            if (mag && i == index) {
+                magazine_refill(allocator, mag, index);
+            }
+#endif /* APR_HAS_THREADS */
+
             /* If we have found a node and it doesn't have any
              * nodes waiting in line behind it _and_ we are on
              * the highest available index, find the new highest
              * available index
              */
-            if ((*ref = node->next) == NULL && i >= max_index) {
+            if (*ref == NULL && i >= max_index) {
                 do {
                     ref--;
                     max_index--;
@@ -351,6 +572,11 @@ apr_memnode_t *allocator_alloc(apr_allocator_t *allocator, apr_size_t in_size)
                 allocator->current_free_index = allocator->max_free_index;
 
             allocator_unlock(allocator);
+#if APR_HAS_THREADS
+            if (mag) {
+                magazine_release(mag);
+            }
+#endif /* APR_HAS_THREADS */
 
             goto have_node;
         }
@@ -379,6 +605,11 @@ apr_memnode_t *allocator_alloc(apr_allocator_t *allocator, apr_size_t in_size)
                 allocator->current_free_index = allocator->max_free_index;
 
             allocator_unlock(allocator);
+#if APR_HAS_THREADS
+            if (mag) {
+                magazine_release(mag);
+            }
+#endif /* APR_HAS_THREADS */
 
             goto have_node;
         }
@@ -386,6 +617,12 @@ apr_memnode_t *allocator_alloc(apr_allocator_t *allocator, apr_size_t in_size)
         allocator_unlock(allocator);
     }
 
+#if APR_HAS_THREADS
+    if (mag) {
+        magazine_release(mag);
+    }
+#endif /* APR_HAS_THREADS */
+
     /* If we haven't got a suitable node, malloc a new one
      * and initialize it.
      */
@@ -426,6 +663,14 @@ void allocator_free(apr_allocator_t *allocator, apr_memnode_t *node)
     apr_size_t index, max_index;
     apr_size_t max_free_index, current_free_index;
 
+#if APR_HAS_THREADS
+    /* Cache in the thread's magazine first, if any */
+    if (allocator->magazines
+        && (node = magazine_free(allocator, node)) == NULL) {
+        return;
+    }
+#endif /* APR_HAS_THREADS */
+
     allocator_lock(allocator);
 
     max_index = allocator->max_index;
@@ -503,6 +748,62 @@ APR_DECLARE(void) apr_allocator_free(apr_allocator_t *allocator,
     allocator_free(allocator, node);
 }
 
+APR_DECLARE(apr_status_t) apr_allocator_cache_set(apr_allocator_t *allocator,
+                                                  apr_size_t size)
+{
+#if APR_HAS_THREADS
+    apr_size_t max_magazine_index;
+    char *magazines;
+
+    max_magazine_index = APR_ALIGN(size, BOUNDARY_SIZE) >> BOUNDARY_INDEX;
+
+    if (max_magazine_index && allocator->magazines) {
+        allocator->max_magazine_index = max_magazine_index;
+        return APR_SUCCESS;
+    }
+
+    if (max_magazine_index) {
+        magazines = malloc(MAGAZINE_COUNT * SIZEOF_MAGAZINE_T);
+        if (!magazines) {
+            return APR_ENOMEM;
+        }
+        memset(magazines, 0, MAGAZINE_COUNT * SIZEOF_MAGAZINE_T);
+
+        allocator->max_magazine_index = max_magazine_index;
+        allocator->magazines = magazines;
+    }
+    else if ((magazines = allocator->magazines) != NULL) {
+        apr_memnode_t *node, *freelist = NULL;
+        apr_size_t i, index;
+
+        allocator->magazines = NULL;
+        allocator->max_magazine_index = 0;
+
+        /* Give the cached nodes back to the free lists */
+        for (i = 0; i < MAGAZINE_COUNT; i++) {
+            allocator_magazine_t *mag = (allocator_magazine_t *)
+                (magazines + i * SIZEOF_MAGAZINE_T);
+
+            for (index = 0; index < MAX_INDEX; index++) {
+                while ((node = mag->free[index]) != NULL) {
+                    mag->free[index] = node->next;
+                    node->next = freelist;
+                    freelist = node;
+                }
+            }
+        }
+        if (freelist) {
+            allocator_free(allocator, freelist);
+        }
+        free(magazines);
+    }
+
+    return APR_SUCCESS;
+#else
+    return size ? APR_ENOTIMPL : APR_SUCCESS;
+#endif /* APR_HAS_THREADS */
+}
+
 APR_DECLARE(apr_size_t) apr_allocator_page_size(void)
 {
     return boundary_size;
@@ -2996,3 +3297,25 @@ APR_DECLARE(apr_status_t) apr_pool_create_unmanaged_ex(apr_pool_t **newpool,
 }
 
 #endif /* APR_POOL_DEBUG */
+
+APR_DECLARE(void *) apr_palloc_aligned(apr_pool_t *pool, apr_size_t size,
+                                       apr_size_t align)
+{
+    apr_uintptr_t mem;
+
+    if (align == 0 || (align & (align - 1)) != 0) {
+        return NULL;
+    }
+    if (size > APR_SIZE_MAX - align) {
+        if (pool->abort_fn)
+            pool->abort_fn(APR_ENOMEM);
+
+        return NULL;
+    }
+
+    mem = (apr_uintptr_t)apr_palloc(pool, size + align - 1);
+    if (!mem) {
+        return NULL;
+    }
+    return (void *)((mem + align - 1) & ~(apr_uintptr_t)(align - 1));
+}
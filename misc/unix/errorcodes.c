@@ -81,6 +81,8 @@ static char *apr_error_string(apr_status_t statcode)
         return "Could not find the requested symbol.";
     case APR_ENOTENOUGHENTROPY:
         return "Not enough entropy to continue.";
+    case APR_EMISALIGNED:
+        return "Misaligned buffer, offset or length for direct I/O";
     case APR_INCHILD:
         return
 	    "Your code just forked, and you are currently executing in the "
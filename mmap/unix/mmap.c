@@ -47,6 +47,21 @@
 
 #if APR_HAS_MMAP || defined(BEOS)
 
+#ifndef BEOS
+static long psize;
+
+static void mmap_init_psize(void)
+{
+#if defined(_SC_PAGESIZE)
+    if (psize == 0) {
+        psize = sysconf(_SC_PAGESIZE);
+        /* the page size should be a power of two */
+        assert(psize > 0 && (psize & (psize - 1)) == 0);
+    }
+#endif
+}
+#endif
+
 static apr_status_t mmap_cleanup(void *themmap)
 {
     apr_mmap_t *mm = themmap;
@@ -86,7 +101,6 @@ APR_DECLARE(apr_status_t) apr_mmap_create(apr_mmap_t **new,
     area_id aid = -1;
     uint32 pages = 0;
 #else
-    static long psize;
     apr_off_t poffset = 0;
     apr_int32_t native_flags = 0;
 #endif
@@ -138,11 +152,7 @@ APR_DECLARE(apr_status_t) apr_mmap_create(apr_mmap_t **new,
     }
 
 #if defined(_SC_PAGESIZE)
-    if (psize == 0) {
-        psize = sysconf(_SC_PAGESIZE);
-        /* the page size should be a power of two */
-        assert(psize > 0 && (psize & (psize - 1)) == 0);
-    }
+    mmap_init_psize();
     poffset = offset & (apr_off_t)(psize - 1);
     (*new)->poffset = poffset;
 #endif
@@ -157,6 +167,16 @@ APR_DECLARE(apr_status_t) apr_mmap_create(apr_mmap_t **new,
         return errno;
     }
 
+#ifdef HAVE_MADVISE
+    /* Advisory only, failures are ignored */
+    if (file->flags & APR_FOPEN_SEQUENTIAL) {
+        (void)madvise(mm, size + poffset, MADV_SEQUENTIAL);
+    }
+    else if (file->flags & APR_FOPEN_RANDOM) {
+        (void)madvise(mm, size + poffset, MADV_RANDOM);
+    }
+#endif
+
     mm = (char *)mm + poffset;
 #endif
 
@@ -190,4 +210,65 @@ APR_DECLARE(apr_status_t) apr_mmap_delete(apr_mmap_t *mm)
     return apr_pool_cleanup_run(mm->cntxt, mm, mmap_cleanup);
 }
 
+APR_DECLARE(apr_status_t) apr_mmap_advise(apr_mmap_t *mm, apr_off_t offset,
+                                          apr_size_t len, int advice)
+{
+#if defined(HAVE_MADVISE) && !defined(BEOS)
+    apr_off_t pgoff;
+    int native;
+
+    switch (advice) {
+    case APR_MADVISE_NORMAL:
+        native = MADV_NORMAL;
+        break;
+    case APR_MADVISE_SEQUENTIAL:
+        native = MADV_SEQUENTIAL;
+        break;
+    case APR_MADVISE_RANDOM:
+        native = MADV_RANDOM;
+        break;
+    case APR_MADVISE_WILLNEED:
+        native = MADV_WILLNEED;
+        break;
+    case APR_MADVISE_DONTNEED:
+        native = MADV_DONTNEED;
+        break;
+    case APR_MADVISE_HUGEPAGE:
+#ifdef MADV_HUGEPAGE
+        native = MADV_HUGEPAGE;
+        break;
+#else
+        return APR_ENOTIMPL;
+#endif
+    default:
+        return APR_EINVAL;
+    }
+
+    if (offset < 0 || (apr_size_t)offset > mm->size) {
+        return APR_EINVAL;
+    }
+    if (len == 0) {
+        len = mm->size - (apr_size_t)offset;
+    }
+    else if (len > mm->size - (apr_size_t)offset) {
+        return APR_EINVAL;
+    }
+
+    /* madvise() wants the start of a page, the mapping starts at one */
+    offset += mm->poffset;
+    pgoff = 0;
+#if defined(_SC_PAGESIZE)
+    mmap_init_psize();
+    pgoff = offset & (apr_off_t)(psize - 1);
+#endif
+    if (madvise((char *)mm->mm - mm->poffset + (offset - pgoff),
+                len + (apr_size_t)pgoff, native)) {
+        return errno;
+    }
+    return APR_SUCCESS;
+#else
+    return APR_ENOTIMPL;
+#endif
+}
+
 #endif
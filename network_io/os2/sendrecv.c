@@ -156,6 +156,15 @@ APR_DECLARE(apr_status_t) apr_socket_sendv(apr_socket_t *sock,
 
 
 
+APR_DECLARE(apr_status_t) apr_socket_zerocopy_reap(apr_socket_t *sock,
+                                                   apr_uint32_t *sent,
+                                                   apr_uint32_t *completed,
+                                                   int block)
+{
+    *sent = *completed = 0;
+    return APR_ENOTIMPL;
+}
+
 APR_DECLARE(apr_status_t) apr_socket_wait(apr_socket_t *sock, apr_wait_type_t direction)
 {
     int pollsocket = sock->socketdes;
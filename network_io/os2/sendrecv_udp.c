@@ -114,3 +114,62 @@ APR_DECLARE(apr_status_t) apr_socket_recvfrom(apr_sockaddr_t *from,
         }
     } while (1);
 }
+
+
+
+APR_DECLARE(apr_status_t) apr_socket_sendmmsg(apr_socket_t *sock,
+                                              apr_sockmsg_t *msgs,
+                                              apr_size_t nmsgs,
+                                              apr_int32_t flags,
+                                              apr_size_t *nsent)
+{
+    apr_status_t rv = APR_SUCCESS;
+    apr_size_t sent;
+
+    for (sent = 0; sent < nmsgs; sent++) {
+        if (msgs[sent].segsize) {
+            *nsent = 0;
+            return APR_ENOTIMPL;
+        }
+    }
+
+    for (sent = 0; sent < nmsgs; sent++) {
+        if (msgs[sent].addr) {
+            rv = apr_socket_sendto(sock, msgs[sent].addr, flags,
+                                   msgs[sent].buf, &msgs[sent].len);
+        }
+        else {
+            rv = apr_socket_send(sock, msgs[sent].buf, &msgs[sent].len);
+        }
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+    }
+
+    *nsent = sent;
+    return sent ? APR_SUCCESS : rv;
+}
+
+
+APR_DECLARE(apr_status_t) apr_socket_recvmmsg(apr_socket_t *sock,
+                                              apr_sockmsg_t *msgs,
+                                              apr_size_t nmsgs,
+                                              apr_int32_t flags,
+                                              apr_size_t *nrecv)
+{
+    apr_sockaddr_t from;
+    apr_status_t rv;
+
+    /* One datagram at a time, the next ones could block */
+    *nrecv = 0;
+    if (!nmsgs) {
+        return APR_SUCCESS;
+    }
+    rv = apr_socket_recvfrom(msgs[0].addr ? msgs[0].addr : &from, sock,
+                             flags, msgs[0].buf, &msgs[0].len);
+    if (rv == APR_SUCCESS) {
+        msgs[0].segsize = 0;
+        *nrecv = 1;
+    }
+    return rv;
+}
@@ -27,6 +27,15 @@
 #include <osreldate.h>
 #endif
 
+/* poll() waits for the MSG_ZEROCOPY completion notifications */
+#ifdef HAVE_MSG_ZEROCOPY
+#if HAVE_POLL_H
+#include <poll.h>
+#elif HAVE_SYS_POLL_H
+#include <sys/poll.h>
+#endif
+#endif
+
 apr_status_t apr_socket_send(apr_socket_t *sock, const char *buf,
                              apr_size_t *len)
 {
@@ -191,6 +200,498 @@ apr_status_t apr_socket_recvfrom(apr_sockaddr_t *from, apr_socket_t *sock,
     return APR_SUCCESS;
 }
 
+#if defined(HAVE_SENDMMSG) && defined(HAVE_RECVMMSG)
+
+/* The maximum number of datagrams per sendmmsg() or recvmmsg() call */
+#define MMSG_BATCH 64
+
+#if defined(UDP_SEGMENT) || defined(UDP_GRO)
+typedef union {
+    char buf[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+} mmsg_control_t;
+#endif
+
+apr_status_t apr_socket_sendmmsg(apr_socket_t *sock, apr_sockmsg_t *msgs,
+                                 apr_size_t nmsgs, apr_int32_t flags,
+                                 apr_size_t *nsent)
+{
+    struct mmsghdr hdrs[MMSG_BATCH];
+    struct iovec vecs[MMSG_BATCH];
+#ifdef UDP_SEGMENT
+    mmsg_control_t controls[MMSG_BATCH];
+#endif
+    apr_size_t sent;
+    int i, count, rv;
+
+#ifndef UDP_SEGMENT
+    for (sent = 0; sent < nmsgs; sent++) {
+        if (msgs[sent].segsize) {
+            *nsent = 0;
+            return APR_ENOTIMPL;
+        }
+    }
+#endif
+
+    sent = 0;
+    while (sent < nmsgs) {
+        count = (nmsgs - sent < MMSG_BATCH) ? (int)(nmsgs - sent) : MMSG_BATCH;
+
+        memset(hdrs, 0, count * sizeof(hdrs[0]));
+        for (i = 0; i < count; i++) {
+            apr_sockmsg_t *msg = &msgs[sent + i];
+            struct msghdr *hdr = &hdrs[i].msg_hdr;
+
+            vecs[i].iov_base = msg->buf;
+            vecs[i].iov_len = msg->len;
+            hdr->msg_iov = &vecs[i];
+            hdr->msg_iovlen = 1;
+            if (msg->addr) {
+                hdr->msg_name = &msg->addr->sa;
+                hdr->msg_namelen = msg->addr->salen;
+            }
+#ifdef UDP_SEGMENT
+            if (msg->segsize) {
+                struct cmsghdr *cmsg;
+
+                hdr->msg_control = controls[i].buf;
+                hdr->msg_controllen = CMSG_SPACE(sizeof(apr_uint16_t));
+                cmsg = CMSG_FIRSTHDR(hdr);
+                cmsg->cmsg_level = IPPROTO_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(apr_uint16_t));
+                *(apr_uint16_t *)CMSG_DATA(cmsg) = (apr_uint16_t)msg->segsize;
+            }
+#endif
+        }
+
+        do {
+            rv = sendmmsg(sock->socketdes, hdrs, count, flags);
+        } while (rv == -1 && errno == EINTR);
+
+        /* Wait only if nothing could be sent yet */
+        while ((rv == -1) && (errno == EAGAIN || errno == EWOULDBLOCK)
+                          && (sock->timeout > 0) && !sent) {
+            apr_status_t arv = apr_wait_for_io_or_timeout(NULL, sock, 0);
+            if (arv != APR_SUCCESS) {
+                *nsent = 0;
+                return arv;
+            }
+            else {
+                do {
+                    rv = sendmmsg(sock->socketdes, hdrs, count, flags);
+                } while (rv == -1 && errno == EINTR);
+            }
+        }
+        if (rv == -1) {
+            *nsent = sent;
+            return sent ? APR_SUCCESS : errno;
+        }
+
+        for (i = 0; i < rv; i++) {
+            msgs[sent + i].len = hdrs[i].msg_len;
+        }
+        sent += rv;
+        if (rv < count) {
+            break;
+        }
+    }
+
+    *nsent = sent;
+    return APR_SUCCESS;
+}
+
+apr_status_t apr_socket_recvmmsg(apr_socket_t *sock, apr_sockmsg_t *msgs,
+                                 apr_size_t nmsgs, apr_int32_t flags,
+                                 apr_size_t *nrecv)
+{
+    struct mmsghdr hdrs[MMSG_BATCH];
+    struct iovec vecs[MMSG_BATCH];
+#ifdef UDP_GRO
+    mmsg_control_t controls[MMSG_BATCH];
+    int gro = apr_is_option_set(sock, APR_SO_UDP_GRO);
+#endif
+    apr_size_t received = 0;
+    int i, count, rv;
+
+    while (received < nmsgs) {
+        count = (nmsgs - received < MMSG_BATCH) ? (int)(nmsgs - received)
+                                                : MMSG_BATCH;
+
+        memset(hdrs, 0, count * sizeof(hdrs[0]));
+        for (i = 0; i < count; i++) {
+            apr_sockmsg_t *msg = &msgs[received + i];
+            struct msghdr *hdr = &hdrs[i].msg_hdr;
+
+            vecs[i].iov_base = msg->buf;
+            vecs[i].iov_len = msg->len;
+            hdr->msg_iov = &vecs[i];
+            hdr->msg_iovlen = 1;
+            if (msg->addr) {
+                hdr->msg_name = &msg->addr->sa;
+                hdr->msg_namelen = sizeof(msg->addr->sa);
+            }
+#ifdef UDP_GRO
+            if (gro) {
+                hdr->msg_control = controls[i].buf;
+                hdr->msg_controllen = sizeof(controls[i].buf);
+            }
+#endif
+        }
+
+        /* Once something is received, take only what's available already */
+        do {
+            rv = recvmmsg(sock->socketdes, hdrs, count,
+                          flags | (received ? MSG_DONTWAIT : MSG_WAITFORONE),
+                          NULL);
+        } while (rv == -1 && errno == EINTR);
+
+        while ((rv == -1) && (errno == EAGAIN || errno == EWOULDBLOCK)
+                          && (sock->timeout > 0) && !received) {
+            apr_status_t arv = apr_wait_for_io_or_timeout(NULL, sock, 1);
+            if (arv != APR_SUCCESS) {
+                *nrecv = 0;
+                return arv;
+            }
+            else {
+                do {
+                    rv = recvmmsg(sock->socketdes, hdrs, count,
+                                  flags | MSG_WAITFORONE, NULL);
+                } while (rv == -1 && errno == EINTR);
+            }
+        }
+        if (rv == -1) {
+            *nrecv = received;
+            return received ? APR_SUCCESS : errno;
+        }
+
+        for (i = 0; i < rv; i++) {
+            apr_sockmsg_t *msg = &msgs[received + i];
+            struct msghdr *hdr = &hdrs[i].msg_hdr;
+
+            msg->len = hdrs[i].msg_len;
+            msg->segsize = 0;
+            if (msg->addr) {
+                msg->addr->salen = hdr->msg_namelen;
+                if (msg->addr->salen > APR_OFFSETOF(struct sockaddr_in,
+                                                    sin_port)) {
+                    apr_sockaddr_vars_set(msg->addr,
+                                          msg->addr->sa.sin.sin_family,
+                                          ntohs(msg->addr->sa.sin.sin_port));
+                }
+            }
+#ifdef UDP_GRO
+            if (gro) {
+                struct cmsghdr *cmsg;
+
+                for (cmsg = CMSG_FIRSTHDR(hdr); cmsg;
+                     cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+                    if (cmsg->cmsg_level == IPPROTO_UDP
+                            && cmsg->cmsg_type == UDP_GRO) {
+                        int segsize;
+
+                        memcpy(&segsize, CMSG_DATA(cmsg), sizeof(int));
+                        msg->segsize = segsize;
+                    }
+                }
+            }
+#endif
+        }
+        received += rv;
+        if (rv < count) {
+            break;
+        }
+    }
+
+    *nrecv = received;
+    return APR_SUCCESS;
+}
+
+#else /* !HAVE_SENDMMSG || !HAVE_RECVMMSG */
+
+apr_status_t apr_socket_sendmmsg(apr_socket_t *sock, apr_sockmsg_t *msgs,
+                                 apr_size_t nmsgs, apr_int32_t flags,
+                                 apr_size_t *nsent)
+{
+    apr_size_t sent;
+    apr_ssize_t rv;
+
+    for (sent = 0; sent < nmsgs; sent++) {
+        if (msgs[sent].segsize) {
+            *nsent = 0;
+            return APR_ENOTIMPL;
+        }
+    }
+
+    for (sent = 0; sent < nmsgs; sent++) {
+        apr_sockmsg_t *msg = &msgs[sent];
+        const struct sockaddr *sa = NULL;
+        apr_socklen_t salen = 0;
+
+        if (msg->addr) {
+            sa = (const struct sockaddr *)&msg->addr->sa;
+            salen = msg->addr->salen;
+        }
+
+        do {
+            rv = sendto(sock->socketdes, msg->buf, msg->len, flags, sa, salen);
+        } while (rv == -1 && errno == EINTR);
+
+        while ((rv == -1) && (errno == EAGAIN || errno == EWOULDBLOCK)
+                          && (sock->timeout > 0) && !sent) {
+            apr_status_t arv = apr_wait_for_io_or_timeout(NULL, sock, 0);
+            if (arv != APR_SUCCESS) {
+                *nsent = 0;
+                return arv;
+            }
+            else {
+                do {
+                    rv = sendto(sock->socketdes, msg->buf, msg->len, flags,
+                                sa, salen);
+                } while (rv == -1 && errno == EINTR);
+            }
+        }
+        if (rv == -1) {
+            *nsent = sent;
+            return sent ? APR_SUCCESS : errno;
+        }
+        msg->len = rv;
+    }
+
+    *nsent = sent;
+    return APR_SUCCESS;
+}
+
+apr_status_t apr_socket_recvmmsg(apr_socket_t *sock, apr_sockmsg_t *msgs,
+                                 apr_size_t nmsgs, apr_int32_t flags,
+                                 apr_size_t *nrecv)
+{
+    apr_size_t received;
+    apr_ssize_t rv;
+
+    for (received = 0; received < nmsgs; received++) {
+        apr_sockmsg_t *msg = &msgs[received];
+        apr_int32_t rflags = flags;
+        struct sockaddr *sa = NULL;
+        apr_socklen_t *salen = NULL;
+
+        /* Once something is received, take only what's available already */
+        if (received) {
+#ifdef MSG_DONTWAIT
+            rflags |= MSG_DONTWAIT;
+#else
+            break;
+#endif
+        }
+        if (msg->addr) {
+            msg->addr->salen = sizeof(msg->addr->sa);
+            sa = (struct sockaddr *)&msg->addr->sa;
+            salen = &msg->addr->salen;
+        }
+
+        do {
+            rv = recvfrom(sock->socketdes, msg->buf, msg->len, rflags,
+                          sa, salen);
+        } while (rv == -1 && errno == EINTR);
+
+        while ((rv == -1) && (errno == EAGAIN || errno == EWOULDBLOCK)
+                          && (sock->timeout > 0) && !received) {
+            apr_status_t arv = apr_wait_for_io_or_timeout(NULL, sock, 1);
+            if (arv != APR_SUCCESS) {
+                *nrecv = 0;
+                return arv;
+            }
+            else {
+                do {
+                    rv = recvfrom(sock->socketdes, msg->buf, msg->len, rflags,
+                                  sa, salen);
+                } while (rv == -1 && errno == EINTR);
+            }
+        }
+        if (rv == -1) {
+            *nrecv = received;
+            return received ? APR_SUCCESS : errno;
+        }
+
+        msg->len = rv;
+        msg->segsize = 0;
+        if (msg->addr && msg->addr->salen > APR_OFFSETOF(struct sockaddr_in,
+                                                         sin_port)) {
+            apr_sockaddr_vars_set(msg->addr, msg->addr->sa.sin.sin_family,
+                                  ntohs(msg->addr->sa.sin.sin_port));
+        }
+    }
+
+    *nrecv = received;
+    return APR_SUCCESS;
+}
+
+#endif /* HAVE_SENDMMSG && HAVE_RECVMMSG */
+
+#ifdef HAVE_MSG_ZEROCOPY
+
+static apr_ssize_t sendv_zerocopy(apr_socket_t *sock, const struct iovec *vec,
+                                  apr_int32_t nvec)
+{
+    struct msghdr msg;
+    apr_ssize_t rv;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = (struct iovec *)vec;
+    msg.msg_iovlen = nvec;
+
+    rv = sendmsg(sock->socketdes, &msg, MSG_ZEROCOPY);
+    if (rv > 0) {
+        /* Only the calls which send something are numbered */
+        sock->zc_sent++;
+    }
+    else if (rv == -1 && errno == ENOBUFS) {
+        /* Too many notifications pending, copy this time */
+        rv = sendmsg(sock->socketdes, &msg, 0);
+    }
+    return rv;
+}
+
+#define SENDV(sock, vec, nvec) \
+    (((sock)->options & APR_SO_ZEROCOPY) ? sendv_zerocopy(sock, vec, nvec) \
+                                         : writev((sock)->socketdes, vec, nvec))
+
+/* Returns the number of notifications reaped, or -1 on error */
+static int zerocopy_reap(apr_socket_t *sock)
+{
+    union {
+        char buf[CMSG_SPACE(sizeof(struct sock_extended_err)
+                            + sizeof(struct sockaddr_in6))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    int n = 0;
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        if (recvmsg(sock->socketdes, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return n;
+            }
+            return -1;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            struct sock_extended_err serr;
+
+            if (!((cmsg->cmsg_level == SOL_IP
+                   && cmsg->cmsg_type == IP_RECVERR)
+#if APR_HAVE_IPV6
+                  || (cmsg->cmsg_level == SOL_IPV6
+                      && cmsg->cmsg_type == IPV6_RECVERR)
+#endif
+                  )) {
+                continue;
+            }
+            memcpy(&serr, CMSG_DATA(cmsg), sizeof(serr));
+            if (serr.ee_errno == 0
+                    && serr.ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                /* The sends [ee_info, ee_data] completed, TCP ones do in
+                 * order (be it copied or not, SO_EE_CODE_ZEROCOPY_COPIED).
+                 */
+                sock->zc_completed = serr.ee_data + 1;
+                n++;
+            }
+        }
+    }
+}
+
+apr_status_t apr_socket_zerocopy_reap(apr_socket_t *sock,
+                                      apr_uint32_t *sent,
+                                      apr_uint32_t *completed,
+                                      int block)
+{
+    apr_status_t rv = APR_SUCCESS;
+    int n, woken = 0;
+
+    for (;;) {
+        struct pollfd pfd;
+        int timeout = -1, prc;
+
+        n = zerocopy_reap(sock);
+        if (n < 0) {
+            rv = errno;
+            break;
+        }
+        if (n > 0 || !block || sock->zc_completed == sock->zc_sent) {
+            break;
+        }
+        if (woken) {
+            /* Not woken by a notification but a socket error */
+            int err = 0;
+            apr_socklen_t errlen = sizeof(err);
+
+            if (getsockopt(sock->socketdes, SOL_SOCKET, SO_ERROR,
+                           (void *)&err, &errlen) == -1) {
+                rv = errno;
+                break;
+            }
+            if (err) {
+                rv = err;
+                break;
+            }
+        }
+        if (sock->timeout == 0) {
+            rv = APR_EAGAIN;
+            break;
+        }
+
+        /* The notifications are reported as errors */
+        if (sock->timeout > 0) {
+            timeout = (int)((sock->timeout + 999) / 1000);
+        }
+        pfd.fd = sock->socketdes;
+        pfd.events = 0;
+        do {
+            prc = poll(&pfd, 1, timeout);
+        } while (prc == -1 && errno == EINTR);
+        if (prc == 0) {
+            rv = APR_TIMEUP;
+            break;
+        }
+        if (prc < 0) {
+            rv = errno;
+            break;
+        }
+        if (!(pfd.revents & POLLERR)) {
+            /* Hung up with nothing pending, no more to come */
+            rv = APR_EOF;
+            break;
+        }
+        woken = 1;
+    }
+
+    *sent = sock->zc_sent;
+    *completed = sock->zc_completed;
+    return rv;
+}
+
+#else /* !HAVE_MSG_ZEROCOPY */
+
+#define SENDV(sock, vec, nvec) writev((sock)->socketdes, vec, nvec)
+
+apr_status_t apr_socket_zerocopy_reap(apr_socket_t *sock,
+                                      apr_uint32_t *sent,
+                                      apr_uint32_t *completed,
+                                      int block)
+{
+    *sent = *completed = 0;
+    return APR_ENOTIMPL;
+}
+
+#endif /* HAVE_MSG_ZEROCOPY */
+
 apr_status_t apr_socket_sendv(apr_socket_t * sock, const struct iovec *vec,
                               apr_int32_t nvec, apr_size_t *len)
 {
@@ -204,7 +705,7 @@ apr_status_t apr_socket_sendv(apr_socket_t * sock, const struct iovec *vec,
     }
 
     do {
-        rv = writev(sock->socketdes, vec, nvec);
+        rv = SENDV(sock, vec, nvec);
     } while (rv == -1 && errno == EINTR);
 
     while ((rv == -1) && (errno == EAGAIN || errno == EWOULDBLOCK)
@@ -218,7 +719,7 @@ do_select:
         }
         else {
             do {
-                rv = writev(sock->socketdes, vec, nvec);
+                rv = SENDV(sock, vec, nvec);
             } while (rv == -1 && errno == EINTR);
         }
     }
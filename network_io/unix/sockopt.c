@@ -342,6 +342,49 @@ apr_status_t apr_socket_opt_set(apr_socket_t *sock,
          * options, IP_BINDANY vs IPV6_BINDANY */
 #else
         return APR_ENOTIMPL;
+#endif
+        break;
+    case APR_SO_UDP_SEGMENT:
+#if defined(UDP_SEGMENT)
+        /* on is the size of the segments, not a boolean */
+        if (setsockopt(sock->socketdes, IPPROTO_UDP, UDP_SEGMENT,
+                       (void *)&on, sizeof(int)) == -1) {
+            return errno;
+        }
+        apr_set_option(sock, APR_SO_UDP_SEGMENT, on);
+        sock->udp_segment = on;
+#else
+        return APR_ENOTIMPL;
+#endif
+        break;
+    case APR_SO_UDP_GRO:
+#if defined(UDP_GRO)
+        if (on != apr_is_option_set(sock, APR_SO_UDP_GRO)) {
+            if (setsockopt(sock->socketdes, IPPROTO_UDP, UDP_GRO,
+                           (void *)&on, sizeof(int)) == -1) {
+                return errno;
+            }
+            apr_set_option(sock, APR_SO_UDP_GRO, on);
+        }
+#else
+        return APR_ENOTIMPL;
+#endif
+        break;
+    case APR_SO_ZEROCOPY:
+#ifdef HAVE_MSG_ZEROCOPY
+        /* Completions are reaped in order, which only TCP guarantees */
+        if (sock->type != SOCK_STREAM) {
+            return APR_ENOTIMPL;
+        }
+        if (on != apr_is_option_set(sock, APR_SO_ZEROCOPY)) {
+            if (setsockopt(sock->socketdes, SOL_SOCKET, SO_ZEROCOPY,
+                           (void *)&one, sizeof(int)) == -1) {
+                return errno;
+            }
+            apr_set_option(sock, APR_SO_ZEROCOPY, on);
+        }
+#else
+        return APR_ENOTIMPL;
 #endif
         break;
     default:
@@ -363,6 +406,10 @@ apr_status_t apr_socket_opt_get(apr_socket_t *sock,
                                 apr_int32_t opt, apr_int32_t *on)
 {
     switch(opt) {
+        case APR_SO_UDP_SEGMENT:
+            /* The size, not a boolean */
+            *on = sock->udp_segment;
+            break;
         default:
             *on = apr_is_option_set(sock, opt);
     }
@@ -127,6 +127,15 @@ APR_DECLARE(apr_status_t) apr_socket_sendv(apr_socket_t *sock,
 }
 
 
+APR_DECLARE(apr_status_t) apr_socket_zerocopy_reap(apr_socket_t *sock,
+                                                   apr_uint32_t *sent,
+                                                   apr_uint32_t *completed,
+                                                   int block)
+{
+    *sent = *completed = 0;
+    return APR_ENOTIMPL;
+}
+
 APR_DECLARE(apr_status_t) apr_socket_sendto(apr_socket_t *sock,
                                             apr_sockaddr_t *where,
                                             apr_int32_t flags, const char *buf,
@@ -174,6 +183,64 @@ APR_DECLARE(apr_status_t) apr_socket_recvfrom(apr_sockaddr_t *from,
 }
 
 
+APR_DECLARE(apr_status_t) apr_socket_sendmmsg(apr_socket_t *sock,
+                                              apr_sockmsg_t *msgs,
+                                              apr_size_t nmsgs,
+                                              apr_int32_t flags,
+                                              apr_size_t *nsent)
+{
+    apr_status_t rv = APR_SUCCESS;
+    apr_size_t sent;
+
+    for (sent = 0; sent < nmsgs; sent++) {
+        if (msgs[sent].segsize) {
+            *nsent = 0;
+            return APR_ENOTIMPL;
+        }
+    }
+
+    for (sent = 0; sent < nmsgs; sent++) {
+        if (msgs[sent].addr) {
+            rv = apr_socket_sendto(sock, msgs[sent].addr, flags,
+                                   msgs[sent].buf, &msgs[sent].len);
+        }
+        else {
+            rv = apr_socket_send(sock, msgs[sent].buf, &msgs[sent].len);
+        }
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+    }
+
+    *nsent = sent;
+    return sent ? APR_SUCCESS : rv;
+}
+
+
+APR_DECLARE(apr_status_t) apr_socket_recvmmsg(apr_socket_t *sock,
+                                              apr_sockmsg_t *msgs,
+                                              apr_size_t nmsgs,
+                                              apr_int32_t flags,
+                                              apr_size_t *nrecv)
+{
+    apr_sockaddr_t from;
+    apr_status_t rv;
+
+    /* One datagram at a time, the next ones could block */
+    *nrecv = 0;
+    if (!nmsgs) {
+        return APR_SUCCESS;
+    }
+    rv = apr_socket_recvfrom(msgs[0].addr ? msgs[0].addr : &from, sock,
+                             flags, msgs[0].buf, &msgs[0].len);
+    if (rv == APR_SUCCESS) {
+        msgs[0].segsize = 0;
+        *nrecv = 1;
+    }
+    return rv;
+}
+
+
 #if APR_HAS_SENDFILE
 static apr_status_t collapse_iovec(char **off, apr_size_t *len,
                                    struct iovec *iovec, int numvec,
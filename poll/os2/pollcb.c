@@ -64,6 +64,22 @@ APR_DECLARE(apr_status_t) apr_pollcb_remove(apr_pollcb_t *pollcb,
 
 
 
+APR_DECLARE(apr_status_t) apr_pollcb_modify(apr_pollcb_t *pollcb,
+                                            apr_pollfd_t *descriptor)
+{
+    return apr_pollset_modify(pollcb->pollset, descriptor);
+}
+
+
+
+APR_DECLARE(apr_status_t) apr_pollcb_rearm(apr_pollcb_t *pollcb,
+                                           apr_pollfd_t *descriptor)
+{
+    return apr_pollset_rearm(pollcb->pollset, descriptor);
+}
+
+
+
 APR_DECLARE(apr_status_t) apr_pollcb_poll(apr_pollcb_t *pollcb,
                                           apr_interval_time_t timeout,
                                           apr_pollcb_cb_t func,
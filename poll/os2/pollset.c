@@ -168,6 +168,33 @@ APR_DECLARE(apr_status_t) apr_pollset_remove(apr_pollset_t *pollset,
 
 
 
+APR_DECLARE(apr_status_t) apr_pollset_modify(apr_pollset_t *pollset,
+                                             const apr_pollfd_t *descriptor)
+{
+    apr_status_t rv = APR_NOTFOUND;
+    apr_uint32_t i;
+
+    for (i = 0; i < pollset->nelts; i++) {
+        if (descriptor->desc.s == pollset->query_set[i].desc.s) {
+            pollset->query_set[i] = *descriptor;
+            pollset->num_read = -1;
+            rv = APR_SUCCESS;
+        }
+    }
+
+    return rv;
+}
+
+
+
+APR_DECLARE(apr_status_t) apr_pollset_rearm(apr_pollset_t *pollset,
+                                            const apr_pollfd_t *descriptor)
+{
+    return apr_pollset_modify(pollset, descriptor);
+}
+
+
+
 static void make_pollset(apr_pollset_t *pollset)
 {
     int i;
@@ -39,6 +39,10 @@ static unsigned get_epoll_event(apr_int16_t event)
     if (event & APR_POLLEXCL)
         rv |= EPOLLEXCLUSIVE;
 #endif
+    if (event & APR_POLLET)
+        rv |= EPOLLET;
+    if (event & APR_POLLONESHOT)
+        rv |= EPOLLONESHOT;
     /* APR_POLLNVAL is not handled by epoll.  EPOLLERR and EPOLLHUP are return-only */
 
     return rv;
@@ -254,6 +258,68 @@ static apr_status_t impl_pollset_remove(apr_pollset_t *pollset,
     return rv;
 }
 
+static apr_status_t impl_pollset_modify(apr_pollset_t *pollset,
+                                        const apr_pollfd_t *descriptor)
+{
+    struct epoll_event ev = {0};
+    int ret;
+    pfd_elem_t *ep = NULL;
+    apr_pollfd_t old_pfd;
+    apr_status_t rv = APR_SUCCESS;
+
+    ev.events = get_epoll_event(descriptor->reqevents);
+
+    if (pollset->flags & APR_POLLSET_NOCOPY) {
+        ev.data.ptr = (void *)descriptor;
+    }
+    else {
+        pollset_lock_rings();
+
+        for (ep = APR_RING_FIRST(&(pollset->p->query_ring));
+             ep != APR_RING_SENTINEL(&(pollset->p->query_ring),
+                                     pfd_elem_t, link);
+             ep = APR_RING_NEXT(ep, link)) {
+
+            if (descriptor->desc.s == ep->pfd.desc.s) {
+                break;
+            }
+        }
+        if (ep == APR_RING_SENTINEL(&(pollset->p->query_ring),
+                                    pfd_elem_t, link)) {
+            pollset_unlock_rings();
+            return APR_NOTFOUND;
+        }
+
+        old_pfd = ep->pfd;
+        ep->pfd = *descriptor;
+        ev.data.ptr = ep;
+    }
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        ret = epoll_ctl(pollset->p->epoll_fd, EPOLL_CTL_MOD,
+                        descriptor->desc.s->socketdes, &ev);
+    }
+    else {
+        ret = epoll_ctl(pollset->p->epoll_fd, EPOLL_CTL_MOD,
+                        descriptor->desc.f->filedes, &ev);
+    }
+
+    if (0 != ret) {
+        rv = apr_get_netos_error();
+        if (APR_STATUS_IS_ENOENT(rv)) {
+            rv = APR_NOTFOUND;
+        }
+    }
+
+    if (!(pollset->flags & APR_POLLSET_NOCOPY)) {
+        if (rv != APR_SUCCESS) {
+            ep->pfd = old_pfd;
+        }
+        pollset_unlock_rings();
+    }
+
+    return rv;
+}
+
 static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
                                            apr_interval_time_t timeout,
                                            apr_int32_t *num,
@@ -328,6 +394,7 @@ static const apr_pollset_provider_t impl = {
     impl_pollset_create,
     impl_pollset_add,
     impl_pollset_remove,
+    impl_pollset_modify,
     impl_pollset_poll,
     impl_pollset_cleanup,
     "epoll"
@@ -436,6 +503,32 @@ static apr_status_t impl_pollcb_remove(apr_pollcb_t *pollcb,
     return rv;
 }
 
+static apr_status_t impl_pollcb_modify(apr_pollcb_t *pollcb,
+                                       apr_pollfd_t *descriptor)
+{
+    struct epoll_event ev = { 0 };
+    int ret;
+
+    ev.events = get_epoll_event(descriptor->reqevents);
+    ev.data.ptr = (void *) descriptor;
+
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        ret = epoll_ctl(pollcb->fd, EPOLL_CTL_MOD,
+                        descriptor->desc.s->socketdes, &ev);
+    }
+    else {
+        ret = epoll_ctl(pollcb->fd, EPOLL_CTL_MOD,
+                        descriptor->desc.f->filedes, &ev);
+    }
+
+    if (ret == -1) {
+        apr_status_t rv = apr_get_netos_error();
+        return APR_STATUS_IS_ENOENT(rv) ? APR_NOTFOUND : rv;
+    }
+
+    return APR_SUCCESS;
+}
+
 
 static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
                                      apr_interval_time_t timeout,
@@ -484,6 +577,7 @@ static const apr_pollcb_provider_t impl_cb = {
     impl_pollcb_create,
     impl_pollcb_add,
     impl_pollcb_remove,
+    impl_pollcb_modify,
     impl_pollcb_poll,
     impl_pollcb_cleanup,
     "epoll"
@@ -0,0 +1,1150 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apr.h"
+#include "apr_poll.h"
+#include "apr_time.h"
+#include "apr_portable.h"
+#include "apr_arch_file_io.h"
+#include "apr_arch_networkio.h"
+#include "apr_arch_poll_private.h"
+#include "apr_arch_inherit.h"
+
+#if defined(HAVE_IO_URING)
+
+#include "apr_ring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/*
+ * The pollset is an io_uring instance where each descriptor has an
+ * IORING_OP_POLL_ADD request in flight.  Adds and re-arms are only queued
+ * in the submission ring, and get submitted in batch by the io_uring_enter()
+ * call which also waits for the completions in _poll(); the results are then
+ * harvested directly from the completion ring, with no copy nor syscall.
+ *
+ * Single shot poll requests are re-armed when harvested, which provides
+ * level triggered semantics, while APR_POLLET descriptors use a multishot
+ * request which the kernel keeps armed.  Removals and modifications are
+ * queued in the submission ring too, as IORING_OP_POLL_REMOVE requests
+ * which cancel or update (IORING_POLL_UPDATE_EVENTS) the pending ones.
+ */
+
+/* APR_POLLET descriptors use multishot requests, unless APR_POLLONESHOT */
+#define URING_MULTISHOT(reqevents) \
+    (((reqevents) & APR_POLLET) && !((reqevents) & APR_POLLONESHOT))
+
+/* Tags the user_data of the requests updating a pending poll request,
+ * the elements are pointers so this bit is always clear otherwise.
+ */
+#define URING_UPDATE 1
+
+/* The maximum number of entries of the submission ring, it's flushed
+ * when full so this only limits how many requests can be batched.
+ */
+#define URING_MAX_ENTRIES 4096
+
+#define ring_load(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ring_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+typedef struct uring_elem_t uring_elem_t;
+
+struct uring_elem_t {
+    APR_RING_ENTRY(uring_elem_t) link;
+    /* The descriptor reported by _poll(), either &pfd or the caller's
+     * one with APR_POLLSET_NOCOPY and pollcb.
+     */
+    apr_pollfd_t *pfdp;
+    apr_pollfd_t pfd;
+    int fd;
+    /* A poll request is pending in the kernel for this element */
+    int armed;
+    /* Position of this request in the submission ring */
+    unsigned int sqe_pos;
+    /* _remove()'d, the element is recycled on the last completion */
+    int dead;
+};
+
+typedef struct uring_poll_t uring_poll_t;
+
+struct uring_poll_t {
+    int fd;
+    /* The process which created the ring */
+    pid_t pid;
+    /* The pool caching the ring when it's destroyed */
+    apr_pool_t *pool;
+    /* Multishot and updatable poll requests (Linux 5.13), see uring_probe() */
+    int poll_update;
+    unsigned int to_submit;
+    /* Number of poll requests pending in the kernel */
+    unsigned int narmed;
+    /* Submission ring */
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int sq_entries;
+    unsigned int cq_entries;
+    struct io_uring_sqe *sqes;
+    /* Completion ring */
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+    /* Mappings of the rings */
+    void *sq_map;
+    void *cq_map;
+    apr_size_t sq_map_len;
+    apr_size_t cq_map_len;
+    apr_size_t sqes_map_len;
+    /* A ring containing all of the elements that are active */
+    APR_RING_HEAD(uring_query_ring_t, uring_elem_t) query_ring;
+    /* A ring of elements that have been used, and then _remove()'d */
+    APR_RING_HEAD(uring_free_ring_t, uring_elem_t) free_ring;
+    /* A ring of elements _remove()'d whose request is still pending */
+    APR_RING_HEAD(uring_dead_ring_t, uring_elem_t) dead_ring;
+    /* The active elements indexed by their fd, for _remove() and _modify()
+     * to find them without walking the query_ring (like epoll finds its
+     * data pointer from the fd).
+     */
+    uring_elem_t **elems;
+    int nelems;
+};
+
+static unsigned get_uring_event(apr_int16_t event)
+{
+    unsigned rv = 0;
+
+    if (event & APR_POLLIN)
+        rv |= POLLIN;
+    if (event & APR_POLLPRI)
+        rv |= POLLPRI;
+    if (event & APR_POLLOUT)
+        rv |= POLLOUT;
+    /* POLLERR, POLLHUP, and POLLNVAL aren't valid as requested events */
+
+#if APR_IS_BIGENDIAN
+    /* poll32_events is expected with its half-words swapped */
+    rv = (rv << 16) | (rv >> 16);
+#endif
+    return rv;
+}
+
+static apr_int16_t get_uring_revent(int res)
+{
+    apr_int16_t rv = 0;
+
+    if (res < 0) {
+        /* The request failed, e.g. the descriptor was closed */
+        return (res == -EBADF) ? APR_POLLNVAL : APR_POLLERR;
+    }
+
+    if (res & POLLIN)
+        rv |= APR_POLLIN;
+    if (res & POLLPRI)
+        rv |= APR_POLLPRI;
+    if (res & POLLOUT)
+        rv |= APR_POLLOUT;
+    if (res & POLLERR)
+        rv |= APR_POLLERR;
+    if (res & POLLHUP)
+        rv |= APR_POLLHUP;
+    if (res & POLLNVAL)
+        rv |= APR_POLLNVAL;
+
+    return rv;
+}
+
+static int uring_enter(uring_poll_t *u, unsigned int min_complete,
+                       unsigned int flags, void *arg, apr_size_t argsz)
+{
+    int ret;
+
+    ret = syscall(__NR_io_uring_enter, u->fd, u->to_submit, min_complete,
+                  flags, arg, argsz);
+    if (ret > 0) {
+        u->to_submit -= ret;
+    }
+    return ret;
+}
+
+/* Get the next free entry of the submission ring, the caller fills it
+ * and queues it with uring_push_sqe().
+ */
+static struct io_uring_sqe *uring_get_sqe(uring_poll_t *u)
+{
+    unsigned int tail = *u->sq_tail;
+    struct io_uring_sqe *sqe;
+
+    if (tail - ring_load(u->sq_head) >= u->sq_entries) {
+        /* Full, submit what's queued already */
+        if (uring_enter(u, 0, 0, NULL, 0) < 0) {
+            return NULL;
+        }
+        if (tail - ring_load(u->sq_head) >= u->sq_entries) {
+            /* The kernel did not take any, don't overwrite them */
+            errno = EAGAIN;
+            return NULL;
+        }
+    }
+
+    sqe = &u->sqes[tail & *u->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+static void uring_push_sqe(uring_poll_t *u)
+{
+    unsigned int tail = *u->sq_tail;
+    unsigned int index = tail & *u->sq_mask;
+
+    u->sq_array[index] = index;
+    ring_store(u->sq_tail, tail + 1);
+    u->to_submit++;
+}
+
+static void uring_close(uring_poll_t *u)
+{
+    if (u->sqes) {
+        munmap(u->sqes, u->sqes_map_len);
+    }
+    if (u->cq_map && u->cq_map != u->sq_map) {
+        munmap(u->cq_map, u->cq_map_len);
+    }
+    if (u->sq_map) {
+        munmap(u->sq_map, u->sq_map_len);
+    }
+    close(u->fd);
+}
+
+/* Setting up a ring is costly, and so is closing one: the kernel tears
+ * it down asynchronously and then notifies each thread which used it,
+ * interrupting their next blocking call (epoll_wait() or select() fail
+ * with EINTR).  So the rings of the destroyed pollsets are kept by the
+ * pool they were created from, for the next ones created there, until
+ * this pool is cleared.
+ */
+#define URING_CACHE_SIZE 8
+#define URING_CACHE_KEY "apr_poll_io_uring_cache"
+
+typedef struct uring_cache_t {
+    uring_poll_t rings[URING_CACHE_SIZE];
+    int nrings;
+    /* The pool is being cleared, nothing can be cached anymore */
+    int closed;
+} uring_cache_t;
+
+static apr_status_t uring_cache_cleanup(void *data)
+{
+    uring_cache_t *cache = data;
+
+    while (cache->nrings) {
+        uring_close(&cache->rings[--cache->nrings]);
+    }
+    cache->closed = 1;
+
+    return APR_SUCCESS;
+}
+
+static uring_cache_t *uring_cache_find(apr_pool_t *pool, int create)
+{
+    void *cache = NULL;
+
+    apr_pool_userdata_get(&cache, URING_CACHE_KEY, pool);
+    if (!cache && create) {
+        cache = apr_pcalloc(pool, sizeof(uring_cache_t));
+        apr_pool_userdata_setn(cache, URING_CACHE_KEY, uring_cache_cleanup,
+                               pool);
+    }
+
+    return cache;
+}
+
+static int uring_cache_get(uring_poll_t *u, apr_pool_t *pool,
+                           apr_uint32_t size)
+{
+    apr_uint32_t sq_size = size < URING_MAX_ENTRIES ? size : URING_MAX_ENTRIES;
+    uring_cache_t *cache = uring_cache_find(pool, 0);
+    pid_t pid = getpid();
+    int i, found = -1;
+
+    if (!cache) {
+        return 0;
+    }
+    /* The rings of the parent process can't be used by a child */
+    for (i = 0; i < cache->nrings; ) {
+        if (cache->rings[i].pid != pid) {
+            uring_close(&cache->rings[i]);
+            cache->rings[i] = cache->rings[--cache->nrings];
+        }
+        else {
+            i++;
+        }
+    }
+    for (i = 0; i < cache->nrings; i++) {
+        if (cache->rings[i].sq_entries >= sq_size
+                && cache->rings[i].cq_entries >= size
+                && (found < 0 || cache->rings[i].sq_entries
+                                 < cache->rings[found].sq_entries)) {
+            found = i;
+        }
+    }
+    if (found < 0) {
+        return 0;
+    }
+    *u = cache->rings[found];
+    cache->rings[found] = cache->rings[--cache->nrings];
+
+    return 1;
+}
+
+static int uring_cache_put(uring_poll_t *u)
+{
+    uring_cache_t *cache = uring_cache_find(u->pool, 1);
+
+    if (cache->closed || cache->nrings == URING_CACHE_SIZE) {
+        return 0;
+    }
+    cache->rings[cache->nrings++] = *u;
+
+    return 1;
+}
+
+/* Check that the poll requests are supported, and whether multishot and
+ * updatable ones are.  IORING_REGISTER_PROBE tells which opcodes the kernel
+ * knows, not which flags, so the latter is found by asking to update a
+ * request which doesn't exist: ENOENT if supported, EINVAL otherwise.
+ */
+static apr_status_t uring_probe(uring_poll_t *u, apr_pool_t *pool)
+{
+    struct io_uring_probe *probe;
+    struct io_uring_sqe *sqe;
+    struct io_uring_cqe *cqe;
+    unsigned int nops = IORING_OP_POLL_REMOVE + 1;
+    unsigned int head;
+
+    probe = apr_pcalloc(pool, sizeof(*probe)
+                              + nops * sizeof(struct io_uring_probe_op));
+    if (syscall(__NR_io_uring_register, u->fd, IORING_REGISTER_PROBE,
+                probe, nops) < 0) {
+        return apr_get_netos_error();
+    }
+    if (probe->ops_len < nops
+            || !(probe->ops[IORING_OP_POLL_ADD].flags & IO_URING_OP_SUPPORTED)
+            || !(probe->ops[IORING_OP_POLL_REMOVE].flags
+                 & IO_URING_OP_SUPPORTED)) {
+        return APR_ENOTIMPL;
+    }
+
+    sqe = uring_get_sqe(u);
+    if (!sqe) {
+        return apr_get_netos_error();
+    }
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->len = IORING_POLL_UPDATE_EVENTS;
+    uring_push_sqe(u);
+    if (uring_enter(u, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0) {
+        return apr_get_netos_error();
+    }
+
+    head = *u->cq_head;
+    if (head == ring_load(u->cq_tail)) {
+        return APR_EGENERAL;
+    }
+    cqe = &u->cqes[head & *u->cq_mask];
+    u->poll_update = (cqe->res == -ENOENT);
+    ring_store(u->cq_head, head + 1);
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t uring_create(uring_poll_t *u, apr_pool_t *pool,
+                                 apr_uint32_t size)
+{
+    struct io_uring_params params;
+    apr_status_t rv;
+    char *sq, *cq;
+    int fd;
+
+    if (uring_cache_get(u, pool, size)) {
+        u->pid = getpid();
+        APR_RING_INIT(&u->query_ring, uring_elem_t, link);
+        APR_RING_INIT(&u->free_ring, uring_elem_t, link);
+        APR_RING_INIT(&u->dead_ring, uring_elem_t, link);
+        u->elems = NULL;
+        u->nelems = 0;
+        return APR_SUCCESS;
+    }
+
+    memset(&params, 0, sizeof(params));
+    if (size > URING_MAX_ENTRIES) {
+        /* Make room in the completion ring for all the descriptors */
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = size;
+        size = URING_MAX_ENTRIES;
+    }
+
+    /* The returned descriptor is close-on-exec already */
+    fd = syscall(__NR_io_uring_setup, size, &params);
+    if (fd < 0) {
+        rv = apr_get_netos_error();
+        /* Not available with this kernel (or disabled), let the caller
+         * fall back to the default method.
+         */
+        if (errno == ENOSYS || errno == EPERM || errno == EINVAL) {
+            rv = APR_ENOTIMPL;
+        }
+        return rv;
+    }
+    /* Both the NODROP completion ring and the timeout for waiting are
+     * required, which came with IORING_FEAT_EXT_ARG.
+     */
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        close(fd);
+        return APR_ENOTIMPL;
+    }
+    u->fd = fd;
+    u->pid = getpid();
+    u->pool = pool;
+
+    u->sq_map_len = params.sq_off.array
+                    + params.sq_entries * sizeof(unsigned int);
+    u->cq_map_len = params.cq_off.cqes
+                    + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (u->cq_map_len > u->sq_map_len) {
+            u->sq_map_len = u->cq_map_len;
+        }
+        u->cq_map_len = u->sq_map_len;
+    }
+
+    u->sq_map = mmap(NULL, u->sq_map_len, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (u->sq_map == MAP_FAILED) {
+        rv = apr_get_netos_error();
+        u->sq_map = NULL;
+        uring_close(u);
+        return rv;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        u->cq_map = u->sq_map;
+    }
+    else {
+        u->cq_map = mmap(NULL, u->cq_map_len, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (u->cq_map == MAP_FAILED) {
+            rv = apr_get_netos_error();
+            u->cq_map = NULL;
+            uring_close(u);
+            return rv;
+        }
+    }
+    u->sqes_map_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_map_len, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        rv = apr_get_netos_error();
+        u->sqes = NULL;
+        uring_close(u);
+        return rv;
+    }
+
+    sq = u->sq_map;
+    u->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    u->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    u->sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+    u->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    u->sq_entries = params.sq_entries;
+    u->cq_entries = params.cq_entries;
+
+    cq = u->cq_map;
+    u->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    u->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    u->cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    if ((rv = uring_probe(u, pool)) != APR_SUCCESS) {
+        uring_close(u);
+        return rv;
+    }
+
+    APR_RING_INIT(&u->query_ring, uring_elem_t, link);
+    APR_RING_INIT(&u->free_ring, uring_elem_t, link);
+    APR_RING_INIT(&u->dead_ring, uring_elem_t, link);
+    u->elems = NULL;
+    u->nelems = 0;
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t uring_arm(uring_poll_t *u, uring_elem_t *elem)
+{
+    struct io_uring_sqe *sqe;
+    apr_int16_t reqevents = elem->pfdp->reqevents;
+
+    sqe = uring_get_sqe(u);
+    if (!sqe) {
+        return apr_get_netos_error();
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = elem->fd;
+    sqe->poll32_events = get_uring_event(reqevents);
+    if (URING_MULTISHOT(reqevents)) {
+        sqe->len = IORING_POLL_ADD_MULTI;
+    }
+    sqe->user_data = (apr_uint64_t)(apr_uintptr_t)elem;
+    elem->sqe_pos = *u->sq_tail;
+    uring_push_sqe(u);
+
+    elem->armed = 1;
+    u->narmed++;
+    return APR_SUCCESS;
+}
+
+/* Get the poll request of the element if it's still queued in the
+ * submission ring, i.e. among the last ones not submitted yet, so that it
+ * can be changed in place.
+ */
+static struct io_uring_sqe *uring_queued_sqe(uring_poll_t *u,
+                                             uring_elem_t *elem)
+{
+    if (!elem->armed || *u->sq_tail - elem->sqe_pos > u->to_submit) {
+        return NULL;
+    }
+    return &u->sqes[elem->sqe_pos & *u->sq_mask];
+}
+
+/* Change the requested events of the pending request of the element, which
+ * uring_next() re-arms if this request completed in the meantime.
+ */
+static apr_status_t uring_update(uring_poll_t *u, uring_elem_t *elem)
+{
+    struct io_uring_sqe *sqe;
+    apr_int16_t reqevents = elem->pfdp->reqevents;
+
+    sqe = uring_get_sqe(u);
+    if (!sqe) {
+        return apr_get_netos_error();
+    }
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (apr_uint64_t)(apr_uintptr_t)elem;
+    sqe->poll32_events = get_uring_event(reqevents);
+    sqe->len = IORING_POLL_UPDATE_EVENTS;
+    if (URING_MULTISHOT(reqevents)) {
+        sqe->len |= IORING_POLL_ADD_MULTI;
+    }
+    sqe->user_data = (apr_uint64_t)(apr_uintptr_t)elem | URING_UPDATE;
+    uring_push_sqe(u);
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t uring_cancel(uring_poll_t *u, uring_elem_t *elem)
+{
+    struct io_uring_sqe *sqe;
+
+    sqe = uring_get_sqe(u);
+    if (!sqe) {
+        return apr_get_netos_error();
+    }
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (apr_uint64_t)(apr_uintptr_t)elem;
+    /* The completion of the removal itself is ignored */
+    sqe->user_data = 0;
+    uring_push_sqe(u);
+
+    return APR_SUCCESS;
+}
+
+static int uring_desc_fd(const apr_pollfd_t *descriptor)
+{
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        return descriptor->desc.s->socketdes;
+    }
+    return descriptor->desc.f->filedes;
+}
+
+static void uring_index(uring_poll_t *u, apr_pool_t *pool,
+                        uring_elem_t *elem)
+{
+    if (elem->fd < 0) {
+        /* Let the kernel fail the request */
+        return;
+    }
+    if (elem->fd >= u->nelems) {
+        int n = u->nelems ? u->nelems * 2 : 64;
+        uring_elem_t **elems;
+
+        while (n <= elem->fd) {
+            n *= 2;
+        }
+        elems = apr_pcalloc(pool, n * sizeof(uring_elem_t *));
+        if (u->nelems) {
+            memcpy(elems, u->elems, u->nelems * sizeof(uring_elem_t *));
+        }
+        u->elems = elems;
+        u->nelems = n;
+    }
+    /* The last one added for an fd, if added more than once */
+    u->elems[elem->fd] = elem;
+}
+
+static void uring_unindex(uring_poll_t *u, uring_elem_t *elem)
+{
+    if (elem->fd >= 0 && u->elems[elem->fd] == elem) {
+        u->elems[elem->fd] = NULL;
+    }
+}
+
+static apr_status_t uring_add(uring_poll_t *u, apr_pool_t *pool,
+                              const apr_pollfd_t *descriptor, int copy)
+{
+    uring_elem_t *elem;
+    apr_status_t rv;
+
+    if (URING_MULTISHOT(descriptor->reqevents) && !u->poll_update) {
+        return APR_ENOTIMPL;
+    }
+
+    if (!APR_RING_EMPTY(&u->free_ring, uring_elem_t, link)) {
+        elem = APR_RING_FIRST(&u->free_ring);
+        APR_RING_REMOVE(elem, link);
+    }
+    else {
+        elem = (uring_elem_t *) apr_palloc(pool, sizeof(uring_elem_t));
+        APR_RING_ELEM_INIT(elem, link);
+    }
+    if (copy) {
+        elem->pfd = *descriptor;
+        elem->pfdp = &elem->pfd;
+    }
+    else {
+        elem->pfdp = (apr_pollfd_t *)descriptor;
+    }
+    elem->fd = uring_desc_fd(descriptor);
+    elem->armed = 0;
+    elem->dead = 0;
+
+    uring_index(u, pool, elem);
+    rv = uring_arm(u, elem);
+    if (rv != APR_SUCCESS) {
+        uring_unindex(u, elem);
+        elem->dead = 1;
+        APR_RING_INSERT_TAIL(&u->free_ring, elem, uring_elem_t, link);
+        return rv;
+    }
+    APR_RING_INSERT_TAIL(&u->query_ring, elem, uring_elem_t, link);
+
+    return APR_SUCCESS;
+}
+
+static uring_elem_t *uring_find(uring_poll_t *u,
+                                const apr_pollfd_t *descriptor)
+{
+    int fd = uring_desc_fd(descriptor);
+    uring_elem_t *ep;
+
+    if (fd >= 0 && fd < u->nelems && (ep = u->elems[fd])
+            && descriptor->desc.s == ep->pfdp->desc.s) {
+        return ep;
+    }
+
+    /* Not found by its fd if it was added more than once, or if it was
+     * closed (or its fd changed) since it was added.
+     */
+    for (ep = APR_RING_FIRST(&u->query_ring);
+         ep != APR_RING_SENTINEL(&u->query_ring, uring_elem_t, link);
+         ep = APR_RING_NEXT(ep, link)) {
+
+        if (descriptor->desc.s == ep->pfdp->desc.s) {
+            return ep;
+        }
+    }
+
+    return NULL;
+}
+
+static apr_status_t uring_remove(uring_poll_t *u,
+                                 const apr_pollfd_t *descriptor)
+{
+    uring_elem_t *ep = uring_find(u, descriptor);
+    struct io_uring_sqe *sqe;
+
+    if (!ep) {
+        return APR_NOTFOUND;
+    }
+
+    /* Dead elements are ignored by the completions still to come */
+    ep->dead = 1;
+    APR_RING_REMOVE(ep, link);
+    uring_unindex(u, ep);
+    if ((sqe = uring_queued_sqe(u, ep))) {
+        /* Not submitted yet, nothing to cancel */
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_NOP;
+        ep->armed = 0;
+        u->narmed--;
+    }
+    if (!ep->armed) {
+        APR_RING_INSERT_TAIL(&u->free_ring, ep, uring_elem_t, link);
+        return APR_SUCCESS;
+    }
+
+    /* Recycled when the request completes, the removal is submitted along
+     * with the other requests queued by the next poll.
+     */
+    APR_RING_INSERT_TAIL(&u->dead_ring, ep, uring_elem_t, link);
+    return uring_cancel(u, ep);
+}
+
+static apr_status_t uring_modify(uring_poll_t *u, apr_pool_t *pool,
+                                 const apr_pollfd_t *descriptor, int copy)
+{
+    uring_elem_t *ep = uring_find(u, descriptor);
+    struct io_uring_sqe *sqe;
+    apr_int16_t reqevents;
+    apr_status_t rv;
+
+    if (!ep) {
+        return APR_NOTFOUND;
+    }
+    if (URING_MULTISHOT(descriptor->reqevents) && !u->poll_update) {
+        return APR_ENOTIMPL;
+    }
+
+    reqevents = ep->pfdp->reqevents;
+    if (copy) {
+        ep->pfd = *descriptor;
+    }
+    else {
+        ep->pfdp = (apr_pollfd_t *)descriptor;
+    }
+
+    if ((sqe = uring_queued_sqe(u, ep))) {
+        /* Not submitted yet, change the request itself */
+        sqe->poll32_events = get_uring_event(descriptor->reqevents);
+        sqe->len = URING_MULTISHOT(descriptor->reqevents)
+                   ? IORING_POLL_ADD_MULTI : 0;
+        return APR_SUCCESS;
+    }
+
+    /* Whether the request is multishot can't be updated, replace it */
+    if (ep->armed
+            && (!u->poll_update
+                || URING_MULTISHOT(reqevents)
+                   != URING_MULTISHOT(descriptor->reqevents))) {
+        if ((rv = uring_remove(u, descriptor)) != APR_SUCCESS) {
+            return rv;
+        }
+        return uring_add(u, pool, descriptor, copy);
+    }
+    if (ep->armed) {
+        return uring_update(u, ep);
+    }
+    return uring_arm(u, ep);
+}
+
+/* Submit the queued requests and wait for at least one completion */
+static apr_status_t uring_wait(uring_poll_t *u, apr_interval_time_t timeout)
+{
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    int ret;
+
+    memset(&arg, 0, sizeof(arg));
+    if (timeout >= 0) {
+        ts.tv_sec = apr_time_sec(timeout);
+        ts.tv_nsec = apr_time_usec(timeout) * 1000;
+        arg.ts = (apr_uint64_t)(apr_uintptr_t)&ts;
+    }
+
+    ret = uring_enter(u, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                      &arg, sizeof(arg));
+    if (ret < 0) {
+        if (errno == ETIME) {
+            return APR_TIMEUP;
+        }
+        return apr_get_netos_error();
+    }
+
+    return APR_SUCCESS;
+}
+
+/* Harvest the next completion to report, if any */
+static int uring_next(uring_poll_t *u, uring_elem_t **pelem,
+                      apr_int16_t *rtnevents)
+{
+    struct io_uring_cqe *cqe;
+    uring_elem_t *elem;
+    apr_uint64_t user_data;
+    unsigned int head, flags;
+    int res;
+
+    for (head = *u->cq_head; head != ring_load(u->cq_tail); ) {
+        cqe = &u->cqes[head & *u->cq_mask];
+        user_data = cqe->user_data;
+        flags = cqe->flags;
+        res = cqe->res;
+        ring_store(u->cq_head, ++head);
+
+        if (!user_data) {
+            /* Completion of a removal */
+            continue;
+        }
+        elem = (uring_elem_t *)(apr_uintptr_t)(user_data & ~(apr_uint64_t)URING_UPDATE);
+        if (user_data & URING_UPDATE) {
+            /* The updated request had completed already, arm a new one
+             * unless it was re-armed when harvested.
+             */
+            if (res < 0 && !elem->dead && !elem->armed) {
+                (void)uring_arm(u, elem);
+            }
+            continue;
+        }
+
+        if (!(flags & IORING_CQE_F_MORE)) {
+            elem->armed = 0;
+            u->narmed--;
+        }
+        if (elem->dead) {
+            if (!elem->armed) {
+                APR_RING_REMOVE(elem, link);
+                APR_RING_INSERT_TAIL(&u->free_ring, elem, uring_elem_t, link);
+            }
+            continue;
+        }
+
+        /* Re-arm single shot requests (or multishot ones terminated by
+         * the kernel), unless asked for APR_POLLONESHOT.  Failed requests
+         * are not re-armed, they would fail again.
+         */
+        if (!elem->armed && res >= 0
+                && !(elem->pfdp->reqevents & APR_POLLONESHOT)) {
+            (void)uring_arm(u, elem);
+        }
+
+        *rtnevents = get_uring_revent(res);
+        *pelem = elem;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Cancel the pending requests and reap all the completions before the ring
+ * is closed or cached, otherwise the kernel completes them asynchronously
+ * on behalf of this thread, interrupting its next blocking call with EINTR.
+ */
+static void uring_cancel_all(uring_poll_t *u)
+{
+    uring_elem_t *ep;
+    apr_int16_t rtnevents;
+
+    for (ep = APR_RING_FIRST(&u->query_ring);
+         ep != APR_RING_SENTINEL(&u->query_ring, uring_elem_t, link);
+         ep = APR_RING_NEXT(ep, link)) {
+        ep->dead = 1;
+        if (ep->armed) {
+            (void)uring_cancel(u, ep);
+        }
+    }
+
+    for (;;) {
+        /* Dead elements only, nothing is returned */
+        while (uring_next(u, &ep, &rtnevents))
+            ;
+        if (!u->narmed && !u->to_submit) {
+            break;
+        }
+        if (uring_enter(u, u->narmed ? 1 : 0, IORING_ENTER_GETEVENTS,
+                        NULL, 0) < 0
+                && errno != EINTR) {
+            break;
+        }
+    }
+}
+
+static void uring_destroy(uring_poll_t *u)
+{
+    /* A child process can't use the ring of its parent */
+    if (u->pid != getpid()) {
+        uring_close(u);
+        return;
+    }
+
+    uring_cancel_all(u);
+    if (u->narmed || u->to_submit || !uring_cache_put(u)) {
+        uring_close(u);
+    }
+}
+
+struct apr_pollset_private_t
+{
+    uring_poll_t uring;
+    apr_pollfd_t *result_set;
+};
+
+static apr_status_t impl_pollset_cleanup(apr_pollset_t *pollset)
+{
+    uring_destroy(&pollset->p->uring);
+    return APR_SUCCESS;
+}
+
+static apr_status_t impl_pollset_create(apr_pollset_t *pollset,
+                                        apr_uint32_t size,
+                                        apr_pool_t *p,
+                                        apr_uint32_t flags)
+{
+    apr_status_t rv;
+
+    /* The rings are not locked */
+    if (flags & APR_POLLSET_THREADSAFE) {
+        pollset->p = NULL;
+        return APR_ENOTIMPL;
+    }
+
+    pollset->p = apr_pcalloc(p, sizeof(apr_pollset_private_t));
+    if ((rv = uring_create(&pollset->p->uring, p, size)) != APR_SUCCESS) {
+        pollset->p = NULL;
+        return rv;
+    }
+    pollset->p->result_set = apr_palloc(p, size * sizeof(apr_pollfd_t));
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t impl_pollset_add(apr_pollset_t *pollset,
+                                     const apr_pollfd_t *descriptor)
+{
+    return uring_add(&pollset->p->uring, pollset->pool, descriptor,
+                     !(pollset->flags & APR_POLLSET_NOCOPY));
+}
+
+static apr_status_t impl_pollset_remove(apr_pollset_t *pollset,
+                                        const apr_pollfd_t *descriptor)
+{
+    return uring_remove(&pollset->p->uring, descriptor);
+}
+
+static apr_status_t impl_pollset_modify(apr_pollset_t *pollset,
+                                        const apr_pollfd_t *descriptor)
+{
+    return uring_modify(&pollset->p->uring, pollset->pool, descriptor,
+                        !(pollset->flags & APR_POLLSET_NOCOPY));
+}
+
+static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
+                                      apr_interval_time_t timeout,
+                                      apr_int32_t *num,
+                                      const apr_pollfd_t **descriptors)
+{
+    uring_poll_t *u = &pollset->p->uring;
+    apr_time_t deadline = 0;
+    apr_status_t rv;
+    uring_elem_t *elem;
+    apr_int16_t rtnevents;
+    apr_uint32_t j = 0;
+
+    *num = 0;
+
+    if (timeout > 0) {
+        deadline = apr_time_now() + timeout;
+    }
+
+    for (;;) {
+        rv = uring_wait(u, timeout);
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+
+        while (j < pollset->nalloc && uring_next(u, &elem, &rtnevents)) {
+            const apr_pollfd_t *fdptr = elem->pfdp;
+
+            /* Check if the polled descriptor is our
+             * wakeup pipe. In that case do not put it result set.
+             */
+            if ((pollset->flags & APR_POLLSET_WAKEABLE) &&
+                fdptr->desc_type == APR_POLL_FILE &&
+                fdptr->desc.f == pollset->wakeup_pipe[0]) {
+                apr_poll_drain_wakeup_pipe(&pollset->wakeup_set, pollset->wakeup_pipe);
+                rv = APR_EINTR;
+            }
+            else {
+                pollset->p->result_set[j] = *fdptr;
+                pollset->p->result_set[j].rtnevents = rtnevents;
+                j++;
+            }
+        }
+        if (j || rv != APR_SUCCESS) {
+            break;
+        }
+
+        /* Only internal completions, wait for what's left of the timeout */
+        if (timeout == 0) {
+            rv = APR_TIMEUP;
+            break;
+        }
+        if (timeout > 0) {
+            timeout = deadline - apr_time_now();
+            if (timeout <= 0) {
+                rv = APR_TIMEUP;
+                break;
+            }
+        }
+    }
+
+    if (((*num) = j)) { /* any event besides wakeup pipe? */
+        rv = APR_SUCCESS;
+
+        if (descriptors) {
+            *descriptors = pollset->p->result_set;
+        }
+    }
+
+    return rv;
+}
+
+static const apr_pollset_provider_t impl = {
+    impl_pollset_create,
+    impl_pollset_add,
+    impl_pollset_remove,
+    impl_pollset_modify,
+    impl_pollset_poll,
+    impl_pollset_cleanup,
+    "io_uring"
+};
+
+const apr_pollset_provider_t *const apr_pollset_provider_io_uring = &impl;
+
+static apr_status_t impl_pollcb_cleanup(apr_pollcb_t *pollcb)
+{
+    uring_destroy(pollcb->pollset.uring);
+    return APR_SUCCESS;
+}
+
+static apr_status_t impl_pollcb_create(apr_pollcb_t *pollcb,
+                                       apr_uint32_t size,
+                                       apr_pool_t *p,
+                                       apr_uint32_t flags)
+{
+    uring_poll_t *u;
+    apr_status_t rv;
+
+    u = apr_pcalloc(p, sizeof(*u));
+    if ((rv = uring_create(u, p, size)) != APR_SUCCESS) {
+        pollcb->fd = -1;
+        return rv;
+    }
+
+    pollcb->fd = u->fd;
+    pollcb->pollset.uring = u;
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t impl_pollcb_add(apr_pollcb_t *pollcb,
+                                    apr_pollfd_t *descriptor)
+{
+    return uring_add(pollcb->pollset.uring, pollcb->pool, descriptor, 0);
+}
+
+static apr_status_t impl_pollcb_remove(apr_pollcb_t *pollcb,
+                                       apr_pollfd_t *descriptor)
+{
+    return uring_remove(pollcb->pollset.uring, descriptor);
+}
+
+static apr_status_t impl_pollcb_modify(apr_pollcb_t *pollcb,
+                                       apr_pollfd_t *descriptor)
+{
+    return uring_modify(pollcb->pollset.uring, pollcb->pool, descriptor, 0);
+}
+
+static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
+                                     apr_interval_time_t timeout,
+                                     apr_pollcb_cb_t func,
+                                     void *baton)
+{
+    uring_poll_t *u = pollcb->pollset.uring;
+    apr_time_t deadline = 0;
+    apr_status_t rv;
+    uring_elem_t *elem;
+    apr_int16_t rtnevents;
+    int called = 0;
+
+    if (timeout > 0) {
+        deadline = apr_time_now() + timeout;
+    }
+
+    for (;;) {
+        rv = uring_wait(u, timeout);
+        if (rv != APR_SUCCESS) {
+            return rv;
+        }
+
+        while (uring_next(u, &elem, &rtnevents)) {
+            apr_pollfd_t *pollfd = elem->pfdp;
+
+            if ((pollcb->flags & APR_POLLSET_WAKEABLE) &&
+                pollfd->desc_type == APR_POLL_FILE &&
+                pollfd->desc.f == pollcb->wakeup_pipe[0]) {
+                apr_poll_drain_wakeup_pipe(&pollcb->wakeup_set, pollcb->wakeup_pipe);
+                return APR_EINTR;
+            }
+
+            pollfd->rtnevents = rtnevents;
+            called = 1;
+
+            rv = func(baton, pollfd);
+            if (rv) {
+                return rv;
+            }
+        }
+        if (called) {
+            return APR_SUCCESS;
+        }
+
+        /* Only internal completions, wait for what's left of the timeout */
+        if (timeout == 0) {
+            return APR_TIMEUP;
+        }
+        if (timeout > 0) {
+            timeout = deadline - apr_time_now();
+            if (timeout <= 0) {
+                return APR_TIMEUP;
+            }
+        }
+    }
+}
+
+static const apr_pollcb_provider_t impl_cb = {
+    impl_pollcb_create,
+    impl_pollcb_add,
+    impl_pollcb_remove,
+    impl_pollcb_modify,
+    impl_pollcb_poll,
+    impl_pollcb_cleanup,
+    "io_uring"
+};
+
+const apr_pollcb_provider_t *const apr_pollcb_provider_io_uring = &impl_cb;
+
+#endif /* HAVE_IO_URING */
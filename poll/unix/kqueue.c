@@ -43,6 +43,78 @@ static apr_int16_t get_kqueue_revent(apr_int16_t event, apr_int16_t flags)
     return rv;
 }
 
+static unsigned short get_kqueue_flags(apr_int16_t reqevents)
+{
+    unsigned short rv = EV_ADD;
+
+    if (reqevents & APR_POLLET)
+        rv |= EV_CLEAR;
+    if (reqevents & APR_POLLONESHOT)
+#ifdef EV_DISPATCH
+        rv |= EV_DISPATCH;
+#else
+        rv |= EV_ONESHOT;
+#endif
+
+    return rv;
+}
+
+/* Update the read and write filters of fd to match reqevents, adding the
+ * requested ones and deleting the others (if present) in a single call
+ * when EV_RECEIPT is available.
+ */
+static apr_status_t kqueue_modify(int kqueue_fd, apr_os_sock_t fd,
+                                  apr_int16_t reqevents, void *udata)
+{
+    struct kevent changes[2];
+    apr_status_t rv = APR_SUCCESS;
+    unsigned short flags;
+    int i;
+#ifdef EV_RECEIPT
+    struct kevent receipts[2];
+    int n;
+#endif
+
+    /* EV_ENABLE re-arms the filters disabled by EV_DISPATCH */
+    flags = get_kqueue_flags(reqevents) | EV_ENABLE;
+    EV_SET(&changes[0], fd, EVFILT_READ,
+           (reqevents & APR_POLLIN) ? flags : EV_DELETE, 0, 0, udata);
+    EV_SET(&changes[1], fd, EVFILT_WRITE,
+           (reqevents & APR_POLLOUT) ? flags : EV_DELETE, 0, 0, udata);
+
+#ifdef EV_RECEIPT
+    changes[0].flags |= EV_RECEIPT;
+    changes[1].flags |= EV_RECEIPT;
+
+    n = kevent(kqueue_fd, changes, 2, receipts, 2, NULL);
+    if (n < 0) {
+        return apr_get_netos_error();
+    }
+    for (i = 0; i < n; i++) {
+        if ((receipts[i].flags & EV_ERROR) && receipts[i].data != 0) {
+            /* Deleting a filter which was not requested is fine */
+            if (receipts[i].data == ENOENT
+                && !(receipts[i].filter == EVFILT_READ
+                         ? reqevents & APR_POLLIN
+                         : reqevents & APR_POLLOUT)) {
+                continue;
+            }
+            rv = (apr_status_t)receipts[i].data;
+        }
+    }
+#else
+    for (i = 0; i < 2; i++) {
+        if (kevent(kqueue_fd, &changes[i], 1, NULL, 0, NULL) == -1) {
+            if (!(changes[i].flags & EV_DELETE) || errno != ENOENT) {
+                rv = apr_get_netos_error();
+            }
+        }
+    }
+#endif
+
+    return rv;
+}
+
 struct apr_pollset_private_t
 {
     int kqueue_fd;
@@ -170,11 +242,13 @@ static apr_status_t impl_pollset_add(apr_pollset_t *pollset,
 
     if (descriptor->reqevents & APR_POLLIN) {
         if (pollset->flags & APR_POLLSET_NOCOPY) {
-            EV_SET(&pollset->p->kevent, fd, EVFILT_READ, EV_ADD, 0, 0,
+            EV_SET(&pollset->p->kevent, fd, EVFILT_READ,
+                   get_kqueue_flags(descriptor->reqevents), 0, 0,
                    (void *)descriptor);
         }
         else {
-            EV_SET(&pollset->p->kevent, fd, EVFILT_READ, EV_ADD, 0, 0,
+            EV_SET(&pollset->p->kevent, fd, EVFILT_READ,
+                   get_kqueue_flags(descriptor->reqevents), 0, 0,
                    elem);
         }
 
@@ -186,11 +260,13 @@ static apr_status_t impl_pollset_add(apr_pollset_t *pollset,
 
     if (descriptor->reqevents & APR_POLLOUT && rv == APR_SUCCESS) {
         if (pollset->flags & APR_POLLSET_NOCOPY) {
-            EV_SET(&pollset->p->kevent, fd, EVFILT_WRITE, EV_ADD, 0, 0,
+            EV_SET(&pollset->p->kevent, fd, EVFILT_WRITE,
+                   get_kqueue_flags(descriptor->reqevents), 0, 0,
                    (void *)descriptor);
         }
         else {
-            EV_SET(&pollset->p->kevent, fd, EVFILT_WRITE, EV_ADD, 0, 0,
+            EV_SET(&pollset->p->kevent, fd, EVFILT_WRITE,
+                   get_kqueue_flags(descriptor->reqevents), 0, 0,
                    elem);
         }
 
@@ -270,6 +346,56 @@ static apr_status_t impl_pollset_remove(apr_pollset_t *pollset,
     return rv;
 }
 
+static apr_status_t impl_pollset_modify(apr_pollset_t *pollset,
+                                        const apr_pollfd_t *descriptor)
+{
+    apr_os_sock_t fd;
+    pfd_elem_t *ep = NULL;
+    apr_pollfd_t old_pfd;
+    apr_status_t rv;
+
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        fd = descriptor->desc.s->socketdes;
+    }
+    else {
+        fd = descriptor->desc.f->filedes;
+    }
+
+    if (pollset->flags & APR_POLLSET_NOCOPY) {
+        return kqueue_modify(pollset->p->kqueue_fd, fd,
+                             descriptor->reqevents, (void *)descriptor);
+    }
+
+    pollset_lock_rings();
+
+    for (ep = APR_RING_FIRST(&(pollset->p->query_ring));
+         ep != APR_RING_SENTINEL(&(pollset->p->query_ring),
+                                 pfd_elem_t, link);
+         ep = APR_RING_NEXT(ep, link)) {
+
+        if (descriptor->desc.s == ep->pfd.desc.s) {
+            break;
+        }
+    }
+    if (ep == APR_RING_SENTINEL(&(pollset->p->query_ring),
+                                pfd_elem_t, link)) {
+        pollset_unlock_rings();
+        return APR_NOTFOUND;
+    }
+
+    old_pfd = ep->pfd;
+    ep->pfd = *descriptor;
+
+    rv = kqueue_modify(pollset->p->kqueue_fd, fd, descriptor->reqevents, ep);
+    if (rv != APR_SUCCESS) {
+        ep->pfd = old_pfd;
+    }
+
+    pollset_unlock_rings();
+
+    return rv;
+}
+
 static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
                                       apr_interval_time_t timeout,
                                       apr_int32_t *num,
@@ -349,6 +475,7 @@ static const apr_pollset_provider_t impl = {
     impl_pollset_create,
     impl_pollset_add,
     impl_pollset_remove,
+    impl_pollset_modify,
     impl_pollset_poll,
     impl_pollset_cleanup,
     "kqueue"
@@ -415,7 +542,8 @@ static apr_status_t impl_pollcb_add(apr_pollcb_t *pollcb,
     }
 
     if (descriptor->reqevents & APR_POLLIN) {
-        EV_SET(&ev, fd, EVFILT_READ, EV_ADD, 0, 0, descriptor);
+        EV_SET(&ev, fd, EVFILT_READ,
+                   get_kqueue_flags(descriptor->reqevents), 0, 0, descriptor);
 
         if (kevent(pollcb->fd, &ev, 1, NULL, 0, NULL) == -1) {
             rv = apr_get_netos_error();
@@ -423,7 +551,8 @@ static apr_status_t impl_pollcb_add(apr_pollcb_t *pollcb,
     }
 
     if (descriptor->reqevents & APR_POLLOUT && rv == APR_SUCCESS) {
-        EV_SET(&ev, fd, EVFILT_WRITE, EV_ADD, 0, 0, descriptor);
+        EV_SET(&ev, fd, EVFILT_WRITE,
+                   get_kqueue_flags(descriptor->reqevents), 0, 0, descriptor);
 
         if (kevent(pollcb->fd, &ev, 1, NULL, 0, NULL) == -1) {
             rv = apr_get_netos_error();
@@ -468,6 +597,21 @@ static apr_status_t impl_pollcb_remove(apr_pollcb_t *pollcb,
 }
 
 
+static apr_status_t impl_pollcb_modify(apr_pollcb_t *pollcb,
+                                       apr_pollfd_t *descriptor)
+{
+    apr_os_sock_t fd;
+
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        fd = descriptor->desc.s->socketdes;
+    }
+    else {
+        fd = descriptor->desc.f->filedes;
+    }
+
+    return kqueue_modify(pollcb->fd, fd, descriptor->reqevents, descriptor);
+}
+
 static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
                                      apr_interval_time_t timeout,
                                      apr_pollcb_cb_t func,
@@ -524,6 +668,7 @@ static const apr_pollcb_provider_t impl_cb = {
     impl_pollcb_create,
     impl_pollcb_add,
     impl_pollcb_remove,
+    impl_pollcb_modify,
     impl_pollcb_poll,
     impl_pollcb_cleanup,
     "kqueue"
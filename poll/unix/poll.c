@@ -64,6 +64,13 @@ static apr_int16_t get_revent(apr_int16_t event)
     return rv;
 }
 
+#if APR_FILES_AS_SOCKETS
+#define get_fd(pfd) ((pfd)->desc_type == APR_POLL_SOCKET \
+                     ? (pfd)->desc.s->socketdes : (pfd)->desc.f->filedes)
+#else
+#define get_fd(pfd) ((pfd)->desc.s->socketdes)
+#endif
+
 #ifdef POLL_USES_POLL
 
 #define SMALL_POLLSET_LIMIT  8
@@ -178,6 +185,9 @@ static apr_status_t impl_pollset_add(apr_pollset_t *pollset,
     if (pollset->nelts == pollset->nalloc) {
         return APR_ENOMEM;
     }
+    if (descriptor->reqevents & APR_POLLET) {
+        return APR_ENOTIMPL;
+    }
 
     pollset->p->query_set[pollset->nelts] = *descriptor;
 
@@ -226,6 +236,27 @@ static apr_status_t impl_pollset_remove(apr_pollset_t *pollset,
     return APR_NOTFOUND;
 }
 
+static apr_status_t impl_pollset_modify(apr_pollset_t *pollset,
+                                        const apr_pollfd_t *descriptor)
+{
+    apr_status_t rv = APR_NOTFOUND;
+    apr_uint32_t i;
+
+    for (i = 0; i < pollset->nelts; i++) {
+        if (descriptor->desc.s == pollset->p->query_set[i].desc.s) {
+            if (descriptor->reqevents & APR_POLLET) {
+                return APR_ENOTIMPL;
+            }
+            pollset->p->query_set[i] = *descriptor;
+            pollset->p->pollset[i].fd = get_fd(descriptor);
+            pollset->p->pollset[i].events = get_event(descriptor->reqevents);
+            rv = APR_SUCCESS;
+        }
+    }
+
+    return rv;
+}
+
 static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
                                       apr_interval_time_t timeout,
                                       apr_int32_t *num,
@@ -290,6 +321,12 @@ static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
                     pollset->p->result_set[j].rtnevents =
                         get_revent(pollset->p->pollset[i].revents);
                     j++;
+
+                    /* Ignored by poll() until re-armed (negative fd) */
+                    if (pollset->p->query_set[i].reqevents
+                            & APR_POLLONESHOT) {
+                        pollset->p->pollset[i].fd = -1;
+                    }
                 }
             }
         }
@@ -306,6 +343,7 @@ static const apr_pollset_provider_t impl = {
     impl_pollset_create,
     impl_pollset_add,
     impl_pollset_remove,
+    impl_pollset_modify,
     impl_pollset_poll,
     NULL,
     "poll"
@@ -339,6 +377,9 @@ static apr_status_t impl_pollcb_add(apr_pollcb_t *pollcb,
     if (pollcb->nelts == pollcb->nalloc) {
         return APR_ENOMEM;
     }
+    if (descriptor->reqevents & APR_POLLET) {
+        return APR_ENOTIMPL;
+    }
 
     if (descriptor->desc_type == APR_POLL_SOCKET) {
         pollcb->pollset.ps[pollcb->nelts].fd = descriptor->desc.s->socketdes;
@@ -387,6 +428,27 @@ static apr_status_t impl_pollcb_remove(apr_pollcb_t *pollcb,
     return APR_NOTFOUND;
 }
 
+static apr_status_t impl_pollcb_modify(apr_pollcb_t *pollcb,
+                                       apr_pollfd_t *descriptor)
+{
+    apr_status_t rv = APR_NOTFOUND;
+    apr_uint32_t i;
+
+    for (i = 0; i < pollcb->nelts; i++) {
+        if (descriptor->desc.s == pollcb->copyset[i]->desc.s) {
+            if (descriptor->reqevents & APR_POLLET) {
+                return APR_ENOTIMPL;
+            }
+            pollcb->copyset[i] = descriptor;
+            pollcb->pollset.ps[i].fd = get_fd(descriptor);
+            pollcb->pollset.ps[i].events = get_event(descriptor->reqevents);
+            rv = APR_SUCCESS;
+        }
+    }
+
+    return rv;
+}
+
 static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
                                      apr_interval_time_t timeout,
                                      apr_pollcb_cb_t func,
@@ -443,6 +505,12 @@ static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
                 }
 #endif
                 pollfd->rtnevents = get_revent(pollcb->pollset.ps[i].revents);
+
+                /* Ignored by poll() until re-armed (negative fd) */
+                if (pollfd->reqevents & APR_POLLONESHOT) {
+                    pollcb->pollset.ps[i].fd = -1;
+                }
+
                 rv = func(baton, pollfd);
                 if (rv) {
                     return rv;
@@ -457,6 +525,7 @@ static const apr_pollcb_provider_t impl_cb = {
     impl_pollcb_create,
     impl_pollcb_add,
     impl_pollcb_remove,
+    impl_pollcb_modify,
     impl_pollcb_poll,
     NULL,
     "poll"
@@ -41,6 +41,9 @@ extern const apr_pollcb_provider_t *apr_pollcb_provider_epoll;
 #if defined(HAVE_POLL)
 extern const apr_pollcb_provider_t *apr_pollcb_provider_poll;
 #endif
+#if defined(HAVE_IO_URING)
+extern const apr_pollcb_provider_t *apr_pollcb_provider_io_uring;
+#endif
 
 static const apr_pollcb_provider_t *pollcb_provider(apr_pollset_method_e method)
 {
@@ -64,6 +67,11 @@ static const apr_pollcb_provider_t *pollcb_provider(apr_pollset_method_e method)
         case APR_POLLSET_POLL:
 #if defined(HAVE_POLL)
             provider = apr_pollcb_provider_poll;
+#endif
+        break;
+        case APR_POLLSET_IO_URING:
+#if defined(HAVE_IO_URING)
+            provider = apr_pollcb_provider_io_uring;
 #endif
         break;
         case APR_POLLSET_SELECT:
@@ -216,6 +224,28 @@ APR_DECLARE(apr_status_t) apr_pollcb_remove(apr_pollcb_t *pollcb,
     return (*pollcb->provider->remove)(pollcb, descriptor);
 }
 
+APR_DECLARE(apr_status_t) apr_pollcb_modify(apr_pollcb_t *pollcb,
+                                            apr_pollfd_t *descriptor)
+{
+    apr_status_t rv;
+
+    if (pollcb->provider->modify) {
+        return (*pollcb->provider->modify)(pollcb, descriptor);
+    }
+
+    /* Emulate with remove + add for methods lacking native support */
+    rv = (*pollcb->provider->remove)(pollcb, descriptor);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+    return (*pollcb->provider->add)(pollcb, descriptor);
+}
+
+APR_DECLARE(apr_status_t) apr_pollcb_rearm(apr_pollcb_t *pollcb,
+                                           apr_pollfd_t *descriptor)
+{
+    return apr_pollcb_modify(pollcb, descriptor);
+}
 
 APR_DECLARE(apr_status_t) apr_pollcb_poll(apr_pollcb_t *pollcb,
                                           apr_interval_time_t timeout,
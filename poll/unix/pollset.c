@@ -60,6 +60,9 @@ extern const apr_pollset_provider_t *apr_pollset_provider_epoll;
 #if defined(HAVE_AIO_MSGQ)
 extern const apr_pollset_provider_t *apr_pollset_provider_aio_msgq;
 #endif
+#if defined(HAVE_IO_URING)
+extern const apr_pollset_provider_t *apr_pollset_provider_io_uring;
+#endif
 #if defined(HAVE_POLL)
 extern const apr_pollset_provider_t *apr_pollset_provider_poll;
 #endif
@@ -87,6 +90,11 @@ static const apr_pollset_provider_t *pollset_provider(apr_pollset_method_e metho
         case APR_POLLSET_AIO_MSGQ:
 #if defined(HAVE_AIO_MSGQ)
             provider = apr_pollset_provider_aio_msgq;
+#endif
+        break;
+        case APR_POLLSET_IO_URING:
+#if defined(HAVE_IO_URING)
+            provider = apr_pollset_provider_io_uring;
 #endif
         break;
         case APR_POLLSET_POLL:
@@ -257,6 +265,29 @@ APR_DECLARE(apr_status_t) apr_pollset_remove(apr_pollset_t *pollset,
     return (*pollset->provider->remove)(pollset, descriptor);
 }
 
+APR_DECLARE(apr_status_t) apr_pollset_modify(apr_pollset_t *pollset,
+                                             const apr_pollfd_t *descriptor)
+{
+    apr_status_t rv;
+
+    if (pollset->provider->modify) {
+        return (*pollset->provider->modify)(pollset, descriptor);
+    }
+
+    /* Emulate with remove + add for methods lacking native support */
+    rv = (*pollset->provider->remove)(pollset, descriptor);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+    return (*pollset->provider->add)(pollset, descriptor);
+}
+
+APR_DECLARE(apr_status_t) apr_pollset_rearm(apr_pollset_t *pollset,
+                                            const apr_pollfd_t *descriptor)
+{
+    return apr_pollset_modify(pollset, descriptor);
+}
+
 APR_DECLARE(apr_status_t) apr_pollset_poll(apr_pollset_t *pollset,
                                            apr_interval_time_t timeout,
                                            apr_int32_t *num,
@@ -222,6 +222,11 @@ static apr_status_t impl_pollset_add(apr_pollset_t *pollset,
     int res;
     apr_status_t rv = APR_SUCCESS;
 
+    /* Event ports are level triggered only */
+    if (descriptor->reqevents & APR_POLLET) {
+        return APR_ENOTIMPL;
+    }
+
     pollset_lock_rings();
 
     if (!APR_RING_EMPTY(&(pollset->p->free_ring), pfd_elem_t, link)) {
@@ -348,6 +353,66 @@ static apr_status_t impl_pollset_remove(apr_pollset_t *pollset,
     return rv;
 }
 
+static apr_status_t impl_pollset_modify(apr_pollset_t *pollset,
+                                        const apr_pollfd_t *descriptor)
+{
+    apr_os_sock_t fd;
+    pfd_elem_t *ep;
+    apr_status_t rv = APR_NOTFOUND;
+    int res;
+
+    pollset_lock_rings();
+
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        fd = descriptor->desc.s->socketdes;
+    }
+    else {
+        fd = descriptor->desc.f->filedes;
+    }
+
+    /* If it is on the add ring, it will be associated with the new
+     * events on the next call to apr_pollset_poll().
+     */
+    for (ep = APR_RING_FIRST(&(pollset->p->add_ring));
+         ep != APR_RING_SENTINEL(&(pollset->p->add_ring),
+                                 pfd_elem_t, link);
+         ep = APR_RING_NEXT(ep, link)) {
+
+        if (descriptor->desc.s == ep->pfd.desc.s) {
+            ep->pfd = *descriptor;
+            rv = APR_SUCCESS;
+            break;
+        }
+    }
+
+    if (rv != APR_SUCCESS) {
+        for (ep = APR_RING_FIRST(&(pollset->p->query_ring));
+             ep != APR_RING_SENTINEL(&(pollset->p->query_ring),
+                                     pfd_elem_t, link);
+             ep = APR_RING_NEXT(ep, link)) {
+
+            if (descriptor->desc.s == ep->pfd.desc.s) {
+                /* Re-associating an associated fd replaces its events */
+                res = port_associate(pollset->p->port_fd, PORT_SOURCE_FD,
+                                     fd, get_event(descriptor->reqevents),
+                                     (void *)ep);
+                if (res < 0) {
+                    rv = apr_get_netos_error();
+                }
+                else {
+                    ep->pfd = *descriptor;
+                    rv = APR_SUCCESS;
+                }
+                break;
+            }
+        }
+    }
+
+    pollset_unlock_rings();
+
+    return rv;
+}
+
 static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
                                       apr_interval_time_t timeout,
                                       apr_int32_t *num,
@@ -424,8 +489,10 @@ static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
          * to the add ring for re-association with the event port
          * later.  (It may have already been moved to the dead ring
          * by a call to pollset_remove on another thread.)
+         * One-shot descriptors stay dissociated on the query ring
+         * until they are re-armed by apr_pollset_modify().
          */
-        if (ep->on_query_ring) {
+        if (ep->on_query_ring && !(ep->pfd.reqevents & APR_POLLONESHOT)) {
             APR_RING_REMOVE(ep, link);
             ep->on_query_ring = 0;
             APR_RING_INSERT_TAIL(&(pollset->p->add_ring), ep,
@@ -451,6 +518,7 @@ static const apr_pollset_provider_t impl = {
     impl_pollset_create,
     impl_pollset_add,
     impl_pollset_remove,
+    impl_pollset_modify,
     impl_pollset_poll,
     impl_pollset_cleanup,
     "port"
@@ -505,6 +573,11 @@ static apr_status_t impl_pollcb_add(apr_pollcb_t *pollcb,
 {
     int ret, fd;
 
+    /* Event ports are level triggered only */
+    if (descriptor->reqevents & APR_POLLET) {
+        return APR_ENOTIMPL;
+    }
+
     if (descriptor->desc_type == APR_POLL_SOCKET) {
         fd = descriptor->desc.s->socketdes;
     }
@@ -543,6 +616,29 @@ static apr_status_t impl_pollcb_remove(apr_pollcb_t *pollcb,
     return APR_SUCCESS;
 }
 
+static apr_status_t impl_pollcb_modify(apr_pollcb_t *pollcb,
+                                       apr_pollfd_t *descriptor)
+{
+    int ret, fd;
+
+    if (descriptor->desc_type == APR_POLL_SOCKET) {
+        fd = descriptor->desc.s->socketdes;
+    }
+    else {
+        fd = descriptor->desc.f->filedes;
+    }
+
+    /* Re-associating an associated fd replaces its events */
+    ret = port_associate(pollcb->fd, PORT_SOURCE_FD, fd,
+                         get_event(descriptor->reqevents), descriptor);
+
+    if (ret == -1) {
+        return apr_get_netos_error();
+    }
+
+    return APR_SUCCESS;
+}
+
 static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
                                      apr_interval_time_t timeout,
                                      apr_pollcb_cb_t func,
@@ -573,7 +669,10 @@ static apr_status_t impl_pollcb_poll(apr_pollcb_t *pollcb,
             if (rv) {
                 return rv;
             }
-            rv = apr_pollcb_add(pollcb, pollfd);
+            /* One-shot descriptors wait for apr_pollcb_modify() */
+            if (!(pollfd->reqevents & APR_POLLONESHOT)) {
+                rv = apr_pollcb_add(pollcb, pollfd);
+            }
         }
     }
 
@@ -584,6 +683,7 @@ static const apr_pollcb_provider_t impl_cb = {
     impl_pollcb_create,
     impl_pollcb_add,
     impl_pollcb_remove,
+    impl_pollcb_modify,
     impl_pollcb_poll,
     impl_pollcb_cleanup,
     "port"
@@ -230,6 +230,9 @@ static apr_status_t impl_pollset_add(apr_pollset_t *pollset,
     if (pollset->nelts == pollset->nalloc) {
         return APR_ENOMEM;
     }
+    if (descriptor->reqevents & APR_POLLET) {
+        return APR_ENOTIMPL;
+    }
 
     pollset->p->query_set[pollset->nelts] = *descriptor;
 
@@ -433,6 +436,13 @@ static apr_status_t impl_pollset_poll(apr_pollset_t *pollset,
                 pollset->p->result_set[j].rtnevents |= APR_POLLERR;
             }
             j++;
+
+            /* Not selected anymore until re-armed (removed and added) */
+            if (pollset->p->query_set[i].reqevents & APR_POLLONESHOT) {
+                FD_CLR(fd, &(pollset->p->readset));
+                FD_CLR(fd, &(pollset->p->writeset));
+                FD_CLR(fd, &(pollset->p->exceptset));
+            }
         }
     }
     if (((*num) = j) != 0)
@@ -447,6 +457,7 @@ static const apr_pollset_provider_t impl = {
     impl_pollset_create,
     impl_pollset_add,
     impl_pollset_remove,
+    NULL,
     impl_pollset_poll,
     NULL,
     "select"
@@ -773,6 +773,7 @@ static const apr_pollset_provider_t impl = {
     asio_pollset_create,
     asio_pollset_add,
     asio_pollset_remove,
+    NULL,
     asio_pollset_poll,
     asio_pollset_cleanup,
     "asio"
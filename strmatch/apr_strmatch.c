@@ -16,12 +16,32 @@
 
 #include "apr_strmatch.h"
 #include "apr_lib.h"
+#include "apr_strings.h"
 #define APR_WANT_STRFUNC
 #include "apr_want.h"
 
 
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STRMATCH_SSE2 1
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ >= 5)
+#include <immintrin.h>
+#define STRMATCH_AVX2 1
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define STRMATCH_NEON 1
+#endif
+
 #define NUM_CHARS  256
 
+/* Longest pattern searched for by its first and last bytes with vector
+ * compares, Boyer-Moore-Horspool skips more for longer ones.
+ */
+#define SIMD_MAX_LENGTH 128
+
 /*
  * String searching functions
  */
@@ -79,6 +99,238 @@ static const char *match_boyer_moore_horspool_nocase(
     return NULL;
 }
 
+#if STRMATCH_SSE2 || STRMATCH_NEON
+
+/*
+ * Vector search: the positions whose first and last bytes match are found
+ * a block at a time, then the bytes in between are compared.
+ */
+
+static APR_INLINE unsigned int mask_first(apr_uint64_t mask)
+{
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctzll(mask);
+#else
+    unsigned int n = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static APR_INLINE int match_rest(const char *s, const char *p, apr_size_t n,
+                                 int nocase)
+{
+    if (!nocase) {
+        return memcmp(s, p, n) == 0;
+    }
+    while (n--) {
+        if (apr_tolower(*s++) != apr_tolower(*p++)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* The positions from i on, after the last full block */
+static APR_INLINE const char *match_tail(
+                               const apr_strmatch_pattern *this_pattern,
+                               const char *s, apr_size_t i, apr_size_t slen,
+                               int nocase)
+{
+    const char *p = this_pattern->pattern;
+    apr_size_t len = this_pattern->length;
+
+    for (; i + len <= slen; i++) {
+        if (match_rest(s + i, p, len, nocase)) {
+            return s + i;
+        }
+    }
+    return NULL;
+}
+
+/* The candidates at s + i + bit for the bits set in mask (each lane being
+ * 1 << shift bits wide)
+ */
+#define MATCH_CANDIDATES(mask, shift) \
+    while (mask) { \
+        apr_size_t pos = i + (mask_first(mask) >> (shift)); \
+        if (len < 3 || match_rest(s + pos + 1, p + 1, len - 2, nocase)) { \
+            return s + pos; \
+        } \
+        mask &= mask - 1; \
+    }
+
+#if STRMATCH_SSE2
+
+static APR_INLINE const char *search_sse2(
+                               const apr_strmatch_pattern *this_pattern,
+                               const char *s, apr_size_t slen, int nocase)
+{
+    const char *p = this_pattern->pattern;
+    apr_size_t len = this_pattern->length, i = 0;
+    const char c0 = p[0], c1 = p[len - 1];
+    const __m128i first = _mm_set1_epi8(nocase ? apr_tolower(c0) : c0);
+    const __m128i last = _mm_set1_epi8(nocase ? apr_tolower(c1) : c1);
+    const __m128i first_up = _mm_set1_epi8(apr_toupper(c0));
+    const __m128i last_up = _mm_set1_epi8(apr_toupper(c1));
+
+    for (; i + len + 15 <= slen; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i bl = _mm_loadu_si128((const __m128i *)(s + i + len - 1));
+        __m128i mf = _mm_cmpeq_epi8(bf, first);
+        __m128i ml = _mm_cmpeq_epi8(bl, last);
+        apr_uint64_t mask;
+
+        if (nocase) {
+            mf = _mm_or_si128(mf, _mm_cmpeq_epi8(bf, first_up));
+            ml = _mm_or_si128(ml, _mm_cmpeq_epi8(bl, last_up));
+        }
+        mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(mf, ml));
+        MATCH_CANDIDATES(mask, 0)
+    }
+    return match_tail(this_pattern, s, i, slen, nocase);
+}
+
+static const char *match_sse2(const apr_strmatch_pattern *this_pattern,
+                              const char *s, apr_size_t slen)
+{
+    return search_sse2(this_pattern, s, slen, 0);
+}
+
+static const char *match_sse2_nocase(const apr_strmatch_pattern *this_pattern,
+                                     const char *s, apr_size_t slen)
+{
+    return search_sse2(this_pattern, s, slen, 1);
+}
+
+#endif /* STRMATCH_SSE2 */
+
+#if STRMATCH_AVX2
+
+/* Compiled for AVX2, used if the CPU has it */
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+static APR_INLINE TARGET_AVX2 const char *search_avx2(
+                               const apr_strmatch_pattern *this_pattern,
+                               const char *s, apr_size_t slen, int nocase)
+{
+    const char *p = this_pattern->pattern;
+    apr_size_t len = this_pattern->length, i = 0;
+    const char c0 = p[0], c1 = p[len - 1];
+    const __m256i first = _mm256_set1_epi8(nocase ? apr_tolower(c0) : c0);
+    const __m256i last = _mm256_set1_epi8(nocase ? apr_tolower(c1) : c1);
+    const __m256i first_up = _mm256_set1_epi8(apr_toupper(c0));
+    const __m256i last_up = _mm256_set1_epi8(apr_toupper(c1));
+
+    for (; i + len + 31 <= slen; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i *)(s + i + len - 1));
+        __m256i mf = _mm256_cmpeq_epi8(bf, first);
+        __m256i ml = _mm256_cmpeq_epi8(bl, last);
+        apr_uint64_t mask;
+
+        if (nocase) {
+            mf = _mm256_or_si256(mf, _mm256_cmpeq_epi8(bf, first_up));
+            ml = _mm256_or_si256(ml, _mm256_cmpeq_epi8(bl, last_up));
+        }
+        mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(mf, ml));
+        MATCH_CANDIDATES(mask, 0)
+    }
+    return match_tail(this_pattern, s, i, slen, nocase);
+}
+
+static TARGET_AVX2 const char *match_avx2(
+                               const apr_strmatch_pattern *this_pattern,
+                               const char *s, apr_size_t slen)
+{
+    return search_avx2(this_pattern, s, slen, 0);
+}
+
+static TARGET_AVX2 const char *match_avx2_nocase(
+                               const apr_strmatch_pattern *this_pattern,
+                               const char *s, apr_size_t slen)
+{
+    return search_avx2(this_pattern, s, slen, 1);
+}
+
+#endif /* STRMATCH_AVX2 */
+
+#if STRMATCH_NEON
+
+static APR_INLINE const char *search_neon(
+                               const apr_strmatch_pattern *this_pattern,
+                               const char *s, apr_size_t slen, int nocase)
+{
+    const char *p = this_pattern->pattern;
+    apr_size_t len = this_pattern->length, i = 0;
+    const char c0 = p[0], c1 = p[len - 1];
+    const uint8x16_t first = vdupq_n_u8(nocase ? apr_tolower(c0) : c0);
+    const uint8x16_t last = vdupq_n_u8(nocase ? apr_tolower(c1) : c1);
+    const uint8x16_t first_up = vdupq_n_u8(apr_toupper(c0));
+    const uint8x16_t last_up = vdupq_n_u8(apr_toupper(c1));
+
+    for (; i + len + 15 <= slen; i += 16) {
+        uint8x16_t bf = vld1q_u8((const unsigned char *)s + i);
+        uint8x16_t bl = vld1q_u8((const unsigned char *)s + i + len - 1);
+        uint8x16_t mf = vceqq_u8(bf, first);
+        uint8x16_t ml = vceqq_u8(bl, last);
+        uint8x8_t narrowed;
+        apr_uint64_t mask;
+
+        if (nocase) {
+            mf = vorrq_u8(mf, vceqq_u8(bf, first_up));
+            ml = vorrq_u8(ml, vceqq_u8(bl, last_up));
+        }
+        /* Four bits per lane, the narrowing shift is cheaper than a
+         * movemask */
+        narrowed = vshrn_n_u16(vreinterpretq_u16_u8(vandq_u8(mf, ml)), 4);
+        mask = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0)
+               & APR_UINT64_C(0x8888888888888888);
+        MATCH_CANDIDATES(mask, 2)
+    }
+    return match_tail(this_pattern, s, i, slen, nocase);
+}
+
+static const char *match_neon(const apr_strmatch_pattern *this_pattern,
+                              const char *s, apr_size_t slen)
+{
+    return search_neon(this_pattern, s, slen, 0);
+}
+
+static const char *match_neon_nocase(const apr_strmatch_pattern *this_pattern,
+                                     const char *s, apr_size_t slen)
+{
+    return search_neon(this_pattern, s, slen, 1);
+}
+
+#endif /* STRMATCH_NEON */
+
+/* The best vector search available for this pattern, if any */
+static int precompile_simd(apr_strmatch_pattern *pattern, int case_sensitive)
+{
+    if (pattern->length > SIMD_MAX_LENGTH) {
+        return 0;
+    }
+#if STRMATCH_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        pattern->compare = case_sensitive ? match_avx2 : match_avx2_nocase;
+        return 1;
+    }
+#endif
+#if STRMATCH_SSE2
+    pattern->compare = case_sensitive ? match_sse2 : match_sse2_nocase;
+#else
+    pattern->compare = case_sensitive ? match_neon : match_neon_nocase;
+#endif
+    return 1;
+}
+
+#endif /* STRMATCH_SSE2 || STRMATCH_NEON */
+
 APR_DECLARE(const apr_strmatch_pattern *) apr_strmatch_precompile(
                                               apr_pool_t *p, const char *s,
                                               int case_sensitive)
@@ -96,6 +348,13 @@ APR_DECLARE(const apr_strmatch_pattern *) apr_strmatch_precompile(
         return pattern;
     }
 
+#if STRMATCH_SSE2 || STRMATCH_NEON
+    if (precompile_simd(pattern, case_sensitive)) {
+        pattern->context = NULL;
+        return pattern;
+    }
+#endif
+
     shift = (apr_size_t *)apr_palloc(p, sizeof(apr_size_t) * NUM_CHARS);
     for (i = 0; i < NUM_CHARS; i++) {
         shift[i] = pattern->length;
@@ -116,3 +375,269 @@ APR_DECLARE(const apr_strmatch_pattern *) apr_strmatch_precompile(
 
     return pattern;
 }
+
+/*
+ * Sets of patterns, matched with an Aho-Corasick automaton compiled to a
+ * DFA.
+ *
+ * The bytes of the patterns are mapped to classes (folded for case
+ * insensitive sets), all the other bytes to class 0, so that each state
+ * has a row of nclasses transitions only.  A transition is the offset of
+ * the row of the next state, with SET_OUTPUT set if the next state ends
+ * some pattern(s): the one(s) of the state first, then those of the
+ * chain of its dictionary suffixes.
+ */
+#define SET_OUTPUT  0x80000000U
+#define SET_NONE    ((apr_uint32_t)-1)
+
+struct apr_strmatch_set {
+    apr_uint32_t *delta;        /* nstates rows of nclasses */
+    apr_uint32_t *out;          /* state: first pattern ending there */
+    apr_uint32_t *dict;         /* state: next suffix state with output */
+    apr_uint32_t *next;         /* pattern: next one ending in the same state */
+    apr_size_t *lengths;        /* pattern: length */
+    apr_uint32_t nclasses;
+    apr_uint16_t classes[NUM_CHARS];
+};
+
+struct apr_strmatch_stream {
+    const apr_strmatch_set *set;
+    apr_uint32_t state;         /* row offset */
+    apr_off_t offset;           /* of the next byte */
+};
+
+APR_DECLARE(const apr_strmatch_set *) apr_strmatch_precompile_set(
+                                              apr_pool_t *p,
+                                              const char * const *patterns,
+                                              apr_size_t npatterns,
+                                              int case_sensitive)
+{
+    apr_strmatch_set *set;
+    apr_pool_t *tmp;
+    apr_uint32_t *trie, *fail, *queue, *out, *dict;
+    apr_size_t i, j, total = 1;
+    apr_uint32_t nstates, nclasses, qhead, qtail, c;
+
+    set = apr_pcalloc(p, sizeof(*set));
+
+    /* Byte classes, the length of the patterns bounds the count of states */
+    nclasses = 1;
+    for (i = 0; i < npatterns; i++) {
+        const unsigned char *pat = (const unsigned char *)patterns[i];
+        for (j = 0; pat[j]; j++) {
+            unsigned char ch = case_sensitive ? pat[j] : apr_tolower(pat[j]);
+            if (!set->classes[ch]) {
+                set->classes[ch] = nclasses++;
+            }
+        }
+        total += j;
+    }
+    if (!case_sensitive) {
+        for (i = 0; i < NUM_CHARS; i++) {
+            set->classes[i] = set->classes[(unsigned char)apr_tolower(i)];
+        }
+    }
+    if (total > (SET_OUTPUT - 1) / nclasses) {
+        return NULL;
+    }
+    set->nclasses = nclasses;
+
+    if (apr_pool_create(&tmp, p) != APR_SUCCESS) {
+        return NULL;
+    }
+
+    /* The trie, where 0 (the root) means no transition */
+    trie = apr_pcalloc(tmp, sizeof(apr_uint32_t) * total * nclasses);
+    out = apr_palloc(tmp, sizeof(apr_uint32_t) * total);
+    out[0] = SET_NONE;
+    set->next = apr_palloc(p, sizeof(apr_uint32_t) * (npatterns + 1));
+    set->lengths = apr_palloc(p, sizeof(apr_size_t) * (npatterns + 1));
+    nstates = 1;
+    for (i = 0; i < npatterns; i++) {
+        const unsigned char *pat = (const unsigned char *)patterns[i];
+        apr_uint32_t state = 0;
+        for (j = 0; pat[j]; j++) {
+            apr_uint32_t *t = &trie[state * nclasses + set->classes[pat[j]]];
+            if (!*t) {
+                out[nstates] = SET_NONE;
+                *t = nstates++;
+            }
+            state = *t;
+        }
+        set->lengths[i] = j;
+        set->next[i] = SET_NONE;
+        if (j) {
+            /* Duplicates are chained, in order */
+            apr_uint32_t *last = &out[state];
+            while (*last != SET_NONE) {
+                last = &set->next[*last];
+            }
+            *last = (apr_uint32_t)i;
+        }
+    }
+
+    /* Failure and dictionary suffix links, in breadth first order, which
+     * turns the trie into the DFA in place (a state's missing transitions
+     * are those of its failure state, complete already).
+     */
+    fail = apr_palloc(tmp, sizeof(apr_uint32_t) * nstates);
+    dict = apr_palloc(tmp, sizeof(apr_uint32_t) * nstates);
+    queue = apr_palloc(tmp, sizeof(apr_uint32_t) * nstates);
+    fail[0] = 0;
+    dict[0] = SET_NONE;
+    qhead = qtail = 0;
+    for (c = 0; c < nclasses; c++) {
+        apr_uint32_t u = trie[c];
+        if (u) {
+            fail[u] = 0;
+            dict[u] = SET_NONE;
+            queue[qtail++] = u;
+        }
+    }
+    while (qhead < qtail) {
+        apr_uint32_t r = queue[qhead++];
+        for (c = 0; c < nclasses; c++) {
+            apr_uint32_t u = trie[r * nclasses + c];
+            apr_uint32_t f = trie[fail[r] * nclasses + c];
+            if (u) {
+                fail[u] = f;
+                dict[u] = (out[f] != SET_NONE) ? f : dict[f];
+                queue[qtail++] = u;
+            }
+            else {
+                trie[r * nclasses + c] = f;
+            }
+        }
+    }
+
+    /* The DFA, compact */
+    set->delta = apr_palloc(p, sizeof(apr_uint32_t) * nstates * nclasses);
+    for (i = 0; i < (apr_size_t)nstates * nclasses; i++) {
+        apr_uint32_t u = trie[i];
+        set->delta[i] = u * nclasses;
+        if (out[u] != SET_NONE || dict[u] != SET_NONE) {
+            set->delta[i] |= SET_OUTPUT;
+        }
+    }
+    set->out = apr_pmemdup(p, out, sizeof(apr_uint32_t) * nstates);
+    set->dict = apr_pmemdup(p, dict, sizeof(apr_uint32_t) * nstates);
+
+    apr_pool_destroy(tmp);
+    return set;
+}
+
+/* Reports the matches ending at end (excluded), offset being the one of s */
+static int set_output(const apr_strmatch_set *set, apr_uint32_t state,
+                      apr_off_t end, apr_strmatch_set_fn_t *fn, void *baton)
+{
+    state /= set->nclasses;
+    if (set->out[state] == SET_NONE) {
+        state = set->dict[state];
+    }
+    do {
+        apr_uint32_t k;
+        for (k = set->out[state]; k != SET_NONE; k = set->next[k]) {
+            if (!fn(baton, k, end - (apr_off_t)set->lengths[k])) {
+                return 0;
+            }
+        }
+        state = set->dict[state];
+    } while (state != SET_NONE);
+    return 1;
+}
+
+/* Runs the DFA from *state over s, *offset being the one of s */
+static int set_scan(const apr_strmatch_set *set, apr_uint32_t *state,
+                    const char *s, apr_size_t slen, apr_off_t *offset,
+                    apr_strmatch_set_fn_t *fn, void *baton)
+{
+    const unsigned char *start = (const unsigned char *)s;
+    const unsigned char *pos = start, *end = start + slen;
+    const apr_uint32_t *delta = set->delta;
+    const apr_uint16_t *classes = set->classes;
+    apr_uint32_t st = *state;
+    int rv = 1;
+
+    while (pos < end) {
+        st = delta[st + classes[*pos++]];
+        if (st & SET_OUTPUT) {
+            st &= ~SET_OUTPUT;
+            if (!set_output(set, st, *offset + (pos - start), fn, baton)) {
+                rv = 0;
+                break;
+            }
+        }
+    }
+
+    *state = st;
+    *offset += pos - start;
+    return rv;
+}
+
+typedef struct {
+    apr_size_t pattern;
+    apr_off_t offset;
+} set_first_t;
+
+static int set_first(void *baton, apr_size_t pattern, apr_off_t offset)
+{
+    set_first_t *first = baton;
+
+    first->pattern = pattern;
+    first->offset = offset;
+    return 0;
+}
+
+APR_DECLARE(const char *) apr_strmatch_set_first(const apr_strmatch_set *set,
+                                                 const char *s,
+                                                 apr_size_t slen,
+                                                 apr_size_t *pattern)
+{
+    apr_uint32_t state = 0;
+    apr_off_t offset = 0;
+    set_first_t first;
+
+    if (set_scan(set, &state, s, slen, &offset, set_first, &first)) {
+        return NULL;
+    }
+    if (pattern) {
+        *pattern = first.pattern;
+    }
+    return s + first.offset;
+}
+
+APR_DECLARE(int) apr_strmatch_set_do(const apr_strmatch_set *set,
+                                     const char *s, apr_size_t slen,
+                                     apr_strmatch_set_fn_t *fn, void *baton)
+{
+    apr_uint32_t state = 0;
+    apr_off_t offset = 0;
+
+    return set_scan(set, &state, s, slen, &offset, fn, baton);
+}
+
+APR_DECLARE(apr_strmatch_stream *) apr_strmatch_stream_create(
+                                              apr_pool_t *p,
+                                              const apr_strmatch_set *set)
+{
+    apr_strmatch_stream *stream = apr_palloc(p, sizeof(*stream));
+
+    stream->set = set;
+    apr_strmatch_stream_reset(stream);
+    return stream;
+}
+
+APR_DECLARE(int) apr_strmatch_stream_do(apr_strmatch_stream *stream,
+                                        const char *s, apr_size_t slen,
+                                        apr_strmatch_set_fn_t *fn,
+                                        void *baton)
+{
+    return set_scan(stream->set, &stream->state, s, slen, &stream->offset,
+                    fn, baton);
+}
+
+APR_DECLARE(void) apr_strmatch_stream_reset(apr_strmatch_stream *stream)
+{
+    stream->state = 0;
+    stream->offset = 0;
+}
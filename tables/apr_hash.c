@@ -33,6 +33,15 @@
 #include <stdio.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH_GROUP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HASH_GROUP_NEON 1
+#endif
+
 /*
  * The internal form of a hash table.
  *
@@ -40,6 +49,14 @@
  * are resolved by hanging a linked list of hash entries off each
  * element of the array. Although this is a really simple design it
  * isn't too bad given that pools have a low allocation overhead.
+ *
+ * Flat tables (apr_hash_make_flat) use open addressing instead, the
+ * entries are stored in an array of slots along with an array of control
+ * bytes telling for each slot whether it's empty, deleted (a tombstone),
+ * or full with the low 7 bits of the entry's hash. Lookups start at the
+ * group of control bytes given by the other bits of the hash, and match
+ * a whole group at once (with SSE2 or NEON when available) to compare only
+ * the keys whose control byte matches. Nothing is allocated per entry.
  */
 
 typedef struct apr_hash_entry_t apr_hash_entry_t;
@@ -65,6 +82,26 @@ struct apr_hash_index_t {
     unsigned int        index;
 };
 
+/*
+ * Control bytes of flat tables, full slots have the high bit cleared.
+ */
+#define CTRL_EMPTY      ((unsigned char)0x80)
+#define CTRL_DELETED    ((unsigned char)0xFE)
+#define CTRL_IS_FULL(c) (!((c) & 0x80))
+
+#define GROUP_WIDTH 16
+
+/* Flat tables scramble the hash (Fibonacci hashing) so that the group
+ * (H1) depends on all the bits, given that close keys may have close
+ * hashes, and control bytes hold 7 other bits (H2).  Only the high bits
+ * of the product depend on all the bits of the hash, so H1 takes the top
+ * log2(gmask + 1) of them (gmask + 1 groups being a power of two).
+ */
+#define HASH_MIX(hash) ((apr_uint32_t)(hash) * 0x9E3779B1U)
+#define HASH_H1(hash, gmask) \
+    ((unsigned int)(((apr_uint64_t)HASH_MIX(hash) * ((gmask) + 1)) >> 32))
+#define HASH_H2(hash) ((unsigned char)(HASH_MIX(hash) & 0x7F))
+
 /*
  * The size of the array is always a power of two. We use the maximum
  * index rather than the size so that we can use bitwise-AND for
@@ -77,12 +114,130 @@ struct apr_hash_t {
     apr_hash_entry_t   **array;
     apr_hash_index_t     iterator;  /* For apr_hash_first(NULL, ...) */
     unsigned int         count, max, seed;
+    apr_uint32_t         flags;
     apr_hashfunc_t       hash_func;
     apr_hash_entry_t    *free;  /* List of recycled entries */
+    /* APR_HASH_INCREMENTAL only, while expanding: the buckets of the
+     * previous array from migrated (to array) onwards are still in use
+     */
+    apr_hash_entry_t   **old_array;
+    unsigned int         old_max, migrated;
+    /* Flat tables only, with max + 1 slots */
+    unsigned char       *ctrl;
+    apr_hash_entry_t    *slots;
+    unsigned int         growth_left; /* before rehashing */
 };
 
 #define INITIAL_MAX 15 /* tunable == 2^n - 1 */
 
+/* Buckets migrated per operation when expanding incrementally, so that
+ * the expansion is over well before the next one
+ */
+#define MIGRATE_STEP 8
+
+/* Flat tables are at most 7/8 full, so that lookups always end */
+#define FLAT_MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+
+/*
+ * Matching a group of control bytes, with the bit (or bits) of each lane
+ * set in the returned mask if the byte matches.
+ */
+#if HASH_GROUP_SSE2
+
+typedef apr_uint32_t group_mask_t;
+#define GROUP_LANE_SHIFT 0
+
+static APR_INLINE group_mask_t group_match(const unsigned char *ctrl,
+                                           unsigned char c)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (group_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group,
+                                                 _mm_set1_epi8((char)c)));
+}
+
+/* Empty or deleted */
+static APR_INLINE group_mask_t group_match_free(const unsigned char *ctrl)
+{
+    return (group_mask_t)_mm_movemask_epi8(
+                             _mm_loadu_si128((const __m128i *)ctrl));
+}
+
+#elif HASH_GROUP_NEON
+
+/* Four bits per lane, the narrowing shift is cheaper than a movemask */
+typedef apr_uint64_t group_mask_t;
+#define GROUP_LANE_SHIFT 2
+
+static APR_INLINE group_mask_t group_mask(uint8x16_t match)
+{
+    uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(match), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0)
+           & APR_UINT64_C(0x8888888888888888);
+}
+
+static APR_INLINE group_mask_t group_match(const unsigned char *ctrl,
+                                           unsigned char c)
+{
+    return group_mask(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(c)));
+}
+
+/* Empty or deleted */
+static APR_INLINE group_mask_t group_match_free(const unsigned char *ctrl)
+{
+    return group_mask(vtstq_u8(vld1q_u8(ctrl), vdupq_n_u8(0x80)));
+}
+
+#else
+
+typedef apr_uint32_t group_mask_t;
+#define GROUP_LANE_SHIFT 0
+
+static APR_INLINE group_mask_t group_match(const unsigned char *ctrl,
+                                           unsigned char c)
+{
+    group_mask_t mask = 0;
+    int i;
+
+    for (i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (group_mask_t)(ctrl[i] == c) << i;
+    }
+    return mask;
+}
+
+/* Empty or deleted */
+static APR_INLINE group_mask_t group_match_free(const unsigned char *ctrl)
+{
+    group_mask_t mask = 0;
+    int i;
+
+    for (i = 0; i < GROUP_WIDTH; i++) {
+        mask |= (group_mask_t)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+}
+
+#endif
+
+/* The first lane set in a (non-zero) mask */
+static APR_INLINE unsigned int group_first(group_mask_t mask)
+{
+#if defined(__GNUC__)
+    if (sizeof(mask) > sizeof(unsigned int)) {
+        return (unsigned int)__builtin_ctzll(mask) >> GROUP_LANE_SHIFT;
+    }
+    return (unsigned int)__builtin_ctz((unsigned int)mask) >> GROUP_LANE_SHIFT;
+#else
+    unsigned int n = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+    return n >> GROUP_LANE_SHIFT;
+#endif
+}
+
 
 /*
  * Hash creation functions.
@@ -93,7 +248,16 @@ static apr_hash_entry_t **alloc_array(apr_hash_t *ht, unsigned int max)
    return apr_pcalloc(ht->pool, sizeof(*ht->array) * (max + 1));
 }
 
-APR_DECLARE(apr_hash_t *) apr_hash_make(apr_pool_t *pool)
+static void flat_alloc(apr_hash_t *ht, unsigned int capacity)
+{
+    ht->ctrl = apr_palloc(ht->pool, capacity);
+    memset(ht->ctrl, CTRL_EMPTY, capacity);
+    ht->slots = apr_palloc(ht->pool, sizeof(*ht->slots) * capacity);
+    ht->max = capacity - 1;
+    ht->growth_left = FLAT_MAX_LOAD(capacity) - ht->count;
+}
+
+static apr_hash_t *hash_make(apr_pool_t *pool)
 {
     apr_hash_t *ht;
     apr_time_t now = apr_time_now();
@@ -105,12 +269,42 @@ APR_DECLARE(apr_hash_t *) apr_hash_make(apr_pool_t *pool)
     ht->max = INITIAL_MAX;
     ht->seed = (unsigned int)((now >> 32) ^ now ^ (apr_uintptr_t)pool ^
                               (apr_uintptr_t)ht ^ (apr_uintptr_t)&now) - 1;
-    ht->array = alloc_array(ht, ht->max);
+    ht->array = NULL;
+    ht->old_array = NULL;
+    ht->old_max = 0;
+    ht->migrated = 0;
+    ht->flags = 0;
     ht->hash_func = NULL;
+    ht->ctrl = NULL;
+    ht->slots = NULL;
+    ht->growth_left = 0;
+
+    return ht;
+}
+
+APR_DECLARE(apr_hash_t *) apr_hash_make_ex(apr_pool_t *pool,
+                                           apr_uint32_t flags)
+{
+    apr_hash_t *ht = hash_make(pool);
 
+    ht->flags = flags;
+    if (flags & APR_HASH_FLAT)
+        flat_alloc(ht, GROUP_WIDTH);
+    else
+        ht->array = alloc_array(ht, ht->max);
     return ht;
 }
 
+APR_DECLARE(apr_hash_t *) apr_hash_make(apr_pool_t *pool)
+{
+    return apr_hash_make_ex(pool, 0);
+}
+
+APR_DECLARE(apr_hash_t *) apr_hash_make_flat(apr_pool_t *pool)
+{
+    return apr_hash_make_ex(pool, APR_HASH_FLAT);
+}
+
 APR_DECLARE(apr_hash_t *) apr_hash_make_custom(apr_pool_t *pool,
                                                apr_hashfunc_t hash_func)
 {
@@ -124,16 +318,61 @@ APR_DECLARE(apr_hash_t *) apr_hash_make_custom(apr_pool_t *pool,
  * Hash iteration functions.
  */
 
+/*
+ * While expanding incrementally, the entries of the (new) bucket i whose
+ * old bucket is not migrated yet are in the old array, mixed with those
+ * of the bucket i + old_max + 1. Migrating keeps the order of entries,
+ * so iterating on a bucket continues in the new array if it's migrated
+ * meanwhile.
+ */
+static APR_INLINE apr_hash_entry_t *bucket_skip(const apr_hash_t *ht,
+                                                apr_hash_entry_t *he,
+                                                unsigned int i)
+{
+    if (ht->old_array) {
+        while (he && (he->hash & ht->max) != i)
+            he = he->next;
+    }
+    return he;
+}
+
+static APR_INLINE apr_hash_entry_t *bucket_first(const apr_hash_t *ht,
+                                                 unsigned int i)
+{
+    if (ht->old_array && (i & ht->old_max) >= ht->migrated)
+        return bucket_skip(ht, ht->old_array[i & ht->old_max], i);
+    return ht->array[i];
+}
+
+static apr_hash_index_t *flat_next(apr_hash_index_t *hi)
+{
+    const apr_hash_t *ht = hi->ht;
+
+    while (hi->index <= ht->max) {
+        unsigned int i = hi->index++;
+        if (CTRL_IS_FULL(ht->ctrl[i])) {
+            hi->this = &ht->slots[i];
+            return hi;
+        }
+    }
+    hi->this = NULL;
+    return NULL;
+}
+
 APR_DECLARE(apr_hash_index_t *) apr_hash_next(apr_hash_index_t *hi)
 {
+    if (hi->ht->ctrl) {
+        return flat_next(hi);
+    }
+
     hi->this = hi->next;
     while (!hi->this) {
         if (hi->index > hi->ht->max)
             return NULL;
 
-        hi->this = hi->ht->array[hi->index++];
+        hi->this = bucket_first(hi->ht, hi->index++);
     }
-    hi->next = hi->this->next;
+    hi->next = bucket_skip(hi->ht, hi->this->next, hi->index - 1);
     return hi;
 }
 
@@ -190,12 +429,55 @@ APR_DECLARE(void *) apr_hash_this_val(apr_hash_index_t *hi)
  * Expanding a hash table
  */
 
+static void migrate_buckets(apr_hash_t *ht, unsigned int n)
+{
+    while (n-- && ht->old_array) {
+        unsigned int k = ht->migrated;
+        apr_hash_entry_t *he = ht->old_array[k];
+        apr_hash_entry_t **lo = &ht->array[k];
+        apr_hash_entry_t **hi = &ht->array[k + ht->old_max + 1];
+
+        /* Split, in order */
+        while (he) {
+            if (he->hash & (ht->old_max + 1)) {
+                *hi = he;
+                hi = &he->next;
+            }
+            else {
+                *lo = he;
+                lo = &he->next;
+            }
+            he = he->next;
+        }
+        *lo = *hi = NULL;
+
+        if (++ht->migrated > ht->old_max) {
+            ht->old_array = NULL;
+        }
+    }
+}
+
 static void expand_array(apr_hash_t *ht)
 {
     apr_hash_index_t *hi;
     apr_hash_entry_t **new_array;
     unsigned int new_max;
 
+    if (ht->flags & APR_HASH_INCREMENTAL) {
+        /* Finish the previous expansion, if needed */
+        migrate_buckets(ht, ht->old_max + 1);
+
+        /* The buckets of the new array are initialized when migrated,
+         * they are not used before.
+         */
+        ht->old_array = ht->array;
+        ht->old_max = ht->max;
+        ht->migrated = 0;
+        ht->max = ht->max * 2 + 1;
+        ht->array = apr_palloc(ht->pool, sizeof(*ht->array) * (ht->max + 1));
+        return;
+    }
+
     new_max = ht->max * 2 + 1;
     new_array = alloc_array(ht, new_max);
     for (hi = apr_hash_first(NULL, ht); hi; hi = apr_hash_next(hi)) {
@@ -273,6 +555,268 @@ APR_DECLARE_NONSTD(unsigned int) apr_hashfunc_default(const char *char_key,
     return hashfunc_default(char_key, klen, 0);
 }
 
+/*
+ * The APR_HASH_FAST hash function, processing the key 16 bytes at a time
+ * and mixing them with the seed through 64x64->128 bit multiplications,
+ * as done by wyhash.
+ */
+#define FAST_K0 APR_UINT64_C(0xa0761d6478bd642f)
+#define FAST_K1 APR_UINT64_C(0xe7037ed1a0b428db)
+#define FAST_K2 APR_UINT64_C(0x8ebc6af09c88c6e3)
+
+static APR_INLINE apr_uint64_t fast_read64(const unsigned char *p)
+{
+    apr_uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static APR_INLINE apr_uint64_t fast_read32(const unsigned char *p)
+{
+    apr_uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Multiply, and fold the 128 bit result */
+static APR_INLINE apr_uint64_t fast_mix(apr_uint64_t a, apr_uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return (apr_uint64_t)r ^ (apr_uint64_t)(r >> 64);
+#else
+    apr_uint64_t ha = a >> 32, la = (apr_uint32_t)a;
+    apr_uint64_t hb = b >> 32, lb = (apr_uint32_t)b;
+    apr_uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    apr_uint64_t t = rl + (rm0 << 32), lo, hi;
+    unsigned int c = t < rl;
+
+    lo = t + (rm1 << 32);
+    c += lo < t;
+    hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    return lo ^ hi;
+#endif
+}
+
+static unsigned int hashfunc_fast(const char *char_key, apr_ssize_t *klen,
+                                  unsigned int seed)
+{
+    const unsigned char *p = (const unsigned char *)char_key;
+    apr_uint64_t h, a, b;
+    apr_size_t len;
+
+    if (*klen == APR_HASH_KEY_STRING) {
+        *klen = strlen(char_key);
+    }
+    len = *klen;
+
+    h = fast_mix(seed ^ FAST_K0, (apr_uint64_t)len ^ FAST_K1);
+    while (len > 16) {
+        h = fast_mix(fast_read64(p) ^ FAST_K1, fast_read64(p + 8) ^ h);
+        p += 16;
+        len -= 16;
+    }
+    /* The last (possibly overlapping) bytes */
+    if (len > 8) {
+        a = fast_read64(p);
+        b = fast_read64(p + len - 8);
+    }
+    else if (len >= 4) {
+        a = fast_read32(p);
+        b = fast_read32(p + len - 4);
+    }
+    else if (len) {
+        a = ((apr_uint64_t)p[0] << 16) | ((apr_uint64_t)p[len >> 1] << 8)
+            | p[len - 1];
+        b = 0;
+    }
+    else {
+        a = b = 0;
+    }
+    h = fast_mix(a ^ FAST_K1, b ^ h);
+    h = fast_mix(h ^ FAST_K2, (apr_uint64_t)*klen ^ FAST_K1);
+
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+static APR_INLINE unsigned int hash_key(const apr_hash_t *ht,
+                                        const void *key, apr_ssize_t *klen)
+{
+    if (ht->hash_func)
+        return ht->hash_func(key, klen);
+    else if (ht->flags & APR_HASH_FAST)
+        return hashfunc_fast(key, klen, ht->seed);
+    else
+        return hashfunc_default(key, klen, ht->seed);
+}
+
+/* Whether the hashes of two tables are the same for the same key */
+static APR_INLINE int same_hash(const apr_hash_t *ht1, const apr_hash_t *ht2)
+{
+    if (ht1->hash_func || ht2->hash_func)
+        return ht1->hash_func == ht2->hash_func;
+    return ht1->seed == ht2->seed
+           && (ht1->flags & APR_HASH_FAST) == (ht2->flags & APR_HASH_FAST);
+}
+
+/*
+ * Flat tables, probing the groups of control bytes quadratically (the
+ * number of groups being a power of two, all of them are visited).
+ */
+
+static apr_hash_entry_t *flat_find(const apr_hash_t *ht,
+                                   const void *key, apr_ssize_t klen,
+                                   unsigned int hash)
+{
+    unsigned int gmask = ht->max / GROUP_WIDTH;
+    unsigned int g = HASH_H1(hash, gmask), n = 0;
+
+    for (;;) {
+        const unsigned char *ctrl = ht->ctrl + g * GROUP_WIDTH;
+        group_mask_t mask = group_match(ctrl, HASH_H2(hash));
+
+        while (mask) {
+            apr_hash_entry_t *he = &ht->slots[g * GROUP_WIDTH
+                                              + group_first(mask)];
+            if (he->hash == hash
+                && he->klen == klen
+                && memcmp(he->key, key, klen) == 0)
+                return he;
+            mask &= mask - 1;
+        }
+        /* The key would be here if it existed */
+        if (group_match(ctrl, CTRL_EMPTY)) {
+            return NULL;
+        }
+        g = (g + ++n) & gmask;
+    }
+}
+
+/* The first empty or deleted slot on the probing path */
+static unsigned int flat_find_free(const apr_hash_t *ht, unsigned int hash)
+{
+    unsigned int gmask = ht->max / GROUP_WIDTH;
+    unsigned int g = HASH_H1(hash, gmask), n = 0;
+
+    for (;;) {
+        group_mask_t mask = group_match_free(ht->ctrl + g * GROUP_WIDTH);
+        if (mask) {
+            return g * GROUP_WIDTH + group_first(mask);
+        }
+        g = (g + ++n) & gmask;
+    }
+}
+
+static void flat_resize(apr_hash_t *ht, unsigned int capacity)
+{
+    unsigned char *old_ctrl = ht->ctrl;
+    apr_hash_entry_t *old_slots = ht->slots;
+    unsigned int i, j, old_capacity = ht->max + 1;
+
+    flat_alloc(ht, capacity);
+    for (i = 0; i < old_capacity; i++) {
+        if (CTRL_IS_FULL(old_ctrl[i])) {
+            j = flat_find_free(ht, old_slots[i].hash);
+            ht->ctrl[j] = old_ctrl[i];
+            ht->slots[j] = old_slots[i];
+        }
+    }
+}
+
+/*
+ * Drop the tombstones without reallocating: mark the full slots deleted and
+ * the deleted ones empty, then put each (formerly full) entry back where it
+ * belongs, possibly swapping it with another entry still to be placed.
+ */
+static void flat_purge(apr_hash_t *ht)
+{
+    unsigned int capacity = ht->max + 1;
+    unsigned int i, j;
+
+    for (i = 0; i < capacity; i++) {
+        ht->ctrl[i] = CTRL_IS_FULL(ht->ctrl[i]) ? CTRL_DELETED : CTRL_EMPTY;
+    }
+    for (i = 0; i < capacity; i++) {
+        apr_hash_entry_t tmp;
+
+        if (ht->ctrl[i] != CTRL_DELETED) {
+            continue;
+        }
+        j = flat_find_free(ht, ht->slots[i].hash);
+        if (j / GROUP_WIDTH == i / GROUP_WIDTH) {
+            /* Already in the first possible group */
+            ht->ctrl[i] = HASH_H2(ht->slots[i].hash);
+        }
+        else if (ht->ctrl[j] == CTRL_EMPTY) {
+            ht->ctrl[j] = HASH_H2(ht->slots[i].hash);
+            ht->slots[j] = ht->slots[i];
+            ht->ctrl[i] = CTRL_EMPTY;
+        }
+        else {
+            ht->ctrl[j] = HASH_H2(ht->slots[i].hash);
+            tmp = ht->slots[j];
+            ht->slots[j] = ht->slots[i];
+            ht->slots[i] = tmp;
+            /* Now place the swapped entry */
+            i--;
+        }
+    }
+    ht->growth_left = FLAT_MAX_LOAD(capacity) - ht->count;
+}
+
+/* Add an entry for a key known not to be in the table */
+static apr_hash_entry_t *flat_insert(apr_hash_t *ht, const void *key,
+                                     apr_ssize_t klen, unsigned int hash)
+{
+    apr_hash_entry_t *he;
+    unsigned int i;
+
+    i = flat_find_free(ht, hash);
+    if (!ht->growth_left && ht->ctrl[i] == CTRL_EMPTY) {
+        unsigned int capacity = ht->max + 1;
+
+        /* Grow if more than 7/16 full, otherwise there are enough
+         * tombstones to reclaim.
+         */
+        if (ht->count >= FLAT_MAX_LOAD(capacity) / 2) {
+            flat_resize(ht, capacity * 2);
+        }
+        else {
+            flat_purge(ht);
+        }
+        i = flat_find_free(ht, hash);
+    }
+    if (ht->ctrl[i] == CTRL_EMPTY) {
+        ht->growth_left--;
+    }
+    ht->ctrl[i] = HASH_H2(hash);
+    ht->count++;
+
+    he = &ht->slots[i];
+    he->next = NULL;
+    he->hash = hash;
+    he->key  = key;
+    he->klen = klen;
+    return he;
+}
+
+static void flat_delete(apr_hash_t *ht, apr_hash_entry_t *he)
+{
+    unsigned int i = (unsigned int)(he - ht->slots);
+
+    /* No probing went past a group with an empty slot, so the slot can be
+     * emptied rather than become a tombstone in this case.
+     */
+    if (group_match(ht->ctrl + i / GROUP_WIDTH * GROUP_WIDTH, CTRL_EMPTY)) {
+        ht->ctrl[i] = CTRL_EMPTY;
+        ht->growth_left++;
+    }
+    else {
+        ht->ctrl[i] = CTRL_DELETED;
+    }
+    ht->count--;
+}
+
 /*
  * This is where we keep the details of the hash function and control
  * the maximum collision rate.
@@ -280,24 +824,32 @@ APR_DECLARE_NONSTD(unsigned int) apr_hashfunc_default(const char *char_key,
  * If val is non-NULL it creates and initializes a new hash entry if
  * there isn't already one there; it returns an updatable pointer so
  * that hash entries can be removed.
+ *
+ * Only writers (migrate set) advance the incremental expansion, so that
+ * lookups don't modify the table.
  */
 
 static apr_hash_entry_t **find_entry(apr_hash_t *ht,
                                      const void *key,
                                      apr_ssize_t klen,
-                                     const void *val)
+                                     const void *val,
+                                     int migrate)
 {
     apr_hash_entry_t **hep, *he;
     unsigned int hash;
 
-    if (ht->hash_func)
-        hash = ht->hash_func(key, &klen);
+    hash = hash_key(ht, key, &klen);
+
+    if (ht->old_array && migrate) {
+        migrate_buckets(ht, MIGRATE_STEP);
+    }
+    if (ht->old_array && (hash & ht->old_max) >= ht->migrated)
+        hep = &ht->old_array[hash & ht->old_max];
     else
-        hash = hashfunc_default(key, &klen, ht->seed);
+        hep = &ht->array[hash & ht->max];
 
     /* scan linked list */
-    for (hep = &ht->array[hash & ht->max], he = *hep;
-         he; hep = &he->next, he = *hep) {
+    for (he = *hep; he; hep = &he->next, he = *hep) {
         if (he->hash == hash
             && he->klen == klen
             && memcmp(he->key, key, klen) == 0)
@@ -328,6 +880,17 @@ APR_DECLARE(apr_hash_t *) apr_hash_copy(apr_pool_t *pool,
     apr_hash_entry_t *new_vals;
     unsigned int i, j;
 
+    if (orig->ctrl) {
+        ht = apr_palloc(pool, sizeof(apr_hash_t));
+        memcpy(ht, orig, sizeof(apr_hash_t));
+        ht->pool = pool;
+        ht->ctrl = apr_palloc(pool, orig->max + 1);
+        memcpy(ht->ctrl, orig->ctrl, orig->max + 1);
+        ht->slots = apr_palloc(pool, sizeof(*ht->slots) * (orig->max + 1));
+        memcpy(ht->slots, orig->slots, sizeof(*ht->slots) * (orig->max + 1));
+        return ht;
+    }
+
     ht = apr_palloc(pool, sizeof(apr_hash_t) +
                     sizeof(*ht->array) * (orig->max + 1) +
                     sizeof(apr_hash_entry_t) * orig->count);
@@ -336,15 +899,22 @@ APR_DECLARE(apr_hash_t *) apr_hash_copy(apr_pool_t *pool,
     ht->count = orig->count;
     ht->max = orig->max;
     ht->seed = orig->seed;
+    ht->flags = orig->flags;
     ht->hash_func = orig->hash_func;
     ht->array = (apr_hash_entry_t **)((char *)ht + sizeof(apr_hash_t));
+    ht->old_array = NULL;
+    ht->old_max = 0;
+    ht->migrated = 0;
+    ht->ctrl = NULL;
+    ht->slots = NULL;
+    ht->growth_left = 0;
 
     new_vals = (apr_hash_entry_t *)((char *)(ht) + sizeof(apr_hash_t) +
                                     sizeof(*ht->array) * (orig->max + 1));
     j = 0;
     for (i = 0; i <= ht->max; i++) {
         apr_hash_entry_t **new_entry = &(ht->array[i]);
-        apr_hash_entry_t *orig_entry = orig->array[i];
+        apr_hash_entry_t *orig_entry = bucket_first(orig, i);
         while (orig_entry) {
             *new_entry = &new_vals[j++];
             (*new_entry)->hash = orig_entry->hash;
@@ -352,7 +922,7 @@ APR_DECLARE(apr_hash_t *) apr_hash_copy(apr_pool_t *pool,
             (*new_entry)->klen = orig_entry->klen;
             (*new_entry)->val = orig_entry->val;
             new_entry = &((*new_entry)->next);
-            orig_entry = orig_entry->next;
+            orig_entry = bucket_skip(orig, orig_entry->next, i);
         }
         *new_entry = NULL;
     }
@@ -364,7 +934,12 @@ APR_DECLARE(void *) apr_hash_get(apr_hash_t *ht,
                                  apr_ssize_t klen)
 {
     apr_hash_entry_t *he;
-    he = *find_entry(ht, key, klen, NULL);
+    if (ht->ctrl) {
+        unsigned int hash = hash_key(ht, key, &klen);
+        he = flat_find(ht, key, klen, hash);
+    }
+    else
+        he = *find_entry(ht, key, klen, NULL, 0);
     if (he)
         return (void *)he->val;
     else
@@ -377,7 +952,20 @@ APR_DECLARE(void) apr_hash_set(apr_hash_t *ht,
                                const void *val)
 {
     apr_hash_entry_t **hep;
-    hep = find_entry(ht, key, klen, val);
+    if (ht->ctrl) {
+        unsigned int hash = hash_key(ht, key, &klen);
+        apr_hash_entry_t *he = flat_find(ht, key, klen, hash);
+        if (!he) {
+            if (val)
+                flat_insert(ht, key, klen, hash)->val = val;
+        }
+        else if (!val)
+            flat_delete(ht, he);
+        else
+            he->val = val;
+        return;
+    }
+    hep = find_entry(ht, key, klen, val, 1);
     if (*hep) {
         if (!val) {
             /* delete entry */
@@ -405,7 +993,16 @@ APR_DECLARE(void *) apr_hash_get_or_set(apr_hash_t *ht,
                                         const void *val)
 {
     apr_hash_entry_t **hep;
-    hep = find_entry(ht, key, klen, val);
+    if (ht->ctrl) {
+        unsigned int hash = hash_key(ht, key, &klen);
+        apr_hash_entry_t *he = flat_find(ht, key, klen, hash);
+        if (he)
+            return (void *)he->val;
+        if (val)
+            flat_insert(ht, key, klen, hash)->val = val;
+        return (void *)val;
+    }
+    hep = find_entry(ht, key, klen, val, val != NULL);
     if (*hep) {
         val = (*hep)->val;
         /* check that the collision rate isn't too high */
@@ -426,6 +1023,12 @@ APR_DECLARE(unsigned int) apr_hash_count(apr_hash_t *ht)
 APR_DECLARE(void) apr_hash_clear(apr_hash_t *ht)
 {
     apr_hash_index_t *hi;
+    if (ht->ctrl) {
+        memset(ht->ctrl, CTRL_EMPTY, ht->max + 1);
+        ht->count = 0;
+        ht->growth_left = FLAT_MAX_LOAD(ht->max + 1);
+        return;
+    }
     for (hi = apr_hash_first(NULL, ht); hi; hi = apr_hash_next(hi))
         apr_hash_set(ht, hi->this->key, hi->this->klen, NULL);
 }
@@ -452,7 +1055,9 @@ APR_DECLARE(apr_hash_t *) apr_hash_merge(apr_pool_t *p,
     apr_hash_entry_t *new_vals = NULL;
     apr_hash_entry_t *iter;
     apr_hash_entry_t *ent;
+    apr_hash_index_t hix, *hi;
     unsigned int i, j, k, hash;
+    int rehash;
 
 #if APR_POOL_DEBUG
     /* we don't copy keys and values, so it's necessary that
@@ -471,9 +1076,51 @@ APR_DECLARE(apr_hash_t *) apr_hash_merge(apr_pool_t *p,
     }
 #endif
 
+    hix.ht    = (apr_hash_t *)overlay;
+    hix.index = 0;
+    hix.this  = NULL;
+    hix.next  = NULL;
+
+    /* The result hashes like the base, the overlay's keys need not be
+     * hashed again if it's the same.
+     */
+    rehash = !same_hash(overlay, base);
+
+    if (base->ctrl) {
+        /* The result is flat too */
+        res = apr_hash_copy(p, base);
+        for (hi = apr_hash_next(&hix); hi; hi = apr_hash_next(hi)) {
+            iter = hi->this;
+            if (rehash)
+                hash = hash_key(res, iter->key, &iter->klen);
+            else
+                hash = iter->hash;
+            ent = flat_find(res, iter->key, iter->klen, hash);
+            if (!ent) {
+                ent = flat_insert(res, iter->key, iter->klen, hash);
+                ent->val = iter->val;
+            }
+            else if (merger) {
+                ent->val = (*merger)(p, iter->key, iter->klen,
+                                     iter->val, ent->val, data);
+            }
+            else {
+                ent->val = iter->val;
+            }
+        }
+        return res;
+    }
+
     res = apr_palloc(p, sizeof(apr_hash_t));
     res->pool = p;
     res->free = NULL;
+    res->old_array = NULL;
+    res->old_max = 0;
+    res->migrated = 0;
+    res->ctrl = NULL;
+    res->slots = NULL;
+    res->growth_left = 0;
+    res->flags = base->flags;
     res->hash_func = base->hash_func;
     res->count = base->count;
     res->max = (overlay->max > base->max) ? overlay->max : base->max;
@@ -488,7 +1135,8 @@ APR_DECLARE(apr_hash_t *) apr_hash_merge(apr_pool_t *p,
     }
     j = 0;
     for (k = 0; k <= base->max; k++) {
-        for (iter = base->array[k]; iter; iter = iter->next) {
+        for (iter = bucket_first(base, k); iter;
+             iter = bucket_skip(base, iter->next, k)) {
             i = iter->hash & res->max;
             new_vals[j].klen = iter->klen;
             new_vals[j].key = iter->key;
@@ -500,36 +1148,36 @@ APR_DECLARE(apr_hash_t *) apr_hash_merge(apr_pool_t *p,
         }
     }
 
-    for (k = 0; k <= overlay->max; k++) {
-        for (iter = overlay->array[k]; iter; iter = iter->next) {
-            if (res->hash_func)
-                hash = res->hash_func(iter->key, &iter->klen);
-            else
-                hash = hashfunc_default(iter->key, &iter->klen, res->seed);
-            i = hash & res->max;
-            for (ent = res->array[i]; ent; ent = ent->next) {
-                if ((ent->klen == iter->klen) &&
-                    (memcmp(ent->key, iter->key, iter->klen) == 0)) {
-                    if (merger) {
-                        ent->val = (*merger)(p, iter->key, iter->klen,
-                                             iter->val, ent->val, data);
-                    }
-                    else {
-                        ent->val = iter->val;
-                    }
-                    break;
+    for (hi = apr_hash_next(&hix); hi; hi = apr_hash_next(hi)) {
+        iter = hi->this;
+        if (rehash)
+            hash = hash_key(res, iter->key, &iter->klen);
+        else
+            hash = iter->hash;
+        i = hash & res->max;
+        for (ent = res->array[i]; ent; ent = ent->next) {
+            if ((ent->hash == hash) &&
+                (ent->klen == iter->klen) &&
+                (memcmp(ent->key, iter->key, iter->klen) == 0)) {
+                if (merger) {
+                    ent->val = (*merger)(p, iter->key, iter->klen,
+                                         iter->val, ent->val, data);
                 }
+                else {
+                    ent->val = iter->val;
+                }
+                break;
             }
-            if (!ent) {
-                new_vals[j].klen = iter->klen;
-                new_vals[j].key = iter->key;
-                new_vals[j].val = iter->val;
-                new_vals[j].hash = hash;
-                new_vals[j].next = res->array[i];
-                res->array[i] = &new_vals[j];
-                res->count++;
-                j++;
-            }
+        }
+        if (!ent) {
+            new_vals[j].klen = iter->klen;
+            new_vals[j].key = iter->key;
+            new_vals[j].val = iter->val;
+            new_vals[j].hash = hash;
+            new_vals[j].next = res->array[i];
+            res->array[i] = &new_vals[j];
+            res->count++;
+            j++;
         }
     }
     return res;
@@ -355,8 +355,126 @@ struct apr_table_t {
     apr_uint32_t index_initialized;
     int index_first[TABLE_HASH_SIZE];
     int index_last[TABLE_HASH_SIZE];
+    /* A full (case-insensitive) hash index, for large tables.  It's
+     * built once the table has TABLE_HINDEX_MIN entries, then:
+     *   - hindex_first[bucket] is the offset of the first entry whose
+     *     key hashes to this bucket, or -1 if there is none
+     *   - hindex_last[bucket] is the offset of the last one
+     *   - hindex_next[i] is the offset of the next entry in the bucket
+     *     of entry i, or -1
+     * so the entries of a bucket are chained in order.
+     */
+    int *hindex_first;
+    int *hindex_last;
+    int *hindex_next;
+    int hindex_nalloc;          /* of hindex_next */
+    unsigned int hindex_bits;   /* 2^bits buckets */
 };
 
+#define TABLE_HINDEX_MIN 64
+#define TABLE_HINDEX_MIN_BITS 7
+
+/* Case-insensitive hash of a key, as folded by CASE_MASK */
+static APR_INLINE unsigned int table_hindex_bucket(const apr_table_t *t,
+                                                   const char *key)
+{
+    const unsigned char *k = (const unsigned char *)key;
+    apr_uint32_t hash = 0;
+
+    while (*k) {
+        hash = hash * 33 + (*k++ & (unsigned char)CASE_MASK);
+    }
+    /* Fibonacci hashing, for the high bits to depend on all the others */
+    return (apr_uint32_t)(hash * 0x9E3779B1U) >> (32 - t->hindex_bits);
+}
+
+static void table_hindex_link(apr_table_t *t, int i)
+{
+    apr_table_entry_t *elt = ((apr_table_entry_t *) t->a.elts) + i;
+    unsigned int bucket;
+
+    t->hindex_next[i] = -1;
+    if (!elt->key) {
+        return;
+    }
+    bucket = table_hindex_bucket(t, elt->key);
+    if (t->hindex_first[bucket] < 0) {
+        t->hindex_first[bucket] = i;
+    }
+    else {
+        t->hindex_next[t->hindex_last[bucket]] = i;
+    }
+    t->hindex_last[bucket] = i;
+}
+
+/* (Re)build the hash index of all the entries, growing it as needed */
+static void table_hindex_build(apr_table_t *t)
+{
+    unsigned int bits = TABLE_HINDEX_MIN_BITS;
+    int i;
+
+    while ((1u << bits) < 2u * (unsigned int)t->a.nelts) {
+        bits++;
+    }
+    if (!t->hindex_first || bits > t->hindex_bits) {
+        t->hindex_bits = bits;
+        t->hindex_first = apr_palloc(t->a.pool, sizeof(int) << bits);
+        t->hindex_last = apr_palloc(t->a.pool, sizeof(int) << bits);
+    }
+    if (t->hindex_nalloc < t->a.nalloc) {
+        t->hindex_nalloc = t->a.nalloc;
+        t->hindex_next = apr_palloc(t->a.pool,
+                                    sizeof(int) * t->hindex_nalloc);
+    }
+    memset(t->hindex_first, 0xff, sizeof(int) << t->hindex_bits);
+    for (i = 0; i < t->a.nelts; i++) {
+        table_hindex_link(t, i);
+    }
+}
+
+/* Index the entry just pushed, or all of them once there are enough */
+static APR_INLINE void table_hindex_push(apr_table_t *t)
+{
+    if (t->hindex_first) {
+        if (t->a.nelts > t->hindex_nalloc
+                || (unsigned int)t->a.nelts > (1u << t->hindex_bits)) {
+            table_hindex_build(t);
+        }
+        else {
+            table_hindex_link(t, t->a.nelts - 1);
+        }
+    }
+    else if (t->a.nelts >= TABLE_HINDEX_MIN) {
+        table_hindex_build(t);
+    }
+}
+
+static apr_table_entry_t *table_hindex_find(const apr_table_t *t,
+                                            const char *key,
+                                            apr_uint32_t checksum)
+{
+    apr_table_entry_t *elts = (apr_table_entry_t *) t->a.elts;
+    int i;
+
+    for (i = t->hindex_first[table_hindex_bucket(t, key)]; i >= 0;
+         i = t->hindex_next[i]) {
+        if ((checksum == elts[i].key_checksum) &&
+            !strcasecmp(elts[i].key, key)) {
+            return &elts[i];
+        }
+    }
+    return NULL;
+}
+
+static APR_INLINE void table_hindex_init(apr_table_t *t)
+{
+    t->hindex_first = NULL;
+    t->hindex_last = NULL;
+    t->hindex_next = NULL;
+    t->hindex_nalloc = 0;
+    t->hindex_bits = 0;
+}
+
 /* keep state for apr_table_getm() */
 typedef struct
 {
@@ -406,6 +524,7 @@ APR_DECLARE(apr_table_t *) apr_table_make(apr_pool_t *p, int nelts)
     t->creator = __builtin_return_address(0);
 #endif
     t->index_initialized = 0;
+    table_hindex_init(t);
     return t;
 }
 
@@ -428,6 +547,10 @@ APR_DECLARE(apr_table_t *) apr_table_copy(apr_pool_t *p, const apr_table_t *t)
     memcpy(new->index_first, t->index_first, sizeof(int) * TABLE_HASH_SIZE);
     memcpy(new->index_last, t->index_last, sizeof(int) * TABLE_HASH_SIZE);
     new->index_initialized = t->index_initialized;
+    table_hindex_init(new);
+    if (t->hindex_first) {
+        table_hindex_build(new);
+    }
     return new;
 }
 
@@ -460,12 +583,18 @@ static void table_reindex(apr_table_t *t)
             TABLE_SET_INDEX_INITIALIZED(t, hash);
         }
     }
+    if (t->hindex_first || t->a.nelts >= TABLE_HINDEX_MIN) {
+        table_hindex_build(t);
+    }
 }
 
 APR_DECLARE(void) apr_table_clear(apr_table_t *t)
 {
     t->a.nelts = 0;
     t->index_initialized = 0;
+    if (t->hindex_first) {
+        memset(t->hindex_first, 0xff, sizeof(int) << t->hindex_bits);
+    }
 }
 
 APR_DECLARE(const char *) apr_table_get(const apr_table_t *t, const char *key)
@@ -484,6 +613,10 @@ APR_DECLARE(const char *) apr_table_get(const apr_table_t *t, const char *key)
         return NULL;
     }
     COMPUTE_KEY_CHECKSUM(key, checksum);
+    if (t->hindex_first) {
+        next_elt = table_hindex_find(t, key, checksum);
+        return next_elt ? next_elt->val : NULL;
+    }
     next_elt = ((apr_table_entry_t *) t->a.elts) + t->index_first[hash];;
     end_elt = ((apr_table_entry_t *) t->a.elts) + t->index_last[hash];
 
@@ -517,6 +650,14 @@ APR_DECLARE(void) apr_table_set(apr_table_t *t, const char *key,
     end_elt = ((apr_table_entry_t *) t->a.elts) + t->index_last[hash];
     table_end =((apr_table_entry_t *) t->a.elts) + t->a.nelts;
 
+    /* Start from the first match, if any */
+    if (t->hindex_first) {
+        next_elt = table_hindex_find(t, key, checksum);
+        if (!next_elt) {
+            goto add_new_elt;
+        }
+    }
+
     for (; next_elt <= end_elt; next_elt++) {
 	if ((checksum == next_elt->key_checksum) &&
             !strcasecmp(next_elt->key, key)) {
@@ -567,6 +708,7 @@ add_new_elt:
     next_elt->key = apr_pstrdup(t->a.pool, key);
     next_elt->val = apr_pstrdup(t->a.pool, val);
     next_elt->key_checksum = checksum;
+    table_hindex_push(t);
 }
 
 APR_DECLARE(void) apr_table_setn(apr_table_t *t, const char *key,
@@ -589,6 +731,14 @@ APR_DECLARE(void) apr_table_setn(apr_table_t *t, const char *key,
     end_elt = ((apr_table_entry_t *) t->a.elts) + t->index_last[hash];
     table_end =((apr_table_entry_t *) t->a.elts) + t->a.nelts;
 
+    /* Start from the first match, if any */
+    if (t->hindex_first) {
+        next_elt = table_hindex_find(t, key, checksum);
+        if (!next_elt) {
+            goto add_new_elt;
+        }
+    }
+
     for (; next_elt <= end_elt; next_elt++) {
 	if ((checksum == next_elt->key_checksum) &&
             !strcasecmp(next_elt->key, key)) {
@@ -639,6 +789,7 @@ add_new_elt:
     next_elt->key = (char *)key;
     next_elt->val = (char *)val;
     next_elt->key_checksum = checksum;
+    table_hindex_push(t);
 }
 
 APR_DECLARE(void) apr_table_unset(apr_table_t *t, const char *key)
@@ -658,6 +809,14 @@ APR_DECLARE(void) apr_table_unset(apr_table_t *t, const char *key)
     next_elt = ((apr_table_entry_t *) t->a.elts) + t->index_first[hash];
     end_elt = ((apr_table_entry_t *) t->a.elts) + t->index_last[hash];
     must_reindex = 0;
+
+    /* Start from the first match, if any */
+    if (t->hindex_first) {
+        next_elt = table_hindex_find(t, key, checksum);
+        if (!next_elt) {
+            return;
+        }
+    }
     for (; next_elt <= end_elt; next_elt++) {
 	if ((checksum == next_elt->key_checksum) &&
             !strcasecmp(next_elt->key, key)) {
@@ -713,6 +872,14 @@ APR_DECLARE(void) apr_table_merge(apr_table_t *t, const char *key,
     next_elt = ((apr_table_entry_t *) t->a.elts) + t->index_first[hash];
     end_elt = ((apr_table_entry_t *) t->a.elts) + t->index_last[hash];
 
+    /* Start from the first match, if any */
+    if (t->hindex_first) {
+        next_elt = table_hindex_find(t, key, checksum);
+        if (!next_elt) {
+            goto add_new_elt;
+        }
+    }
+
     for (; next_elt <= end_elt; next_elt++) {
 	if ((checksum == next_elt->key_checksum) &&
             !strcasecmp(next_elt->key, key)) {
@@ -730,6 +897,7 @@ add_new_elt:
     next_elt->key = apr_pstrdup(t->a.pool, key);
     next_elt->val = apr_pstrdup(t->a.pool, val);
     next_elt->key_checksum = checksum;
+    table_hindex_push(t);
 }
 
 APR_DECLARE(void) apr_table_mergen(apr_table_t *t, const char *key,
@@ -768,6 +936,14 @@ APR_DECLARE(void) apr_table_mergen(apr_table_t *t, const char *key,
     next_elt = ((apr_table_entry_t *) t->a.elts) + t->index_first[hash];;
     end_elt = ((apr_table_entry_t *) t->a.elts) + t->index_last[hash];
 
+    /* Start from the first match, if any */
+    if (t->hindex_first) {
+        next_elt = table_hindex_find(t, key, checksum);
+        if (!next_elt) {
+            goto add_new_elt;
+        }
+    }
+
     for (; next_elt <= end_elt; next_elt++) {
 	if ((checksum == next_elt->key_checksum) &&
             !strcasecmp(next_elt->key, key)) {
@@ -785,6 +961,7 @@ add_new_elt:
     next_elt->key = (char *)key;
     next_elt->val = (char *)val;
     next_elt->key_checksum = checksum;
+    table_hindex_push(t);
 }
 
 APR_DECLARE(void) apr_table_add(apr_table_t *t, const char *key,
@@ -805,6 +982,7 @@ APR_DECLARE(void) apr_table_add(apr_table_t *t, const char *key,
     elts->key = apr_pstrdup(t->a.pool, key);
     elts->val = apr_pstrdup(t->a.pool, val);
     elts->key_checksum = checksum;
+    table_hindex_push(t);
 }
 
 APR_DECLARE(void) apr_table_addn(apr_table_t *t, const char *key,
@@ -838,6 +1016,7 @@ APR_DECLARE(void) apr_table_addn(apr_table_t *t, const char *key,
     elts->key = (char *)key;
     elts->val = (char *)val;
     elts->key_checksum = checksum;
+    table_hindex_push(t);
 }
 
 APR_DECLARE(apr_table_t *) apr_table_overlay(apr_pool_t *p,
@@ -868,6 +1047,7 @@ APR_DECLARE(apr_table_t *) apr_table_overlay(apr_pool_t *p,
     res->a.pool = p;
     copy_array_hdr_core(&res->a, &overlay->a);
     apr_array_cat(&res->a, &base->a);
+    table_hindex_init(res);
     table_reindex(res);
     return res;
 }
@@ -971,7 +1151,18 @@ APR_DECLARE(int) apr_table_vdo(apr_table_do_callback_fn_t *comp,
         if (argp) {
             /* Scan for entries that match the next key */
             int hash = TABLE_HASH(argp);
-            if (TABLE_INDEX_IS_INITIALIZED(t, hash)) {
+            if (t->hindex_first) {
+                apr_uint32_t checksum;
+                COMPUTE_KEY_CHECKSUM(argp, checksum);
+                for (i = t->hindex_first[table_hindex_bucket(t, argp)];
+                     rv && (i >= 0); i = t->hindex_next[i]) {
+                    if ((checksum == elts[i].key_checksum) &&
+                        !strcasecmp(elts[i].key, argp)) {
+                        rv = (*comp) (rec, elts[i].key, elts[i].val);
+                    }
+                }
+            }
+            else if (TABLE_INDEX_IS_INITIALIZED(t, hash)) {
                 apr_uint32_t checksum;
                 COMPUTE_KEY_CHECKSUM(argp, checksum);
                 for (i = t->index_first[hash];
@@ -1215,19 +1406,23 @@ static void apr_table_cat(apr_table_t *t, const apr_table_t *s)
         memcpy(t->index_first,s->index_first,sizeof(int) * TABLE_HASH_SIZE);
         memcpy(t->index_last, s->index_last, sizeof(int) * TABLE_HASH_SIZE);
         t->index_initialized = s->index_initialized;
-        return;
     }
-
-    for (idx = 0; idx < TABLE_HASH_SIZE; ++idx) {
-        if (TABLE_INDEX_IS_INITIALIZED(s, idx)) {
-            t->index_last[idx] = s->index_last[idx] + n;
-            if (!TABLE_INDEX_IS_INITIALIZED(t, idx)) {
-                t->index_first[idx] = s->index_first[idx] + n;
+    else {
+        for (idx = 0; idx < TABLE_HASH_SIZE; ++idx) {
+            if (TABLE_INDEX_IS_INITIALIZED(s, idx)) {
+                t->index_last[idx] = s->index_last[idx] + n;
+                if (!TABLE_INDEX_IS_INITIALIZED(t, idx)) {
+                    t->index_first[idx] = s->index_first[idx] + n;
+                }
             }
         }
+
+        t->index_initialized |= s->index_initialized;
     }
 
-    t->index_initialized |= s->index_initialized;
+    if (t->hindex_first || t->a.nelts >= TABLE_HINDEX_MIN) {
+        table_hindex_build(t);
+    }
 }
 
 APR_DECLARE(void) apr_table_overlap(apr_table_t *a, const apr_table_t *b,
@@ -31,6 +31,7 @@ const struct testlist {
     {testenv},
     {testescape},
     {testfile},
+    {testfileaio},
     {testfilecopy},
     {testfileinfo},
     {testflock},
@@ -88,6 +89,7 @@ const struct testlist {
     {testrmm},
     {testdbm},
     {testqueue},
+    {testthreadpool},
     {testreslist},
     {testlfsabi},
     {testskiplist},
@@ -24,10 +24,16 @@
  *
  *   ./echod &
  *   ./sockperf
+ *
+ * When run as "./sockperf -u" it instead times how many UDP datagrams
+ * per second go through the loopback interface, one at a time with
+ * apr_socket_sendto()/apr_socket_recvfrom() and then in batches with
+ * apr_socket_sendmmsg()/apr_socket_recvmmsg(); no echod is needed.
  */
 
 #include <stdio.h>
 #include <stdlib.h>  /* for atexit() */
+#include <string.h>
 
 #include "apr.h"
 #include "apr_network_io.h"
@@ -36,6 +42,10 @@
 #define MAX_ITERS    10
 #define TEST_SIZE  1024
 
+#define UDP_DATAGRAMS 200000
+#define UDP_SIZE         512
+#define UDP_BATCH         32
+
 struct testSet {
     char c;
     apr_size_t size;
@@ -209,6 +219,118 @@ static apr_status_t runTest(struct testSet *ts, struct testResult *res,
     return rv;
 }
 
+static apr_status_t udpTest(int batched, apr_time_t *t, apr_pool_t *pool)
+{
+    apr_socket_t *rsock, *ssock;
+    apr_sockaddr_t *to;
+    apr_sockmsg_t msgs[UDP_BATCH];
+    char *sbuf, *rbufs;
+    apr_size_t done = 0;
+    apr_time_t start;
+    apr_status_t rv;
+    int i;
+
+    rv = apr_sockaddr_info_get(&to, "127.0.0.1", APR_INET, testPort + 1, 0,
+                               pool);
+    if (rv != APR_SUCCESS) {
+        reportError("Unable to get loopback address", rv, pool);
+        return rv;
+    }
+    if ((rv = apr_socket_create(&rsock, APR_INET, SOCK_DGRAM,
+                                APR_PROTO_UDP, pool)) != APR_SUCCESS
+            || (rv = apr_socket_create(&ssock, APR_INET, SOCK_DGRAM,
+                                       APR_PROTO_UDP, pool)) != APR_SUCCESS) {
+        reportError("Unable to create UDP socket", rv, pool);
+        return rv;
+    }
+    apr_socket_opt_set(rsock, APR_SO_REUSEADDR, 1);
+    apr_socket_opt_set(rsock, APR_SO_RCVBUF, UDP_BATCH * UDP_SIZE * 8);
+    rv = apr_socket_bind(rsock, to);
+    if (rv != APR_SUCCESS) {
+        reportError("Unable to bind UDP socket", rv, pool);
+        return rv;
+    }
+    apr_socket_timeout_set(rsock, apr_time_from_sec(5));
+
+    sbuf = apr_palloc(pool, UDP_SIZE);
+    memset(sbuf, 'u', UDP_SIZE);
+    rbufs = apr_palloc(pool, UDP_BATCH * UDP_SIZE);
+
+    start = apr_time_now();
+    while (done < UDP_DATAGRAMS) {
+        apr_size_t n, len;
+
+        /* Never send more than a batch ahead, so nothing gets dropped */
+        if (batched) {
+            for (i = 0; i < UDP_BATCH; i++) {
+                msgs[i].addr = to;
+                msgs[i].buf = sbuf;
+                msgs[i].len = UDP_SIZE;
+                msgs[i].segsize = 0;
+            }
+            rv = apr_socket_sendmmsg(ssock, msgs, UDP_BATCH, 0, &n);
+            if (rv == APR_SUCCESS && n != UDP_BATCH) {
+                rv = APR_EGENERAL;
+            }
+            for (n = 0; rv == APR_SUCCESS && n < UDP_BATCH; ) {
+                apr_size_t nrecv;
+
+                for (i = 0; i < UDP_BATCH; i++) {
+                    msgs[i].addr = NULL;
+                    msgs[i].buf = rbufs + i * UDP_SIZE;
+                    msgs[i].len = UDP_SIZE;
+                }
+                rv = apr_socket_recvmmsg(rsock, msgs, UDP_BATCH - n, 0,
+                                         &nrecv);
+                n += nrecv;
+            }
+        }
+        else {
+            for (i = 0; rv == APR_SUCCESS && i < UDP_BATCH; i++) {
+                len = UDP_SIZE;
+                rv = apr_socket_sendto(ssock, to, 0, sbuf, &len);
+            }
+            for (i = 0; rv == APR_SUCCESS && i < UDP_BATCH; i++) {
+                len = UDP_SIZE;
+                rv = apr_socket_recv(rsock, rbufs, &len);
+            }
+        }
+        if (rv != APR_SUCCESS) {
+            reportError("Unable to send or receive datagrams", rv, pool);
+            return rv;
+        }
+        done += UDP_BATCH;
+    }
+    *t = apr_time_now() - start;
+
+    apr_socket_close(ssock);
+    apr_socket_close(rsock);
+    return APR_SUCCESS;
+}
+
+static int runUdpTests(apr_pool_t *pool)
+{
+    const char *names[] = { "sendto/recv", "sendmmsg/recvmmsg" };
+    int batched;
+
+    for (batched = 0; batched < 2; batched++) {
+        apr_time_t t;
+
+        if (udpTest(batched, &t, pool) != APR_SUCCESS) {
+            /* error already reported */
+            return 1;
+        }
+        if (t <= 0) {
+            t = 1;
+        }
+        printf("%18s: %d datagrams of %d bytes in %6" APR_TIME_T_FMT
+               " ms, %8" APR_TIME_T_FMT " datagrams/s\n",
+               names[batched], UDP_DATAGRAMS, UDP_SIZE, t / 1000,
+               (apr_time_t)UDP_DATAGRAMS * APR_USEC_PER_SEC / t);
+    }
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
     apr_pool_t *pool;
@@ -224,6 +346,10 @@ int main(int argc, char **argv)
 
     apr_pool_create(&pool, NULL);
 
+    if (argc > 1 && strcmp(argv[1], "-u") == 0) {
+        return runUdpTests(pool);
+    }
+
     results = (struct testResult *)apr_pcalloc(pool,
                                         sizeof(*results) * nTests);
 
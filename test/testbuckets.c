@@ -18,6 +18,7 @@
 #include "testutil.h"
 #include "apr_buckets.h"
 #include "apr_strings.h"
+#include "apr_thread_proc.h"
 
 static void test_create(abts_case *tc, void *data)
 {
@@ -555,6 +556,330 @@ static void test_truncfile(abts_case *tc, void *data)
     apr_bucket_alloc_destroy(ba);
 }
 
+/* File buckets read at their offsets, the shared file's offset is left
+ * alone and an APR_FOPEN_XTHREAD file is not reopened. */
+static void test_sharedfile(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_file_t *f;
+    apr_bucket *e;
+    apr_off_t off = 0;
+    apr_size_t len;
+    apr_status_t rv;
+    char buf[1];
+
+    f = make_test_file(tc, "sharedfile.bin", "hello, brave world\n");
+    apr_file_close(f);
+    rv = apr_file_open(&f, "sharedfile.bin",
+                       APR_FOPEN_READ | APR_FOPEN_XTHREAD, 0, p);
+    APR_ASSERT_SUCCESS(tc, "open shared file", rv);
+
+    apr_brigade_insert_file(bb, f, 7, 12, p);
+    apr_brigade_insert_file(bb, f, 0, 7, p);
+    for (e = APR_BRIGADE_FIRST(bb); e != APR_BRIGADE_SENTINEL(bb);
+         e = APR_BUCKET_NEXT(e)) {
+        apr_bucket_file_enable_mmap(e, 0);
+    }
+
+    rv = apr_file_seek(f, APR_SET, &off);
+    APR_ASSERT_SUCCESS(tc, "seek shared file", rv);
+
+    flatten_match(tc, "shared file read", bb, "brave world\nhello, ");
+
+    rv = apr_file_seek(f, APR_CUR, &off);
+    APR_ASSERT_SUCCESS(tc, "get shared file offset", rv);
+    len = 1;
+    if (apr_file_pread(f, buf, &len, 0) != APR_ENOTIMPL) {
+        ABTS_INT_EQUAL(tc, 0, (int)off);
+    }
+
+    apr_file_close(f);
+    apr_file_remove("sharedfile.bin", p);
+    apr_brigade_destroy(bb);
+    apr_bucket_alloc_destroy(ba);
+}
+
+/* Reading a file bucket advises to read a large window ahead, once */
+static void test_file_readahead(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_size_t flen = 2 * APR_BUCKET_BUFF_SIZE + 10, len;
+    char *contents = apr_palloc(p, flen + 1);
+    apr_bucket_file *a;
+    apr_bucket *e;
+    apr_file_t *f;
+    const char *str;
+    apr_status_t rv;
+
+    memset(contents, 'x', flen);
+    contents[flen] = '\0';
+    f = make_test_file(tc, "readahead.bin", contents);
+    apr_file_close(f);
+
+    rv = apr_file_open(&f, "readahead.bin", APR_FOPEN_READ, 0, p);
+    APR_ASSERT_SUCCESS(tc, "open file", rv);
+    e = apr_bucket_file_create(f, 0, flen, p, ba);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    apr_bucket_file_enable_mmap(e, 0);
+    a = e->data;
+    ABTS_TRUE(tc, a->readahead == 0);
+
+    rv = apr_bucket_read(e, &str, &len, APR_BLOCK_READ);
+    APR_ASSERT_SUCCESS(tc, "read first bucket", rv);
+    ABTS_SIZE_EQUAL(tc, APR_BUCKET_BUFF_SIZE, len);
+    if (a->readahead < 0) {
+        ABTS_NOT_IMPL(tc, "apr_file_advise");
+    }
+    else {
+        ABTS_TRUE(tc, a->readahead == (apr_off_t)flen);
+        e = APR_BUCKET_NEXT(e);
+        rv = apr_bucket_read(e, &str, &len, APR_BLOCK_READ);
+        APR_ASSERT_SUCCESS(tc, "read second bucket", rv);
+        ABTS_TRUE(tc, a->readahead == (apr_off_t)flen);
+    }
+    flatten_match(tc, "file read ahead", bb, contents);
+    apr_brigade_cleanup(bb);
+    apr_file_close(f);
+
+    /* Not for randomly accessed files */
+    rv = apr_file_open(&f, "readahead.bin",
+                       APR_FOPEN_READ | APR_FOPEN_RANDOM, 0, p);
+    APR_ASSERT_SUCCESS(tc, "open random file", rv);
+    e = apr_bucket_file_create(f, 0, flen, p, ba);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    a = e->data;
+    ABTS_TRUE(tc, a->readahead == -1);
+    apr_brigade_cleanup(bb);
+    apr_file_close(f);
+
+    apr_file_remove("readahead.bin", p);
+    apr_brigade_destroy(bb);
+    apr_bucket_alloc_destroy(ba);
+}
+
+static void test_file_seek_read(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_size_t flen = 2 * APR_BUCKET_BUFF_SIZE + 10, len, off;
+    char *contents = apr_palloc(p, flen + 1);
+    apr_bucket_file *a;
+    apr_bucket *e;
+    apr_file_t *f;
+    const char *str;
+    apr_status_t rv;
+    int prefetch;
+
+    for (off = 0; off < flen; off++) {
+        contents[off] = 'a' + (char)(off * 7 % 26);
+    }
+    contents[flen] = '\0';
+    f = make_test_file(tc, "seekread.bin", contents);
+    apr_file_close(f);
+
+    rv = apr_file_open(&f, "seekread.bin", APR_FOPEN_READ, 0, p);
+    APR_ASSERT_SUCCESS(tc, "open file", rv);
+
+    /* As if apr_file_pread() was not implemented */
+    for (prefetch = 0; prefetch <= 1; prefetch++) {
+        e = apr_bucket_file_create(f, 0, flen, p, ba);
+        APR_BRIGADE_INSERT_TAIL(bb, e);
+        apr_bucket_file_enable_mmap(e, 0);
+        if (prefetch) {
+            apr_bucket_file_set_prefetch(e, 65536);
+        }
+        a = e->data;
+        a->can_pread = 0;
+
+        off = 0;
+        while (!APR_BRIGADE_EMPTY(bb) && off < flen) {
+            e = APR_BRIGADE_FIRST(bb);
+            rv = apr_bucket_read(e, &str, &len, APR_BLOCK_READ);
+            APR_ASSERT_SUCCESS(tc, "read file bucket", rv);
+            ABTS_TRUE(tc, len > 0);
+            if (rv != APR_SUCCESS || len == 0) {
+                break;
+            }
+            ABTS_TRUE(tc, memcmp(str, contents + off, len) == 0);
+            off += len;
+            apr_bucket_delete(e);
+        }
+        ABTS_SIZE_EQUAL(tc, flen, off);
+        ABTS_TRUE(tc, APR_BRIGADE_EMPTY(bb));
+        apr_brigade_cleanup(bb);
+    }
+
+    apr_file_close(f);
+    apr_file_remove("seekread.bin", p);
+    apr_brigade_destroy(bb);
+    apr_bucket_alloc_destroy(ba);
+}
+
+static void test_file_prefetch(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_size_t flen = 300000, len, off, i;
+    apr_size_t expect[] = { 8192, 16384, 32768, 65536, 65536 };
+    char *contents = apr_palloc(p, flen + 1);
+    apr_bucket_file *a;
+    apr_bucket *e, *e2;
+    apr_file_t *f;
+    const char *str, *str2;
+    apr_status_t rv;
+
+    for (i = 0; i < flen; i++) {
+        contents[i] = 'a' + (char)(i * 7 % 26);
+    }
+    contents[flen] = '\0';
+    f = make_test_file(tc, "prefetch.bin", contents);
+    apr_file_close(f);
+
+    rv = apr_file_open(&f, "prefetch.bin", APR_FOPEN_READ, 0, p);
+    APR_ASSERT_SUCCESS(tc, "open file", rv);
+    e = apr_bucket_file_create(f, 0, flen, p, ba);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    apr_bucket_file_enable_mmap(e, 0);
+    rv = apr_bucket_file_set_prefetch(e, 65536);
+    APR_ASSERT_SUCCESS(tc, "set prefetch", rv);
+
+    /* The chunks grow while read sequentially */
+    off = i = 0;
+    while (!APR_BRIGADE_EMPTY(bb)) {
+        e = APR_BRIGADE_FIRST(bb);
+        rv = apr_bucket_read(e, &str, &len, APR_BLOCK_READ);
+        APR_ASSERT_SUCCESS(tc, "read prefetched bucket", rv);
+        ABTS_TRUE(tc, APR_BUCKET_IS_HEAP(e));
+        if (i < sizeof(expect) / sizeof(expect[0])) {
+            ABTS_SIZE_EQUAL(tc, expect[i++], len);
+        }
+        ABTS_TRUE(tc, off + len <= flen);
+        ABTS_TRUE(tc, memcmp(str, contents + off, len) == 0);
+        off += len;
+        apr_bucket_delete(e);
+    }
+    ABTS_SIZE_EQUAL(tc, flen, off);
+
+    /* Split buckets share the chunk */
+    e = apr_bucket_file_create(f, 0, flen, p, ba);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    apr_bucket_file_enable_mmap(e, 0);
+    apr_bucket_file_set_prefetch(e, 65536);
+    apr_bucket_split(e, 100);
+    e2 = APR_BUCKET_NEXT(e);
+    a = e2->data;
+    rv = apr_bucket_read(e, &str, &len, APR_BLOCK_READ);
+    APR_ASSERT_SUCCESS(tc, "read first split bucket", rv);
+    ABTS_SIZE_EQUAL(tc, 100, len);
+    ABTS_PTR_NOTNULL(tc, a->prefetch);
+    rv = apr_bucket_read(e2, &str2, &len, APR_BLOCK_READ);
+    APR_ASSERT_SUCCESS(tc, "read second split bucket", rv);
+    ABTS_SIZE_EQUAL(tc, 8192 - 100, len);
+    ABTS_PTR_EQUAL(tc, str + 100, str2);
+    flatten_match(tc, "file prefetch", bb, contents);
+    apr_brigade_cleanup(bb);
+    apr_file_close(f);
+
+    apr_file_remove("prefetch.bin", p);
+    apr_brigade_destroy(bb);
+    apr_bucket_alloc_destroy(ba);
+}
+
+#define BENCH_SIZE      (8 * 1024 * 1024)
+#define BENCH_ROUNDS    4
+
+/* Stream the file through a brigade, returning the number of reads */
+static apr_size_t bench_file_read(abts_case *tc, apr_bucket_brigade *bb,
+                                  apr_file_t *f, apr_size_t prefetch)
+{
+    apr_bucket *e;
+    apr_size_t len, total = 0, reads = 0;
+    const char *str;
+    apr_status_t rv;
+
+    e = apr_bucket_file_create(f, 0, BENCH_SIZE, p, bb->bucket_alloc);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    apr_bucket_file_enable_mmap(e, 0);
+    if (prefetch) {
+        apr_bucket_file_set_prefetch(e, prefetch);
+    }
+    while (!APR_BRIGADE_EMPTY(bb)) {
+        e = APR_BRIGADE_FIRST(bb);
+        rv = apr_bucket_read(e, &str, &len, APR_BLOCK_READ);
+        if (rv != APR_SUCCESS) {
+            APR_ASSERT_SUCCESS(tc, "read file bucket", rv);
+            break;
+        }
+        total += len;
+        reads++;
+        apr_bucket_delete(e);
+    }
+    ABTS_SIZE_EQUAL(tc, BENCH_SIZE, total);
+    apr_brigade_cleanup(bb);
+
+    return reads;
+}
+
+static apr_time_t bench_since(apr_time_t start)
+{
+    apr_time_t t = apr_time_now() - start;
+
+    return t > 0 ? t : 1;
+}
+
+/* MB per second */
+#define BENCH_RATE(t) \
+    ((apr_uint64_t)BENCH_SIZE * BENCH_ROUNDS / (apr_uint64_t)(t))
+
+static void test_file_prefetch_bench(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_size_t reads[2] = { 0, 0 };
+    apr_time_t start, t[2];
+    apr_file_t *f;
+    char *contents;
+    apr_status_t rv;
+    int round;
+
+    contents = malloc(BENCH_SIZE + 1);
+    memset(contents, 'x', BENCH_SIZE);
+    contents[BENCH_SIZE] = '\0';
+    f = make_test_file(tc, "prefetch.bin", contents);
+    apr_file_close(f);
+    free(contents);
+
+    rv = apr_file_open(&f, "prefetch.bin", APR_FOPEN_READ, 0, p);
+    APR_ASSERT_SUCCESS(tc, "open file", rv);
+
+    start = apr_time_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        reads[0] += bench_file_read(tc, bb, f, 0);
+    }
+    t[0] = bench_since(start);
+
+    start = apr_time_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        reads[1] += bench_file_read(tc, bb, f, 1024 * 1024);
+    }
+    t[1] = bench_since(start);
+    ABTS_TRUE(tc, reads[1] < reads[0]);
+
+    abts_log_message("%d x %dMB: %" APR_SIZE_T_FMT " reads, %"
+                     APR_UINT64_T_FMT "MB/s; prefetching %" APR_SIZE_T_FMT
+                     " reads, %" APR_UINT64_T_FMT "MB/s",
+                     BENCH_ROUNDS, BENCH_SIZE / (1024 * 1024),
+                     reads[0] / BENCH_ROUNDS, BENCH_RATE(t[0]),
+                     reads[1] / BENCH_ROUNDS, BENCH_RATE(t[1]));
+
+    apr_file_close(f);
+    apr_file_remove("prefetch.bin", p);
+    apr_brigade_destroy(bb);
+    apr_bucket_alloc_destroy(ba);
+}
+
 static const char hello[] = "hello, world";
 
 static void test_partition(abts_case *tc, void *data)
@@ -657,6 +982,204 @@ static void test_iovec(abts_case *tc, void *data)
     apr_bucket_alloc_destroy(ba);
 }
 
+/* A connected pair of TCP sockets over the loopback */
+static apr_status_t socket_pair(abts_case *tc, apr_socket_t **ls,
+                                apr_socket_t **cs, apr_socket_t **ss)
+{
+    apr_sockaddr_t *sa;
+    apr_status_t rv;
+
+    rv = apr_sockaddr_info_get(&sa, "127.0.0.1", APR_INET, 0, 0, p);
+    APR_ASSERT_SUCCESS(tc, "get loopback address", rv);
+    rv = apr_socket_create(ls, APR_INET, SOCK_STREAM, APR_PROTO_TCP, p);
+    APR_ASSERT_SUCCESS(tc, "create listening socket", rv);
+    rv = apr_socket_bind(*ls, sa);
+    APR_ASSERT_SUCCESS(tc, "bind listening socket", rv);
+    rv = apr_socket_listen(*ls, 1);
+    APR_ASSERT_SUCCESS(tc, "listen", rv);
+    rv = apr_socket_addr_get(&sa, APR_LOCAL, *ls);
+    APR_ASSERT_SUCCESS(tc, "get listening address", rv);
+    rv = apr_socket_create(cs, APR_INET, SOCK_STREAM, APR_PROTO_TCP, p);
+    APR_ASSERT_SUCCESS(tc, "create client socket", rv);
+    rv = apr_socket_connect(*cs, sa);
+    APR_ASSERT_SUCCESS(tc, "connect", rv);
+    rv = apr_socket_accept(ss, *ls, p);
+    APR_ASSERT_SUCCESS(tc, "accept", rv);
+    apr_socket_timeout_set(*cs, apr_time_from_sec(5));
+
+    return rv;
+}
+
+static void test_splice(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_socket_t *ls, *cs, *ss;
+    apr_file_t *readp, *writep;
+    apr_bucket *e;
+    char buf[32];
+    apr_size_t len;
+    apr_status_t rv;
+
+    rv = socket_pair(tc, &ls, &cs, &ss);
+    if (rv != APR_SUCCESS)
+        return;
+
+    /* What the client sends comes back through a SOCKET bucket */
+    len = 5;
+    rv = apr_socket_send(cs, "hello", &len);
+    APR_ASSERT_SUCCESS(tc, "send", rv);
+
+    e = apr_bucket_socket_create(ss, ba);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    len = sizeof(buf);
+    rv = apr_bucket_splice(e, ss, &len, APR_BLOCK_READ);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_bucket_splice() not implemented");
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "splice socket bucket", rv);
+    ABTS_SIZE_EQUAL(tc, 5, len);
+    ABTS_PTR_EQUAL(tc, e, APR_BRIGADE_FIRST(bb));
+    ABTS_ASSERT(tc, "still a socket bucket", APR_BUCKET_IS_SOCKET(e));
+
+    len = sizeof(buf);
+    rv = apr_bucket_splice(e, ss, &len, APR_NONBLOCK_READ);
+    ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_EAGAIN(rv));
+    ABTS_SIZE_EQUAL(tc, 0, len);
+
+    len = 5;
+    rv = apr_socket_recv(cs, buf, &len);
+    APR_ASSERT_SUCCESS(tc, "recv", rv);
+    ABTS_STR_EQUAL(tc, "hello", apr_pstrmemdup(p, buf, len));
+
+    /* And the content of a pipe through a PIPE bucket */
+    rv = apr_file_pipe_create_pools(&readp, &writep, APR_FULL_BLOCK, p, p);
+    APR_ASSERT_SUCCESS(tc, "create pipe", rv);
+    len = 5;
+    rv = apr_file_write(writep, "world", &len);
+    APR_ASSERT_SUCCESS(tc, "write pipe", rv);
+    apr_file_close(writep);
+
+    apr_brigade_cleanup(bb);
+    e = apr_bucket_pipe_create(readp, ba);
+    APR_BRIGADE_INSERT_TAIL(bb, e);
+    len = sizeof(buf);
+    rv = apr_bucket_splice(e, ss, &len, APR_BLOCK_READ);
+    APR_ASSERT_SUCCESS(tc, "splice pipe bucket", rv);
+    ABTS_SIZE_EQUAL(tc, 5, len);
+    ABTS_ASSERT(tc, "still a pipe bucket", APR_BUCKET_IS_PIPE(e));
+
+    len = sizeof(buf);
+    rv = apr_bucket_splice(e, ss, &len, APR_BLOCK_READ);
+    APR_ASSERT_SUCCESS(tc, "splice pipe bucket at EOF", rv);
+    ABTS_SIZE_EQUAL(tc, 0, len);
+    ABTS_ASSERT(tc, "empty bucket at EOF", !APR_BUCKET_IS_PIPE(e)
+                                           && e->length == 0);
+
+    len = 5;
+    rv = apr_socket_recv(cs, buf, &len);
+    APR_ASSERT_SUCCESS(tc, "recv", rv);
+    ABTS_STR_EQUAL(tc, "world", apr_pstrmemdup(p, buf, len));
+
+    /* The socket's timeout applies even with a blocking pipe */
+    rv = apr_file_pipe_create_pools(&readp, &writep, APR_FULL_BLOCK, p, p);
+    APR_ASSERT_SUCCESS(tc, "create pipe", rv);
+    apr_socket_timeout_set(ss, apr_time_from_msec(100));
+    len = sizeof(buf);
+    rv = apr_socket_splice_out(ss, readp, &len, 0);
+    ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+    ABTS_SIZE_EQUAL(tc, 0, len);
+    apr_socket_timeout_set(ss, -1);
+    apr_file_close(writep);
+    apr_file_close(readp);
+
+    /* Other buckets are to be read */
+    apr_brigade_cleanup(bb);
+    e = apr_bucket_immortal_create("foo", 3, ba);
+    len = sizeof(buf);
+    ABTS_INT_EQUAL(tc, APR_ENOTIMPL, apr_bucket_splice(e, ss, &len,
+                                                        APR_BLOCK_READ));
+    apr_bucket_destroy(e);
+
+    apr_socket_close(cs);
+    apr_socket_close(ss);
+    apr_socket_close(ls);
+    apr_brigade_destroy(bb);
+    apr_bucket_alloc_destroy(ba);
+}
+
+#define ZC_SIZE (64 * 1024)
+
+static void test_zerocopy(abts_case *tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_zerocopy_t *zc;
+    apr_socket_t *ls, *cs, *ss;
+    apr_uint32_t sent, completed;
+    apr_bucket *e;
+    struct iovec vec;
+    char *buf = apr_palloc(p, ZC_SIZE);
+    apr_size_t len, total, held;
+    apr_status_t rv;
+
+    rv = socket_pair(tc, &ls, &cs, &ss);
+    if (rv != APR_SUCCESS)
+        return;
+
+    rv = apr_socket_opt_set(ss, APR_SO_ZEROCOPY, 1);
+    if (rv != APR_SUCCESS) {
+        ABTS_NOT_IMPL(tc, "APR_SO_ZEROCOPY");
+        goto cleanup;
+    }
+    apr_socket_timeout_set(ss, apr_time_from_sec(5));
+
+    memset(buf, 'z', ZC_SIZE);
+    e = apr_bucket_heap_create(buf, ZC_SIZE, NULL, ba);
+    vec.iov_base = ((apr_bucket_heap *)e->data)->base;
+    vec.iov_len = ZC_SIZE;
+
+    rv = apr_socket_sendv(ss, &vec, 1, &len);
+    APR_ASSERT_SUCCESS(tc, "zero-copy sendv", rv);
+    ABTS_ASSERT(tc, "nothing sent", len > 0);
+
+    rv = apr_socket_zerocopy_reap(ss, &sent, &completed, 0);
+    ABTS_ASSERT(tc, "reap",
+                rv == APR_SUCCESS || APR_STATUS_IS_EAGAIN(rv));
+    ABTS_INT_EQUAL(tc, 1, sent);
+
+    /* The bucket is held until the kernel is done with its data */
+    zc = apr_bucket_zerocopy_create(ss, p, ba);
+    rv = apr_bucket_zerocopy_hold(zc, e);
+    APR_ASSERT_SUCCESS(tc, "hold", rv);
+
+    total = 0;
+    while (total < len) {
+        apr_size_t n = ZC_SIZE;
+        rv = apr_socket_recv(cs, buf, &n);
+        APR_ASSERT_SUCCESS(tc, "recv", rv);
+        if (rv != APR_SUCCESS)
+            break;
+        total += n;
+    }
+    ABTS_SIZE_EQUAL(tc, len, total);
+
+    rv = apr_bucket_zerocopy_reap(zc, 1, &held);
+    APR_ASSERT_SUCCESS(tc, "reap held buckets", rv);
+    ABTS_SIZE_EQUAL(tc, 0, held);
+
+    /* Transient buckets can't be held */
+    e = apr_bucket_transient_create("foo", 3, ba);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, apr_bucket_zerocopy_hold(zc, e));
+    apr_bucket_destroy(e);
+
+cleanup:
+    apr_socket_close(cs);
+    apr_socket_close(ss);
+    apr_socket_close(ls);
+    apr_bucket_alloc_destroy(ba);
+}
+
 abts_suite *testbuckets(abts_suite *suite)
 {
     suite = ADD_SUITE(suite);
@@ -674,10 +1197,17 @@ abts_suite *testbuckets(abts_suite *suite)
     abts_run_test(suite, test_insertfile, NULL);
     abts_run_test(suite, test_manyfile, NULL);
     abts_run_test(suite, test_truncfile, NULL);
+    abts_run_test(suite, test_sharedfile, NULL);
+    abts_run_test(suite, test_file_readahead, NULL);
+    abts_run_test(suite, test_file_seek_read, NULL);
+    abts_run_test(suite, test_file_prefetch, NULL);
+    abts_run_test(suite, test_file_prefetch_bench, NULL);
     abts_run_test(suite, test_partition, NULL);
     abts_run_test(suite, test_write_split, NULL);
     abts_run_test(suite, test_write_putstrs, NULL);
     abts_run_test(suite, test_iovec, NULL);
+    abts_run_test(suite, test_splice, NULL);
+    abts_run_test(suite, test_zerocopy, NULL);
 
     return suite;
 }
@@ -20,6 +20,7 @@
 
 #include "apr_encode.h"
 #include "apr_strings.h"
+#include "apr_time.h"
 
 #include "abts.h"
 #include "testutil.h"
@@ -1101,6 +1102,288 @@ static void test_decode_errors(abts_case * tc, void *data)
     ABTS_SIZE_EQUAL(tc, 2, len);
 }
 
+/* Bit at a time references, for the lengths the vector code handles */
+static char *reference_base64(apr_pool_t *pool, const unsigned char *src,
+                              apr_size_t slen, int flags)
+{
+    const char *base = (flags & APR_ENCODE_BASE64URL) ?
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" :
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char *dest = apr_palloc(pool, (slen + 2) / 3 * 4 + 1), *d = dest;
+    apr_size_t bit;
+
+    for (bit = 0; bit < slen * 8; bit += 6) {
+        unsigned int v = 0, j;
+
+        for (j = bit; j < bit + 6; j++) {
+            v <<= 1;
+            if (j < slen * 8) {
+                v |= (src[j / 8] >> (7 - j % 8)) & 1;
+            }
+        }
+        *d++ = base[v];
+    }
+    while (!(flags & APR_ENCODE_NOPADDING) && (d - dest) % 4) {
+        *d++ = '=';
+    }
+    *d = '\0';
+    return dest;
+}
+
+static char *reference_base16(apr_pool_t *pool, const unsigned char *src,
+                              apr_size_t slen, int flags)
+{
+    const char *base = (flags & APR_ENCODE_LOWER) ? "0123456789abcdef" :
+                                                    "0123456789ABCDEF";
+    char *dest = apr_palloc(pool, slen * 3 + 1), *d = dest;
+    apr_size_t i;
+
+    for (i = 0; i < slen; i++) {
+        if ((flags & APR_ENCODE_COLON) && i) {
+            *d++ = ':';
+        }
+        *d++ = base[src[i] >> 4];
+        *d++ = base[src[i] & 0xf];
+    }
+    *d = '\0';
+    return dest;
+}
+
+#define LONG_MAX_LEN 200
+
+/* Lengths around the sizes of the vector blocks */
+static void test_base64_long(abts_case * tc, void *data)
+{
+    static const int all_flags[] = {
+        APR_ENCODE_NONE, APR_ENCODE_BASE64URL, APR_ENCODE_NOPADDING,
+        APR_ENCODE_BASE64URL | APR_ENCODE_NOPADDING
+    };
+    apr_pool_t *pool;
+    unsigned char src[LONG_MAX_LEN], udest[LONG_MAX_LEN + 1];
+    char *dest = (char *)udest;
+    apr_size_t slen, len, i;
+    apr_status_t rv;
+    int f;
+
+    apr_pool_create(&pool, NULL);
+
+    for (i = 0; i < sizeof(src); i++) {
+        src[i] = (unsigned char)(i * 131 + (i >> 3) * 7 + 1);
+    }
+
+    for (f = 0; f < (int)(sizeof(all_flags) / sizeof(all_flags[0])); f++) {
+        int flags = all_flags[f];
+
+        for (slen = 0; slen <= sizeof(src); slen++) {
+            const char *target = reference_base64(pool, src, slen, flags);
+            const char *enc;
+            char *bad;
+            apr_size_t tlen = strlen(target);
+
+            enc = apr_pencode_base64_binary(pool, src, slen, flags, &len);
+            ABTS_STR_EQUAL(tc, target, enc);
+            ABTS_SIZE_EQUAL(tc, tlen, len);
+
+            /* the char interface reads the same bytes */
+            enc = apr_pencode_base64(pool, (const char *)src, slen, flags,
+                                     &len);
+            ABTS_STR_EQUAL(tc, target, enc);
+
+            rv = apr_decode_base64_binary(udest, target, tlen, 0, &len);
+            APR_ASSERT_SUCCESS(tc, "decode base64", rv);
+            ABTS_SIZE_EQUAL(tc, slen, len);
+            ABTS_INT_EQUAL(tc, 0, memcmp(src, udest, slen));
+
+            rv = apr_decode_base64(dest, target, tlen, 0, &len);
+            APR_ASSERT_SUCCESS(tc, "decode base64", rv);
+            ABTS_SIZE_EQUAL(tc, slen, len);
+            ABTS_INT_EQUAL(tc, 0, memcmp(src, udest, slen));
+
+            /* a bad char anywhere is found, and decoding stops there */
+            bad = apr_pstrdup(pool, target);
+            for (i = 0; i < tlen && bad[i] != '='; i += 7) {
+                bad[i] = '!';
+                rv = apr_decode_base64_binary(udest, bad, tlen, 0, &len);
+                ABTS_INT_EQUAL(tc, i % 4 == 1 ? APR_EINCOMPLETE : APR_BADCH,
+                               rv);
+                rv = apr_decode_base64_binary(udest, bad, tlen,
+                                              APR_ENCODE_RELAXED, &len);
+                ABTS_SIZE_EQUAL(tc, i / 4 * 3 + (i % 4 ? i % 4 - 1 : 0), len);
+                bad[i] = target[i];
+            }
+        }
+    }
+
+    /* both alphabets at once */
+    rv = apr_decode_base64_binary(udest, "+/-_+/-_+/-_+/-_+/-_+/-_+/-_+/-_",
+                                  APR_ENCODE_STRING, 0, &len);
+    APR_ASSERT_SUCCESS(tc, "decode mixed alphabets", rv);
+    ABTS_SIZE_EQUAL(tc, 24, len);
+    for (i = 0; i < len; i += 3) {
+        ABTS_INT_EQUAL(tc, 0xfb, udest[i]);
+        ABTS_INT_EQUAL(tc, 0xff, udest[i + 1]);
+        ABTS_INT_EQUAL(tc, 0xbf, udest[i + 2]);
+    }
+
+    apr_pool_destroy(pool);
+}
+
+static void test_base16_long(abts_case * tc, void *data)
+{
+    static const int all_flags[] = {
+        APR_ENCODE_NONE, APR_ENCODE_LOWER, APR_ENCODE_COLON,
+        APR_ENCODE_LOWER | APR_ENCODE_COLON
+    };
+    apr_pool_t *pool;
+    unsigned char src[LONG_MAX_LEN], udest[LONG_MAX_LEN + 1];
+    char *dest = (char *)udest;
+    apr_size_t slen, len, i;
+    apr_status_t rv;
+    int f;
+
+    apr_pool_create(&pool, NULL);
+
+    for (i = 0; i < sizeof(src); i++) {
+        src[i] = (unsigned char)(i * 151 + (i >> 4) * 3);
+    }
+
+    for (f = 0; f < (int)(sizeof(all_flags) / sizeof(all_flags[0])); f++) {
+        int flags = all_flags[f];
+
+        for (slen = 0; slen <= sizeof(src); slen++) {
+            const char *target = reference_base16(pool, src, slen, flags);
+            const char *enc;
+            char *bad;
+            apr_size_t tlen = strlen(target);
+
+            enc = apr_pencode_base16_binary(pool, src, slen, flags, &len);
+            ABTS_STR_EQUAL(tc, target, enc);
+            ABTS_SIZE_EQUAL(tc, tlen, len);
+
+            enc = apr_pencode_base16(pool, (const char *)src, slen, flags,
+                                     &len);
+            ABTS_STR_EQUAL(tc, target, enc);
+
+            rv = apr_decode_base16_binary(udest, target, tlen,
+                                          flags & APR_ENCODE_COLON, &len);
+            APR_ASSERT_SUCCESS(tc, "decode base16", rv);
+            ABTS_SIZE_EQUAL(tc, slen, len);
+            ABTS_INT_EQUAL(tc, 0, memcmp(src, udest, slen));
+
+            rv = apr_decode_base16(dest, target, tlen,
+                                   flags & APR_ENCODE_COLON, &len);
+            APR_ASSERT_SUCCESS(tc, "decode base16", rv);
+            ABTS_SIZE_EQUAL(tc, slen, len);
+            ABTS_INT_EQUAL(tc, 0, memcmp(src, udest, slen));
+
+            /* decoding stops where the prefix before a bad char would */
+            bad = apr_pstrdup(pool, target);
+            for (i = 0; i < tlen; i += 5) {
+                apr_size_t plen;
+                apr_status_t prv;
+
+                bad[i] = 'g';
+                rv = apr_decode_base16_binary(udest, bad, tlen,
+                                              flags & APR_ENCODE_COLON, &len);
+                ABTS_TRUE(tc, rv == APR_BADCH || rv == APR_EINCOMPLETE);
+                rv = apr_decode_base16_binary(udest, bad, tlen,
+                                              (flags & APR_ENCODE_COLON)
+                                              | APR_ENCODE_RELAXED, &len);
+                prv = apr_decode_base16_binary(udest, target, i,
+                                               flags & APR_ENCODE_COLON,
+                                               &plen);
+                ABTS_INT_EQUAL(tc, prv, rv);
+                ABTS_SIZE_EQUAL(tc, plen, len);
+                bad[i] = target[i];
+            }
+        }
+
+        /* colons are no hex digits */
+        if (!(flags & APR_ENCODE_COLON)) {
+            const char *target = reference_base16(pool, src, sizeof(src),
+                                                  APR_ENCODE_COLON);
+
+            rv = apr_decode_base16_binary(udest, target, APR_ENCODE_STRING,
+                                          0, &len);
+            ABTS_INT_EQUAL(tc, APR_BADCH, rv);
+        }
+    }
+
+    apr_pool_destroy(pool);
+}
+
+#define BENCH_SIZE      (1024 * 1024)
+#define BENCH_ROUNDS    20
+
+static apr_time_t bench_since(apr_time_t start)
+{
+    apr_time_t t = apr_time_now() - start;
+
+    return t > 0 ? t : 1;
+}
+
+/* MB per second */
+#define BENCH_RATE(t) \
+    ((apr_uint64_t)BENCH_SIZE * BENCH_ROUNDS / (apr_uint64_t)(t))
+
+static void test_encode_bench(abts_case * tc, void *data)
+{
+    apr_pool_t *pool;
+    unsigned char *src, *udest;
+    char *enc64, *enc16;
+    apr_size_t len, len64, len16, i;
+    apr_time_t start, t[4];
+    int round;
+
+    apr_pool_create(&pool, NULL);
+
+    src = apr_palloc(pool, BENCH_SIZE);
+    udest = apr_palloc(pool, BENCH_SIZE);
+    for (i = 0; i < BENCH_SIZE; i++) {
+        src[i] = (unsigned char)(i * 2654435761u >> 13);
+    }
+    apr_encode_base64_binary(NULL, src, BENCH_SIZE, 0, &len);
+    enc64 = apr_palloc(pool, len);
+    apr_encode_base16_binary(NULL, src, BENCH_SIZE, 0, &len);
+    enc16 = apr_palloc(pool, len);
+
+    start = apr_time_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        apr_encode_base64_binary(enc64, src, BENCH_SIZE, 0, &len64);
+    }
+    t[0] = bench_since(start);
+
+    start = apr_time_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        apr_decode_base64_binary(udest, enc64, len64, 0, &len);
+    }
+    t[1] = bench_since(start);
+    ABTS_SIZE_EQUAL(tc, BENCH_SIZE, len);
+    ABTS_INT_EQUAL(tc, 0, memcmp(src, udest, BENCH_SIZE));
+
+    start = apr_time_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        apr_encode_base16_binary(enc16, src, BENCH_SIZE, 0, &len16);
+    }
+    t[2] = bench_since(start);
+
+    start = apr_time_now();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        apr_decode_base16_binary(udest, enc16, len16, 0, &len);
+    }
+    t[3] = bench_since(start);
+    ABTS_SIZE_EQUAL(tc, BENCH_SIZE, len);
+    ABTS_INT_EQUAL(tc, 0, memcmp(src, udest, BENCH_SIZE));
+
+    abts_log_message("%d x %dKB: base64 encode %" APR_UINT64_T_FMT "MB/s, "
+                     "decode %" APR_UINT64_T_FMT "MB/s; base16 encode %"
+                     APR_UINT64_T_FMT "MB/s, decode %" APR_UINT64_T_FMT "MB/s",
+                     BENCH_ROUNDS, BENCH_SIZE / 1024, BENCH_RATE(t[0]),
+                     BENCH_RATE(t[1]), BENCH_RATE(t[2]), BENCH_RATE(t[3]));
+
+    apr_pool_destroy(pool);
+}
+
 abts_suite *testencode(abts_suite * suite)
 {
     suite = ADD_SUITE(suite);
@@ -1119,6 +1402,9 @@ abts_suite *testencode(abts_suite * suite)
     abts_run_test(suite, test_decode_base16_binary, NULL);
     abts_run_test(suite, test_encode_errors, NULL);
     abts_run_test(suite, test_decode_errors, NULL);
+    abts_run_test(suite, test_base64_long, NULL);
+    abts_run_test(suite, test_base16_long, NULL);
+    abts_run_test(suite, test_encode_bench, NULL);
 
     return suite;
 }
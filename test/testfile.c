@@ -23,6 +23,7 @@
 #include "apr_lib.h"
 #include "apr_strings.h"
 #include "apr_thread_proc.h"
+#include "apr_portable.h"
 #include "testutil.h"
 
 #define DIRNAME "data"
@@ -2242,6 +2243,320 @@ static void test_append_buffered(abts_case *tc, void *data)
     apr_file_remove(fname, p);
 }
 
+static void test_pread_pwrite(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_file_t *f;
+    const char *fname = "data/testpread.dat";
+    apr_size_t nbytes;
+    apr_off_t off = 0;
+    char buf[64];
+
+    apr_file_remove(fname, p);
+
+    rv = apr_file_open(&f, fname,
+                       APR_FOPEN_READ | APR_FOPEN_WRITE | APR_FOPEN_CREATE,
+                       APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "create file", rv);
+
+    nbytes = 6;
+    rv = apr_file_pwrite(f, "abcdef", &nbytes, 0);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_file_pwrite");
+        apr_file_close(f);
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "pwrite", rv);
+    ABTS_SIZE_EQUAL(tc, 6, nbytes);
+
+    nbytes = 3;
+    rv = apr_file_pwrite(f, "XYZ", &nbytes, 10);
+    APR_ASSERT_SUCCESS(tc, "pwrite past the end", rv);
+
+    /* The file offset is left alone */
+    APR_ASSERT_SUCCESS(tc, "get offset", apr_file_seek(f, APR_CUR, &off));
+    ABTS_INT_EQUAL(tc, 0, (int)off);
+
+    nbytes = 4;
+    rv = apr_file_pread(f, buf, &nbytes, 2);
+    APR_ASSERT_SUCCESS(tc, "pread", rv);
+    ABTS_SIZE_EQUAL(tc, 4, nbytes);
+    ABTS_TRUE(tc, memcmp(buf, "cdef", 4) == 0);
+
+    nbytes = sizeof(buf);
+    rv = apr_file_pread(f, buf, &nbytes, 4);
+    APR_ASSERT_SUCCESS(tc, "pread to the end", rv);
+    ABTS_SIZE_EQUAL(tc, 9, nbytes);
+    ABTS_TRUE(tc, memcmp(buf, "ef\0\0\0\0XYZ", 9) == 0);
+
+    nbytes = sizeof(buf);
+    rv = apr_file_pread(f, buf, &nbytes, 13);
+    ABTS_INT_EQUAL(tc, APR_EOF, rv);
+    ABTS_SIZE_EQUAL(tc, 0, nbytes);
+
+    /* Still read from the start */
+    nbytes = 3;
+    rv = apr_file_read(f, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "read", rv);
+    ABTS_TRUE(tc, memcmp(buf, "abc", 3) == 0);
+
+    apr_file_close(f);
+    apr_file_remove(fname, p);
+}
+
+static void test_preadv_pwritev(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_file_t *f;
+    const char *fname = "data/testpreadv.dat";
+    struct iovec vec[3];
+    apr_size_t nbytes;
+    char a[4], b[2], c[8];
+
+    apr_file_remove(fname, p);
+
+    rv = apr_file_open(&f, fname,
+                       APR_FOPEN_READ | APR_FOPEN_WRITE | APR_FOPEN_CREATE,
+                       APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "create file", rv);
+
+    vec[0].iov_base = LINE1;
+    vec[0].iov_len = strlen(LINE1);
+    vec[1].iov_base = LINE2;
+    vec[1].iov_len = strlen(LINE2);
+    rv = apr_file_pwritev(f, vec, 2, 5, &nbytes);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_file_pwritev");
+        apr_file_close(f);
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "pwritev", rv);
+    ABTS_SIZE_EQUAL(tc, strlen(LINE1 LINE2), nbytes);
+
+    vec[0].iov_base = a;
+    vec[0].iov_len = sizeof(a);
+    vec[1].iov_base = b;
+    vec[1].iov_len = sizeof(b);
+    vec[2].iov_base = c;
+    vec[2].iov_len = sizeof(c);
+    rv = apr_file_preadv(f, vec, 3, 5, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "preadv", rv);
+    ABTS_SIZE_EQUAL(tc, sizeof(a) + sizeof(b) + sizeof(c), nbytes);
+    ABTS_TRUE(tc, memcmp(a, LINE1, sizeof(a)) == 0);
+    ABTS_TRUE(tc, memcmp(b, LINE1 + sizeof(a), sizeof(b)) == 0);
+    ABTS_TRUE(tc, memcmp(c, LINE1 + sizeof(a) + sizeof(b), sizeof(c)) == 0);
+
+    /* Short at the end */
+    rv = apr_file_preadv(f, vec, 3, 5 + strlen(LINE1 LINE2) - 5, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "preadv at the end", rv);
+    ABTS_SIZE_EQUAL(tc, 5, nbytes);
+
+    rv = apr_file_preadv(f, vec, 3, 5 + strlen(LINE1 LINE2), &nbytes);
+    ABTS_INT_EQUAL(tc, APR_EOF, rv);
+    ABTS_SIZE_EQUAL(tc, 0, nbytes);
+
+    apr_file_close(f);
+    file_contents_equal(tc, fname, "\0\0\0\0\0" LINE1 LINE2,
+                        5 + strlen(LINE1 LINE2));
+    apr_file_remove(fname, p);
+}
+
+/* The user buffer is bypassed, but stays consistent */
+static void test_pread_pwrite_buffered(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_file_t *f;
+    const char *fname = "data/testpread_buffered.dat";
+    apr_size_t nbytes;
+    apr_off_t off = 0;
+    char buf[64];
+
+    apr_file_remove(fname, p);
+
+    rv = apr_file_open(&f, fname,
+                       APR_FOPEN_READ | APR_FOPEN_WRITE | APR_FOPEN_CREATE
+                       | APR_FOPEN_BUFFERED, APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "create file", rv);
+
+    /* Pending data are written first */
+    rv = apr_file_puts("0123456789", f);
+    APR_ASSERT_SUCCESS(tc, "buffered write", rv);
+    nbytes = 4;
+    rv = apr_file_pread(f, buf, &nbytes, 3);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_file_pread");
+        apr_file_close(f);
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "pread", rv);
+    ABTS_SIZE_EQUAL(tc, 4, nbytes);
+    ABTS_TRUE(tc, memcmp(buf, "3456", 4) == 0);
+
+    /* Read ahead data are discarded when written */
+    rv = apr_file_seek(f, APR_SET, &off);
+    APR_ASSERT_SUCCESS(tc, "rewind", rv);
+    nbytes = 2;
+    rv = apr_file_read(f, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "buffered read", rv);
+    ABTS_TRUE(tc, memcmp(buf, "01", 2) == 0);
+    nbytes = 3;
+    rv = apr_file_pwrite(f, "abc", &nbytes, 4);
+    APR_ASSERT_SUCCESS(tc, "pwrite", rv);
+    nbytes = 6;
+    rv = apr_file_read(f, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "buffered read", rv);
+    ABTS_SIZE_EQUAL(tc, 6, nbytes);
+    ABTS_TRUE(tc, memcmp(buf, "23abc7", 6) == 0);
+
+    apr_file_close(f);
+    apr_file_remove(fname, p);
+}
+
+static void test_file_advise(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_file_t *f;
+    apr_size_t nbytes;
+    char buf[64];
+
+    /* Advisory, the file reads the same */
+    rv = apr_file_open(&f, FILENAME, APR_FOPEN_READ | APR_FOPEN_SEQUENTIAL,
+                       APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "open sequential file", rv);
+    ABTS_TRUE(tc, (apr_file_flags_get(f) & APR_FOPEN_SEQUENTIAL) != 0);
+    nbytes = sizeof(buf);
+    rv = apr_file_read(f, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "read sequential file", rv);
+    ABTS_SIZE_EQUAL(tc, strlen(TESTSTR), nbytes);
+    ABTS_TRUE(tc, memcmp(buf, TESTSTR, nbytes) == 0);
+
+    rv = apr_file_advise(f, 0, 0, APR_FADVISE_WILLNEED);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_file_advise");
+        apr_file_close(f);
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "advise willneed", rv);
+    rv = apr_file_advise(f, 4, 10, APR_FADVISE_DONTNEED);
+    APR_ASSERT_SUCCESS(tc, "advise dontneed", rv);
+    rv = apr_file_advise(f, 0, 0, APR_FADVISE_RANDOM);
+    APR_ASSERT_SUCCESS(tc, "advise random", rv);
+    rv = apr_file_advise(f, 0, 0, APR_FADVISE_NORMAL);
+    APR_ASSERT_SUCCESS(tc, "advise normal", rv);
+    rv = apr_file_advise(f, 0, 0, -1);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+    apr_file_close(f);
+
+    rv = apr_file_open(&f, FILENAME, APR_FOPEN_READ | APR_FOPEN_RANDOM,
+                       APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "open random file", rv);
+    nbytes = 4;
+    rv = apr_file_read(f, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "read random file", rv);
+    ABTS_TRUE(tc, memcmp(buf, TESTSTR, 4) == 0);
+    apr_file_close(f);
+}
+
+static void test_direct_io(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_file_t *f, *f2;
+    apr_os_file_t fd;
+    const char *fname = "data/testdirect.dat";
+    apr_size_t align, nbytes;
+    apr_off_t off = 0;
+    char *wbuf, *rbuf;
+
+    apr_file_remove(fname, p);
+
+    rv = apr_file_open(&f, fname,
+                       APR_FOPEN_READ | APR_FOPEN_WRITE | APR_FOPEN_CREATE
+                       | APR_FOPEN_DIRECT | APR_FOPEN_BUFFERED,
+                       APR_FPROT_OS_DEFAULT, p);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "APR_FOPEN_DIRECT");
+        return;
+    }
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+
+    rv = apr_file_open(&f, fname,
+                       APR_FOPEN_READ | APR_FOPEN_WRITE | APR_FOPEN_CREATE
+                       | APR_FOPEN_DIRECT,
+                       APR_FPROT_OS_DEFAULT, p);
+    if (rv == APR_EINVAL) {
+        /* e.g. tmpfs */
+        ABTS_NOT_IMPL(tc, "APR_FOPEN_DIRECT on this filesystem");
+        apr_file_remove(fname, p);
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "open direct file", rv);
+
+    rv = apr_file_alignment_get(&align, f);
+    APR_ASSERT_SUCCESS(tc, "get alignment", rv);
+    ABTS_TRUE(tc, align > 1 && (align & (align - 1)) == 0);
+
+    /* Can't be buffered afterwards either */
+    rv = apr_file_buffer_set(f, apr_palloc(p, 4096), 4096);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+    rv = apr_file_buffer_set(f, NULL, 0);
+    APR_ASSERT_SUCCESS(tc, "unbuffer direct file", rv);
+    rv = apr_os_file_get(&fd, f);
+    APR_ASSERT_SUCCESS(tc, "get direct file descriptor", rv);
+    rv = apr_os_file_put(&f2, &fd, APR_FOPEN_READ | APR_FOPEN_DIRECT
+                                    | APR_FOPEN_BUFFERED, p);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+
+    wbuf = apr_palloc_aligned(p, 2 * align, align);
+    rbuf = apr_palloc_aligned(p, 2 * align, align);
+    ABTS_PTR_NOTNULL(tc, wbuf);
+    ABTS_PTR_NOTNULL(tc, rbuf);
+    memset(wbuf, 'a', align);
+    memset(wbuf + align, 'b', align);
+
+    /* Misaligned buffer, length and offset */
+    nbytes = align;
+    rv = apr_file_write(f, wbuf + 1, &nbytes);
+    ABTS_INT_EQUAL(tc, APR_EMISALIGNED, rv);
+    ABTS_SIZE_EQUAL(tc, 0, nbytes);
+    ABTS_TRUE(tc, APR_STATUS_IS_EMISALIGNED(rv));
+    nbytes = align - 1;
+    rv = apr_file_write(f, wbuf, &nbytes);
+    ABTS_INT_EQUAL(tc, APR_EMISALIGNED, rv);
+    nbytes = align;
+    rv = apr_file_pwrite(f, wbuf, &nbytes, 1);
+    if (rv != APR_ENOTIMPL) {
+        ABTS_INT_EQUAL(tc, APR_EMISALIGNED, rv);
+    }
+
+    nbytes = 2 * align;
+    rv = apr_file_write(f, wbuf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "direct write", rv);
+    ABTS_SIZE_EQUAL(tc, 2 * align, nbytes);
+
+    rv = apr_file_seek(f, APR_SET, &off);
+    APR_ASSERT_SUCCESS(tc, "rewind", rv);
+    nbytes = 2 * align;
+    rv = apr_file_read(f, rbuf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "direct read", rv);
+    ABTS_SIZE_EQUAL(tc, 2 * align, nbytes);
+    ABTS_TRUE(tc, memcmp(rbuf, wbuf, 2 * align) == 0);
+
+    nbytes = align;
+    rv = apr_file_read(f, rbuf + 1, &nbytes);
+    ABTS_INT_EQUAL(tc, APR_EMISALIGNED, rv);
+
+    nbytes = align;
+    rv = apr_file_pread(f, rbuf, &nbytes, align);
+    if (rv != APR_ENOTIMPL) {
+        APR_ASSERT_SUCCESS(tc, "direct pread", rv);
+        ABTS_SIZE_EQUAL(tc, align, nbytes);
+        ABTS_TRUE(tc, memcmp(rbuf, wbuf + align, align) == 0);
+    }
+
+    apr_file_close(f);
+    apr_file_remove(fname, p);
+}
+
 abts_suite *testfile(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -2307,6 +2622,11 @@ abts_suite *testfile(abts_suite *suite)
     abts_run_test(suite, test_datasync_on_file, NULL);
     abts_run_test(suite, test_datasync_on_stream, NULL);
     abts_run_test(suite, test_append_buffered, NULL);
+    abts_run_test(suite, test_pread_pwrite, NULL);
+    abts_run_test(suite, test_preadv_pwritev, NULL);
+    abts_run_test(suite, test_pread_pwrite_buffered, NULL);
+    abts_run_test(suite, test_file_advise, NULL);
+    abts_run_test(suite, test_direct_io, NULL);
 
     return suite;
 }
@@ -0,0 +1,387 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apr_file_aio.h"
+#include "apr_file_io.h"
+#include "apr_poll.h"
+#include "apr_strings.h"
+#include "abts.h"
+#include "testutil.h"
+
+#define FILENAME "data/testfileaio.tmp"
+
+#define NUM_OPS  16
+#define OP_SIZE  4096
+
+static apr_uint32_t aio_flags[2] = { 0, APR_FILE_AIO_THREADS };
+
+static int completed;
+
+static void count_cb(apr_file_aio_op_t *op)
+{
+    completed++;
+}
+
+static apr_file_t *open_file(abts_case *tc, apr_int32_t flags)
+{
+    apr_file_t *f = NULL;
+    apr_status_t rv;
+
+    rv = apr_file_open(&f, FILENAME, APR_FOPEN_CREATE | APR_FOPEN_READ
+                       | APR_FOPEN_WRITE | APR_FOPEN_TRUNCATE
+                       | APR_FOPEN_DELONCLOSE | flags,
+                       APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "open test file", rv);
+    return f;
+}
+
+/* Reaps until nothing is pending, 10 seconds at most */
+static void reap_all(abts_case *tc, apr_file_aio_t *aio)
+{
+    apr_time_t deadline = apr_time_now() + apr_time_from_sec(10);
+    apr_status_t rv;
+
+    while (apr_file_aio_pending(aio) && apr_time_now() < deadline) {
+        rv = apr_file_aio_reap(aio, apr_time_from_sec(1), NULL);
+        ABTS_ASSERT(tc, "reap", rv == APR_SUCCESS || APR_STATUS_IS_TIMEUP(rv));
+    }
+    ABTS_INT_EQUAL(tc, 0, apr_file_aio_pending(aio));
+}
+
+static apr_file_aio_t *create_aio(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = NULL;
+    apr_uint32_t flags = *(apr_uint32_t *)data;
+    apr_status_t rv;
+
+    rv = apr_file_aio_create(&aio, NUM_OPS, flags, p);
+    APR_ASSERT_SUCCESS(tc, "create aio", rv);
+    if (flags & APR_FILE_AIO_THREADS) {
+        ABTS_ASSERT(tc, "not io_uring",
+                    strcmp(apr_file_aio_method_name(aio), "io_uring") != 0);
+    }
+    return aio;
+}
+
+static void test_read_write(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = create_aio(tc, data);
+    apr_file_aio_op_t ops[NUM_OPS], op;
+    apr_file_t *f = open_file(tc, 0);
+    char *wbuf, *rbuf;
+    apr_status_t rv;
+    apr_uint32_t num;
+    int i;
+
+    wbuf = apr_palloc(p, NUM_OPS * OP_SIZE);
+    rbuf = apr_pcalloc(p, NUM_OPS * OP_SIZE);
+    for (i = 0; i < NUM_OPS * OP_SIZE; i++) {
+        wbuf[i] = (char)(i * 7 + i / OP_SIZE);
+    }
+
+    /* Nothing pending */
+    rv = apr_file_aio_reap(aio, -1, &num);
+    APR_ASSERT_SUCCESS(tc, "reap nothing", rv);
+    ABTS_INT_EQUAL(tc, 0, num);
+
+    /* Writes in reverse order, at their offset */
+    completed = 0;
+    for (i = NUM_OPS - 1; i >= 0; i--) {
+        memset(&ops[i], 0, sizeof(ops[i]));
+        ops[i].type = APR_FILE_AIO_WRITE;
+        ops[i].file = f;
+        ops[i].buf = wbuf + i * OP_SIZE;
+        ops[i].len = OP_SIZE;
+        ops[i].offset = i * OP_SIZE;
+        ops[i].buf_index = -1;
+        ops[i].cb = count_cb;
+        rv = apr_file_aio_submit(aio, &ops[i]);
+        APR_ASSERT_SUCCESS(tc, "submit write", rv);
+    }
+    ABTS_INT_EQUAL(tc, NUM_OPS, apr_file_aio_pending(aio));
+    reap_all(tc, aio);
+    ABTS_INT_EQUAL(tc, NUM_OPS, completed);
+    for (i = 0; i < NUM_OPS; i++) {
+        APR_ASSERT_SUCCESS(tc, "write status", ops[i].status);
+        ABTS_SIZE_EQUAL(tc, OP_SIZE, ops[i].nbytes);
+    }
+
+    memset(&op, 0, sizeof(op));
+    op.type = APR_FILE_AIO_DATASYNC;
+    op.file = f;
+    op.buf_index = -1;
+    rv = apr_file_aio_submit(aio, &op);
+    APR_ASSERT_SUCCESS(tc, "submit datasync", rv);
+    reap_all(tc, aio);
+    APR_ASSERT_SUCCESS(tc, "datasync status", op.status);
+
+    /* Reads, without callback */
+    for (i = 0; i < NUM_OPS; i++) {
+        ops[i].type = APR_FILE_AIO_READ;
+        ops[i].buf = rbuf + i * OP_SIZE;
+        ops[i].cb = NULL;
+        rv = apr_file_aio_submit(aio, &ops[i]);
+        APR_ASSERT_SUCCESS(tc, "submit read", rv);
+    }
+    reap_all(tc, aio);
+    for (i = 0; i < NUM_OPS; i++) {
+        APR_ASSERT_SUCCESS(tc, "read status", ops[i].status);
+        ABTS_SIZE_EQUAL(tc, OP_SIZE, ops[i].nbytes);
+    }
+    ABTS_ASSERT(tc, "data read back",
+                memcmp(wbuf, rbuf, NUM_OPS * OP_SIZE) == 0);
+
+    /* At the end of the file */
+    op.type = APR_FILE_AIO_READ;
+    op.buf = rbuf;
+    op.len = OP_SIZE;
+    op.offset = NUM_OPS * OP_SIZE;
+    rv = apr_file_aio_submit(aio, &op);
+    APR_ASSERT_SUCCESS(tc, "submit read at EOF", rv);
+    reap_all(tc, aio);
+    ABTS_INT_EQUAL(tc, APR_EOF, op.status);
+    ABTS_SIZE_EQUAL(tc, 0, op.nbytes);
+
+    /* The file's own offset is untouched */
+    {
+        apr_off_t off = 0;
+        apr_file_seek(f, APR_CUR, &off);
+        ABTS_INT_EQUAL(tc, 0, (int)off);
+    }
+
+    apr_file_close(f);
+    apr_file_aio_destroy(aio);
+}
+
+static void test_invalid(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = create_aio(tc, data);
+    apr_file_t *f = open_file(tc, 0);
+    apr_file_aio_op_t op;
+    char buf[16];
+
+    memset(&op, 0, sizeof(op));
+    op.type = APR_FILE_AIO_READ;
+    op.buf = buf;
+    op.len = sizeof(buf);
+    op.buf_index = -1;
+    ABTS_INT_EQUAL(tc, APR_EINVAL, apr_file_aio_submit(aio, &op));
+
+    op.file = f;
+    op.offset = -1;
+    ABTS_INT_EQUAL(tc, APR_EINVAL, apr_file_aio_submit(aio, &op));
+
+    /* No buffer registered */
+    op.offset = 0;
+    op.buf_index = 0;
+    ABTS_INT_EQUAL(tc, APR_EINVAL, apr_file_aio_submit(aio, &op));
+    ABTS_INT_EQUAL(tc, 0, apr_file_aio_pending(aio));
+
+    apr_file_close(f);
+    apr_file_aio_destroy(aio);
+}
+
+static void test_notifier(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = create_aio(tc, data);
+    apr_file_t *f = open_file(tc, 0);
+    apr_file_t *notifier;
+    apr_pollset_t *pollset;
+    apr_pollfd_t pfd;
+    const apr_pollfd_t *descs;
+    apr_file_aio_op_t op;
+    apr_int32_t num;
+    apr_uint32_t n;
+    apr_status_t rv;
+    char buf[] = "notified";
+
+    rv = apr_file_aio_notifier_get(&notifier, aio);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "no notifier without threads");
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "get notifier", rv);
+
+    rv = apr_pollset_create(&pollset, 1, p, 0);
+    APR_ASSERT_SUCCESS(tc, "create pollset", rv);
+    memset(&pfd, 0, sizeof(pfd));
+    pfd.desc_type = APR_POLL_FILE;
+    pfd.desc.f = notifier;
+    pfd.reqevents = APR_POLLIN;
+    rv = apr_pollset_add(pollset, &pfd);
+    APR_ASSERT_SUCCESS(tc, "add notifier", rv);
+
+    rv = apr_pollset_poll(pollset, 0, &num, &descs);
+    ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+    memset(&op, 0, sizeof(op));
+    op.type = APR_FILE_AIO_WRITE;
+    op.file = f;
+    op.buf = buf;
+    op.len = sizeof(buf);
+    op.buf_index = -1;
+    rv = apr_file_aio_submit(aio, &op);
+    APR_ASSERT_SUCCESS(tc, "submit write", rv);
+
+    rv = apr_pollset_poll(pollset, apr_time_from_sec(10), &num, &descs);
+    APR_ASSERT_SUCCESS(tc, "poll notifier", rv);
+    ABTS_INT_EQUAL(tc, 1, num);
+    rv = apr_file_aio_reap(aio, 0, &n);
+    APR_ASSERT_SUCCESS(tc, "reap notified", rv);
+    ABTS_INT_EQUAL(tc, 1, n);
+    ABTS_SIZE_EQUAL(tc, sizeof(buf), op.nbytes);
+
+    /* Drained by the reap */
+    rv = apr_pollset_poll(pollset, 0, &num, &descs);
+    ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+    apr_pollset_destroy(pollset);
+    apr_file_close(f);
+    apr_file_aio_destroy(aio);
+}
+
+static void test_buffers(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = create_aio(tc, data);
+    apr_file_t *f = open_file(tc, 0);
+    apr_file_aio_op_t op;
+    struct iovec vec[2];
+    apr_status_t rv;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        vec[i].iov_base = apr_palloc(p, OP_SIZE);
+        vec[i].iov_len = OP_SIZE;
+    }
+    rv = apr_file_aio_buffers_register(aio, vec, 2);
+    if (rv == APR_ENOMEM || rv == APR_FROM_OS_ERROR(EPERM)) {
+        ABTS_NOT_IMPL(tc, "buffers exceed the locked memory limit");
+        apr_file_aio_destroy(aio);
+        apr_file_close(f);
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "register buffers", rv);
+
+    memset(vec[0].iov_base, 'a', OP_SIZE);
+    memset(&op, 0, sizeof(op));
+    op.type = APR_FILE_AIO_WRITE;
+    op.file = f;
+    op.buf = vec[0].iov_base;
+    op.len = OP_SIZE;
+    op.buf_index = 0;
+    rv = apr_file_aio_submit(aio, &op);
+    APR_ASSERT_SUCCESS(tc, "submit fixed write", rv);
+    reap_all(tc, aio);
+    APR_ASSERT_SUCCESS(tc, "fixed write status", op.status);
+    ABTS_SIZE_EQUAL(tc, OP_SIZE, op.nbytes);
+
+    /* Part of the second buffer */
+    op.type = APR_FILE_AIO_READ;
+    op.buf = (char *)vec[1].iov_base + 100;
+    op.len = OP_SIZE - 100;
+    op.buf_index = 1;
+    rv = apr_file_aio_submit(aio, &op);
+    APR_ASSERT_SUCCESS(tc, "submit fixed read", rv);
+    reap_all(tc, aio);
+    APR_ASSERT_SUCCESS(tc, "fixed read status", op.status);
+    ABTS_SIZE_EQUAL(tc, OP_SIZE - 100, op.nbytes);
+    ABTS_ASSERT(tc, "fixed data read back",
+                memcmp(vec[0].iov_base, op.buf, op.nbytes) == 0);
+
+    /* Beyond the registered buffer */
+    op.len = OP_SIZE;
+    ABTS_INT_EQUAL(tc, APR_EINVAL, apr_file_aio_submit(aio, &op));
+
+    rv = apr_file_aio_buffers_register(aio, NULL, 0);
+    APR_ASSERT_SUCCESS(tc, "unregister buffers", rv);
+    op.len = 1;
+    ABTS_INT_EQUAL(tc, APR_EINVAL, apr_file_aio_submit(aio, &op));
+
+    apr_file_close(f);
+    apr_file_aio_destroy(aio);
+}
+
+/* Destroying the engine waits for the operations in flight */
+static void test_destroy_inflight(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = create_aio(tc, data);
+    apr_file_t *f = open_file(tc, 0);
+    apr_file_aio_op_t ops[NUM_OPS];
+    char *buf = apr_pcalloc(p, OP_SIZE);
+    apr_status_t rv;
+    int i;
+
+    for (i = 0; i < NUM_OPS; i++) {
+        memset(&ops[i], 0, sizeof(ops[i]));
+        ops[i].type = APR_FILE_AIO_WRITE;
+        ops[i].file = f;
+        ops[i].buf = buf;
+        ops[i].len = OP_SIZE;
+        ops[i].offset = i * OP_SIZE;
+        ops[i].buf_index = -1;
+        rv = apr_file_aio_submit(aio, &ops[i]);
+        APR_ASSERT_SUCCESS(tc, "submit write", rv);
+    }
+    apr_file_aio_destroy(aio);
+    apr_file_close(f);
+}
+
+static void test_buffered_file(abts_case *tc, void *data)
+{
+    apr_file_aio_t *aio = create_aio(tc, data);
+    apr_file_t *f = open_file(tc, APR_FOPEN_BUFFERED);
+    apr_file_aio_op_t op;
+    apr_status_t rv;
+    char buf[8];
+
+    /* Still in the file's buffer, flushed by the submission */
+    rv = apr_file_puts("buffered", f);
+    APR_ASSERT_SUCCESS(tc, "write to buffer", rv);
+
+    memset(&op, 0, sizeof(op));
+    op.type = APR_FILE_AIO_READ;
+    op.file = f;
+    op.buf = buf;
+    op.len = sizeof(buf);
+    op.buf_index = -1;
+    rv = apr_file_aio_submit(aio, &op);
+    APR_ASSERT_SUCCESS(tc, "submit read", rv);
+    reap_all(tc, aio);
+    APR_ASSERT_SUCCESS(tc, "read status", op.status);
+    ABTS_SIZE_EQUAL(tc, sizeof(buf), op.nbytes);
+    ABTS_ASSERT(tc, "flushed data read", memcmp(buf, "buffered", 8) == 0);
+
+    apr_file_close(f);
+    apr_file_aio_destroy(aio);
+}
+
+abts_suite *testfileaio(abts_suite *suite)
+{
+    int i;
+
+    suite = ADD_SUITE(suite);
+
+    for (i = 0; i < 2; i++) {
+        abts_run_test(suite, test_read_write, &aio_flags[i]);
+        abts_run_test(suite, test_invalid, &aio_flags[i]);
+        abts_run_test(suite, test_notifier, &aio_flags[i]);
+        abts_run_test(suite, test_buffers, &aio_flags[i]);
+        abts_run_test(suite, test_destroy_inflight, &aio_flags[i]);
+        abts_run_test(suite, test_buffered_file, &aio_flags[i]);
+    }
+
+    return suite;
+}
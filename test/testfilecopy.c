@@ -19,6 +19,7 @@
 #include "apr_file_info.h"
 #include "apr_errno.h"
 #include "apr_pools.h"
+#include "apr_time.h"
 
 static void copy_helper(abts_case *tc, const char *from, const char * to,
                         apr_fileperms_t perms, int append, apr_pool_t *p)
@@ -123,6 +124,154 @@ static void append_exist(abts_case *tc, void *data)
     APR_ASSERT_SUCCESS(tc, "Couldn't remove copy file", rv);
 }
 
+static void content_match(abts_case *tc, const char *from, const char *to,
+                          apr_pool_t *p)
+{
+    apr_file_t *f1, *f2;
+    apr_status_t rv1, rv2;
+    char buf1[8192], buf2[8192];
+    apr_size_t len1, len2;
+
+    APR_ASSERT_SUCCESS(tc, "Couldn't open original file",
+                       apr_file_open(&f1, from, APR_FOPEN_READ,
+                                     APR_FPROT_OS_DEFAULT, p));
+    APR_ASSERT_SUCCESS(tc, "Couldn't open copy file",
+                       apr_file_open(&f2, to, APR_FOPEN_READ,
+                                     APR_FPROT_OS_DEFAULT, p));
+    do {
+        rv1 = apr_file_read_full(f1, buf1, sizeof(buf1), &len1);
+        rv2 = apr_file_read_full(f2, buf2, sizeof(buf2), &len2);
+        ABTS_INT_EQUAL(tc, rv1, rv2);
+        ABTS_SIZE_EQUAL(tc, len1, len2);
+        ABTS_ASSERT(tc, "File content differs",
+                    len1 == len2 && memcmp(buf1, buf2, len1) == 0);
+    } while (rv1 == APR_SUCCESS && rv2 == APR_SUCCESS && !tc->failed);
+    apr_file_close(f1);
+    apr_file_close(f2);
+}
+
+static const struct {
+    apr_int32_t method;
+    const char *name;
+} copy_methods[] = {
+    { APR_FILE_COPY_CLONE,    "clone" },
+    { APR_FILE_COPY_RANGE,    "copy_file_range" },
+    { APR_FILE_COPY_SENDFILE, "sendfile" },
+    { APR_FILE_COPY_BUFFERED, "buffered" }
+};
+
+static void copy_each_method(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_int32_t used;
+    int i, n = 0;
+
+    for (i = 0; i < sizeof(copy_methods) / sizeof(copy_methods[0]); i++) {
+        apr_file_remove("data/file_copy.txt", p);
+
+        rv = apr_file_copy_ex("data/file_datafile.txt", "data/file_copy.txt",
+                              APR_FPROT_FILE_SOURCE_PERMS,
+                              copy_methods[i].method, &used, p);
+        if (rv == APR_ENOTIMPL) {
+            continue;
+        }
+        APR_ASSERT_SUCCESS(tc, "Error copying file", rv);
+        ABTS_INT_EQUAL(tc, copy_methods[i].method, used);
+        content_match(tc, "data/file_datafile.txt", "data/file_copy.txt", p);
+        n++;
+    }
+    /* The buffered copy always works */
+    ABTS_ASSERT(tc, "No copy method worked", n > 0);
+
+    /* The best one by default */
+    rv = apr_file_copy_ex("data/file_datafile.txt", "data/file_copy.txt",
+                          APR_FPROT_FILE_SOURCE_PERMS, APR_FILE_COPY_ALL,
+                          &used, p);
+    APR_ASSERT_SUCCESS(tc, "Error copying file", rv);
+    ABTS_ASSERT(tc, "A single method is used", used != 0
+                                               && (used & (used - 1)) == 0);
+    content_match(tc, "data/file_datafile.txt", "data/file_copy.txt", p);
+
+    rv = apr_file_remove("data/file_copy.txt", p);
+    APR_ASSERT_SUCCESS(tc, "Couldn't remove copy file", rv);
+}
+
+/* Files reporting a size but looking empty to the system methods */
+static void copy_special_file(abts_case *tc, void *data)
+{
+    const char *from = "/sys/devices/system/cpu/online";
+    apr_finfo_t finfo;
+    apr_status_t rv;
+    apr_int32_t used;
+
+    rv = apr_stat(&finfo, from, APR_FINFO_TYPE | APR_FINFO_SIZE, p);
+    if (rv != APR_SUCCESS || finfo.filetype != APR_REG || finfo.size == 0) {
+        ABTS_NOT_IMPL(tc, "No sized special file to copy");
+        return;
+    }
+
+    apr_file_remove("data/file_copy.txt", p);
+    rv = apr_file_copy_ex(from, "data/file_copy.txt", APR_FPROT_OS_DEFAULT,
+                          APR_FILE_COPY_ALL, &used, p);
+    APR_ASSERT_SUCCESS(tc, "Error copying special file", rv);
+    rv = apr_stat(&finfo, "data/file_copy.txt", APR_FINFO_SIZE, p);
+    APR_ASSERT_SUCCESS(tc, "Couldn't stat copy file", rv);
+    ABTS_ASSERT(tc, "Special file copied empty", finfo.size > 0);
+    content_match(tc, from, "data/file_copy.txt", p);
+
+    apr_file_remove("data/file_copy.txt", p);
+}
+
+#define LARGE_FILE_SIZE (64 * 1024 * 1024)
+
+/* Times each method on a large file, shown by "testall -v testfilecopy" */
+static void copy_large_file(abts_case *tc, void *data)
+{
+    const char *from = "data/file_copy_large.bin";
+    const char *to = "data/file_copy_large.copy";
+    apr_file_t *f;
+    apr_status_t rv;
+    apr_int32_t used;
+    apr_size_t i;
+    char *buf;
+    int m;
+
+    buf = apr_palloc(p, 1024 * 1024);
+    for (i = 0; i < 1024 * 1024; i++) {
+        buf[i] = (char)(i * 31 + (i >> 10));
+    }
+    rv = apr_file_open(&f, from, APR_FOPEN_WRITE | APR_FOPEN_CREATE
+                       | APR_FOPEN_TRUNCATE, APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "Couldn't create large file", rv);
+    for (i = 0; i < LARGE_FILE_SIZE / (1024 * 1024) && !rv; i++) {
+        buf[0] = (char)i;
+        rv = apr_file_write_full(f, buf, 1024 * 1024, NULL);
+    }
+    APR_ASSERT_SUCCESS(tc, "Couldn't write large file", rv);
+    apr_file_close(f);
+
+    for (m = 0; m < sizeof(copy_methods) / sizeof(copy_methods[0]); m++) {
+        apr_time_t start = apr_time_now();
+
+        apr_file_remove(to, p);
+        rv = apr_file_copy_ex(from, to, APR_FPROT_OS_DEFAULT,
+                              copy_methods[m].method, &used, p);
+        if (rv == APR_ENOTIMPL) {
+            abts_log_message("%16s: not supported", copy_methods[m].name);
+            continue;
+        }
+        APR_ASSERT_SUCCESS(tc, "Error copying large file", rv);
+        abts_log_message("%16s: %d MB in %" APR_TIME_T_FMT " ms",
+                         copy_methods[m].name,
+                         LARGE_FILE_SIZE / (1024 * 1024),
+                         apr_time_as_msec(apr_time_now() - start));
+        content_match(tc, from, to, p);
+    }
+
+    apr_file_remove(to, p);
+    apr_file_remove(from, p);
+}
+
 abts_suite *testfilecopy(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -133,6 +282,10 @@ abts_suite *testfilecopy(abts_suite *suite)
     abts_run_test(suite, append_nonexist, NULL);
     abts_run_test(suite, append_exist, NULL);
 
+    abts_run_test(suite, copy_each_method, NULL);
+    abts_run_test(suite, copy_special_file, NULL);
+    abts_run_test(suite, copy_large_file, NULL);
+
     return suite;
 }
 
@@ -76,11 +76,28 @@ static void sum_hash(apr_pool_t *p, apr_hash_t *h, int *pcount, int *keySum, int
     *pcount=count;
 }
 
+/* Most tests are run for each kind of hash table, given by data */
+static apr_uint32_t hash_flags[] = {
+    APR_HASH_FLAT, APR_HASH_FAST, APR_HASH_FLAT | APR_HASH_FAST,
+    APR_HASH_INCREMENTAL
+};
+#define HASH_FLAT       ((void *)&hash_flags[0])
+#define HASH_FAST       ((void *)&hash_flags[1])
+#define HASH_FLAT_FAST  ((void *)&hash_flags[2])
+#define HASH_INCREMENTAL ((void *)&hash_flags[3])
+
+static apr_hash_t *make_hash(void *data)
+{
+    if (data)
+        return apr_hash_make_ex(p, *(apr_uint32_t *)data);
+    return apr_hash_make(p);
+}
+
 static void hash_make(abts_case *tc, void *data)
 {
     apr_hash_t *h = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 }
 
@@ -89,7 +106,7 @@ static void hash_set(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     char *result = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "key", APR_HASH_KEY_STRING, "value");
@@ -102,7 +119,7 @@ static void hash_get_or_set(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     char *result = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     result = apr_hash_get_or_set(h, "key", APR_HASH_KEY_STRING, "value");
@@ -130,7 +147,7 @@ static void hash_reset(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     char *result = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "key", APR_HASH_KEY_STRING, "value");
@@ -147,7 +164,7 @@ static void same_value(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     char *result = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "same1", APR_HASH_KEY_STRING, "same");
@@ -191,7 +208,7 @@ static void key_space(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     char *result = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "key with space", APR_HASH_KEY_STRING, "value");
@@ -204,7 +221,7 @@ static void hash_clear(abts_case *tc, void *data)
     apr_hash_t *h;
     int i, *e;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     for (i = 1; i <= 10; i++) {
@@ -226,7 +243,7 @@ static void hash_traverse(abts_case *tc, void *data)
     apr_hash_t *h;
     char StrArray[MAX_DEPTH][MAX_LTH];
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "OVERWRITE", APR_HASH_KEY_STRING, "should not see this");
@@ -261,7 +278,7 @@ static void summation_test(abts_case *tc, void *data)
     int sumKeys, sumVal, trySumKey, trySumVal;
     int i, j, *val, *key;
 
-    h =apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     sumKeys = 0;
@@ -291,7 +308,7 @@ static void delete_key(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     char *result = NULL;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "key", APR_HASH_KEY_STRING, "value");
@@ -317,7 +334,7 @@ static void hash_count_0(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     int count;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     count = apr_hash_count(h);
@@ -329,7 +346,7 @@ static void hash_count_1(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     int count;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "key", APR_HASH_KEY_STRING, "value");
@@ -343,7 +360,7 @@ static void hash_count_5(abts_case *tc, void *data)
     apr_hash_t *h = NULL;
     int count;
 
-    h = apr_hash_make(p);
+    h = make_hash(data);
     ABTS_PTR_NOTNULL(tc, h);
 
     apr_hash_set(h, "key1", APR_HASH_KEY_STRING, "value1");
@@ -364,8 +381,8 @@ static void overlay_empty(abts_case *tc, void *data)
     int count;
     char StrArray[MAX_DEPTH][MAX_LTH];
 
-    base = apr_hash_make(p);
-    overlay = apr_hash_make(p);
+    base = make_hash(data);
+    overlay = make_hash(data);
     ABTS_PTR_NOTNULL(tc, base);
     ABTS_PTR_NOTNULL(tc, overlay);
 
@@ -398,8 +415,8 @@ static void overlay_2unique(abts_case *tc, void *data)
     int count;
     char StrArray[MAX_DEPTH][MAX_LTH];
 
-    base = apr_hash_make(p);
-    overlay = apr_hash_make(p);
+    base = make_hash(data);
+    overlay = make_hash(data);
     ABTS_PTR_NOTNULL(tc, base);
     ABTS_PTR_NOTNULL(tc, overlay);
 
@@ -442,7 +459,7 @@ static void overlay_same(abts_case *tc, void *data)
     int count;
     char StrArray[MAX_DEPTH][MAX_LTH];
 
-    base = apr_hash_make(p);
+    base = make_hash(data);
     ABTS_PTR_NOTNULL(tc, base);
 
     apr_hash_set(base, "base1", APR_HASH_KEY_STRING, "value1");
@@ -473,8 +490,8 @@ static void overlay_fetch(abts_case *tc, void *data)
     apr_hash_t *result = NULL;
     int count;
 
-    base = apr_hash_make(p);
-    overlay = apr_hash_make(p);
+    base = make_hash(data);
+    overlay = make_hash(data);
     ABTS_PTR_NOTNULL(tc, base);
     ABTS_PTR_NOTNULL(tc, overlay);
 
@@ -539,32 +556,409 @@ static void overlay_fetch(abts_case *tc, void *data)
                        apr_hash_get(overlay, "overlay5", APR_HASH_KEY_STRING));
 }
 
+/* Lots of keys set, deleted and set again, checking everything's there */
+#define MANY_KEYS 20000
+
+static void many_keys(abts_case *tc, void *data)
+{
+    apr_hash_t *h;
+    apr_hash_index_t *hi;
+    char **keys;
+    int i, round, found;
+
+    h = make_hash(data);
+    keys = apr_palloc(p, MANY_KEYS * sizeof(*keys));
+    for (i = 0; i < MANY_KEYS; i++) {
+        keys[i] = apr_psprintf(p, "key-%d", i);
+    }
+
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < MANY_KEYS; i++) {
+            apr_hash_set(h, keys[i], APR_HASH_KEY_STRING, keys[i]);
+        }
+        ABTS_INT_EQUAL(tc, MANY_KEYS, apr_hash_count(h));
+
+        /* Delete the odd keys (leaving tombstones in flat tables) */
+        for (i = 1; i < MANY_KEYS; i += 2) {
+            apr_hash_set(h, keys[i], APR_HASH_KEY_STRING, NULL);
+        }
+        ABTS_INT_EQUAL(tc, MANY_KEYS / 2, apr_hash_count(h));
+
+        for (i = 0; i < MANY_KEYS; i++) {
+            const char *val = apr_hash_get(h, keys[i], APR_HASH_KEY_STRING);
+            if (i % 2) {
+                ABTS_PTR_EQUAL(tc, NULL, val);
+            }
+            else if (val != keys[i]) {
+                ABTS_STR_EQUAL(tc, keys[i], val);
+                break;
+            }
+        }
+
+        found = 0;
+        for (hi = apr_hash_first(p, h); hi; hi = apr_hash_next(hi)) {
+            const char *key = apr_hash_this_key(hi);
+            ABTS_PTR_EQUAL(tc, key, apr_hash_this_val(hi));
+            found++;
+        }
+        ABTS_INT_EQUAL(tc, MANY_KEYS / 2, found);
+    }
+
+    /* Deleting while iterating */
+    for (hi = apr_hash_first(p, h); hi; hi = apr_hash_next(hi)) {
+        apr_hash_set(h, apr_hash_this_key(hi), APR_HASH_KEY_STRING, NULL);
+    }
+    ABTS_INT_EQUAL(tc, 0, apr_hash_count(h));
+    ABTS_PTR_EQUAL(tc, NULL, apr_hash_first(p, h));
+}
+
+static void flat_mixed_overlay(abts_case *tc, void *data)
+{
+    apr_hash_t *base, *overlay, *result;
+
+    base = apr_hash_make_flat(p);
+    overlay = apr_hash_make(p);
+    apr_hash_set(base, "key1", APR_HASH_KEY_STRING, "value1");
+    apr_hash_set(base, "key2", APR_HASH_KEY_STRING, "value2");
+    apr_hash_set(overlay, "key2", APR_HASH_KEY_STRING, "value2b");
+    apr_hash_set(overlay, "key3", APR_HASH_KEY_STRING, "value3");
+
+    result = apr_hash_overlay(p, overlay, base);
+    ABTS_INT_EQUAL(tc, 3, apr_hash_count(result));
+    ABTS_STR_EQUAL(tc, "value1", apr_hash_get(result, "key1",
+                                              APR_HASH_KEY_STRING));
+    ABTS_STR_EQUAL(tc, "value2b", apr_hash_get(result, "key2",
+                                               APR_HASH_KEY_STRING));
+    ABTS_STR_EQUAL(tc, "value3", apr_hash_get(result, "key3",
+                                              APR_HASH_KEY_STRING));
+
+    result = apr_hash_overlay(p, base, overlay);
+    ABTS_INT_EQUAL(tc, 3, apr_hash_count(result));
+    ABTS_STR_EQUAL(tc, "value2", apr_hash_get(result, "key2",
+                                              APR_HASH_KEY_STRING));
+
+    /* Copies are independent */
+    result = apr_hash_copy(p, base);
+    apr_hash_set(result, "key1", APR_HASH_KEY_STRING, NULL);
+    ABTS_INT_EQUAL(tc, 1, apr_hash_count(result));
+    ABTS_INT_EQUAL(tc, 2, apr_hash_count(base));
+    ABTS_STR_EQUAL(tc, "value1", apr_hash_get(base, "key1",
+                                              APR_HASH_KEY_STRING));
+}
+
+/* Keys of all lengths, around the word and block sizes of APR_HASH_FAST */
+static void fast_keys(abts_case *tc, void *data)
+{
+    char buf[64], *keys[64];
+    apr_hash_t *h;
+    int i;
+
+    h = make_hash(data);
+    memset(buf, 'x', sizeof(buf));
+    for (i = 0; i < 64; i++) {
+        keys[i] = apr_pstrmemdup(p, buf, i);
+        apr_hash_set(h, keys[i], i, keys[i]);
+    }
+    /* Keys that differ by one byte anywhere */
+    for (i = 0; i < 63; i++) {
+        char *key = apr_pstrmemdup(p, buf, 63);
+        key[i] = 'y';
+        apr_hash_set(h, key, APR_HASH_KEY_STRING, key);
+    }
+    ABTS_INT_EQUAL(tc, 64 + 63, apr_hash_count(h));
+
+    for (i = 0; i < 64; i++) {
+        ABTS_PTR_EQUAL(tc, keys[i], apr_hash_get(h, buf, i));
+    }
+    ABTS_PTR_EQUAL(tc, NULL, apr_hash_get(h, "xxxxxxxxxxxxxxxxxxz",
+                                          APR_HASH_KEY_STRING));
+}
+
+static int hash_calls;
+
+static unsigned int counting_hashfunc(const char *key, apr_ssize_t *klen)
+{
+    hash_calls++;
+    return apr_hashfunc_default(key, klen);
+}
+
+/* The hashes are computed once, when set */
+static void hash_cached(abts_case *tc, void *data)
+{
+    apr_hash_t *base, *overlay, *result;
+    char *key;
+    int i;
+
+    base = apr_hash_make_custom(p, counting_hashfunc);
+    overlay = apr_hash_make_custom(p, counting_hashfunc);
+    hash_calls = 0;
+    for (i = 0; i < 1000; i++) {
+        key = apr_psprintf(p, "key%d", i);
+        apr_hash_set(i % 2 ? base : overlay, key, APR_HASH_KEY_STRING, key);
+    }
+    /* Expansions, copies and overlays don't hash again */
+    ABTS_INT_EQUAL(tc, 1000, hash_calls);
+    result = apr_hash_copy(p, base);
+    result = apr_hash_overlay(p, overlay, result);
+    ABTS_INT_EQUAL(tc, 1000, hash_calls);
+    ABTS_INT_EQUAL(tc, 1000, apr_hash_count(result));
+
+    /* An overlay hashing differently is */
+    overlay = apr_hash_make(p);
+    for (i = 0; i < 10; i++) {
+        key = apr_psprintf(p, "key%d", i);
+        apr_hash_set(overlay, key, APR_HASH_KEY_STRING, "other");
+    }
+    result = apr_hash_overlay(p, overlay, base);
+    ABTS_INT_EQUAL(tc, 1010, hash_calls);
+    ABTS_INT_EQUAL(tc, 505, apr_hash_count(result));
+    ABTS_STR_EQUAL(tc, "other", apr_hash_get(result, "key1",
+                                             APR_HASH_KEY_STRING));
+    ABTS_STR_EQUAL(tc, "key11", apr_hash_get(result, "key11",
+                                             APR_HASH_KEY_STRING));
+}
+
+#define INCR_KEYS 520 /* just over 512, for an expansion to be ongoing */
+
+/* Iterating while an incremental expansion is ongoing, and advances */
+static void incremental_iterate(abts_case *tc, void *data)
+{
+    apr_hash_t *h, *copy;
+    apr_hash_index_t *hi;
+    char *keys[INCR_KEYS];
+    int visited[INCR_KEYS];
+    int i, n;
+
+    h = apr_hash_make_ex(p, APR_HASH_INCREMENTAL);
+    for (i = 0; i < INCR_KEYS; i++) {
+        keys[i] = apr_psprintf(p, "%d", i);
+        visited[i] = 0;
+        apr_hash_set(h, keys[i], APR_HASH_KEY_STRING, &visited[i]);
+    }
+
+    /* Replacing values migrates buckets */
+    n = 0;
+    for (hi = apr_hash_first(p, h); hi; hi = apr_hash_next(hi)) {
+        int *v = apr_hash_this_val(hi);
+        (*v)++;
+        n++;
+        apr_hash_set(h, apr_hash_this_key(hi), APR_HASH_KEY_STRING, v);
+    }
+    ABTS_INT_EQUAL(tc, INCR_KEYS, n);
+    for (i = 0; i < INCR_KEYS; i++) {
+        ABTS_INT_EQUAL(tc, 1, visited[i]);
+    }
+
+    /* Copies and overlays of a table being expanded */
+    for (i = 0; i < INCR_KEYS; i++) {
+        keys[i] = apr_psprintf(p, "other%d", i);
+        apr_hash_set(h, keys[i], APR_HASH_KEY_STRING, keys[i]);
+    }
+    copy = apr_hash_copy(p, h);
+    ABTS_INT_EQUAL(tc, 2 * INCR_KEYS, apr_hash_count(copy));
+    copy = apr_hash_overlay(p, apr_hash_make(p), h);
+    ABTS_INT_EQUAL(tc, 2 * INCR_KEYS, apr_hash_count(copy));
+    for (i = 0; i < INCR_KEYS; i++) {
+        ABTS_PTR_EQUAL(tc, keys[i], apr_hash_get(copy, keys[i],
+                                                 APR_HASH_KEY_STRING));
+    }
+
+    /* Deleting migrates buckets too */
+    n = 0;
+    for (hi = apr_hash_first(p, h); hi; hi = apr_hash_next(hi)) {
+        apr_hash_set(h, apr_hash_this_key(hi), APR_HASH_KEY_STRING, NULL);
+        n++;
+    }
+    ABTS_INT_EQUAL(tc, 2 * INCR_KEYS, n);
+    ABTS_INT_EQUAL(tc, 0, apr_hash_count(h));
+}
+
+/* Worst insertion time, expanding at once or incrementally */
+static void incremental_bench(abts_case *tc, void *data)
+{
+    const int count = 1000000;
+    apr_pool_t *pool;
+    char **keys;
+    int i, k;
+
+    apr_pool_create(&pool, p);
+    keys = apr_palloc(pool, count * sizeof(*keys));
+    for (i = 0; i < count; i++) {
+        keys[i] = apr_psprintf(pool, "/some/path/to/key/%d", i);
+    }
+
+    for (k = 0; k < 2; k++) {
+        apr_time_t start, now, total, worst = 0;
+        apr_pool_t *subpool;
+        apr_hash_t *h;
+
+        apr_pool_create(&subpool, pool);
+        h = apr_hash_make_ex(subpool, k ? APR_HASH_INCREMENTAL : 0);
+
+        total = start = apr_time_now();
+        for (i = 0; i < count; i++) {
+            apr_hash_set(h, keys[i], APR_HASH_KEY_STRING, keys[i]);
+            now = apr_time_now();
+            if (worst < now - start)
+                worst = now - start;
+            start = now;
+        }
+        total = apr_time_now() - total;
+        ABTS_INT_EQUAL(tc, count, apr_hash_count(h));
+
+        abts_log_message("%d keys%s: total %" APR_TIME_T_FMT "us, worst set "
+                         "%" APR_TIME_T_FMT "us", count,
+                         k ? " (incremental)" : "", total, worst);
+        apr_pool_destroy(subpool);
+    }
+
+    apr_pool_destroy(pool);
+}
+
+/* Throughput of the hash functions, by key length */
+static void hashfunc_bench(abts_case *tc, void *data)
+{
+    static const int lengths[] = { 8, 32, 128, 1024 };
+    char *key;
+    int n;
+
+    key = apr_palloc(p, lengths[3]);
+    for (n = 0; n < lengths[3]; n++) {
+        key[n] = 'a' + n % 26;
+    }
+
+    for (n = 0; n < (int)(sizeof(lengths) / sizeof(lengths[0])); n++) {
+        int loops = 10000000 / lengths[n], i, k, misses = 0;
+        apr_time_t t[2];
+
+        for (k = 0; k < 2; k++) {
+            apr_hash_t *h = apr_hash_make_ex(p, k ? APR_HASH_FAST : 0);
+            apr_time_t start;
+
+            apr_hash_set(h, key, lengths[n], key);
+            start = apr_time_now();
+            for (i = 0; i < loops; i++) {
+                if (!apr_hash_get(h, key, lengths[n]))
+                    misses++;
+            }
+            t[k] = apr_time_now() - start;
+        }
+        ABTS_INT_EQUAL(tc, 0, misses);
+
+        abts_log_message("%5d bytes keys, %8d gets: %6" APR_TIME_T_FMT
+                         "us (fast %6" APR_TIME_T_FMT "us)", lengths[n],
+                         loops, t[0], t[1]);
+    }
+}
+
+/* Insert and lookup throughput of each kind of table */
+static void hash_bench(abts_case *tc, void *data)
+{
+    static const int sizes[] = { 1000, 10000, 100000, 1000000 };
+    apr_pool_t *pool;
+    char **keys;
+    int i, n, k;
+
+    apr_pool_create(&pool, p);
+
+    keys = apr_palloc(pool, sizes[3] * sizeof(*keys));
+    for (i = 0; i < sizes[3]; i++) {
+        keys[i] = apr_psprintf(pool, "/some/path/to/key/%d", i);
+    }
+    /* Not in order, for the (chained) entries not to be too */
+    srand(42);
+    for (i = sizes[3] - 1; i > 0; i--) {
+        char *key;
+        k = rand() % (i + 1);
+        key = keys[i];
+        keys[i] = keys[k];
+        keys[k] = key;
+    }
+
+    for (n = 0; n < (int)(sizeof(sizes) / sizeof(sizes[0])); n++) {
+        apr_time_t t_set[2], t_get[2];
+        apr_pool_t *subpool;
+
+        for (k = 0; k < 2; k++) {
+            apr_hash_t *h;
+            apr_time_t start;
+            int misses = 0;
+
+            apr_pool_create(&subpool, pool);
+            h = k ? apr_hash_make_flat(subpool) : apr_hash_make(subpool);
+
+            start = apr_time_now();
+            for (i = 0; i < sizes[n]; i++) {
+                apr_hash_set(h, keys[i], APR_HASH_KEY_STRING, keys[i]);
+            }
+            t_set[k] = apr_time_now() - start;
+
+            start = apr_time_now();
+            for (i = sizes[n] - 1; i >= 0; i--) {
+                if (!apr_hash_get(h, keys[i], APR_HASH_KEY_STRING))
+                    misses++;
+            }
+            t_get[k] = apr_time_now() - start;
+            ABTS_INT_EQUAL(tc, 0, misses);
+
+            apr_pool_destroy(subpool);
+        }
+
+        abts_log_message("%8d keys: set %6" APR_TIME_T_FMT "us (flat %6"
+                         APR_TIME_T_FMT "us), get %6" APR_TIME_T_FMT
+                         "us (flat %6" APR_TIME_T_FMT "us)", sizes[n],
+                         t_set[0], t_set[1], t_get[0], t_get[1]);
+    }
+
+    apr_pool_destroy(pool);
+}
+
+static void run_hash_tests(abts_suite *suite, void *data)
+{
+    abts_run_test(suite, hash_make, data);
+    abts_run_test(suite, hash_set, data);
+    abts_run_test(suite, hash_get_or_set, data);
+    abts_run_test(suite, hash_reset, data);
+    abts_run_test(suite, same_value, data);
+    abts_run_test(suite, key_space, data);
+    abts_run_test(suite, delete_key, data);
+
+    abts_run_test(suite, hash_count_0, data);
+    abts_run_test(suite, hash_count_1, data);
+    abts_run_test(suite, hash_count_5, data);
+
+    abts_run_test(suite, hash_clear, data);
+    abts_run_test(suite, hash_traverse, data);
+    abts_run_test(suite, summation_test, data);
+
+    abts_run_test(suite, overlay_empty, data);
+    abts_run_test(suite, overlay_2unique, data);
+    abts_run_test(suite, overlay_same, data);
+    abts_run_test(suite, overlay_fetch, data);
+    abts_run_test(suite, many_keys, data);
+    abts_run_test(suite, fast_keys, data);
+}
+
 abts_suite *testhash(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
-    abts_run_test(suite, hash_make, NULL);
-    abts_run_test(suite, hash_set, NULL);
-    abts_run_test(suite, hash_get_or_set, NULL);
-    abts_run_test(suite, hash_reset, NULL);
-    abts_run_test(suite, same_value, NULL);
+    run_hash_tests(suite, NULL);
     abts_run_test(suite, same_value_custom, NULL);
-    abts_run_test(suite, key_space, NULL);
-    abts_run_test(suite, delete_key, NULL);
 
-    abts_run_test(suite, hash_count_0, NULL);
-    abts_run_test(suite, hash_count_1, NULL);
-    abts_run_test(suite, hash_count_5, NULL);
+    run_hash_tests(suite, HASH_FLAT);
+    abts_run_test(suite, flat_mixed_overlay, NULL);
 
-    abts_run_test(suite, hash_clear, NULL);
-    abts_run_test(suite, hash_traverse, NULL);
-    abts_run_test(suite, summation_test, NULL);
+    run_hash_tests(suite, HASH_FAST);
+    run_hash_tests(suite, HASH_FLAT_FAST);
+    abts_run_test(suite, hash_cached, NULL);
 
-    abts_run_test(suite, overlay_empty, NULL);
-    abts_run_test(suite, overlay_2unique, NULL);
-    abts_run_test(suite, overlay_same, NULL);
-    abts_run_test(suite, overlay_fetch, NULL);
+    run_hash_tests(suite, HASH_INCREMENTAL);
+    abts_run_test(suite, incremental_iterate, NULL);
+
+    abts_run_test(suite, hash_bench, NULL);
+    abts_run_test(suite, hashfunc_bench, NULL);
+    abts_run_test(suite, incremental_bench, NULL);
 
     return suite;
 }
-
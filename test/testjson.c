@@ -276,6 +276,584 @@ static void test_json_create(abts_case* tc, void* data)
                    buf);
 }
 
+static const char *parser_src =
+    " {"
+    "  \"Image\" : {"
+    "    \"Width\" : 800 ,"
+    "    \"IDs\" : [116, -943, 2.5e3, 38793],"
+    "    \"Title\" : \"View from \\\"15th\\\" Floor \\u00e9\\n\","
+    "    \"Animated\" : false,"
+    "    \"Empty\" : [],"
+    "    \"Thumbnail\" : {"
+    "      \"Height\" : 125,"
+    "      \"Visible\" : true,"
+    "      \"Url\" : null"
+    "    },"
+    "    \"Height\" : 600 "
+    "  }"
+    "} ";
+
+static const char *json_to_string(apr_json_value_t *json, int flags)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    char *str;
+    apr_size_t len;
+
+    apr_json_encode(bb, NULL, NULL, json, flags, p);
+    apr_brigade_pflatten(bb, &str, &len, p);
+    return apr_pstrmemdup(p, str, len);
+}
+
+static void test_json_parser(abts_case * tc, void *data)
+{
+    static const apr_size_t chunks[] = { 1, 2, 3, 7, 64, 4096 };
+    static const int flags[] = { APR_JSON_FLAGS_NONE,
+                                 APR_JSON_FLAGS_WHITESPACE };
+    apr_json_parser_t *parser;
+    apr_json_value_t *json;
+    apr_size_t len = strlen(parser_src), i, n;
+    apr_off_t offset;
+    apr_status_t status;
+    const char *expected;
+    int f;
+
+    for (f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+        status = apr_json_decode(&json, parser_src, len, &offset, flags[f],
+                                 10, p);
+        APR_ASSERT_SUCCESS(tc, "decode", status);
+        expected = json_to_string(json, flags[f]);
+
+        for (i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+            status = apr_json_parser_create(&parser, NULL, NULL, flags[f],
+                                            10, p);
+            APR_ASSERT_SUCCESS(tc, "create parser", status);
+            for (n = 0; n < len && status == APR_SUCCESS; n += chunks[i]) {
+                status = apr_json_parser_feed(parser, parser_src + n,
+                                    n + chunks[i] < len ? chunks[i] : len - n);
+            }
+            APR_ASSERT_SUCCESS(tc, "feed parser", status);
+            status = apr_json_parser_finish(parser, &json, &offset);
+            APR_ASSERT_SUCCESS(tc, "finish parser", status);
+            ABTS_SIZE_EQUAL(tc, len, (apr_size_t)offset);
+            ABTS_STR_EQUAL(tc, expected, json_to_string(json, flags[f]));
+        }
+    }
+}
+
+/* Scalars at the top, ended by the end of the text */
+static void test_json_parser_scalar(abts_case * tc, void *data)
+{
+    apr_json_parser_t *parser;
+    apr_json_value_t *json;
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    apr_json_parser_feed(parser, "12", 2);
+    apr_json_parser_feed(parser, "34", 2);
+    APR_ASSERT_SUCCESS(tc, "finish number",
+                       apr_json_parser_finish(parser, &json, NULL));
+    ABTS_INT_EQUAL(tc, APR_JSON_LONG, json->type);
+    ABTS_LLONG_EQUAL(tc, 1234, json->value.lnumber);
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    apr_json_parser_feed(parser, " tr", 3);
+    apr_json_parser_feed(parser, "ue ", 3);
+    APR_ASSERT_SUCCESS(tc, "finish boolean",
+                       apr_json_parser_finish(parser, &json, NULL));
+    ABTS_INT_EQUAL(tc, APR_JSON_BOOLEAN, json->type);
+    ABTS_INT_EQUAL(tc, 1, json->value.boolean);
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    apr_json_parser_feed(parser, "\"a\\", 3);
+    apr_json_parser_feed(parser, "\"b\"", 3);
+    APR_ASSERT_SUCCESS(tc, "finish string",
+                       apr_json_parser_finish(parser, &json, NULL));
+    ABTS_INT_EQUAL(tc, APR_JSON_STRING, json->type);
+    ABTS_STR_EQUAL(tc, "a\"b", json->value.string.p);
+}
+
+static void test_json_parser_errors(abts_case * tc, void *data)
+{
+    apr_json_parser_t *parser;
+    apr_json_value_t *json;
+    apr_off_t offset;
+    apr_status_t status;
+
+    /* bad chars stop the parser, and stick */
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    APR_ASSERT_SUCCESS(tc, "feed", apr_json_parser_feed(parser, "[1,", 3));
+    status = apr_json_parser_feed(parser, " ]", 2);
+    ABTS_INT_EQUAL(tc, APR_BADCH, status);
+    status = apr_json_parser_feed(parser, "2]", 2);
+    ABTS_INT_EQUAL(tc, APR_BADCH, status);
+    status = apr_json_parser_finish(parser, &json, &offset);
+    ABTS_INT_EQUAL(tc, APR_BADCH, status);
+    ABTS_PTR_EQUAL(tc, NULL, json);
+    ABTS_INT_EQUAL(tc, 4, (int)offset);
+
+    /* bad tokens */
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    status = apr_json_parser_feed(parser, "[truth]", 7);
+    ABTS_INT_EQUAL(tc, APR_BADCH, status);
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    status = apr_json_parser_feed(parser, "{\"a\":1-2}", 9);
+    ABTS_INT_EQUAL(tc, APR_BADCH, status);
+
+    /* trailing craft */
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    status = apr_json_parser_feed(parser, "{} {}", 5);
+    ABTS_INT_EQUAL(tc, APR_BADCH, status);
+
+    /* truncated */
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    APR_ASSERT_SUCCESS(tc, "feed", apr_json_parser_feed(parser, "{\"a\":1", 6));
+    status = apr_json_parser_finish(parser, &json, &offset);
+    ABTS_INT_EQUAL(tc, APR_EOF, status);
+    ABTS_INT_EQUAL(tc, 6, (int)offset);
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    APR_ASSERT_SUCCESS(tc, "feed", apr_json_parser_feed(parser, "\"abc", 4));
+    status = apr_json_parser_finish(parser, &json, &offset);
+    ABTS_INT_EQUAL(tc, APR_EOF, status);
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 10, p);
+    status = apr_json_parser_finish(parser, &json, &offset);
+    ABTS_INT_EQUAL(tc, APR_EOF, status);
+
+    /* nested too deep */
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_NONE, 2, p);
+    status = apr_json_parser_feed(parser, "{\"One\":{\"Two\":{", 15);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, status);
+    status = apr_json_parser_finish(parser, &json, &offset);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, status);
+    ABTS_INT_EQUAL(tc, 14, (int)offset);
+}
+
+typedef struct parser_trace_t {
+    const char *trace;
+    int values;
+} parser_trace_t;
+
+static apr_status_t trace_object_start(void *ctx)
+{
+    parser_trace_t *t = ctx;
+    t->trace = apr_pstrcat(p, t->trace, "{", NULL);
+    return APR_SUCCESS;
+}
+
+static apr_status_t trace_object_key(void *ctx, const apr_json_string_t *key)
+{
+    parser_trace_t *t = ctx;
+    t->trace = apr_pstrcat(p, t->trace, apr_pstrndup(p, key->p, key->len),
+                           ":", NULL);
+    return APR_SUCCESS;
+}
+
+static apr_status_t trace_object_end(void *ctx)
+{
+    parser_trace_t *t = ctx;
+    t->trace = apr_pstrcat(p, t->trace, "}", NULL);
+    return APR_SUCCESS;
+}
+
+static apr_status_t trace_array_start(void *ctx)
+{
+    parser_trace_t *t = ctx;
+    t->trace = apr_pstrcat(p, t->trace, "[", NULL);
+    return APR_SUCCESS;
+}
+
+static apr_status_t trace_array_end(void *ctx)
+{
+    parser_trace_t *t = ctx;
+    t->trace = apr_pstrcat(p, t->trace, "]", NULL);
+    return APR_SUCCESS;
+}
+
+static apr_status_t trace_value(void *ctx, const apr_json_value_t *value)
+{
+    parser_trace_t *t = ctx;
+
+    if (t->values-- == 0) {
+        return APR_EGENERAL;
+    }
+    switch (value->type) {
+    case APR_JSON_STRING:
+        t->trace = apr_pstrcat(p, t->trace, "'", apr_pstrndup(p,
+                               value->value.string.p, value->value.string.len),
+                               "' ", NULL);
+        break;
+    case APR_JSON_LONG:
+        t->trace = apr_psprintf(p, "%s%" APR_INT64_T_FMT " ", t->trace,
+                                value->value.lnumber);
+        break;
+    case APR_JSON_DOUBLE:
+        t->trace = apr_psprintf(p, "%s%g ", t->trace, value->value.dnumber);
+        break;
+    case APR_JSON_BOOLEAN:
+        t->trace = apr_pstrcat(p, t->trace,
+                               value->value.boolean ? "true " : "false ", NULL);
+        break;
+    default:
+        t->trace = apr_pstrcat(p, t->trace, "null ", NULL);
+    }
+    return APR_SUCCESS;
+}
+
+static const apr_json_callbacks_t trace_callbacks = {
+    trace_object_start,
+    trace_object_key,
+    trace_object_end,
+    trace_array_start,
+    trace_array_end,
+    trace_value
+};
+
+static void test_json_parser_callbacks(abts_case * tc, void *data)
+{
+    apr_json_parser_t *parser;
+    apr_json_value_t *json = NULL;
+    parser_trace_t t;
+    apr_size_t len = strlen(parser_src), n;
+    apr_status_t status = APR_SUCCESS;
+
+    t.trace = "";
+    t.values = -1;
+    apr_json_parser_create(&parser, &trace_callbacks, &t,
+                           APR_JSON_FLAGS_WHITESPACE, 10, p);
+    for (n = 0; n < len && status == APR_SUCCESS; n += 3) {
+        status = apr_json_parser_feed(parser, parser_src + n,
+                                      n + 3 < len ? 3 : len - n);
+    }
+    APR_ASSERT_SUCCESS(tc, "feed parser", status);
+    status = apr_json_parser_finish(parser, &json, NULL);
+    APR_ASSERT_SUCCESS(tc, "finish parser", status);
+    ABTS_PTR_EQUAL(tc, NULL, json);
+    ABTS_STR_EQUAL(tc, "{Image:{Width:800 IDs:[116 -943 2500 38793 ]"
+                   "Title:'View from \"15th\" Floor \xc3\xa9\n' "
+                   "Animated:false Empty:[]Thumbnail:{Height:125 "
+                   "Visible:true Url:null }Height:600 }}", t.trace);
+
+    /* callbacks stop the parser */
+    t.trace = "";
+    t.values = 2;
+    apr_json_parser_create(&parser, &trace_callbacks, &t,
+                           APR_JSON_FLAGS_NONE, 10, p);
+    status = apr_json_parser_feed(parser, parser_src, len);
+    ABTS_INT_EQUAL(tc, APR_EGENERAL, status);
+    ABTS_STR_EQUAL(tc, "{Image:{Width:800 IDs:[116 ", t.trace);
+}
+
+static void test_json_parser_brigade(abts_case * tc, void *data)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    apr_json_parser_t *parser;
+    apr_json_value_t *json, *parsed;
+    apr_size_t len = strlen(parser_src), n;
+    apr_status_t status;
+
+    for (n = 0; n < len; n += 5) {
+        APR_BRIGADE_INSERT_TAIL(bb, apr_bucket_immortal_create(parser_src + n,
+                                    n + 5 < len ? 5 : len - n, ba));
+    }
+    APR_BRIGADE_INSERT_TAIL(bb, apr_bucket_eos_create(ba));
+
+    apr_json_parser_create(&parser, NULL, NULL, APR_JSON_FLAGS_WHITESPACE,
+                           10, p);
+    status = apr_json_parser_feed_brigade(parser, bb);
+    APR_ASSERT_SUCCESS(tc, "feed brigade", status);
+    ABTS_TRUE(tc, APR_BRIGADE_EMPTY(bb));
+    status = apr_json_parser_finish(parser, &parsed, NULL);
+    APR_ASSERT_SUCCESS(tc, "finish parser", status);
+
+    status = apr_json_decode(&json, parser_src, len, NULL,
+                             APR_JSON_FLAGS_WHITESPACE, 10, p);
+    APR_ASSERT_SUCCESS(tc, "decode", status);
+    ABTS_STR_EQUAL(tc, json_to_string(json, APR_JSON_FLAGS_WHITESPACE),
+                   json_to_string(parsed, APR_JSON_FLAGS_WHITESPACE));
+}
+
+/* Escapes, UTF-8 and whitespace around the blocks scanned at once */
+static void test_json_scan(abts_case * tc, void *data)
+{
+    static const char *specials[] = { "\\n", "\\\"", "\\u00e9", "\xc3\xa9",
+                                      "\xe2\x82\xac", "\\\\" };
+    static const char *decoded[] = { "\n", "\"", "\xc3\xa9", "\xc3\xa9",
+                                     "\xe2\x82\xac", "\\" };
+    apr_json_value_t *json;
+    apr_status_t status;
+    char src[128], expected[128], *q;
+    apr_size_t i, n, len;
+    int k;
+
+    for (k = 0; k < sizeof(specials) / sizeof(specials[0]); k++) {
+        for (n = 0; n < 80; n++) {
+            /* special at n, in a string of 80 plain chars */
+            q = src;
+            *q++ = '"';
+            for (i = 0; i < 80; i++) {
+                if (i == n) {
+                    q = apr_cpystrn(q, specials[k], sizeof(src) - (q - src));
+                }
+                *q++ = 'a' + i % 26;
+            }
+            *q++ = '"';
+            len = q - src;
+
+            q = expected;
+            for (i = 0; i < 80; i++) {
+                if (i == n) {
+                    q = apr_cpystrn(q, decoded[k], sizeof(expected)
+                                                   - (q - expected));
+                }
+                *q++ = 'a' + i % 26;
+            }
+            *q = 0;
+
+            status = apr_json_decode(&json, src, len, NULL,
+                                     APR_JSON_FLAGS_NONE, 10, p);
+            APR_ASSERT_SUCCESS(tc, "decode string", status);
+            ABTS_STR_EQUAL(tc, expected, json->value.string.p);
+            ABTS_SIZE_EQUAL(tc, strlen(expected), json->value.string.len);
+        }
+    }
+
+    /* invalid UTF-8 is found after any number of plain chars */
+    for (n = 0; n < 80; n++) {
+        memset(src, 'a', sizeof(src));
+        src[0] = '"';
+        src[n + 1] = '\xc3';
+        src[n + 2] = '(';
+        src[100] = '"';
+        status = apr_json_decode(&json, src, 101, NULL, APR_JSON_FLAGS_NONE,
+                                 10, p);
+        ABTS_INT_EQUAL(tc, APR_BADCH, status);
+    }
+
+    /* runs of whitespace */
+    for (n = 0; n < 80; n++) {
+        for (i = 0; i < n; i++) {
+            src[i] = " \t\r\n"[i % 4];
+        }
+        src[n] = '1';
+        src[n + 1] = '\v';
+        status = apr_json_decode(&json, src, n + 2, NULL,
+                                 APR_JSON_FLAGS_WHITESPACE, 10, p);
+        APR_ASSERT_SUCCESS(tc, "decode whitespace", status);
+        ABTS_LLONG_EQUAL(tc, 1, json->value.lnumber);
+        if (n) {
+            ABTS_SIZE_EQUAL(tc, n, strlen(json->pre));
+            ABTS_TRUE(tc, !strncmp(json->pre, src, n));
+        }
+        else {
+            ABTS_PTR_EQUAL(tc, NULL, json->pre);
+        }
+        ABTS_STR_EQUAL(tc, "\v", json->post);
+    }
+}
+
+#define BENCH_RECORDS   20000
+#define BENCH_ROUNDS    10
+
+/* Pretty printed records of ids, text, numbers and tags */
+static char *bench_document(apr_size_t *len)
+{
+    apr_bucket_alloc_t *ba = apr_bucket_alloc_create(p);
+    apr_bucket_brigade *bb = apr_brigade_create(p, ba);
+    char *doc;
+    int i;
+
+    apr_brigade_puts(bb, NULL, NULL, "[\n");
+    for (i = 0; i < BENCH_RECORDS; i++) {
+        apr_brigade_printf(bb, NULL, NULL,
+            "  {\n"
+            "    \"id\": %d,\n"
+            "    \"name\": \"user%d\",\n"
+            "    \"url\": \"https://www.example.com/users/%d/profile?"
+            "lang=en&format=json\",\n"
+            "    \"bio\": \"Caf\xc3\xa9 owner in M\xc3\xbcnchen since %d. "
+            "Likes \\\"long\\\" walks,\\nreading and writing JSON by hand "
+            "for fun and profit.\",\n"
+            "    \"score\": %d.%d,\n"
+            "    \"active\": %s,\n"
+            "    \"tags\": [\"alpha\", \"beta\", \"gamma\", \"delta\"]\n"
+            "  }%s\n", i, i, i, 1900 + i % 100, i % 100, i % 10,
+            i % 2 ? "true" : "false", i + 1 < BENCH_RECORDS ? "," : "");
+    }
+    apr_brigade_puts(bb, NULL, NULL, "]\n");
+    apr_brigade_pflatten(bb, &doc, len, p);
+    return doc;
+}
+
+static void test_json_decode_bench(abts_case * tc, void *data)
+{
+    apr_pool_t *pool;
+    apr_json_parser_t *parser;
+    apr_json_value_t *json;
+    apr_time_t decode, parse;
+    apr_status_t status;
+    apr_size_t len, n;
+    char *doc;
+    int i;
+
+    doc = bench_document(&len);
+    apr_pool_create(&pool, p);
+
+    decode = apr_time_now();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        status = apr_json_decode(&json, doc, len, NULL,
+                                 APR_JSON_FLAGS_WHITESPACE, 10, pool);
+        APR_ASSERT_SUCCESS(tc, "decode document", status);
+        apr_pool_clear(pool);
+    }
+    decode = apr_time_now() - decode;
+
+    parse = apr_time_now();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        apr_json_parser_create(&parser, NULL, NULL,
+                               APR_JSON_FLAGS_WHITESPACE, 10, pool);
+        for (n = 0; n < len; n += 65536) {
+            status = apr_json_parser_feed(parser, doc + n,
+                                    n + 65536 < len ? 65536 : len - n);
+        }
+        status = apr_json_parser_finish(parser, &json, NULL);
+        APR_ASSERT_SUCCESS(tc, "parse document", status);
+        apr_pool_clear(pool);
+    }
+    parse = apr_time_now() - parse;
+
+    apr_pool_destroy(pool);
+
+    abts_log_message("%" APR_SIZE_T_FMT " bytes x %d: decode %" APR_TIME_T_FMT
+                     "ms (%" APR_TIME_T_FMT "MB/s), push parser %"
+                     APR_TIME_T_FMT "ms (%" APR_TIME_T_FMT "MB/s)",
+                     len, BENCH_ROUNDS, apr_time_as_msec(decode),
+                     (apr_time_t)len * BENCH_ROUNDS / (decode + 1),
+                     apr_time_as_msec(parse),
+                     (apr_time_t)len * BENCH_ROUNDS / (parse + 1));
+}
+
+static void test_json_flat(abts_case * tc, void *data)
+{
+    apr_json_value_t *json, *hashed, *obj, *res;
+    apr_json_kv_t *kv, *image;
+    apr_status_t status;
+    char key[16];
+    int i;
+
+    status = apr_json_decode(&json, parser_src, APR_JSON_VALUE_STRING, NULL,
+                             APR_JSON_FLAGS_WHITESPACE | APR_JSON_FLAGS_FLAT,
+                             10, p);
+    APR_ASSERT_SUCCESS(tc, "decode flat", status);
+    status = apr_json_decode(&hashed, parser_src, APR_JSON_VALUE_STRING, NULL,
+                             APR_JSON_FLAGS_WHITESPACE, 10, p);
+    APR_ASSERT_SUCCESS(tc, "decode hashed", status);
+    ABTS_STR_EQUAL(tc, json_to_string(hashed, APR_JSON_FLAGS_WHITESPACE),
+                   json_to_string(json, APR_JSON_FLAGS_WHITESPACE));
+
+    ABTS_PTR_EQUAL(tc, NULL, json->value.object->hash);
+    image = apr_json_object_get(json, "Image", APR_JSON_VALUE_STRING);
+    ABTS_PTR_NOTNULL(tc, image);
+    ABTS_PTR_EQUAL(tc, NULL, image->v->value.object->hash);
+    kv = apr_json_object_get(image->v, "Height", 6);
+    ABTS_PTR_NOTNULL(tc, kv);
+    ABTS_LLONG_EQUAL(tc, 600, kv->v->value.lnumber);
+    ABTS_PTR_EQUAL(tc, NULL, apr_json_object_get(image->v, "Heigh", 5));
+
+    /* duplicate keys replace the value in place, as with the hash */
+    status = apr_json_decode(&json, "{\"a\":1,\"b\":2,\"a\":3}",
+                             APR_JSON_VALUE_STRING, NULL,
+                             APR_JSON_FLAGS_FLAT, 10, p);
+    APR_ASSERT_SUCCESS(tc, "decode duplicates", status);
+    ABTS_STR_EQUAL(tc, "{\"a\":3,\"b\":2}",
+                   json_to_string(json, APR_JSON_FLAGS_NONE));
+
+    /* the hash is built past APR_JSON_OBJECT_FLAT_MAX keys */
+    obj = apr_json_object_create_ex(p, APR_JSON_FLAGS_FLAT);
+    for (i = 0; i < APR_JSON_OBJECT_FLAT_MAX * 2; i++) {
+        if (i == APR_JSON_OBJECT_FLAT_MAX) {
+            ABTS_PTR_EQUAL(tc, NULL, obj->value.object->hash);
+        }
+        /* the key is not copied */
+        apr_json_object_set(obj, apr_psprintf(p, "key%d", i),
+                            APR_JSON_VALUE_STRING,
+                            apr_json_long_create(p, i), p);
+    }
+    ABTS_PTR_NOTNULL(tc, obj->value.object->hash);
+    ABTS_INT_EQUAL(tc, APR_JSON_OBJECT_FLAT_MAX * 2,
+                   apr_hash_count(obj->value.object->hash));
+    for (i = 0; i < APR_JSON_OBJECT_FLAT_MAX * 2; i++) {
+        apr_snprintf(key, sizeof(key), "key%d", i);
+        kv = apr_json_object_get(obj, key, APR_JSON_VALUE_STRING);
+        ABTS_PTR_NOTNULL(tc, kv);
+        ABTS_LLONG_EQUAL(tc, i, kv->v->value.lnumber);
+    }
+
+    /* removal, and overlay of flat objects */
+    obj = apr_json_object_create_ex(p, APR_JSON_FLAGS_FLAT);
+    apr_json_object_set(obj, "a", 1, apr_json_long_create(p, 1), p);
+    apr_json_object_set(obj, "b", 1, apr_json_long_create(p, 2), p);
+    apr_json_object_set(obj, "c", 1, apr_json_long_create(p, 3), p);
+    apr_json_object_set(obj, "b", 1, NULL, p);
+    ABTS_PTR_EQUAL(tc, NULL, apr_json_object_get(obj, "b", 1));
+    ABTS_STR_EQUAL(tc, "{\"a\":1,\"c\":3}",
+                   json_to_string(obj, APR_JSON_FLAGS_NONE));
+
+    json = apr_json_object_create_ex(p, APR_JSON_FLAGS_FLAT);
+    apr_json_object_set(json, "c", 1, apr_json_long_create(p, 4), p);
+    apr_json_object_set(json, "d", 1, apr_json_long_create(p, 5), p);
+    res = apr_json_overlay(p, json, obj, APR_JSON_FLAGS_NONE);
+    ABTS_STR_EQUAL(tc, "{\"a\":1,\"c\":4,\"d\":5}",
+                   json_to_string(res, APR_JSON_FLAGS_NONE));
+    res = apr_json_overlay(p, json, obj, APR_JSON_FLAGS_STRICT);
+    ABTS_PTR_EQUAL(tc, NULL, res);
+}
+
+/* Decoding records of a few keys and looking them up */
+static void test_json_flat_bench(abts_case * tc, void *data)
+{
+    static const int flags[] = { APR_JSON_FLAGS_NONE, APR_JSON_FLAGS_FLAT };
+    apr_pool_t *pool;
+    apr_json_value_t *json, *rec;
+    apr_json_kv_t *kv;
+    apr_time_t elapsed[2];
+    apr_status_t status;
+    apr_size_t len;
+    char *doc;
+    int f, i, found;
+
+    doc = bench_document(&len);
+    apr_pool_create(&pool, p);
+
+    for (f = 0; f < 2; f++) {
+        elapsed[f] = apr_time_now();
+        for (i = 0; i < BENCH_ROUNDS; i++) {
+            status = apr_json_decode(&json, doc, len, NULL, flags[f], 10,
+                                     pool);
+            APR_ASSERT_SUCCESS(tc, "decode document", status);
+
+            found = 0;
+            for (rec = apr_json_array_first(json); rec;
+                 rec = apr_json_array_next(json, rec)) {
+                kv = apr_json_object_get(rec, "score", 5);
+                found += kv && apr_json_object_get(rec, "missing", 7) == NULL;
+            }
+            ABTS_INT_EQUAL(tc, BENCH_RECORDS, found);
+            apr_pool_clear(pool);
+        }
+        elapsed[f] = apr_time_now() - elapsed[f];
+    }
+
+    apr_pool_destroy(pool);
+
+    abts_log_message("%d records x %d: hashed %" APR_TIME_T_FMT "ms, "
+                     "flat %" APR_TIME_T_FMT "ms", BENCH_RECORDS,
+                     BENCH_ROUNDS, apr_time_as_msec(elapsed[0]),
+                     apr_time_as_msec(elapsed[1]));
+}
+
 abts_suite *testjson(abts_suite * suite)
 {
     suite = ADD_SUITE(suite);
@@ -288,6 +866,15 @@ abts_suite *testjson(abts_suite * suite)
     abts_run_test(suite, test_json_object_iterate, NULL);
     abts_run_test(suite, test_json_array_iterate, NULL);
     abts_run_test(suite, test_json_create, NULL);
+    abts_run_test(suite, test_json_parser, NULL);
+    abts_run_test(suite, test_json_parser_scalar, NULL);
+    abts_run_test(suite, test_json_parser_errors, NULL);
+    abts_run_test(suite, test_json_parser_callbacks, NULL);
+    abts_run_test(suite, test_json_parser_brigade, NULL);
+    abts_run_test(suite, test_json_scan, NULL);
+    abts_run_test(suite, test_json_decode_bench, NULL);
+    abts_run_test(suite, test_json_flat, NULL);
+    abts_run_test(suite, test_json_flat_bench, NULL);
 
     return suite;
 }
@@ -174,6 +174,36 @@ static void test_mmap_offset(abts_case *tc, void *data)
     ABTS_STR_NEQUAL(tc, addr, thisfdata + 5, thisfsize - 5);
 }
 
+static void test_mmap_advise(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+
+    ABTS_PTR_NOTNULL(tc, themmap);
+    rv = apr_mmap_advise(themmap, 0, 0, APR_MADVISE_SEQUENTIAL);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_mmap_advise");
+        return;
+    }
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+    /* Not page aligned */
+    rv = apr_mmap_advise(themmap, 5, 10, APR_MADVISE_WILLNEED);
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+    /* Read back from the file once released */
+    rv = apr_mmap_advise(themmap, 0, thisfsize, APR_MADVISE_DONTNEED);
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    ABTS_STR_NEQUAL(tc, themmap->mm, thisfdata, thisfsize);
+
+    rv = apr_mmap_advise(themmap, 0, 0, APR_MADVISE_NORMAL);
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+    rv = apr_mmap_advise(themmap, 0, thisfsize + 1, APR_MADVISE_RANDOM);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+    rv = apr_mmap_advise(themmap, 0, 0, -1);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+}
+
 #endif
 
 abts_suite *testmmap(abts_suite *suite)
@@ -193,6 +223,7 @@ abts_suite *testmmap(abts_suite *suite)
         abts_run_test(suite, test_mmap_create, &test_set[i].offset);
         abts_run_test(suite, test_mmap_contents, &test_set[i].offset);
         abts_run_test(suite, test_mmap_offset, &test_set[i].offset);
+        abts_run_test(suite, test_mmap_advise, NULL);
         abts_run_test(suite, test_mmap_delete, NULL);
         abts_run_test(suite, test_file_close, NULL);
         apr_pool_clear(ptest);
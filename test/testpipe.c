@@ -220,6 +220,82 @@ static void wait_pipe(abts_case *tc, void *data)
     APR_ASSERT_SUCCESS(tc, "Wait for pipe failed", rv);
 }
 
+static void splice_tee(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_file_t *readp2, *writep2, *file;
+    const char *fname = "data/testpipe_splice.tmp";
+    char buf[32];
+    apr_size_t nbytes;
+    apr_off_t off = 0;
+
+    rv = apr_file_pipe_create_pools(&readp, &writep, APR_FULL_BLOCK, p, p);
+    APR_ASSERT_SUCCESS(tc, "Couldn't create pipe", rv);
+    rv = apr_file_pipe_create_pools(&readp2, &writep2, APR_FULL_NONBLOCK,
+                                    p, p);
+    APR_ASSERT_SUCCESS(tc, "Couldn't create second pipe", rv);
+
+    nbytes = 14;
+    rv = apr_file_write(writep, "this is a test", &nbytes);
+    APR_ASSERT_SUCCESS(tc, "Couldn't write to pipe", rv);
+
+    nbytes = sizeof(buf);
+    rv = apr_file_tee(writep2, readp, &nbytes, 0);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "apr_file_tee() not implemented");
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "Couldn't tee pipe", rv);
+    ABTS_SIZE_EQUAL(tc, 14, nbytes);
+
+    rv = apr_file_open(&file, fname, APR_FOPEN_READ | APR_FOPEN_WRITE
+                       | APR_FOPEN_CREATE | APR_FOPEN_TRUNCATE,
+                       APR_FPROT_OS_DEFAULT, p);
+    APR_ASSERT_SUCCESS(tc, "Couldn't create file", rv);
+
+    /* The data is still in the first pipe */
+    nbytes = sizeof(buf);
+    rv = apr_file_splice(file, readp, &nbytes, 0);
+    APR_ASSERT_SUCCESS(tc, "Couldn't splice pipe to file", rv);
+    ABTS_SIZE_EQUAL(tc, 14, nbytes);
+
+    rv = apr_file_seek(file, APR_SET, &off);
+    APR_ASSERT_SUCCESS(tc, "Couldn't seek file", rv);
+    nbytes = sizeof(buf);
+    rv = apr_file_read(file, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "Couldn't read file", rv);
+    ABTS_STR_EQUAL(tc, "this is a test", apr_pstrmemdup(p, buf, nbytes));
+
+    nbytes = sizeof(buf);
+    rv = apr_file_read(readp2, buf, &nbytes);
+    APR_ASSERT_SUCCESS(tc, "Couldn't read second pipe", rv);
+    ABTS_STR_EQUAL(tc, "this is a test", apr_pstrmemdup(p, buf, nbytes));
+
+    /* Nothing left, the second pipe does not wait */
+    nbytes = sizeof(buf);
+    rv = apr_file_splice(file, readp2, &nbytes, 0);
+    ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_EAGAIN(rv));
+    ABTS_SIZE_EQUAL(tc, 0, nbytes);
+
+    /* Neither is a pipe */
+    nbytes = sizeof(buf);
+    rv = apr_file_splice(file, file, &nbytes, 0);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+
+    /* End of the pipe */
+    apr_file_close(writep);
+    nbytes = sizeof(buf);
+    rv = apr_file_splice(file, readp, &nbytes, 0);
+    ABTS_INT_EQUAL(tc, APR_EOF, rv);
+    ABTS_SIZE_EQUAL(tc, 0, nbytes);
+
+    apr_file_close(file);
+    apr_file_remove(fname, p);
+    apr_file_close(readp);
+    apr_file_close(readp2);
+    apr_file_close(writep2);
+}
+
 abts_suite *testpipe(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -234,6 +310,7 @@ abts_suite *testpipe(abts_suite *suite)
     abts_run_test(suite, test_pipe_writefull, NULL);
     abts_run_test(suite, close_pipe, NULL);
     abts_run_test(suite, wait_pipe, NULL);
+    abts_run_test(suite, splice_tee, NULL);
 
     return suite;
 }
@@ -486,6 +486,15 @@ static void clear_last_pollset(abts_case *tc, void *data)
     ABTS_PTR_EQUAL(tc, NULL, descs);
 }
 
+static void destroy_pollset(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+
+    /* APR_POLLSET_IO_URING keeps the sockets open until they are removed */
+    rv = apr_pollset_destroy(pollset);
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+}
+
 static void close_all_sockets(abts_case *tc, void *data)
 {
     apr_status_t rv;
@@ -574,6 +583,185 @@ static void pollset_remove(abts_case *tc, void *data)
              (hot_files[1].client_data == (void *)1)));
 }
 
+static const apr_pollset_method_e poll_methods[] = {
+    APR_POLLSET_SELECT,
+    APR_POLLSET_KQUEUE,
+    APR_POLLSET_PORT,
+    APR_POLLSET_EPOLL,
+    APR_POLLSET_POLL,
+    APR_POLLSET_IO_URING};
+
+static void pollset_modify(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_pollset_t *pollset;
+    apr_pollfd_t pfd;
+    apr_int32_t num;
+    const apr_pollfd_t *descs;
+    int i;
+
+    for (i = 0; i < sizeof poll_methods / sizeof poll_methods[0]; i++) {
+        rv = apr_pollset_create_ex(&pollset, 2, p, APR_POLLSET_NODEFAULT,
+                                   poll_methods[i]);
+        if (rv == APR_ENOTIMPL) {
+            continue;
+        }
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        /* Nothing to read on s[0] */
+        pfd.p = p;
+        pfd.desc_type = APR_POLL_SOCKET;
+        pfd.reqevents = APR_POLLIN;
+        pfd.desc.s = s[0];
+        pfd.client_data = s[0];
+        rv = apr_pollset_add(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+        /* But always writable */
+        pfd.reqevents = APR_POLLOUT;
+        pfd.client_data = s[1];
+        rv = apr_pollset_modify(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, num);
+        ABTS_PTR_EQUAL(tc, s[0], descs[0].desc.s);
+        ABTS_PTR_EQUAL(tc, s[1], descs[0].client_data);
+        ABTS_INT_EQUAL(tc, APR_POLLOUT, descs[0].rtnevents);
+
+        pfd.reqevents = APR_POLLIN;
+        rv = apr_pollset_modify(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+        /* s[1] was never added */
+        pfd.desc.s = s[1];
+        rv = apr_pollset_modify(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_NOTFOUND, rv);
+
+        pfd.desc.s = s[0];
+        rv = apr_pollset_remove(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_destroy(pollset);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+}
+
+static void pollset_oneshot(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_pollset_t *pollset;
+    apr_pollfd_t pfd;
+    apr_int32_t num;
+    const apr_pollfd_t *descs;
+    int i;
+
+    for (i = 0; i < sizeof poll_methods / sizeof poll_methods[0]; i++) {
+        rv = apr_pollset_create_ex(&pollset, 2, p, APR_POLLSET_NODEFAULT,
+                                   poll_methods[i]);
+        if (rv == APR_ENOTIMPL) {
+            continue;
+        }
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        pfd.p = p;
+        pfd.desc_type = APR_POLL_SOCKET;
+        pfd.reqevents = APR_POLLOUT | APR_POLLONESHOT;
+        pfd.desc.s = s[0];
+        pfd.client_data = s[0];
+        rv = apr_pollset_add(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        /* Signalled once, though still writable */
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, num);
+        ABTS_INT_EQUAL(tc, APR_POLLOUT, descs[0].rtnevents);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+        /* And again once re-armed */
+        rv = apr_pollset_rearm(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, num);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+        rv = apr_pollset_remove(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_destroy(pollset);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+}
+
+static void pollset_edge(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_pollset_t *pollset;
+    apr_pollfd_t pfd;
+    apr_int32_t num;
+    const apr_pollfd_t *descs;
+    int i;
+
+    for (i = 0; i < sizeof poll_methods / sizeof poll_methods[0]; i++) {
+        rv = apr_pollset_create_ex(&pollset, 2, p, APR_POLLSET_NODEFAULT,
+                                   poll_methods[i]);
+        if (rv == APR_ENOTIMPL) {
+            continue;
+        }
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        pfd.p = p;
+        pfd.desc_type = APR_POLL_SOCKET;
+        pfd.reqevents = APR_POLLIN | APR_POLLET;
+        pfd.desc.s = s[0];
+        pfd.client_data = s[0];
+        rv = apr_pollset_add(pollset, &pfd);
+        if (rv == APR_ENOTIMPL) {
+            apr_pollset_destroy(pollset);
+            continue;
+        }
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        /* Signalled on arrival only, though still readable */
+        send_msg(s, sa, 0, tc);
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, num);
+        ABTS_INT_EQUAL(tc, APR_POLLIN, descs[0].rtnevents);
+
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+
+        send_msg(s, sa, 0, tc);
+        rv = apr_pollset_poll(pollset, 0, &num, &descs);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, num);
+
+        recv_msg(s, 0, p, tc);
+        recv_msg(s, 0, p, tc);
+
+        rv = apr_pollset_remove(pollset, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollset_destroy(pollset);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+}
+
 #define POLLCB_PREREQ \
     do { \
         if (pollcb == NULL) { \
@@ -585,7 +773,8 @@ static void pollset_remove(abts_case *tc, void *data)
 static void setup_pollcb(abts_case *tc, void *data)
 {
     apr_status_t rv;
-    rv = apr_pollcb_create(&pollcb, LARGE_NUM_SOCKETS, p, 0);
+    rv = apr_pollcb_create_ex(&pollcb, LARGE_NUM_SOCKETS, p, 0,
+                              default_pollset_impl);
     if (rv == APR_ENOTIMPL) {
         pollcb = NULL;
         ABTS_NOT_IMPL(tc, "pollcb interface not supported");
@@ -680,6 +869,120 @@ static void timeout_pollin_pollcb(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
 }
 
+static apr_status_t modify_pollcb_cb(void *baton, apr_pollfd_t *descriptor)
+{
+    pollcb_baton_t *pcb = (pollcb_baton_t *) baton;
+    ABTS_PTR_EQUAL(pcb->tc, s[0], descriptor->desc.s);
+    ABTS_INT_EQUAL(pcb->tc, APR_POLLOUT, descriptor->rtnevents);
+    pcb->count++;
+    return APR_SUCCESS;
+}
+
+static void pollcb_modify(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_pollcb_t *pollcb;
+    apr_pollfd_t pfd;
+    pollcb_baton_t pcb;
+    int i;
+
+    for (i = 0; i < sizeof poll_methods / sizeof poll_methods[0]; i++) {
+        rv = apr_pollcb_create_ex(&pollcb, 2, p, APR_POLLSET_NODEFAULT,
+                                  poll_methods[i]);
+        if (rv == APR_ENOTIMPL) {
+            continue;
+        }
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        pfd.p = p;
+        pfd.desc_type = APR_POLL_SOCKET;
+        pfd.reqevents = APR_POLLIN;
+        pfd.desc.s = s[0];
+        pfd.client_data = s[0];
+        rv = apr_pollcb_add(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        pcb.tc = tc;
+        pcb.count = 0;
+        rv = apr_pollcb_poll(pollcb, 0, modify_pollcb_cb, &pcb);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+        ABTS_INT_EQUAL(tc, 0, pcb.count);
+
+        pfd.reqevents = APR_POLLOUT;
+        rv = apr_pollcb_modify(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollcb_poll(pollcb, 0, modify_pollcb_cb, &pcb);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, pcb.count);
+
+        pfd.reqevents = APR_POLLIN;
+        rv = apr_pollcb_modify(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollcb_poll(pollcb, 0, modify_pollcb_cb, &pcb);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+        ABTS_INT_EQUAL(tc, 1, pcb.count);
+
+        rv = apr_pollcb_remove(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+}
+
+static apr_status_t oneshot_pollcb_cb(void *baton, apr_pollfd_t *descriptor)
+{
+    pollcb_baton_t *pcb = (pollcb_baton_t *) baton;
+    ABTS_PTR_EQUAL(pcb->tc, s[0], descriptor->desc.s);
+    pcb->count++;
+    return APR_SUCCESS;
+}
+
+static void pollcb_oneshot(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_pollcb_t *pollcb;
+    apr_pollfd_t pfd;
+    pollcb_baton_t pcb;
+    int i;
+
+    for (i = 0; i < sizeof poll_methods / sizeof poll_methods[0]; i++) {
+        rv = apr_pollcb_create_ex(&pollcb, 2, p, APR_POLLSET_NODEFAULT,
+                                  poll_methods[i]);
+        if (rv == APR_ENOTIMPL) {
+            continue;
+        }
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        pfd.p = p;
+        pfd.desc_type = APR_POLL_SOCKET;
+        pfd.reqevents = APR_POLLOUT | APR_POLLONESHOT;
+        pfd.desc.s = s[0];
+        pfd.client_data = s[0];
+        rv = apr_pollcb_add(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        pcb.tc = tc;
+        pcb.count = 0;
+        rv = apr_pollcb_poll(pollcb, 0, oneshot_pollcb_cb, &pcb);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 1, pcb.count);
+
+        rv = apr_pollcb_poll(pollcb, 0, oneshot_pollcb_cb, &pcb);
+        ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_TIMEUP(rv));
+        ABTS_INT_EQUAL(tc, 1, pcb.count);
+
+        rv = apr_pollcb_rearm(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+        rv = apr_pollcb_poll(pollcb, 0, oneshot_pollcb_cb, &pcb);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_INT_EQUAL(tc, 2, pcb.count);
+
+        rv = apr_pollcb_remove(pollcb, &pfd);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+}
+
 static void pollset_default(abts_case *tc, void *data)
 {
     apr_status_t rv1, rv2;
@@ -845,7 +1148,8 @@ static void pollcb_wakeup(abts_case *tc, void *data)
     apr_status_t rv;
     apr_pollcb_t *pcb;
 
-    rv = apr_pollcb_create(&pcb, 1, p, APR_POLLSET_WAKEABLE);
+    rv = apr_pollcb_create_ex(&pcb, 1, p, APR_POLLSET_WAKEABLE,
+                              default_pollset_impl);
     if (rv == APR_ENOTIMPL) {
         ABTS_NOT_IMPL(tc, "pollcb interface not supported");
         return;
@@ -885,7 +1189,8 @@ static void justsleep(abts_case *tc, void *data)
         APR_POLLSET_KQUEUE,
         APR_POLLSET_PORT,
         APR_POLLSET_EPOLL,
-        APR_POLLSET_POLL};
+        APR_POLLSET_POLL,
+        APR_POLLSET_IO_URING};
 
     nsds = 1;
     t1 = apr_time_now();
@@ -935,6 +1240,12 @@ static void justsleep(abts_case *tc, void *data)
 
 abts_suite *testpoll(abts_suite *suite)
 {
+    /* The methods which the tests below use by default, in turn */
+    const apr_pollset_method_e methods[] = {
+        APR_POLLSET_DEFAULT,
+        APR_POLLSET_IO_URING};
+    int i;
+
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, create_all_sockets, NULL);
@@ -952,26 +1263,41 @@ abts_suite *testpoll(abts_suite *suite)
     abts_run_test(suite, recv_large_pollarray, NULL);
 #endif
 
-    abts_run_test(suite, setup_pollset, NULL);
-    abts_run_test(suite, multi_event_pollset, NULL);
-    abts_run_test(suite, add_sockets_pollset, NULL);
-    abts_run_test(suite, nomessage_pollset, NULL);
-    abts_run_test(suite, send0_pollset, NULL);
-    abts_run_test(suite, recv0_pollset, NULL);
-    abts_run_test(suite, send_middle_pollset, NULL);
-    abts_run_test(suite, clear_middle_pollset, NULL);
-    abts_run_test(suite, send_last_pollset, NULL);
-    abts_run_test(suite, clear_last_pollset, NULL);
-    abts_run_test(suite, pollset_remove, NULL);
-    abts_run_test(suite, close_all_sockets, NULL);
-    abts_run_test(suite, create_all_sockets, NULL);
-    abts_run_test(suite, setup_pollcb, NULL);
-    abts_run_test(suite, trigger_pollcb, NULL);
-    abts_run_test(suite, timeout_pollcb, NULL);
-    abts_run_test(suite, timeout_pollin_pollcb, NULL);
-    abts_run_test(suite, pollset_wakeup, NULL);
-    abts_run_test(suite, pollcb_wakeup, NULL);
-    abts_run_test(suite, close_all_sockets, NULL);
+    for (i = 0; i < sizeof methods / sizeof methods[0]; i++) {
+        default_pollset_impl = methods[i];
+
+        if (i > 0) {
+            abts_run_test(suite, create_all_sockets, NULL);
+        }
+        abts_run_test(suite, setup_pollset, NULL);
+        abts_run_test(suite, multi_event_pollset, NULL);
+        abts_run_test(suite, add_sockets_pollset, NULL);
+        abts_run_test(suite, nomessage_pollset, NULL);
+        abts_run_test(suite, send0_pollset, NULL);
+        abts_run_test(suite, recv0_pollset, NULL);
+        abts_run_test(suite, send_middle_pollset, NULL);
+        abts_run_test(suite, clear_middle_pollset, NULL);
+        abts_run_test(suite, send_last_pollset, NULL);
+        abts_run_test(suite, clear_last_pollset, NULL);
+        abts_run_test(suite, destroy_pollset, NULL);
+        abts_run_test(suite, pollset_remove, NULL);
+        abts_run_test(suite, pollset_modify, NULL);
+        abts_run_test(suite, pollset_oneshot, NULL);
+        abts_run_test(suite, pollset_edge, NULL);
+        abts_run_test(suite, close_all_sockets, NULL);
+        abts_run_test(suite, create_all_sockets, NULL);
+        abts_run_test(suite, setup_pollcb, NULL);
+        abts_run_test(suite, trigger_pollcb, NULL);
+        abts_run_test(suite, timeout_pollcb, NULL);
+        abts_run_test(suite, timeout_pollin_pollcb, NULL);
+        abts_run_test(suite, pollcb_modify, NULL);
+        abts_run_test(suite, pollcb_oneshot, NULL);
+        abts_run_test(suite, pollset_wakeup, NULL);
+        abts_run_test(suite, pollcb_wakeup, NULL);
+        abts_run_test(suite, close_all_sockets, NULL);
+    }
+    default_pollset_impl = APR_POLLSET_DEFAULT;
+
     abts_run_test(suite, pollset_default, NULL);
     abts_run_test(suite, pollcb_default, NULL);
     abts_run_test(suite, justsleep, NULL);
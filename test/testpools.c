@@ -19,6 +19,9 @@
 #include "apr_pools.h"
 #include "apr_errno.h"
 #include "apr_file_io.h"
+#include "apr_allocator.h"
+#include "apr_thread_proc.h"
+#include "apr_time.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -64,6 +67,24 @@ static void calloc_bytes(abts_case *tc, void *data)
     }
 }
 
+static void alloc_aligned(abts_case *tc, void *data)
+{
+    apr_size_t align;
+    char *alloc;
+
+    for (align = 1; align <= 8192; align <<= 1) {
+        alloc = apr_palloc(pmain, 1); /* misalign the next allocation */
+        ABTS_PTR_NOTNULL(tc, alloc);
+        alloc = apr_palloc_aligned(pmain, ALLOC_BYTES, align);
+        ABTS_PTR_NOTNULL(tc, alloc);
+        ABTS_TRUE(tc, ((apr_uintptr_t)alloc & (align - 1)) == 0);
+        memset(alloc, 0, ALLOC_BYTES);
+    }
+
+    ABTS_PTR_EQUAL(tc, NULL, apr_palloc_aligned(pmain, ALLOC_BYTES, 0));
+    ABTS_PTR_EQUAL(tc, NULL, apr_palloc_aligned(pmain, ALLOC_BYTES, 24));
+}
+
 static void parent_pool(abts_case *tc, void *data)
 {
     apr_status_t rv;
@@ -176,6 +197,168 @@ static void test_tags(abts_case *tc, void *data)
     ABTS_STR_EQUAL(tc, "main pool", apr_pool_get_tag(pmain));
 }
 
+#if APR_HAS_THREADS
+#define CACHE_THREADS 4
+#define CACHE_LOOPS   500
+
+static void * APR_THREAD_FUNC cache_thread(apr_thread_t *thd, void *data)
+{
+    apr_allocator_t *allocator = data;
+    apr_status_t rv = APR_SUCCESS;
+    int i, j;
+
+    for (i = 0; i < CACHE_LOOPS && rv == APR_SUCCESS; i++) {
+        apr_pool_t *p;
+        char *buf[4];
+
+        rv = apr_pool_create_unmanaged_ex(&p, NULL, allocator);
+        if (rv != APR_SUCCESS) {
+            break;
+        }
+        for (j = 0; j < 4; j++) {
+            apr_size_t size = 1000 + (i % 7) * 5000 + j * 30000;
+
+            buf[j] = apr_palloc(p, size);
+            memset(buf[j], j, size);
+        }
+        for (j = 0; j < 4; j++) {
+            if (buf[j][0] != j) {
+                rv = APR_EGENERAL;
+            }
+        }
+        apr_pool_destroy(p);
+    }
+
+    apr_thread_exit(thd, rv);
+    return NULL;
+}
+
+static void test_allocator_cache(abts_case *tc, void *data)
+{
+    apr_allocator_t *allocator;
+    apr_thread_mutex_t *mutex;
+    apr_thread_t *threads[CACHE_THREADS];
+    apr_status_t rv, retval;
+    apr_memnode_t *node;
+    int i;
+
+    rv = apr_allocator_create(&allocator);
+    APR_ASSERT_SUCCESS(tc, "create allocator", rv);
+    rv = apr_thread_mutex_create(&mutex, APR_THREAD_MUTEX_DEFAULT, pmain);
+    APR_ASSERT_SUCCESS(tc, "create allocator mutex", rv);
+    apr_allocator_mutex_set(allocator, mutex);
+
+    rv = apr_allocator_cache_set(allocator, 256 * 1024);
+    APR_ASSERT_SUCCESS(tc, "enable allocator cache", rv);
+
+    /* A freed node is handed out again from the cache */
+    node = apr_allocator_alloc(allocator, 100);
+    ABTS_PTR_NOTNULL(tc, node);
+    apr_allocator_free(allocator, node);
+    ABTS_PTR_EQUAL(tc, node, apr_allocator_alloc(allocator, 100));
+    apr_allocator_free(allocator, node);
+
+    for (i = 0; i < CACHE_THREADS; i++) {
+        rv = apr_thread_create(&threads[i], NULL, cache_thread, allocator,
+                               pmain);
+        APR_ASSERT_SUCCESS(tc, "create thread", rv);
+    }
+    for (i = 0; i < CACHE_THREADS; i++) {
+        rv = apr_thread_join(&retval, threads[i]);
+        APR_ASSERT_SUCCESS(tc, "join thread", rv);
+        APR_ASSERT_SUCCESS(tc, "thread allocations", retval);
+    }
+
+    rv = apr_allocator_cache_set(allocator, 0);
+    APR_ASSERT_SUCCESS(tc, "disable allocator cache", rv);
+
+    apr_allocator_destroy(allocator);
+}
+
+#define BENCH_THREADS 8
+#define BENCH_LOOPS   100000
+
+static void * APR_THREAD_FUNC bench_thread(apr_thread_t *thd, void *data)
+{
+    apr_allocator_t *allocator = data;
+    apr_memnode_t *node[4];
+    apr_status_t rv = APR_SUCCESS;
+    int i, j;
+
+    for (i = 0; i < BENCH_LOOPS && rv == APR_SUCCESS; i++) {
+        for (j = 0; j < 4; j++) {
+            node[j] = apr_allocator_alloc(allocator, 4000 + j * 8192);
+            if (!node[j]) {
+                rv = APR_ENOMEM;
+            }
+        }
+        for (j = 0; j < 4; j++) {
+            if (node[j]) {
+                apr_allocator_free(allocator, node[j]);
+            }
+        }
+    }
+
+    apr_thread_exit(thd, rv);
+    return NULL;
+}
+
+/* Threads allocating and freeing nodes of a few sizes from a shared
+ * allocator, with or without the caches.
+ */
+static apr_time_t bench_allocator(abts_case *tc, apr_size_t cache_size)
+{
+    apr_allocator_t *allocator;
+    apr_thread_mutex_t *mutex;
+    apr_thread_t *threads[BENCH_THREADS];
+    apr_status_t rv, retval;
+    apr_time_t start;
+    int i;
+
+    rv = apr_allocator_create(&allocator);
+    APR_ASSERT_SUCCESS(tc, "create allocator", rv);
+    rv = apr_thread_mutex_create(&mutex, APR_THREAD_MUTEX_DEFAULT, pmain);
+    APR_ASSERT_SUCCESS(tc, "create allocator mutex", rv);
+    apr_allocator_mutex_set(allocator, mutex);
+    if (cache_size) {
+        rv = apr_allocator_cache_set(allocator, cache_size);
+        APR_ASSERT_SUCCESS(tc, "enable allocator cache", rv);
+    }
+
+    start = apr_time_now();
+    for (i = 0; i < BENCH_THREADS; i++) {
+        rv = apr_thread_create(&threads[i], NULL, bench_thread, allocator,
+                               pmain);
+        APR_ASSERT_SUCCESS(tc, "create thread", rv);
+    }
+    for (i = 0; i < BENCH_THREADS; i++) {
+        rv = apr_thread_join(&retval, threads[i]);
+        APR_ASSERT_SUCCESS(tc, "join thread", rv);
+        APR_ASSERT_SUCCESS(tc, "thread allocations", retval);
+    }
+    start = apr_time_now() - start;
+
+    apr_allocator_destroy(allocator);
+    apr_thread_mutex_destroy(mutex);
+
+    return start;
+}
+
+static void test_allocator_contention(abts_case *tc, void *data)
+{
+    apr_time_t locked, cached;
+
+    locked = bench_allocator(tc, 0);
+    cached = bench_allocator(tc, 256 * 1024);
+
+    abts_log_message("%d threads, %d x 4 allocations each: "
+                     "mutex %" APR_TIME_T_FMT "ms, "
+                     "caches %" APR_TIME_T_FMT "ms",
+                     BENCH_THREADS, BENCH_LOOPS,
+                     apr_time_as_msec(locked), apr_time_as_msec(cached));
+}
+#endif /* APR_HAS_THREADS */
+
 abts_suite *testpool(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -186,8 +369,13 @@ abts_suite *testpool(abts_suite *suite)
     abts_run_test(suite, test_notancestor, NULL);
     abts_run_test(suite, alloc_bytes, NULL);
     abts_run_test(suite, calloc_bytes, NULL);
+    abts_run_test(suite, alloc_aligned, NULL);
     abts_run_test(suite, test_cleanups, NULL);
     abts_run_test(suite, test_tags, NULL);
+#if APR_HAS_THREADS
+    abts_run_test(suite, test_allocator_cache, NULL);
+    abts_run_test(suite, test_allocator_contention, NULL);
+#endif
 
     return suite;
 }
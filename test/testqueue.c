@@ -17,6 +17,7 @@
 #include "apu.h"
 #include "apr_queue.h"
 #include "apr_thread_pool.h"
+#include "apr_thread_proc.h"
 #include "apr_time.h"
 #include "abts.h"
 #include "testutil.h"
@@ -170,6 +171,183 @@ static void test_queue_timeout(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
 }
 
+static void test_queue_lockfree(abts_case *tc, void *data)
+{
+    apr_queue_t *q;
+    apr_status_t rv;
+    apr_time_t start;
+    apr_uintptr_t i;
+    void *value;
+
+    rv = apr_queue_create_ex(&q, 0, APR_QUEUE_LOCKFREE, p);
+    ABTS_INT_EQUAL(tc, APR_EINVAL, rv);
+
+    /* Rounded up to 8 */
+    rv = apr_queue_create_ex(&q, 5, APR_QUEUE_LOCKFREE, p);
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+    for (i = 0; i < 4; ++i) {
+        rv = apr_queue_timedpush(q, (void *)(i + 1), apr_time_from_msec(1));
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+    for (; i < 8; ++i) {
+        rv = apr_queue_trypush(q, (void *)(i + 1));
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+    }
+    ABTS_INT_EQUAL(tc, 8, apr_queue_size(q));
+
+    start = apr_time_now();
+    rv = apr_queue_timedpush(q, NULL, apr_time_from_msec(1));
+    ABTS_TRUE(tc, APR_STATUS_IS_TIMEUP(rv));
+    ABTS_TRUE(tc, apr_time_now() - start >= apr_time_from_msec(1));
+
+    rv = apr_queue_trypush(q, NULL);
+    ABTS_TRUE(tc, APR_STATUS_IS_EAGAIN(rv));
+
+    /* First in, first out */
+    for (i = 0; i < 4; ++i) {
+        rv = apr_queue_timedpop(q, &value, apr_time_from_msec(1));
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_PTR_EQUAL(tc, (void *)(i + 1), value);
+    }
+    for (; i < 8; ++i) {
+        rv = apr_queue_trypop(q, &value);
+        ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+        ABTS_PTR_EQUAL(tc, (void *)(i + 1), value);
+    }
+    ABTS_INT_EQUAL(tc, 0, apr_queue_size(q));
+
+    start = apr_time_now();
+    rv = apr_queue_timedpop(q, &value, apr_time_from_msec(10));
+    ABTS_TRUE(tc, APR_STATUS_IS_TIMEUP(rv));
+    ABTS_TRUE(tc, apr_time_now() - start >= apr_time_from_msec(1));
+
+    rv = apr_queue_trypop(q, &value);
+    ABTS_TRUE(tc, APR_STATUS_IS_EAGAIN(rv));
+
+    rv = apr_queue_term(q);
+    ABTS_INT_EQUAL(tc, APR_SUCCESS, rv);
+
+    rv = apr_queue_trypush(q, NULL);
+    ABTS_INT_EQUAL(tc, APR_EOF, rv);
+}
+
+#define BENCH_THREADS       4
+#define BENCH_ITEMS         200000
+#define BENCH_QUEUE_SIZE    64
+
+typedef struct bench_t {
+    apr_queue_t *q;
+    apr_uint64_t sum;
+    apr_status_t rv;
+    /* apr_queue_trypush()/trypop(), yielding until they succeed */
+    int try;
+} bench_t;
+
+static void * APR_THREAD_FUNC bench_producer(apr_thread_t *thd, void *data)
+{
+    bench_t *b = data;
+    apr_uintptr_t i;
+
+    for (i = 1; i <= BENCH_ITEMS; i++) {
+        if (b->try) {
+            while ((b->rv = apr_queue_trypush(b->q, (void *)i)) == APR_EAGAIN) {
+                apr_thread_yield();
+            }
+        }
+        else do {
+            b->rv = apr_queue_push(b->q, (void *)i);
+        } while (b->rv == APR_EINTR);
+        if (b->rv != APR_SUCCESS)
+            break;
+    }
+
+    return NULL;
+}
+
+static void * APR_THREAD_FUNC bench_consumer(apr_thread_t *thd, void *data)
+{
+    bench_t *b = data;
+    void *v;
+    int i;
+
+    for (i = 0; i < BENCH_ITEMS; i++) {
+        if (b->try) {
+            while ((b->rv = apr_queue_trypop(b->q, &v)) == APR_EAGAIN) {
+                apr_thread_yield();
+            }
+        }
+        else do {
+            b->rv = apr_queue_pop(b->q, &v);
+        } while (b->rv == APR_EINTR);
+        if (b->rv != APR_SUCCESS)
+            break;
+        b->sum += (apr_uintptr_t)v;
+    }
+
+    return NULL;
+}
+
+/* As many producers as consumers contending on a small queue, with
+ * every item accounted for.
+ */
+static apr_time_t bench_queue(abts_case *tc, apr_uint32_t flags, int try)
+{
+    apr_thread_t *threads[BENCH_THREADS * 2];
+    bench_t bench[BENCH_THREADS * 2];
+    apr_uint64_t sum = 0;
+    apr_queue_t *q;
+    apr_time_t start;
+    apr_status_t rv, retval;
+    int i;
+
+    rv = apr_queue_create_ex(&q, BENCH_QUEUE_SIZE, flags, p);
+    APR_ASSERT_SUCCESS(tc, "create queue", rv);
+
+    start = apr_time_now();
+    for (i = 0; i < BENCH_THREADS * 2; i++) {
+        bench[i].q = q;
+        bench[i].sum = 0;
+        bench[i].rv = APR_SUCCESS;
+        bench[i].try = try;
+        rv = apr_thread_create(&threads[i], NULL,
+                               (i % 2) ? bench_consumer : bench_producer,
+                               &bench[i], p);
+        APR_ASSERT_SUCCESS(tc, "create thread", rv);
+    }
+    for (i = 0; i < BENCH_THREADS * 2; i++) {
+        apr_thread_join(&retval, threads[i]);
+        APR_ASSERT_SUCCESS(tc, "push/pop", bench[i].rv);
+        sum += bench[i].sum;
+    }
+
+    ABTS_TRUE(tc, sum == (apr_uint64_t)BENCH_THREADS
+                         * BENCH_ITEMS * (BENCH_ITEMS + 1) / 2);
+    ABTS_INT_EQUAL(tc, 0, apr_queue_size(q));
+
+    apr_queue_term(q);
+    return apr_time_now() - start;
+}
+
+static void test_queue_contention(abts_case *tc, void *data)
+{
+    apr_time_t locked, lockfree;
+    int try;
+
+    for (try = 0; try <= 1; try++) {
+        locked = bench_queue(tc, 0, try);
+        lockfree = bench_queue(tc, APR_QUEUE_LOCKFREE, try);
+
+        abts_log_message("%d producers/consumers, %d items each (%s): "
+                         "mutex %" APR_TIME_T_FMT "ms, "
+                         "lock-free %" APR_TIME_T_FMT "ms",
+                         BENCH_THREADS, BENCH_ITEMS,
+                         try ? "trypush/trypop" : "push/pop",
+                         apr_time_as_msec(locked),
+                         apr_time_as_msec(lockfree));
+    }
+}
+
 #endif /* APR_HAS_THREADS */
 
 abts_suite *testqueue(abts_suite *suite)
@@ -179,6 +357,8 @@ abts_suite *testqueue(abts_suite *suite)
 #if APR_HAS_THREADS
     abts_run_test(suite, test_queue_producer_consumer, NULL);
     abts_run_test(suite, test_queue_timeout, NULL);
+    abts_run_test(suite, test_queue_lockfree, NULL);
+    abts_run_test(suite, test_queue_contention, NULL);
 #endif /* APR_HAS_THREADS */
 
     return suite;
@@ -192,6 +192,173 @@ static void sendto_receivefrom6(abts_case *tc, void *data)
 }
 #endif
 
+#define NMSGS 8
+
+static void sendmmsg_recvmmsg(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_socket_t *sock, *sock2;
+    apr_sockaddr_t *to, *from;
+    apr_sockmsg_t msgs[NMSGS];
+    char bufs[NMSGS][STRLEN];
+    apr_size_t i, n, total;
+
+    rv = apr_sockaddr_info_get(&to, "127.0.0.1", APR_INET, 7774, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not get address", rv);
+    rv = apr_sockaddr_info_get(&from, "127.0.0.1", APR_INET, 7773, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not get address", rv);
+
+    rv = apr_socket_create(&sock, APR_INET, SOCK_DGRAM, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not create receiving socket", rv);
+    rv = apr_socket_create(&sock2, APR_INET, SOCK_DGRAM, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not create sending socket", rv);
+
+    rv = apr_socket_opt_set(sock, APR_SO_REUSEADDR, 1);
+    APR_ASSERT_SUCCESS(tc, "Could not set REUSEADDR on socket", rv);
+    rv = apr_socket_opt_set(sock2, APR_SO_REUSEADDR, 1);
+    APR_ASSERT_SUCCESS(tc, "Could not set REUSEADDR on socket2", rv);
+    rv = apr_socket_bind(sock, to);
+    APR_ASSERT_SUCCESS(tc, "Could not bind receiving socket", rv);
+    if (rv != APR_SUCCESS)
+        return;
+    rv = apr_socket_bind(sock2, from);
+    APR_ASSERT_SUCCESS(tc, "Could not bind sending socket", rv);
+    if (rv != APR_SUCCESS)
+        return;
+    rv = apr_socket_timeout_set(sock, apr_time_from_sec(5));
+    APR_ASSERT_SUCCESS(tc, "Could not set timeout", rv);
+
+    for (i = 0; i < NMSGS; i++) {
+        msgs[i].addr = to;
+        msgs[i].buf = apr_psprintf(p, "datagram %" APR_SIZE_T_FMT, i);
+        msgs[i].len = strlen(msgs[i].buf);
+        msgs[i].segsize = 0;
+    }
+    rv = apr_socket_sendmmsg(sock2, msgs, NMSGS, 0, &n);
+    APR_ASSERT_SUCCESS(tc, "Could not send datagrams", rv);
+    ABTS_SIZE_EQUAL(tc, NMSGS, n);
+
+    /* Fewer datagrams than asked for may be returned by each call */
+    for (total = 0; total < NMSGS; total += n) {
+        for (i = total; i < NMSGS; i++) {
+            msgs[i].addr = apr_pcalloc(p, sizeof(apr_sockaddr_t));
+            msgs[i].addr->pool = p;
+            msgs[i].buf = bufs[i];
+            msgs[i].len = sizeof(bufs[i]);
+        }
+        rv = apr_socket_recvmmsg(sock, msgs + total, NMSGS - total, 0, &n);
+        APR_ASSERT_SUCCESS(tc, "Could not receive datagrams", rv);
+        if (rv != APR_SUCCESS)
+            return;
+        ABTS_ASSERT(tc, "No datagram received", n > 0);
+    }
+    ABTS_SIZE_EQUAL(tc, NMSGS, total);
+
+    for (i = 0; i < NMSGS; i++) {
+        char *ip_addr;
+
+        ABTS_STR_EQUAL(tc, apr_psprintf(p, "datagram %" APR_SIZE_T_FMT, i),
+                       apr_pstrmemdup(p, msgs[i].buf, msgs[i].len));
+        ABTS_SIZE_EQUAL(tc, 0, msgs[i].segsize);
+        apr_sockaddr_ip_get(&ip_addr, msgs[i].addr);
+        ABTS_STR_EQUAL(tc, "127.0.0.1", ip_addr);
+        ABTS_INT_EQUAL(tc, 7773, msgs[i].addr->port);
+    }
+
+    /* Nothing left to receive */
+    apr_socket_timeout_set(sock, 0);
+    msgs[0].len = sizeof(bufs[0]);
+    rv = apr_socket_recvmmsg(sock, msgs, 1, 0, &n);
+    ABTS_INT_EQUAL(tc, 1, APR_STATUS_IS_EAGAIN(rv));
+    ABTS_SIZE_EQUAL(tc, 0, n);
+
+    apr_socket_close(sock);
+    apr_socket_close(sock2);
+}
+
+static void udp_segment_gro(abts_case *tc, void *data)
+{
+    apr_status_t rv;
+    apr_socket_t *sock, *sock2;
+    apr_sockaddr_t *to;
+    apr_sockmsg_t msg;
+    char segments[] = "0123456789abcdefghijABCDEFGHIJ";
+    char buf[64];
+    apr_size_t n, total;
+
+    rv = apr_sockaddr_info_get(&to, "127.0.0.1", APR_INET, 7775, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not get address", rv);
+    rv = apr_socket_create(&sock, APR_INET, SOCK_DGRAM, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not create receiving socket", rv);
+    rv = apr_socket_create(&sock2, APR_INET, SOCK_DGRAM, 0, p);
+    APR_ASSERT_SUCCESS(tc, "Could not create sending socket", rv);
+    rv = apr_socket_opt_set(sock, APR_SO_REUSEADDR, 1);
+    APR_ASSERT_SUCCESS(tc, "Could not set REUSEADDR on socket", rv);
+    rv = apr_socket_bind(sock, to);
+    APR_ASSERT_SUCCESS(tc, "Could not bind receiving socket", rv);
+    if (rv != APR_SUCCESS)
+        return;
+    rv = apr_socket_timeout_set(sock, apr_time_from_sec(5));
+    APR_ASSERT_SUCCESS(tc, "Could not set timeout", rv);
+
+    rv = apr_socket_opt_set(sock, APR_SO_UDP_GRO, 1);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "UDP GRO");
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "Could not set UDP_GRO", rv);
+
+    /* The segment size is what opt_get returns */
+    rv = apr_socket_opt_set(sock2, APR_SO_UDP_SEGMENT, 10);
+    if (rv != APR_ENOTIMPL) {
+        apr_int32_t segsize;
+
+        APR_ASSERT_SUCCESS(tc, "Could not set UDP_SEGMENT", rv);
+        rv = apr_socket_opt_get(sock2, APR_SO_UDP_SEGMENT, &segsize);
+        APR_ASSERT_SUCCESS(tc, "Could not get UDP_SEGMENT", rv);
+        ABTS_INT_EQUAL(tc, 10, segsize);
+        rv = apr_socket_opt_set(sock2, APR_SO_UDP_SEGMENT, 0);
+        APR_ASSERT_SUCCESS(tc, "Could not reset UDP_SEGMENT", rv);
+        rv = apr_socket_opt_get(sock2, APR_SO_UDP_SEGMENT, &segsize);
+        APR_ASSERT_SUCCESS(tc, "Could not get UDP_SEGMENT", rv);
+        ABTS_INT_EQUAL(tc, 0, segsize);
+    }
+
+    /* Three segments of 10 bytes in a single send */
+    msg.addr = to;
+    msg.buf = segments;
+    msg.len = 30;
+    msg.segsize = 10;
+    rv = apr_socket_sendmmsg(sock2, &msg, 1, 0, &n);
+    if (rv == APR_ENOTIMPL) {
+        ABTS_NOT_IMPL(tc, "UDP GSO");
+        return;
+    }
+    APR_ASSERT_SUCCESS(tc, "Could not send segmented datagram", rv);
+    ABTS_SIZE_EQUAL(tc, 1, n);
+    ABTS_SIZE_EQUAL(tc, 30, msg.len);
+
+    /* The segments may be received coalesced or one by one */
+    for (total = 0; total < 30; total += msg.len) {
+        msg.addr = NULL;
+        msg.buf = buf + total;
+        msg.len = sizeof(buf) - total;
+        rv = apr_socket_recvmmsg(sock, &msg, 1, 0, &n);
+        APR_ASSERT_SUCCESS(tc, "Could not receive datagram", rv);
+        if (rv != APR_SUCCESS)
+            return;
+        ABTS_SIZE_EQUAL(tc, 1, n);
+        if (msg.len > 10) {
+            ABTS_SIZE_EQUAL(tc, 10, msg.segsize);
+        }
+    }
+    ABTS_SIZE_EQUAL(tc, 30, total);
+    ABTS_STR_EQUAL(tc, segments, apr_pstrmemdup(p, buf, total));
+
+    apr_socket_close(sock);
+    apr_socket_close(sock2);
+}
+
 static void socket_userdata(abts_case *tc, void *data)
 {
     apr_socket_t *sock1, *sock2;
@@ -225,6 +392,8 @@ abts_suite *testsockets(abts_suite *suite)
     abts_run_test(suite, udp_socket, NULL);
 
     abts_run_test(suite, sendto_receivefrom, NULL);
+    abts_run_test(suite, sendmmsg_recvmmsg, NULL);
+    abts_run_test(suite, udp_segment_gro, NULL);
 
 #if APR_HAVE_IPV6
     abts_run_test(suite, tcp6_socket, NULL);
@@ -19,6 +19,9 @@
 #include "apr.h"
 #include "apr_general.h"
 #include "apr_strmatch.h"
+#include "apr_lib.h"
+#include "apr_strings.h"
+#include "apr_time.h"
 #if APR_HAVE_STDLIB_H
 #include <stdlib.h>
 #endif
@@ -81,11 +84,346 @@ static void test_str(abts_case *tc, void *data)
     ABTS_PTR_EQUAL(tc, input6 + 35, match);
 }
 
+/* The vector search, around the block boundaries and at the end */
+static void test_str_blocks(abts_case *tc, void *data)
+{
+    static const char *patterns[] = { "x", "xy", "xyz", "xyzxyzxyzxyzxyzX",
+                                      "xyzxyzxyzxyzxyzxyzxyzxyzxyzxyzxY" };
+    char buf[256];
+    int n;
+
+    for (n = 0; n < (int)(sizeof(patterns) / sizeof(patterns[0])); n++) {
+        const apr_strmatch_pattern *pattern, *pattern_nocase;
+        apr_size_t len = strlen(patterns[n]), i, slen;
+
+        pattern = apr_strmatch_precompile(p, patterns[n], 1);
+        pattern_nocase = apr_strmatch_precompile(p, patterns[n], 0);
+        for (slen = len; slen < 100; slen++) {
+            for (i = 0; i + len <= slen; i++) {
+                const char *match;
+
+                memset(buf, 'x', slen);
+                memcpy(buf + i, patterns[n], len);
+                match = apr_strmatch(pattern, buf, slen);
+                ABTS_ASSERT(tc, "first match", match && match <= buf + i);
+
+                memset(buf, '.', slen);
+                memcpy(buf + i, patterns[n], len);
+                ABTS_PTR_EQUAL(tc, buf + i, apr_strmatch(pattern, buf, slen));
+                ABTS_PTR_EQUAL(tc, NULL, apr_strmatch(pattern, buf,
+                                                      i + len - 1));
+                ABTS_PTR_EQUAL(tc, NULL, apr_strmatch(pattern, buf + i + 1,
+                                                      slen - i - 1));
+
+                buf[i] = apr_toupper(buf[i]);
+                buf[i + len - 1] = apr_toupper(buf[i + len - 1]);
+                ABTS_PTR_EQUAL(tc, buf + i, apr_strmatch(pattern_nocase,
+                                                         buf, slen));
+                buf[i + len - 1] = '\200';
+                ABTS_PTR_EQUAL(tc, NULL, apr_strmatch(pattern_nocase,
+                                                      buf, slen));
+            }
+        }
+    }
+}
+
+/* Throughput by pattern length, with the match at the end */
+static void test_str_bench(abts_case *tc, void *data)
+{
+    static const char text[] = "GET /index.html HTTP/1.1, Host: example.org"
+                               ", User-Agent: Mozilla/5.0 (X11; Linux) ";
+    static const int lengths[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    const apr_size_t slen = 8 * 1024 * 1024;
+    char *input, *pat;
+    int n, k;
+
+    input = apr_palloc(p, slen);
+    for (n = 0; n < (int)slen; n++) {
+        input[n] = text[n % (sizeof(text) - 1)];
+    }
+    pat = apr_palloc(p, 129);
+
+    for (n = 0; n < (int)(sizeof(lengths) / sizeof(lengths[0])); n++) {
+        apr_time_t t[2];
+
+        /* From the text but for the last byte, at the end of the input */
+        memcpy(pat, input + 1000, lengths[n]);
+        pat[lengths[n] - 1] = '#';
+        pat[lengths[n]] = '\0';
+        memcpy(input + slen - lengths[n], pat, lengths[n]);
+
+        for (k = 0; k < 2; k++) {
+            const apr_strmatch_pattern *pattern;
+            const char *match;
+            int i;
+
+            pattern = apr_strmatch_precompile(p, pat, !k);
+            t[k] = apr_time_now();
+            for (i = 0; i < 10; i++) {
+                match = apr_strmatch(pattern, input, slen);
+                ABTS_PTR_EQUAL(tc, input + slen - lengths[n], match);
+            }
+            t[k] = apr_time_now() - t[k];
+        }
+
+        abts_log_message("%3d bytes pattern: %5" APR_TIME_T_FMT " MB/s (%5"
+                         APR_TIME_T_FMT " MB/s case insensitive)",
+                         lengths[n],
+                         (apr_time_t)(10 * slen) / (t[0] ? t[0] : 1),
+                         (apr_time_t)(10 * slen) / (t[1] ? t[1] : 1));
+        memcpy(input + slen - lengths[n], input + slen - 128 - lengths[n],
+               lengths[n]);
+    }
+}
+
+typedef struct {
+    char buf[256];
+    apr_size_t len;
+    int stop_after;
+} set_matches_t;
+
+/* Collects the matches as "pattern@offset " */
+static int set_collect(void *baton, apr_size_t pattern, apr_off_t offset)
+{
+    set_matches_t *m = baton;
+
+    m->len += apr_snprintf(m->buf + m->len, sizeof(m->buf) - m->len,
+                           "%" APR_SIZE_T_FMT "@%" APR_OFF_T_FMT " ",
+                           pattern, offset);
+    return --m->stop_after != 0;
+}
+
+static const char * const set_patterns[] = {
+    "he", "she", "his", "hers", "", "she", "s"
+};
+#define SET_PATTERNS 7
+#define SET_INPUT "ushers, his shell"
+#define SET_MATCHES "6@1 1@1 5@1 0@2 3@2 6@5 2@8 6@10 6@12 1@12 5@12 0@13 "
+
+static void test_set(abts_case *tc, void *data)
+{
+    const apr_strmatch_set *set;
+    const char *input = SET_INPUT;
+    apr_size_t pattern;
+    set_matches_t m;
+
+    set = apr_strmatch_precompile_set(p, set_patterns, SET_PATTERNS, 1);
+    ABTS_PTR_NOTNULL(tc, set);
+
+    m.len = 0;
+    m.stop_after = -1;
+    ABTS_INT_EQUAL(tc, 1, apr_strmatch_set_do(set, input, strlen(input),
+                                              set_collect, &m));
+    ABTS_STR_EQUAL(tc, SET_MATCHES, m.buf);
+
+    /* Stopping */
+    m.len = 0;
+    m.stop_after = 3;
+    ABTS_INT_EQUAL(tc, 0, apr_strmatch_set_do(set, input, strlen(input),
+                                              set_collect, &m));
+    ABTS_STR_EQUAL(tc, "6@1 1@1 5@1 ", m.buf);
+
+    ABTS_PTR_EQUAL(tc, input + 1,
+                   apr_strmatch_set_first(set, input, strlen(input),
+                                          &pattern));
+    ABTS_INT_EQUAL(tc, 6, pattern);
+    ABTS_PTR_EQUAL(tc, input + 2,
+                   apr_strmatch_set_first(set, input + 2, strlen(input) - 2,
+                                          &pattern));
+    ABTS_INT_EQUAL(tc, 0, pattern);
+    ABTS_PTR_EQUAL(tc, NULL, apr_strmatch_set_first(set, "HERS", 4, NULL));
+    ABTS_PTR_EQUAL(tc, NULL, apr_strmatch_set_first(set, "xy\200", 3, NULL));
+    ABTS_PTR_EQUAL(tc, NULL, apr_strmatch_set_first(set, input, 0, NULL));
+}
+
+static void test_set_nocase(abts_case *tc, void *data)
+{
+    static const char * const patterns[] = { "Cookie", "SET-cookie" };
+    const apr_strmatch_set *set;
+    const char *input = "uSHErs, HiS shELL";
+    apr_size_t pattern;
+    set_matches_t m;
+
+    set = apr_strmatch_precompile_set(p, set_patterns, SET_PATTERNS, 0);
+    ABTS_PTR_NOTNULL(tc, set);
+    m.len = 0;
+    m.stop_after = -1;
+    apr_strmatch_set_do(set, input, strlen(input), set_collect, &m);
+    ABTS_STR_EQUAL(tc, SET_MATCHES, m.buf);
+
+    set = apr_strmatch_precompile_set(p, patterns, 2, 0);
+    input = "X-Set-Cookie\200: cookie";
+    ABTS_PTR_EQUAL(tc, input + 2,
+                   apr_strmatch_set_first(set, input, strlen(input),
+                                          &pattern));
+    ABTS_INT_EQUAL(tc, 1, pattern);
+    m.len = 0;
+    m.stop_after = -1;
+    apr_strmatch_set_do(set, input, strlen(input), set_collect, &m);
+    ABTS_STR_EQUAL(tc, "1@2 0@6 0@15 ", m.buf);
+}
+
+/* Matches spanning the parts of a stream */
+static void test_set_stream(abts_case *tc, void *data)
+{
+    const apr_strmatch_set *set;
+    apr_strmatch_stream *stream;
+    const char *input = SET_INPUT;
+    apr_size_t i, len = strlen(input);
+    set_matches_t m;
+
+    set = apr_strmatch_precompile_set(p, set_patterns, SET_PATTERNS, 1);
+    stream = apr_strmatch_stream_create(p, set);
+
+    /* Byte by byte */
+    m.len = 0;
+    m.stop_after = -1;
+    for (i = 0; i < len; i++) {
+        apr_strmatch_stream_do(stream, input + i, 1, set_collect, &m);
+    }
+    ABTS_STR_EQUAL(tc, SET_MATCHES, m.buf);
+
+    /* Stopped, then continued */
+    apr_strmatch_stream_reset(stream);
+    m.len = 0;
+    m.stop_after = 5;
+    ABTS_INT_EQUAL(tc, 1, apr_strmatch_stream_do(stream, input, 3,
+                                                 set_collect, &m));
+    ABTS_INT_EQUAL(tc, 0, apr_strmatch_stream_do(stream, input + 3, 3,
+                                                 set_collect, &m));
+    m.stop_after = -1;
+    ABTS_INT_EQUAL(tc, 1, apr_strmatch_stream_do(stream, input + 6, len - 6,
+                                                 set_collect, &m));
+    ABTS_STR_EQUAL(tc, "6@1 1@1 5@1 0@2 3@2 2@8 6@10 6@12 1@12 5@12 0@13 ",
+                   m.buf);
+}
+
+#define RANDOM_PATTERNS 50
+#define RANDOM_INPUT    4096
+
+typedef struct {
+    const char **patterns;
+    const char *input;
+    int count;
+    int errors;
+} set_check_t;
+
+static int set_check(void *baton, apr_size_t pattern, apr_off_t offset)
+{
+    set_check_t *c = baton;
+    const char *pat = c->patterns[pattern];
+
+    if (strncmp(c->input + offset, pat, strlen(pat)) != 0) {
+        c->errors++;
+    }
+    c->count++;
+    return 1;
+}
+
+/* Against a naive search, on a small alphabet for many overlaps */
+static void test_set_random(abts_case *tc, void *data)
+{
+    const char *patterns[RANDOM_PATTERNS];
+    char input[RANDOM_INPUT + 1];
+    const apr_strmatch_set *set;
+    set_check_t c;
+    int i, j, expected = 0;
+
+    srand(42);
+    for (i = 0; i < RANDOM_PATTERNS; i++) {
+        int len = 1 + rand() % 6;
+        char *pat = apr_palloc(p, len + 1);
+        for (j = 0; j < len; j++) {
+            pat[j] = 'a' + rand() % 3;
+        }
+        pat[len] = '\0';
+        patterns[i] = pat;
+    }
+    for (i = 0; i < RANDOM_INPUT; i++) {
+        input[i] = 'a' + rand() % 4;
+    }
+    input[RANDOM_INPUT] = '\0';
+
+    for (i = 0; i < RANDOM_INPUT; i++) {
+        for (j = 0; j < RANDOM_PATTERNS; j++) {
+            if (!strncmp(input + i, patterns[j], strlen(patterns[j]))) {
+                expected++;
+            }
+        }
+    }
+
+    set = apr_strmatch_precompile_set(p, patterns, RANDOM_PATTERNS, 1);
+    c.patterns = patterns;
+    c.input = input;
+    c.count = c.errors = 0;
+    apr_strmatch_set_do(set, input, RANDOM_INPUT, set_check, &c);
+    ABTS_INT_EQUAL(tc, expected, c.count);
+    ABTS_INT_EQUAL(tc, 0, c.errors);
+}
+
+static int set_count(void *baton, apr_size_t pattern, apr_off_t offset)
+{
+    (*(int *)baton)++;
+    return 1;
+}
+
+/* One pass for the set versus one per pattern */
+static void test_set_bench(abts_case *tc, void *data)
+{
+    static const int counts[] = { 1, 10, 100, 500 };
+    const apr_size_t len = 1024 * 1024;
+    const char **patterns;
+    char *input;
+    apr_size_t i;
+    int n;
+
+    patterns = apr_palloc(p, counts[3] * sizeof(*patterns));
+    for (n = 0; n < counts[3]; n++) {
+        patterns[n] = apr_psprintf(p, "<script%dx>", n);
+    }
+    input = apr_palloc(p, len);
+    for (i = 0; i < len; i++) {
+        input[i] = "<scripts> and some text, "[i % 25];
+    }
+
+    for (n = 0; n < (int)(sizeof(counts) / sizeof(counts[0])); n++) {
+        const apr_strmatch_set *set;
+        apr_time_t t_set, t_single;
+        int j, found = 0;
+
+        t_single = apr_time_now();
+        for (j = 0; j < counts[n]; j++) {
+            const apr_strmatch_pattern *pattern;
+            pattern = apr_strmatch_precompile(p, patterns[j], 1);
+            if (apr_strmatch(pattern, input, len))
+                found++;
+        }
+        t_single = apr_time_now() - t_single;
+
+        t_set = apr_time_now();
+        set = apr_strmatch_precompile_set(p, patterns, counts[n], 1);
+        apr_strmatch_set_do(set, input, len, set_count, &found);
+        t_set = apr_time_now() - t_set;
+        ABTS_INT_EQUAL(tc, 0, found);
+
+        abts_log_message("%4d patterns in 1MB: %7" APR_TIME_T_FMT "us one "
+                         "by one, %6" APR_TIME_T_FMT "us as a set",
+                         counts[n], t_single, t_set);
+    }
+}
+
 abts_suite *teststrmatch(abts_suite *suite)
 {
     suite = ADD_SUITE(suite);
 
     abts_run_test(suite, test_str, NULL);
+    abts_run_test(suite, test_str_blocks, NULL);
+    abts_run_test(suite, test_str_bench, NULL);
+    abts_run_test(suite, test_set, NULL);
+    abts_run_test(suite, test_set_nocase, NULL);
+    abts_run_test(suite, test_set_stream, NULL);
+    abts_run_test(suite, test_set_random, NULL);
+    abts_run_test(suite, test_set_bench, NULL);
 
     return suite;
 }
@@ -222,6 +222,116 @@ static void table_overlap3(abts_case *tc, void *data)
 
 }
 
+#define LARGE_KEYS 1000
+
+static int large_do(void *rec, const char *key, const char *val)
+{
+    APR_ARRAY_PUSH((apr_array_header_t *)rec, const char *) = val;
+    return 1;
+}
+
+/* Large tables are indexed by a full hash of the keys */
+static void table_large(abts_case *tc, void *data)
+{
+    apr_table_t *t, *t2;
+    apr_array_header_t *vals;
+    char *key;
+    int i;
+
+    t = apr_table_make(p, 1);
+    for (i = 0; i < LARGE_KEYS; i++) {
+        key = apr_psprintf(p, "Header-%d", i);
+        apr_table_setn(t, key, key);
+    }
+    ABTS_INT_EQUAL(tc, LARGE_KEYS, apr_table_elts(t)->nelts);
+    for (i = 0; i < LARGE_KEYS; i++) {
+        key = apr_psprintf(p, "HEADER-%d", i);
+        ABTS_STR_EQUAL(tc, key + 6, apr_table_get(t, key) + 6);
+    }
+    ABTS_PTR_EQUAL(tc, NULL, apr_table_get(t, "Header-1000"));
+
+    /* Set, add and merge keep the order, unset shifts the entries */
+    apr_table_set(t, "header-500", "set");
+    apr_table_add(t, "header-500", "added");
+    apr_table_merge(t, "Header-501", "merged");
+    apr_table_unset(t, "header-10");
+    ABTS_INT_EQUAL(tc, LARGE_KEYS, apr_table_elts(t)->nelts);
+    ABTS_STR_EQUAL(tc, "set", apr_table_get(t, "Header-500"));
+    ABTS_STR_EQUAL(tc, "Header-501, merged", apr_table_get(t, "header-501"));
+    ABTS_STR_EQUAL(tc, "Header-999", apr_table_get(t, "header-999"));
+    ABTS_PTR_EQUAL(tc, NULL, apr_table_get(t, "Header-10"));
+
+    vals = apr_array_make(p, 2, sizeof(const char *));
+    apr_table_do(large_do, vals, t, "HEADER-500", NULL);
+    ABTS_INT_EQUAL(tc, 2, vals->nelts);
+    ABTS_STR_EQUAL(tc, "set", APR_ARRAY_IDX(vals, 0, const char *));
+    ABTS_STR_EQUAL(tc, "added", APR_ARRAY_IDX(vals, 1, const char *));
+    ABTS_STR_EQUAL(tc, "set,added", apr_table_getm(p, t, "header-500"));
+
+    apr_table_set(t, "header-500", "reset");
+    ABTS_INT_EQUAL(tc, LARGE_KEYS - 1, apr_table_elts(t)->nelts);
+    ABTS_STR_EQUAL(tc, "reset", apr_table_get(t, "Header-500"));
+    ABTS_STR_EQUAL(tc, "Header-999", apr_table_get(t, "header-999"));
+
+    /* Copies, overlays and overlaps */
+    t2 = apr_table_copy(p, t);
+    apr_table_unset(t, "header-999");
+    ABTS_STR_EQUAL(tc, "Header-999", apr_table_get(t2, "header-999"));
+    ABTS_PTR_EQUAL(tc, NULL, apr_table_get(t, "header-999"));
+
+    t2 = apr_table_make(p, 1);
+    apr_table_setn(t2, "Header-1", "overlay");
+    apr_table_setn(t2, "Header-1000", "overlay");
+    t2 = apr_table_overlay(p, t2, t);
+    ABTS_STR_EQUAL(tc, "overlay", apr_table_get(t2, "header-1"));
+    ABTS_STR_EQUAL(tc, "overlay", apr_table_get(t2, "header-1000"));
+    ABTS_STR_EQUAL(tc, "Header-2", apr_table_get(t2, "header-2"));
+
+    apr_table_overlap(t, t2, APR_OVERLAP_TABLES_SET);
+    ABTS_INT_EQUAL(tc, LARGE_KEYS - 1, apr_table_elts(t)->nelts);
+    ABTS_STR_EQUAL(tc, "overlay", apr_table_get(t, "header-1000"));
+    ABTS_STR_EQUAL(tc, "Header-998", apr_table_get(t, "header-998"));
+
+    apr_table_clear(t);
+    ABTS_PTR_EQUAL(tc, NULL, apr_table_get(t, "header-1"));
+    apr_table_setn(t, "Header-1", "again");
+    ABTS_STR_EQUAL(tc, "again", apr_table_get(t, "header-1"));
+}
+
+/* Lookups in tables of increasing sizes */
+static void table_bench(abts_case *tc, void *data)
+{
+    static const int sizes[] = { 16, 64, 256, 1024, 4096 };
+    const int lookups = 1000000;
+    char **keys;
+    int n, i;
+
+    keys = apr_palloc(p, sizes[4] * sizeof(*keys));
+    for (i = 0; i < sizes[4]; i++) {
+        keys[i] = apr_psprintf(p, "Cookie-Name-%d", i);
+    }
+
+    for (n = 0; n < (int)(sizeof(sizes) / sizeof(sizes[0])); n++) {
+        apr_table_t *t = apr_table_make(p, sizes[n]);
+        apr_time_t start;
+        int misses = 0;
+
+        for (i = 0; i < sizes[n]; i++) {
+            apr_table_setn(t, keys[i], keys[i]);
+        }
+        start = apr_time_now();
+        for (i = 0; i < lookups; i++) {
+            if (!apr_table_get(t, keys[i % sizes[n]]))
+                misses++;
+        }
+        start = apr_time_now() - start;
+        ABTS_INT_EQUAL(tc, 0, misses);
+
+        abts_log_message("%5d entries: %d gets in %" APR_TIME_T_FMT "us",
+                         sizes[n], lookups, start);
+    }
+}
+
 abts_suite *testtable(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -239,6 +349,8 @@ abts_suite *testtable(abts_suite *suite)
     abts_run_test(suite, table_overlap, NULL);
     abts_run_test(suite, table_overlap2, NULL);
     abts_run_test(suite, table_overlap3, NULL);
+    abts_run_test(suite, table_large, NULL);
+    abts_run_test(suite, table_bench, NULL);
 
     return suite;
 }
@@ -0,0 +1,212 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apr_thread_pool.h"
+#include "apr_atomic.h"
+#include "apr_time.h"
+#include "abts.h"
+#include "testutil.h"
+
+#if APR_HAS_THREADS
+
+#define NUM_THREADS     4
+#define NUM_TASKS       1000
+#define NUM_CHILDREN    8
+
+static volatile apr_uint32_t counter;
+static apr_thread_pool_t *current_tp;
+
+static void * APR_THREAD_FUNC count_task(apr_thread_t *thd, void *data)
+{
+    apr_atomic_inc32(&counter);
+    return NULL;
+}
+
+/* Pushes more tasks from a task, they go to this thread's queue */
+static void * APR_THREAD_FUNC parent_task(apr_thread_t *thd, void *data)
+{
+    int i;
+
+    for (i = 0; i < NUM_CHILDREN; i++) {
+        apr_thread_pool_push(current_tp, count_task, NULL,
+                             APR_THREAD_TASK_PRIORITY_NORMAL, NULL);
+    }
+    apr_atomic_inc32(&counter);
+    return NULL;
+}
+
+static void * APR_THREAD_FUNC sleep_task(apr_thread_t *thd, void *data)
+{
+    apr_sleep(apr_time_from_msec(10));
+    apr_atomic_inc32(&counter);
+    return NULL;
+}
+
+/* Waits for the counter to reach n, for 10 seconds at most */
+static apr_uint32_t wait_counter(apr_uint32_t n)
+{
+    apr_time_t deadline = apr_time_now() + apr_time_from_sec(10);
+    apr_uint32_t c;
+
+    while ((c = apr_atomic_read32(&counter)) < n
+           && apr_time_now() < deadline) {
+        apr_sleep(apr_time_from_msec(1));
+    }
+    return c;
+}
+
+static void test_work_stealing(abts_case *tc, void *data)
+{
+    apr_thread_pool_t *tp;
+    apr_status_t rv;
+    apr_size_t i;
+
+    rv = apr_thread_pool_create_ex(&tp, 0, NUM_THREADS,
+                                   APR_THREAD_POOL_WORK_STEALING, p);
+    APR_ASSERT_SUCCESS(tc, "create work stealing pool", rv);
+    ABTS_SIZE_EQUAL(tc, NUM_THREADS, apr_thread_pool_queues_count(tp));
+
+    apr_atomic_set32(&counter, 0);
+    for (i = 0; i < NUM_TASKS; i++) {
+        rv = apr_thread_pool_push(tp, count_task, NULL, (apr_byte_t)i, NULL);
+        APR_ASSERT_SUCCESS(tc, "push task", rv);
+    }
+    ABTS_INT_EQUAL(tc, NUM_TASKS, wait_counter(NUM_TASKS));
+    ABTS_SIZE_EQUAL(tc, NUM_TASKS, apr_thread_pool_tasks_run_count(tp));
+    ABTS_SIZE_EQUAL(tc, 0, apr_thread_pool_tasks_count(tp));
+    for (i = 0; i < NUM_THREADS; i++) {
+        ABTS_SIZE_EQUAL(tc, 0, apr_thread_pool_queue_tasks_count(tp, i));
+        ABTS_ASSERT(tc, "queue used",
+                    apr_thread_pool_queue_tasks_high_count(tp, i) > 0);
+    }
+
+    /* Tasks pushed by tasks */
+    apr_atomic_set32(&counter, 0);
+    current_tp = tp;
+    for (i = 0; i < NUM_TASKS / NUM_CHILDREN; i++) {
+        rv = apr_thread_pool_top(tp, parent_task, NULL,
+                                 APR_THREAD_TASK_PRIORITY_HIGH, NULL);
+        APR_ASSERT_SUCCESS(tc, "push parent task", rv);
+    }
+    i = (NUM_TASKS / NUM_CHILDREN) * (NUM_CHILDREN + 1);
+    ABTS_INT_EQUAL(tc, i, wait_counter(i));
+
+    /* Scheduled tasks still run */
+    apr_atomic_set32(&counter, 0);
+    rv = apr_thread_pool_schedule(tp, count_task, NULL,
+                                  apr_time_from_msec(10), NULL);
+    APR_ASSERT_SUCCESS(tc, "schedule task", rv);
+    ABTS_INT_EQUAL(tc, 1, wait_counter(1));
+
+    abts_log_message("%" APR_SIZE_T_FMT " tasks run, %" APR_SIZE_T_FMT
+                     " stolen", apr_thread_pool_tasks_run_count(tp),
+                     apr_thread_pool_tasks_stolen_count(tp));
+
+    rv = apr_thread_pool_destroy(tp);
+    APR_ASSERT_SUCCESS(tc, "destroy pool", rv);
+}
+
+static void test_work_stealing_cancel(abts_case *tc, void *data)
+{
+    apr_thread_pool_t *tp;
+    apr_status_t rv;
+    apr_uint32_t done;
+    int i, owner;
+
+    rv = apr_thread_pool_create_ex(&tp, NUM_THREADS, NUM_THREADS,
+                                   APR_THREAD_POOL_WORK_STEALING, p);
+    APR_ASSERT_SUCCESS(tc, "create work stealing pool", rv);
+
+    apr_atomic_set32(&counter, 0);
+    for (i = 0; i < 100; i++) {
+        rv = apr_thread_pool_push(tp, sleep_task, NULL,
+                                  APR_THREAD_TASK_PRIORITY_NORMAL, &owner);
+        APR_ASSERT_SUCCESS(tc, "push task", rv);
+    }
+    apr_sleep(apr_time_from_msec(15));
+
+    /* Nothing of the owner runs anymore once cancelled */
+    rv = apr_thread_pool_tasks_cancel(tp, &owner);
+    APR_ASSERT_SUCCESS(tc, "cancel tasks", rv);
+    done = apr_atomic_read32(&counter);
+    ABTS_ASSERT(tc, "some tasks cancelled", done < 100);
+    ABTS_SIZE_EQUAL(tc, 0, apr_thread_pool_tasks_count(tp));
+    apr_sleep(apr_time_from_msec(30));
+    ABTS_INT_EQUAL(tc, done, apr_atomic_read32(&counter));
+
+    rv = apr_thread_pool_destroy(tp);
+    APR_ASSERT_SUCCESS(tc, "destroy pool", rv);
+}
+
+#define BENCH_THREADS   8
+#define BENCH_TASKS     200000
+
+static apr_time_t bench_pool(abts_case *tc, apr_uint32_t flags,
+                             apr_size_t *stolen)
+{
+    apr_thread_pool_t *tp;
+    apr_time_t start;
+    apr_status_t rv;
+    int i;
+
+    rv = apr_thread_pool_create_ex(&tp, BENCH_THREADS, BENCH_THREADS,
+                                   flags, p);
+    APR_ASSERT_SUCCESS(tc, "create pool", rv);
+
+    apr_atomic_set32(&counter, 0);
+    start = apr_time_now();
+    for (i = 0; i < BENCH_TASKS; i++) {
+        apr_thread_pool_push(tp, count_task, NULL,
+                             APR_THREAD_TASK_PRIORITY_NORMAL, NULL);
+    }
+    ABTS_INT_EQUAL(tc, BENCH_TASKS, wait_counter(BENCH_TASKS));
+    start = apr_time_now() - start;
+
+    *stolen = apr_thread_pool_tasks_stolen_count(tp);
+    apr_thread_pool_destroy(tp);
+    return start;
+}
+
+/* Short tasks on many threads, shared queue versus work stealing */
+static void test_work_stealing_bench(abts_case *tc, void *data)
+{
+    apr_time_t shared, stealing;
+    apr_size_t stolen;
+
+    shared = bench_pool(tc, 0, &stolen);
+    stealing = bench_pool(tc, APR_THREAD_POOL_WORK_STEALING, &stolen);
+
+    abts_log_message("%d threads, %d tasks: shared %" APR_TIME_T_FMT "ms, "
+                     "work stealing %" APR_TIME_T_FMT "ms (%" APR_SIZE_T_FMT
+                     " stolen)", BENCH_THREADS, BENCH_TASKS,
+                     apr_time_as_msec(shared), apr_time_as_msec(stealing),
+                     stolen);
+}
+
+#endif /* APR_HAS_THREADS */
+
+abts_suite *testthreadpool(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite);
+
+#if APR_HAS_THREADS
+    abts_run_test(suite, test_work_stealing, NULL);
+    abts_run_test(suite, test_work_stealing_cancel, NULL);
+    abts_run_test(suite, test_work_stealing_bench, NULL);
+#endif /* APR_HAS_THREADS */
+
+    return suite;
+}
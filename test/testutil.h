@@ -73,6 +73,7 @@ abts_suite *testdup(abts_suite *suite);
 abts_suite *testencode(abts_suite *suite);
 abts_suite *testenv(abts_suite *suite);
 abts_suite *testfile(abts_suite *suite);
+abts_suite *testfileaio(abts_suite *suite);
 abts_suite *testfilecopy(abts_suite *suite);
 abts_suite *testfileinfo(abts_suite *suite);
 abts_suite *testflock(abts_suite *suite);
@@ -127,6 +128,7 @@ abts_suite *testmemcache(abts_suite *suite);
 abts_suite *testredis(abts_suite *suite);
 abts_suite *testreslist(abts_suite *suite);
 abts_suite *testqueue(abts_suite *suite);
+abts_suite *testthreadpool(abts_suite *suite);
 abts_suite *testxml(abts_suite *suite);
 abts_suite *testxlate(abts_suite *suite);
 abts_suite *testrmm(abts_suite *suite);
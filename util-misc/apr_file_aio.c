@@ -0,0 +1,915 @@
+/* Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apr_private.h"
+#include "apr_file_aio.h"
+#include "apr_portable.h"
+#include "apr_strings.h"
+#include "apr_thread_pool.h"
+#include "apr_thread_mutex.h"
+#include "apr_thread_cond.h"
+
+#if APR_HAVE_ERRNO_H
+#include <errno.h>
+#endif
+#if APR_HAVE_STRING_H
+#include <string.h>
+#endif
+
+#if defined(HAVE_IO_URING)
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+
+#define ring_load(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ring_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* The maximum number of entries of the submission ring, operations are
+ * submitted one at a time so it only needs room for those the kernel
+ * could not take yet (EAGAIN).
+ */
+#define AIO_URING_MAX_ENTRIES 4096
+
+/* Enough for any read or write, Linux transfers 2GB at most */
+#define AIO_URING_MAX_LEN 0x7ffff000
+#endif
+
+/* The threads performing the operations when io_uring is not available */
+#define AIO_MAX_THREADS 8
+
+typedef enum {
+    AIO_SYNC,
+    AIO_THREADS,
+    AIO_URING
+} aio_method_e;
+
+struct apr_file_aio_t {
+    apr_pool_t *pool;
+    aio_method_e method;
+    /* Number of operations submitted and not reaped yet */
+    apr_uint32_t pending;
+    /* Copy of the registered buffers */
+    struct iovec *bufs;
+    apr_size_t nbufs;
+    apr_file_t *notifier;
+    /* The operations completed, not reaped yet (all methods but io_uring,
+     * which reaps them from its completion ring).
+     */
+    apr_file_aio_op_t *done;
+    apr_file_aio_op_t *done_tail;
+#if APR_HAS_THREADS
+    apr_thread_pool_t *tp;
+    apr_thread_mutex_t *mutex;
+    apr_thread_cond_t *cond;
+    /* Serializes the operations seeking the files (no positional I/O) */
+    apr_thread_mutex_t *seek_mutex;
+    /* The write end of the notifier pipe, and whether it has been written
+     * since the last reap.
+     */
+    apr_file_t *notifier_out;
+    int notified;
+#endif
+#if defined(HAVE_IO_URING)
+    int fd;
+    int efd;
+    unsigned int to_submit;
+    /* Number of operations submitted whose completion is not harvested */
+    unsigned int inflight;
+    /* Submission ring */
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int sq_entries;
+    struct io_uring_sqe *sqes;
+    /* Completion ring */
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_cqe *cqes;
+    /* Mappings of the rings */
+    void *sq_map;
+    void *cq_map;
+    apr_size_t sq_map_len;
+    apr_size_t cq_map_len;
+    apr_size_t sqes_map_len;
+#endif
+};
+
+/* Read or write at the offset of an operation by seeking the file, for
+ * the systems without positional I/O; the threads take turns.
+ */
+static apr_status_t aio_seek_perform(apr_file_aio_op_t *op)
+{
+    apr_off_t offset = op->offset;
+    apr_status_t rv;
+
+#if APR_HAS_THREADS
+    if (op->aio->seek_mutex) {
+        apr_thread_mutex_lock(op->aio->seek_mutex);
+    }
+#endif
+    op->nbytes = op->len;
+    rv = apr_file_seek(op->file, APR_SET, &offset);
+    if (rv != APR_SUCCESS) {
+        op->nbytes = 0;
+    }
+    else if (op->type == APR_FILE_AIO_READ) {
+        rv = apr_file_read(op->file, op->buf, &op->nbytes);
+    }
+    else {
+        rv = apr_file_write(op->file, op->buf, &op->nbytes);
+    }
+#if APR_HAS_THREADS
+    if (op->aio->seek_mutex) {
+        apr_thread_mutex_unlock(op->aio->seek_mutex);
+    }
+#endif
+    return rv;
+}
+
+/* Perform an operation synchronously */
+static void aio_perform(apr_file_aio_op_t *op)
+{
+    op->nbytes = 0;
+    switch (op->type) {
+    case APR_FILE_AIO_READ:
+        op->nbytes = op->len;
+        op->status = apr_file_pread(op->file, op->buf, &op->nbytes,
+                                    op->offset);
+        if (op->status == APR_ENOTIMPL) {
+            op->status = aio_seek_perform(op);
+        }
+        if (op->status == APR_SUCCESS && op->len && !op->nbytes) {
+            op->status = APR_EOF;
+        }
+        break;
+    case APR_FILE_AIO_WRITE:
+        op->nbytes = op->len;
+        op->status = apr_file_pwrite(op->file, op->buf, &op->nbytes,
+                                     op->offset);
+        if (op->status == APR_ENOTIMPL) {
+            op->status = aio_seek_perform(op);
+        }
+        break;
+    case APR_FILE_AIO_SYNC:
+        op->status = apr_file_sync(op->file);
+        break;
+    case APR_FILE_AIO_DATASYNC:
+        op->status = apr_file_datasync(op->file);
+        break;
+    }
+}
+
+static void aio_done_push(apr_file_aio_t *aio, apr_file_aio_op_t *op)
+{
+    op->next = NULL;
+    if (aio->done_tail) {
+        aio->done_tail->next = op;
+    }
+    else {
+        aio->done = op;
+    }
+    aio->done_tail = op;
+}
+
+/* Run the callbacks of a list of completed operations */
+static apr_uint32_t aio_done_run(apr_file_aio_t *aio, apr_file_aio_op_t *op)
+{
+    apr_file_aio_op_t *next;
+    apr_uint32_t n = 0;
+
+    for (; op; op = next) {
+        next = op->next;
+        op->next = NULL;
+        aio->pending--;
+        n++;
+        if (op->cb) {
+            op->cb(op);
+        }
+    }
+    return n;
+}
+
+#if APR_HAS_THREADS
+
+static void * APR_THREAD_FUNC aio_task(apr_thread_t *thd, void *data)
+{
+    apr_file_aio_op_t *op = data;
+    apr_file_aio_t *aio = op->aio;
+
+    aio_perform(op);
+
+    apr_thread_mutex_lock(aio->mutex);
+    aio_done_push(aio, op);
+    if (aio->notifier_out && !aio->notified) {
+        char c = 0;
+        apr_size_t len = 1;
+
+        /* Non-blocking, it's readable already if full */
+        apr_file_write(aio->notifier_out, &c, &len);
+        aio->notified = 1;
+    }
+    apr_thread_cond_signal(aio->cond);
+    apr_thread_mutex_unlock(aio->mutex);
+
+    return NULL;
+}
+
+static void aio_notifier_drain(apr_file_aio_t *aio)
+{
+    char buf[64];
+    apr_size_t len;
+
+    do {
+        len = sizeof(buf);
+    } while (apr_file_read(aio->notifier, buf, &len) == APR_SUCCESS);
+}
+
+static apr_status_t aio_threads_create(apr_file_aio_t *aio,
+                                       apr_uint32_t size)
+{
+    apr_status_t rv;
+
+    rv = apr_thread_mutex_create(&aio->mutex, APR_THREAD_MUTEX_DEFAULT,
+                                 aio->pool);
+    if (rv == APR_SUCCESS) {
+        rv = apr_thread_mutex_create(&aio->seek_mutex,
+                                     APR_THREAD_MUTEX_DEFAULT, aio->pool);
+    }
+    if (rv == APR_SUCCESS) {
+        rv = apr_thread_cond_create(&aio->cond, aio->pool);
+    }
+    if (rv == APR_SUCCESS) {
+        rv = apr_thread_pool_create(&aio->tp, 0,
+                                    size < 1 ? 1 :
+                                    size > AIO_MAX_THREADS ? AIO_MAX_THREADS :
+                                    size, aio->pool);
+    }
+    return rv;
+}
+
+static apr_status_t aio_threads_reap(apr_file_aio_t *aio,
+                                     apr_interval_time_t timeout,
+                                     apr_uint32_t *num)
+{
+    apr_file_aio_op_t *done;
+    apr_status_t rv = APR_SUCCESS;
+    apr_time_t deadline = 0;
+
+    if (timeout > 0) {
+        deadline = apr_time_now() + timeout;
+    }
+
+    apr_thread_mutex_lock(aio->mutex);
+    while (!aio->done && timeout != 0) {
+        if (timeout < 0) {
+            apr_thread_cond_wait(aio->cond, aio->mutex);
+        }
+        else {
+            rv = apr_thread_cond_timedwait(aio->cond, aio->mutex, timeout);
+            if (rv != APR_SUCCESS && !APR_STATUS_IS_TIMEUP(rv)) {
+                break;
+            }
+            timeout = deadline - apr_time_now();
+            if (timeout < 0) {
+                timeout = 0;
+            }
+        }
+    }
+    done = aio->done;
+    aio->done = aio->done_tail = NULL;
+    if (aio->notified) {
+        aio_notifier_drain(aio);
+        aio->notified = 0;
+    }
+    apr_thread_mutex_unlock(aio->mutex);
+
+    if (!done) {
+        return APR_STATUS_IS_TIMEUP(rv) || rv == APR_SUCCESS ? APR_TIMEUP : rv;
+    }
+    *num = aio_done_run(aio, done);
+    return APR_SUCCESS;
+}
+
+#endif /* APR_HAS_THREADS */
+
+#if defined(HAVE_IO_URING)
+
+static int aio_uring_enter(apr_file_aio_t *aio, unsigned int min_complete,
+                           unsigned int flags, void *arg, apr_size_t argsz)
+{
+    int ret;
+
+    ret = syscall(__NR_io_uring_enter, aio->fd, aio->to_submit,
+                  min_complete, flags, arg, argsz);
+    if (ret > 0) {
+        aio->to_submit -= ret;
+    }
+    return ret;
+}
+
+static void aio_uring_close(apr_file_aio_t *aio)
+{
+    if (aio->sqes) {
+        munmap(aio->sqes, aio->sqes_map_len);
+    }
+    if (aio->cq_map && aio->cq_map != aio->sq_map) {
+        munmap(aio->cq_map, aio->cq_map_len);
+    }
+    if (aio->sq_map) {
+        munmap(aio->sq_map, aio->sq_map_len);
+    }
+    close(aio->fd);
+}
+
+static apr_status_t aio_uring_create(apr_file_aio_t *aio, apr_uint32_t size)
+{
+    struct io_uring_params params;
+    apr_status_t rv;
+    char *sq, *cq;
+    int fd;
+
+    memset(&params, 0, sizeof(params));
+    if (size < 1) {
+        size = 1;
+    }
+    if (size > AIO_URING_MAX_ENTRIES) {
+        /* Make room in the completion ring for all the operations */
+        params.flags |= IORING_SETUP_CQSIZE;
+        params.cq_entries = size;
+        size = AIO_URING_MAX_ENTRIES;
+    }
+
+    /* The returned descriptor is close-on-exec already */
+    fd = syscall(__NR_io_uring_setup, size, &params);
+    if (fd < 0) {
+        rv = errno;
+        /* Not available with this kernel (or disabled), let the caller
+         * fall back to the threads.
+         */
+        if (errno == ENOSYS || errno == EPERM || errno == EINVAL) {
+            rv = APR_ENOTIMPL;
+        }
+        return rv;
+    }
+    /* Both the NODROP completion ring (more operations than completion
+     * entries can be in flight) and the timeout for waiting are required,
+     * which came with IORING_FEAT_EXT_ARG.
+     */
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        close(fd);
+        return APR_ENOTIMPL;
+    }
+    aio->fd = fd;
+
+    aio->sq_map_len = params.sq_off.array
+                      + params.sq_entries * sizeof(unsigned int);
+    aio->cq_map_len = params.cq_off.cqes
+                      + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (aio->cq_map_len > aio->sq_map_len) {
+            aio->sq_map_len = aio->cq_map_len;
+        }
+        aio->cq_map_len = aio->sq_map_len;
+    }
+
+    aio->sq_map = mmap(NULL, aio->sq_map_len, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (aio->sq_map == MAP_FAILED) {
+        rv = errno;
+        aio->sq_map = NULL;
+        aio_uring_close(aio);
+        return rv;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        aio->cq_map = aio->sq_map;
+    }
+    else {
+        aio->cq_map = mmap(NULL, aio->cq_map_len, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (aio->cq_map == MAP_FAILED) {
+            rv = errno;
+            aio->cq_map = NULL;
+            aio_uring_close(aio);
+            return rv;
+        }
+    }
+    aio->sqes_map_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    aio->sqes = mmap(NULL, aio->sqes_map_len, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (aio->sqes == MAP_FAILED) {
+        rv = errno;
+        aio->sqes = NULL;
+        aio_uring_close(aio);
+        return rv;
+    }
+
+    sq = aio->sq_map;
+    aio->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    aio->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    aio->sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+    aio->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    aio->sq_entries = params.sq_entries;
+
+    cq = aio->cq_map;
+    aio->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    aio->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    aio->cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+    aio->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    aio->efd = -1;
+
+    return APR_SUCCESS;
+}
+
+/* Harvest the completions available, up to the tail seen on entry so
+ * that operations submitted by the callbacks are left for the next reap.
+ */
+static apr_uint32_t aio_uring_harvest(apr_file_aio_t *aio, int run)
+{
+    struct io_uring_cqe *cqe;
+    apr_file_aio_op_t *op;
+    unsigned int head, tail;
+    apr_uint32_t n = 0;
+    int res;
+
+    tail = ring_load(aio->cq_tail);
+    for (head = *aio->cq_head; head != tail; ) {
+        cqe = &aio->cqes[head & *aio->cq_mask];
+        op = (apr_file_aio_op_t *)(apr_uintptr_t)cqe->user_data;
+        res = cqe->res;
+        ring_store(aio->cq_head, ++head);
+        aio->inflight--;
+        if (!run) {
+            continue;
+        }
+
+        if (res < 0) {
+            op->status = APR_FROM_OS_ERROR(-res);
+            op->nbytes = 0;
+        }
+        else {
+            op->nbytes = res;
+            op->status = (op->type == APR_FILE_AIO_READ && op->len && !res)
+                         ? APR_EOF : APR_SUCCESS;
+        }
+        aio->pending--;
+        n++;
+        if (op->cb) {
+            op->cb(op);
+        }
+    }
+
+    return n;
+}
+
+static apr_status_t aio_uring_submit(apr_file_aio_t *aio,
+                                     apr_file_aio_op_t *op)
+{
+    struct io_uring_sqe *sqe;
+    apr_os_file_t fd;
+    unsigned int tail, index;
+    int ret;
+
+    apr_os_file_get(&fd, op->file);
+
+    tail = *aio->sq_tail;
+    if (tail - ring_load(aio->sq_head) >= aio->sq_entries) {
+        /* Full, the kernel did not take what's queued already */
+        if (aio_uring_enter(aio, 0, 0, NULL, 0) < 0) {
+            return errno;
+        }
+        if (tail - ring_load(aio->sq_head) >= aio->sq_entries) {
+            return APR_EAGAIN;
+        }
+    }
+
+    index = tail & *aio->sq_mask;
+    sqe = &aio->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->user_data = (apr_uint64_t)(apr_uintptr_t)op;
+    switch (op->type) {
+    case APR_FILE_AIO_READ:
+    case APR_FILE_AIO_WRITE:
+        if (op->buf_index >= 0) {
+            sqe->opcode = (op->type == APR_FILE_AIO_READ) ?
+                          IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+            sqe->buf_index = op->buf_index;
+        }
+        else {
+            sqe->opcode = (op->type == APR_FILE_AIO_READ) ?
+                          IORING_OP_READ : IORING_OP_WRITE;
+        }
+        sqe->addr = (apr_uint64_t)(apr_uintptr_t)op->buf;
+        sqe->len = op->len > AIO_URING_MAX_LEN ? AIO_URING_MAX_LEN
+                                               : (apr_uint32_t)op->len;
+        sqe->off = op->offset;
+        break;
+    case APR_FILE_AIO_SYNC:
+    case APR_FILE_AIO_DATASYNC:
+        sqe->opcode = IORING_OP_FSYNC;
+        if (op->type == APR_FILE_AIO_DATASYNC) {
+            sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+        }
+        break;
+    }
+    aio->sq_array[index] = index;
+    ring_store(aio->sq_tail, tail + 1);
+    aio->to_submit++;
+
+    do {
+        ret = aio_uring_enter(aio, 0, 0, NULL, 0);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0 && errno != EAGAIN && errno != EBUSY) {
+        apr_status_t rv = errno;
+
+        /* Not consumed by the kernel, take it back */
+        ring_store(aio->sq_tail, tail);
+        aio->to_submit--;
+        return rv;
+    }
+    /* Otherwise it's queued until the kernel can take it */
+
+    aio->inflight++;
+    return APR_SUCCESS;
+}
+
+static apr_status_t aio_uring_reap(apr_file_aio_t *aio,
+                                   apr_interval_time_t timeout,
+                                   apr_uint32_t *num)
+{
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    int ret;
+
+    if (aio->efd >= 0) {
+        apr_uint64_t count;
+
+        /* Drained before harvesting, later completions signal it again */
+        (void)read(aio->efd, &count, sizeof(count));
+    }
+
+    if (*aio->cq_head == ring_load(aio->cq_tail) && timeout != 0) {
+        memset(&arg, 0, sizeof(arg));
+        if (timeout > 0) {
+            ts.tv_sec = apr_time_sec(timeout);
+            ts.tv_nsec = apr_time_usec(timeout) * 1000;
+            arg.ts = (apr_uint64_t)(apr_uintptr_t)&ts;
+        }
+        ret = aio_uring_enter(aio, 1,
+                              IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                              &arg, sizeof(arg));
+        if (ret < 0 && errno != ETIME) {
+            return errno;
+        }
+    }
+    else if (aio->to_submit) {
+        (void)aio_uring_enter(aio, 0, 0, NULL, 0);
+    }
+
+    *num = aio_uring_harvest(aio, 1);
+    return *num ? APR_SUCCESS : APR_TIMEUP;
+}
+
+/* Wait for the operations in flight before the ring is closed, the kernel
+ * might still be using their buffers otherwise.
+ */
+static void aio_uring_destroy(apr_file_aio_t *aio)
+{
+    while (aio->inflight) {
+        if (aio_uring_enter(aio, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+                && errno != EINTR) {
+            break;
+        }
+        (void)aio_uring_harvest(aio, 0);
+    }
+    if (aio->efd >= 0) {
+        close(aio->efd);
+    }
+    aio_uring_close(aio);
+}
+
+#endif /* HAVE_IO_URING */
+
+static apr_status_t aio_cleanup(void *data)
+{
+    apr_file_aio_t *aio = data;
+
+    switch (aio->method) {
+#if defined(HAVE_IO_URING)
+    case AIO_URING:
+        aio_uring_destroy(aio);
+        break;
+#endif
+#if APR_HAS_THREADS
+    case AIO_THREADS:
+        /* Cancels the operations queued and waits for the running ones */
+        apr_thread_pool_destroy(aio->tp);
+        break;
+#endif
+    default:
+        break;
+    }
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_file_aio_create(apr_file_aio_t **paio,
+                                              apr_uint32_t size,
+                                              apr_uint32_t flags,
+                                              apr_pool_t *p)
+{
+    apr_file_aio_t *aio;
+    apr_pool_t *pool;
+    apr_status_t rv;
+
+    *paio = NULL;
+
+    rv = apr_pool_create(&pool, p);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+    apr_pool_tag(pool, "apr_file_aio");
+
+    aio = apr_pcalloc(pool, sizeof(*aio));
+    aio->pool = pool;
+    aio->method = AIO_SYNC;
+
+    rv = APR_ENOTIMPL;
+#if defined(HAVE_IO_URING)
+    if (!(flags & APR_FILE_AIO_THREADS)) {
+        rv = aio_uring_create(aio, size);
+        if (rv == APR_SUCCESS) {
+            aio->method = AIO_URING;
+        }
+    }
+#endif
+#if APR_HAS_THREADS
+    if (rv == APR_ENOTIMPL) {
+        rv = aio_threads_create(aio, size);
+        if (rv == APR_SUCCESS) {
+            aio->method = AIO_THREADS;
+        }
+    }
+#endif
+    if (rv == APR_ENOTIMPL) {
+        rv = APR_SUCCESS;
+    }
+    if (rv != APR_SUCCESS) {
+        apr_pool_destroy(pool);
+        return rv;
+    }
+
+    apr_pool_pre_cleanup_register(pool, aio, aio_cleanup);
+
+    *paio = aio;
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_file_aio_destroy(apr_file_aio_t *aio)
+{
+    apr_pool_destroy(aio->pool);
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(const char *) apr_file_aio_method_name(apr_file_aio_t *aio)
+{
+    switch (aio->method) {
+    case AIO_URING:
+        return "io_uring";
+    case AIO_THREADS:
+        return "threads";
+    default:
+        return "sync";
+    }
+}
+
+APR_DECLARE(apr_status_t) apr_file_aio_buffers_register(apr_file_aio_t *aio,
+                                                  const struct iovec *vec,
+                                                  apr_size_t nvec)
+{
+#if defined(HAVE_IO_URING)
+    if (aio->method == AIO_URING) {
+        if (aio->nbufs) {
+            aio->nbufs = 0;
+            if (syscall(__NR_io_uring_register, aio->fd,
+                        IORING_UNREGISTER_BUFFERS, NULL, 0) < 0) {
+                return errno;
+            }
+        }
+        if (nvec && syscall(__NR_io_uring_register, aio->fd,
+                            IORING_REGISTER_BUFFERS, vec, nvec) < 0) {
+            return errno;
+        }
+    }
+#endif
+
+    aio->bufs = nvec ? apr_pmemdup(aio->pool, vec, nvec * sizeof(*vec))
+                     : NULL;
+    aio->nbufs = nvec;
+    return APR_SUCCESS;
+}
+
+APR_DECLARE(apr_status_t) apr_file_aio_submit(apr_file_aio_t *aio,
+                                              apr_file_aio_op_t *op)
+{
+    apr_status_t rv;
+
+    if (!op->file) {
+        return APR_EINVAL;
+    }
+    switch (op->type) {
+    case APR_FILE_AIO_READ:
+    case APR_FILE_AIO_WRITE:
+        if (op->offset < 0) {
+            return APR_EINVAL;
+        }
+        if (op->buf_index >= 0) {
+            const struct iovec *vec;
+
+            if ((apr_size_t)op->buf_index >= aio->nbufs) {
+                return APR_EINVAL;
+            }
+            vec = &aio->bufs[op->buf_index];
+            if ((char *)op->buf < (char *)vec->iov_base
+                    || op->len > vec->iov_len
+                    || (apr_size_t)((char *)op->buf
+                                    - (char *)vec->iov_base)
+                       > vec->iov_len - op->len) {
+                return APR_EINVAL;
+            }
+        }
+        if (apr_file_flags_get(op->file) & APR_FOPEN_BUFFERED) {
+            rv = apr_file_flush(op->file);
+            if (rv != APR_SUCCESS) {
+                return rv;
+            }
+        }
+        break;
+    case APR_FILE_AIO_SYNC:
+    case APR_FILE_AIO_DATASYNC:
+        break;
+    default:
+        return APR_EINVAL;
+    }
+
+    op->aio = aio;
+    op->next = NULL;
+    op->status = APR_SUCCESS;
+    op->nbytes = 0;
+
+    switch (aio->method) {
+#if defined(HAVE_IO_URING)
+    case AIO_URING:
+        rv = aio_uring_submit(aio, op);
+        break;
+#endif
+#if APR_HAS_THREADS
+    case AIO_THREADS:
+        rv = apr_thread_pool_push(aio->tp, aio_task, op,
+                                  APR_THREAD_TASK_PRIORITY_NORMAL, aio);
+        break;
+#endif
+    default:
+        aio_perform(op);
+        aio_done_push(aio, op);
+        rv = APR_SUCCESS;
+        break;
+    }
+
+    if (rv == APR_SUCCESS) {
+        aio->pending++;
+    }
+    return rv;
+}
+
+APR_DECLARE(apr_status_t) apr_file_aio_reap(apr_file_aio_t *aio,
+                                            apr_interval_time_t timeout,
+                                            apr_uint32_t *num)
+{
+    apr_uint32_t n = 0;
+    apr_status_t rv;
+
+    if (!aio->pending) {
+        rv = APR_SUCCESS;
+    }
+    else switch (aio->method) {
+#if defined(HAVE_IO_URING)
+    case AIO_URING:
+        rv = aio_uring_reap(aio, timeout, &n);
+        break;
+#endif
+#if APR_HAS_THREADS
+    case AIO_THREADS:
+        rv = aio_threads_reap(aio, timeout, &n);
+        break;
+#endif
+    default: {
+        apr_file_aio_op_t *done = aio->done;
+
+        aio->done = aio->done_tail = NULL;
+        n = aio_done_run(aio, done);
+        rv = APR_SUCCESS;
+        break;
+    }
+    }
+
+    if (num) {
+        *num = n;
+    }
+    return rv;
+}
+
+APR_DECLARE(apr_uint32_t) apr_file_aio_pending(apr_file_aio_t *aio)
+{
+    return aio->pending;
+}
+
+APR_DECLARE(apr_status_t) apr_file_aio_notifier_get(apr_file_t **notifier,
+                                                    apr_file_aio_t *aio)
+{
+    apr_status_t rv = APR_SUCCESS;
+
+    if (aio->notifier) {
+        *notifier = aio->notifier;
+        return APR_SUCCESS;
+    }
+
+    switch (aio->method) {
+#if defined(HAVE_IO_URING)
+    case AIO_URING: {
+        apr_os_file_t fd;
+        int efd;
+
+        /* Signaled by the kernel for each completion */
+        efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (efd < 0) {
+            return errno;
+        }
+        if (syscall(__NR_io_uring_register, aio->fd,
+                    IORING_REGISTER_EVENTFD, &efd, 1) < 0) {
+            rv = errno;
+            close(efd);
+            return rv;
+        }
+        /* Closed by the cleanup, along with the ring */
+        aio->efd = fd = efd;
+        rv = apr_os_file_put(&aio->notifier, &fd, APR_FOPEN_READ, aio->pool);
+        if (rv == APR_SUCCESS
+                && *aio->cq_head != ring_load(aio->cq_tail)) {
+            apr_uint64_t one = 1;
+
+            /* Completions are ready already */
+            (void)write(efd, &one, sizeof(one));
+        }
+        break;
+    }
+#endif
+#if APR_HAS_THREADS
+    case AIO_THREADS: {
+        apr_file_t *in, *out;
+
+        apr_thread_mutex_lock(aio->mutex);
+        rv = apr_file_pipe_create_ex(&in, &out, APR_FULL_NONBLOCK,
+                                     aio->pool);
+        if (rv == APR_SUCCESS) {
+            aio->notifier = in;
+            aio->notifier_out = out;
+            if (aio->done) {
+                char c = 0;
+                apr_size_t len = 1;
+
+                apr_file_write(out, &c, &len);
+                aio->notified = 1;
+            }
+        }
+        apr_thread_mutex_unlock(aio->mutex);
+        break;
+    }
+#endif
+    default:
+        rv = APR_ENOTIMPL;
+        break;
+    }
+
+    if (rv == APR_SUCCESS) {
+        *notifier = aio->notifier;
+    }
+    return rv;
+}
@@ -30,6 +30,7 @@
 #include "apr_portable.h"
 #include "apr_thread_mutex.h"
 #include "apr_thread_cond.h"
+#include "apr_atomic.h"
 #include "apr_errno.h"
 #include "apr_queue.h"
 
@@ -40,6 +41,21 @@
 #define QUEUE_DEBUG
  */
 
+/* Keeps the producers' and consumers' counters on distinct cache lines */
+#define QUEUE_CACHELINE 64
+
+/* How many times the lock-free queue yields and retries before parking */
+#define QUEUE_YIELD_TRIES 16
+
+/**
+ * A slot of the lock-free ring, its sequence number tells whether it is
+ * to be pushed (seq == pos) or popped (seq == pos + 1) at position pos.
+ */
+typedef struct queue_slot_t {
+    volatile apr_uint32_t seq;
+    void               *data;
+} queue_slot_t;
+
 struct apr_queue_t {
     void              **data;
     unsigned int        nelts; /**< # elements */
@@ -51,7 +67,18 @@ struct apr_queue_t {
     apr_thread_mutex_t *one_big_mutex;
     apr_thread_cond_t  *not_empty;
     apr_thread_cond_t  *not_full;
-    int                 terminated;
+    volatile int        terminated;
+    apr_uint32_t        flags;
+    /* APR_QUEUE_LOCKFREE */
+    queue_slot_t       *slots;
+    apr_uint32_t        mask;
+    volatile apr_uint32_t lf_full_waiters;
+    volatile apr_uint32_t lf_empty_waiters;
+    char                pad0[QUEUE_CACHELINE];
+    volatile apr_uint32_t tail; /**< next push position */
+    char                pad1[QUEUE_CACHELINE - sizeof(apr_uint32_t)];
+    volatile apr_uint32_t head; /**< next pop position */
+    char                pad2[QUEUE_CACHELINE - sizeof(apr_uint32_t)];
 };
 
 #ifdef QUEUE_DEBUG
@@ -101,9 +128,23 @@ static apr_status_t queue_destroy(void *data)
 APR_DECLARE(apr_status_t) apr_queue_create(apr_queue_t **q,
                                            unsigned int queue_capacity,
                                            apr_pool_t *a)
+{
+    return apr_queue_create_ex(q, queue_capacity, 0, a);
+}
+
+APR_DECLARE(apr_status_t) apr_queue_create_ex(apr_queue_t **q,
+                                              unsigned int queue_capacity,
+                                              apr_uint32_t flags,
+                                              apr_pool_t *a)
 {
     apr_status_t rv;
     apr_queue_t *queue;
+
+    if ((flags & APR_QUEUE_LOCKFREE)
+            && (queue_capacity == 0 || queue_capacity > 0x80000000U)) {
+        return APR_EINVAL;
+    }
+
     queue = apr_palloc(a, sizeof(apr_queue_t));
     *q = queue;
 
@@ -125,8 +166,29 @@ APR_DECLARE(apr_status_t) apr_queue_create(apr_queue_t **q,
         return rv;
     }
 
-    /* Set all the data in the queue to NULL */
-    queue->data = apr_pcalloc(a, queue_capacity * sizeof(void*));
+    queue->flags = flags;
+    if (flags & APR_QUEUE_LOCKFREE) {
+        apr_uint32_t i, size = 1;
+
+        /* The ring's positions wrap, so its size must divide 2^32 */
+        while (size < queue_capacity) {
+            size <<= 1;
+        }
+        queue->slots = apr_palloc(a, size * sizeof(queue_slot_t));
+        for (i = 0; i < size; i++) {
+            queue->slots[i].seq = i;
+            queue->slots[i].data = NULL;
+        }
+        queue->mask = size - 1;
+        queue->data = NULL;
+        queue_capacity = size;
+    }
+    else {
+        /* Set all the data in the queue to NULL */
+        queue->data = apr_pcalloc(a, queue_capacity * sizeof(void*));
+        queue->slots = NULL;
+        queue->mask = 0;
+    }
     queue->bounds = queue_capacity;
     queue->nelts = 0;
     queue->in = 0;
@@ -134,12 +196,200 @@ APR_DECLARE(apr_status_t) apr_queue_create(apr_queue_t **q,
     queue->terminated = 0;
     queue->full_waiters = 0;
     queue->empty_waiters = 0;
+    queue->lf_full_waiters = 0;
+    queue->lf_empty_waiters = 0;
+    queue->tail = 0;
+    queue->head = 0;
 
     apr_pool_cleanup_register(a, queue, queue_destroy, apr_pool_cleanup_null);
 
     return APR_SUCCESS;
 }
 
+/*
+ * The APR_QUEUE_LOCKFREE queue is a bounded MPMC ring: each slot carries a
+ * sequence number telling the position it is ready for, so producers (resp.
+ * consumers) only race on the tail (resp. head) position with a CAS, and
+ * never on the slots themselves.
+ */
+static apr_status_t lf_trypush(apr_queue_t *queue, void *data)
+{
+    queue_slot_t *slot;
+    apr_uint32_t pos, seq, cur;
+
+    pos = apr_atomic_read32(&queue->tail);
+    for (;;) {
+        slot = &queue->slots[pos & queue->mask];
+        seq = apr_atomic_read32(&slot->seq);
+        if (seq == pos) {
+            cur = apr_atomic_cas32(&queue->tail, pos + 1, pos);
+            if (cur == pos) {
+                break;
+            }
+            pos = cur;
+        }
+        else if ((apr_int32_t)(seq - pos) < 0) {
+            /* Not popped yet from the previous round */
+            return APR_EAGAIN;
+        }
+        else {
+            pos = apr_atomic_read32(&queue->tail);
+        }
+    }
+
+    slot->data = data;
+    apr_atomic_set32(&slot->seq, pos + 1);
+
+    return APR_SUCCESS;
+}
+
+static apr_status_t lf_trypop(apr_queue_t *queue, void **data)
+{
+    queue_slot_t *slot;
+    apr_uint32_t pos, seq, cur;
+
+    pos = apr_atomic_read32(&queue->head);
+    for (;;) {
+        slot = &queue->slots[pos & queue->mask];
+        seq = apr_atomic_read32(&slot->seq);
+        if (seq == pos + 1) {
+            cur = apr_atomic_cas32(&queue->head, pos + 1, pos);
+            if (cur == pos) {
+                break;
+            }
+            pos = cur;
+        }
+        else if ((apr_int32_t)(seq - (pos + 1)) < 0) {
+            /* Not pushed yet */
+            return APR_EAGAIN;
+        }
+        else {
+            pos = apr_atomic_read32(&queue->head);
+        }
+    }
+
+    *data = slot->data;
+    apr_atomic_set32(&slot->seq, pos + queue->mask + 1);
+
+    return APR_SUCCESS;
+}
+
+/**
+ * Wake up a thread parked on the given condition, if any. The waiters
+ * count is incremented before they check the queue a last time, so either
+ * they see our change or we see them waiting.
+ */
+static apr_status_t lf_wakeup(apr_queue_t *queue, volatile apr_uint32_t *waiters,
+                              apr_thread_cond_t *cond)
+{
+    apr_status_t rv;
+
+    if (!apr_atomic_read32(waiters)) {
+        return APR_SUCCESS;
+    }
+
+    rv = apr_thread_mutex_lock(queue->one_big_mutex);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+    rv = apr_thread_cond_signal(cond);
+    if (rv != APR_SUCCESS) {
+        apr_thread_mutex_unlock(queue->one_big_mutex);
+        return rv;
+    }
+    return apr_thread_mutex_unlock(queue->one_big_mutex);
+}
+
+/**
+ * Push or pop (according to "data" or "datap") without ever locking, unless
+ * the queue is full or empty and we have to park until it is not anymore.
+ */
+static apr_status_t lf_queue_op(apr_queue_t *queue, void *data, void **datap,
+                                apr_interval_time_t timeout)
+{
+    volatile apr_uint32_t *waiters, *others;
+    apr_thread_cond_t *cond, *other_cond;
+    apr_status_t rv, arv;
+    int tries = 0;
+
+    if (queue->terminated) {
+        return APR_EOF; /* no more elements ever again */
+    }
+
+    if (datap) {
+        waiters = &queue->lf_empty_waiters;
+        cond = queue->not_empty;
+        others = &queue->lf_full_waiters;
+        other_cond = queue->not_full;
+    }
+    else {
+        waiters = &queue->lf_full_waiters;
+        cond = queue->not_full;
+        others = &queue->lf_empty_waiters;
+        other_cond = queue->not_empty;
+    }
+    for (;;) {
+        rv = datap ? lf_trypop(queue, datap) : lf_trypush(queue, data);
+        if (rv == APR_SUCCESS) {
+            return lf_wakeup(queue, others, other_cond);
+        }
+        if (!timeout) {
+            return APR_EAGAIN;
+        }
+        if (tries++ == QUEUE_YIELD_TRIES) {
+            break;
+        }
+        /* Parking and being woken up costs way more than letting the
+         * other side run for a while.
+         */
+        apr_thread_yield();
+        if (queue->terminated) {
+            return APR_EOF;
+        }
+    }
+
+    rv = apr_thread_mutex_lock(queue->one_big_mutex);
+    if (rv != APR_SUCCESS) {
+        return rv;
+    }
+    apr_atomic_inc32(waiters);
+
+    /* Last chance before parking */
+    rv = datap ? lf_trypop(queue, datap) : lf_trypush(queue, data);
+    if (rv == APR_EAGAIN && !queue->terminated) {
+        if (timeout > 0) {
+            rv = apr_thread_cond_timedwait(cond, queue->one_big_mutex,
+                                           timeout);
+        }
+        else {
+            rv = apr_thread_cond_wait(cond, queue->one_big_mutex);
+        }
+        if (rv == APR_SUCCESS) {
+            rv = datap ? lf_trypop(queue, datap) : lf_trypush(queue, data);
+            if (rv == APR_EAGAIN) {
+                /* If we wake up and it's still empty (or full),
+                 * then we were interrupted
+                 */
+                Q_DBG("lockfree queue (intr)", queue);
+                rv = queue->terminated ? APR_EOF : APR_EINTR;
+            }
+        }
+    }
+    else if (rv == APR_EAGAIN) {
+        rv = APR_EOF;
+    }
+
+    apr_atomic_dec32(waiters);
+    arv = apr_thread_mutex_unlock(queue->one_big_mutex);
+    if (rv == APR_SUCCESS) {
+        rv = arv;
+        if (rv == APR_SUCCESS) {
+            rv = lf_wakeup(queue, others, other_cond);
+        }
+    }
+    return rv;
+}
+
 /**
  * Push new data onto the queue. Blocks if the queue is full. Once
  * the push operation has completed, it signals other threads waiting
@@ -150,6 +400,10 @@ static apr_status_t queue_push(apr_queue_t *queue, void *data,
 {
     apr_status_t rv;
 
+    if (queue->flags & APR_QUEUE_LOCKFREE) {
+        return lf_queue_op(queue, data, NULL, timeout);
+    }
+
     if (queue->terminated) {
         return APR_EOF; /* no more elements ever again */
     }
@@ -241,6 +495,14 @@ APR_DECLARE(apr_status_t) apr_queue_timedpush(apr_queue_t *queue, void *data,
  * not thread safe
  */
 APR_DECLARE(unsigned int) apr_queue_size(apr_queue_t *queue) {
+    if (queue->flags & APR_QUEUE_LOCKFREE) {
+        apr_uint32_t n = apr_atomic_read32(&queue->tail)
+                         - apr_atomic_read32(&queue->head);
+
+        /* Both may have moved in between */
+        return ((apr_int32_t)n < 0) ? 0 : (n > queue->bounds) ? queue->bounds
+                                                               : n;
+    }
     return queue->nelts;
 }
 
@@ -256,6 +518,10 @@ static apr_status_t queue_pop(apr_queue_t *queue, void **data,
 {
     apr_status_t rv;
 
+    if (queue->flags & APR_QUEUE_LOCKFREE) {
+        return lf_queue_op(queue, NULL, data, timeout);
+    }
+
     if (queue->terminated) {
         return APR_EOF; /* no more elements ever again */
     }
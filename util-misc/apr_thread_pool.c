@@ -21,6 +21,7 @@
 #include "apr_ring.h"
 #include "apr_thread_cond.h"
 #include "apr_portable.h"
+#include "apr_atomic.h"
 
 #if APR_HAS_THREADS
 
@@ -42,13 +43,32 @@ typedef struct apr_thread_pool_task
 
 APR_RING_HEAD(apr_thread_pool_tasks, apr_thread_pool_task);
 
+/*
+ * With APR_THREAD_POOL_WORK_STEALING, the tasks are spread over a queue per
+ * worker (each with its own lock and priority segments), where the worker
+ * pops the first task of its highest priority segment, or else steals the
+ * last task of another queue.
+ */
+typedef struct apr_thread_pool_queue
+{
+    apr_thread_pool_t *tp;
+    apr_thread_mutex_t *lock;
+    struct apr_thread_pool_tasks tasks[TASK_PRIORITY_SEGS];
+    struct apr_thread_pool_tasks recycled_tasks;
+    volatile apr_size_t task_cnt;
+    volatile apr_size_t tasks_high;
+    volatile apr_size_t tasks_run;
+    volatile apr_size_t tasks_stolen;
+} apr_thread_pool_queue_t;
+
 struct apr_thread_list_elt
 {
     APR_RING_ENTRY(apr_thread_list_elt) link;
     apr_thread_t *thd;
-    void *current_owner;
+    void *volatile current_owner;
     enum { TH_RUN, TH_STOP, TH_PROBATION } state;
-    int signal_work_done;
+    volatile apr_uint32_t signal_work_done;
+    apr_thread_pool_queue_t *queue;
 };
 
 APR_RING_HEAD(apr_thread_list, apr_thread_list_elt);
@@ -82,11 +102,48 @@ struct apr_thread_pool
     struct apr_thread_pool_tasks *recycled_tasks;
     struct apr_thread_list *recycled_thds;
     apr_thread_pool_task_t *task_idx[TASK_PRIORITY_SEGS];
+    /* APR_THREAD_POOL_WORK_STEALING */
+    apr_thread_pool_queue_t *queues;
+    apr_size_t queues_cnt;
+    apr_size_t queues_next;
+    volatile apr_uint32_t queues_rr;
+    volatile apr_uint32_t pending_cnt;
+    volatile apr_uint32_t sleeping_cnt;
 };
 
+#if APR_HAS_THREAD_LOCAL
+/* The queue of the worker running on this thread, if any */
+static APR_THREAD_LOCAL apr_thread_pool_queue_t *current_queue;
+#endif
+
+static apr_status_t queues_construct(apr_thread_pool_t *me)
+{
+    apr_status_t rv;
+    apr_size_t i;
+    int seg;
+
+    me->queues = apr_pcalloc(me->pool, me->queues_cnt * sizeof(*me->queues));
+    for (i = 0; i < me->queues_cnt; i++) {
+        apr_thread_pool_queue_t *q = &me->queues[i];
+
+        q->tp = me;
+        rv = apr_thread_mutex_create(&q->lock, APR_THREAD_MUTEX_DEFAULT,
+                                     me->pool);
+        if (APR_SUCCESS != rv) {
+            return rv;
+        }
+        for (seg = 0; seg < TASK_PRIORITY_SEGS; seg++) {
+            APR_RING_INIT(&q->tasks[seg], apr_thread_pool_task, link);
+        }
+        APR_RING_INIT(&q->recycled_tasks, apr_thread_pool_task, link);
+    }
+    return APR_SUCCESS;
+}
+
 static apr_status_t thread_pool_construct(apr_thread_pool_t **tp,
                                           apr_size_t init_threads,
                                           apr_size_t max_threads,
+                                          apr_uint32_t flags,
                                           apr_pool_t *pool)
 {
     apr_status_t rv;
@@ -165,6 +222,17 @@ static apr_status_t thread_pool_construct(apr_thread_pool_t **tp,
         goto CATCH_ENOMEM;
     }
     APR_RING_INIT(me->recycled_thds, apr_thread_list_elt, link);
+    if (flags & APR_THREAD_POOL_WORK_STEALING) {
+        /* One queue per thread, those above are shared */
+        me->queues_cnt = max_threads ? max_threads : 1;
+        rv = queues_construct(me);
+        if (APR_SUCCESS != rv) {
+            apr_thread_cond_destroy(me->all_done);
+            apr_thread_cond_destroy(me->work_done);
+            apr_thread_cond_destroy(me->more_work);
+            apr_thread_mutex_destroy(me->lock);
+        }
+    }
     goto FINAL_EXIT;
   CATCH_ENOMEM:
     rv = APR_ENOMEM;
@@ -179,12 +247,10 @@ static apr_status_t thread_pool_construct(apr_thread_pool_t **tp,
 /*
  * NOTE: This function is not thread safe by itself. Caller should hold the lock
  */
-static apr_thread_pool_task_t *pop_task(apr_thread_pool_t * me)
+static apr_thread_pool_task_t *pop_scheduled_task(apr_thread_pool_t * me)
 {
     apr_thread_pool_task_t *task = NULL;
-    int seg;
 
-    /* check for scheduled tasks */
     if (me->scheduled_task_cnt > 0) {
         task = APR_RING_FIRST(me->scheduled_tasks);
         assert(task != NULL);
@@ -198,6 +264,22 @@ static apr_thread_pool_task_t *pop_task(apr_thread_pool_t * me)
             return task;
         }
     }
+    return NULL;
+}
+
+/*
+ * NOTE: This function is not thread safe by itself. Caller should hold the lock
+ */
+static apr_thread_pool_task_t *pop_task(apr_thread_pool_t * me)
+{
+    apr_thread_pool_task_t *task = NULL;
+    int seg;
+
+    /* check for scheduled tasks */
+    task = pop_scheduled_task(me);
+    if (task) {
+        return task;
+    }
     /* check for normal tasks if we're not returning a scheduled task */
     if (me->task_cnt == 0) {
         return NULL;
@@ -220,6 +302,138 @@ static apr_thread_pool_task_t *pop_task(apr_thread_pool_t * me)
     return task;
 }
 
+/*
+ * Take a task from the given queue, the first of the highest priority for
+ * its own worker or the last one for a thief. The task's owner is set
+ * for the worker before unlocking, so that apr_thread_pool_tasks_cancel()
+ * either removes the task or waits for it to complete.
+ */
+static apr_thread_pool_task_t *queue_pop_task(apr_thread_pool_queue_t *q,
+                                              struct apr_thread_list_elt *elt,
+                                              int steal)
+{
+    apr_thread_pool_task_t *task = NULL;
+    int seg;
+
+    if (!q->task_cnt) {
+        return NULL;
+    }
+
+    apr_thread_mutex_lock(q->lock);
+    for (seg = TASK_PRIORITY_SEGS - 1; seg >= 0; seg--) {
+        if (!APR_RING_EMPTY(&q->tasks[seg], apr_thread_pool_task, link)) {
+            task = steal ? APR_RING_LAST(&q->tasks[seg])
+                         : APR_RING_FIRST(&q->tasks[seg]);
+            APR_RING_REMOVE(task, link);
+            --q->task_cnt;
+            ++q->tasks_run;
+            if (steal) {
+                ++q->tasks_stolen;
+            }
+            apr_atomic_xchgptr(&elt->current_owner, task->owner);
+            break;
+        }
+    }
+    apr_thread_mutex_unlock(q->lock);
+
+    if (task) {
+        apr_atomic_dec32(&q->tp->pending_cnt);
+    }
+    return task;
+}
+
+/*
+ * Take a task from the worker's own queue, or steal one from the others'.
+ */
+static apr_thread_pool_task_t *queues_pop_task(apr_thread_pool_t *me,
+                                               struct apr_thread_list_elt *elt)
+{
+    apr_thread_pool_task_t *task;
+    apr_size_t i, n;
+
+    task = queue_pop_task(elt->queue, elt, 0);
+    if (task) {
+        return task;
+    }
+
+    n = elt->queue - me->queues;
+    for (i = 1; i < me->queues_cnt; i++) {
+        if (++n == me->queues_cnt) {
+            n = 0;
+        }
+        task = queue_pop_task(&me->queues[n], elt, 1);
+        if (task) {
+            break;
+        }
+    }
+    return task;
+}
+
+/*
+ * The task is done, signal apr_thread_pool_tasks_cancel() if it is waiting
+ * for it (it sets signal_work_done before checking current_owner again).
+ */
+static void queue_task_done(apr_thread_pool_t *me,
+                            struct apr_thread_list_elt *elt,
+                            apr_thread_pool_task_t *task)
+{
+    apr_thread_pool_queue_t *q = elt->queue;
+
+    apr_thread_mutex_lock(q->lock);
+    APR_RING_INSERT_TAIL(&q->recycled_tasks, task,
+                         apr_thread_pool_task, link);
+    apr_thread_mutex_unlock(q->lock);
+
+    apr_atomic_xchgptr(&elt->current_owner, NULL);
+    if (apr_atomic_read32(&elt->signal_work_done)) {
+        apr_thread_mutex_lock(me->lock);
+        apr_pool_owner_set(me->pool, 0);
+        elt->signal_work_done = 0;
+        apr_thread_cond_signal(me->work_done);
+        apr_thread_mutex_unlock(me->lock);
+    }
+}
+
+/*
+ * Run the tasks from the queues (and the scheduled ones when it's time)
+ * until there is none or the worker is asked to stop, without holding
+ * the pool's lock.
+ */
+static void queues_run_tasks(apr_thread_pool_t *me,
+                             struct apr_thread_list_elt *elt,
+                             apr_thread_t *t)
+{
+    apr_thread_pool_task_t *task;
+
+    while (elt->state != TH_STOP) {
+        task = NULL;
+        if (me->scheduled_task_cnt) {
+            apr_thread_mutex_lock(me->lock);
+            apr_pool_owner_set(me->pool, 0);
+            task = pop_scheduled_task(me);
+            if (task) {
+                ++me->tasks_run;
+                apr_atomic_xchgptr(&elt->current_owner, task->owner);
+            }
+            apr_thread_mutex_unlock(me->lock);
+        }
+        if (!task) {
+            task = queues_pop_task(me, elt);
+            if (!task) {
+                break;
+            }
+        }
+
+        /* Run the task (or drop it if terminated already) */
+        if (!me->terminated) {
+            apr_thread_data_set(task, "apr_thread_pool_task", NULL, t);
+            task->func(t, task->param);
+        }
+
+        queue_task_done(me, elt, task);
+    }
+}
+
 static apr_interval_time_t waiting_time(apr_thread_pool_t * me)
 {
     apr_thread_pool_task_t *task = NULL;
@@ -256,6 +470,10 @@ static struct apr_thread_list_elt *elt_new(apr_thread_pool_t * me,
     elt->current_owner = NULL;
     elt->signal_work_done = 0;
     elt->state = TH_RUN;
+    elt->queue = NULL;
+    if (me->queues) {
+        elt->queue = &me->queues[me->queues_next++ % me->queues_cnt];
+    }
     return elt;
 }
 
@@ -282,6 +500,9 @@ static void *APR_THREAD_FUNC thread_pool_func(apr_thread_t * t, void *param)
         apr_thread_mutex_unlock(me->lock);
         apr_thread_exit(t, APR_ENOMEM);
     }
+#if APR_HAS_THREAD_LOCAL
+    current_queue = elt->queue;
+#endif
 
     for (;;) {
         /* Test if not new element, it is awakened from idle */
@@ -294,31 +515,40 @@ static void *APR_THREAD_FUNC thread_pool_func(apr_thread_t * t, void *param)
             ++me->busy_cnt;
             APR_RING_INSERT_TAIL(me->busy_thds, elt,
                                  apr_thread_list_elt, link);
-            do {
-                task = pop_task(me);
-                if (!task) {
-                    break;
-                }
-                ++me->tasks_run;
-                elt->current_owner = task->owner;
+            if (me->queues) {
                 apr_thread_mutex_unlock(me->lock);
-
-                /* Run the task (or drop it if terminated already) */
-                if (!me->terminated) {
-                    apr_thread_data_set(task, "apr_thread_pool_task", NULL, t);
-                    task->func(t, task->param);
-                }
-
+                queues_run_tasks(me, elt, t);
                 apr_thread_mutex_lock(me->lock);
                 apr_pool_owner_set(me->pool, 0);
-                APR_RING_INSERT_TAIL(me->recycled_tasks, task,
-                                     apr_thread_pool_task, link);
-                elt->current_owner = NULL;
-                if (elt->signal_work_done) {
-                    elt->signal_work_done = 0;
-                    apr_thread_cond_signal(me->work_done);
-                }
-            } while (elt->state != TH_STOP);
+            }
+            else {
+                do {
+                    task = pop_task(me);
+                    if (!task) {
+                        break;
+                    }
+                    ++me->tasks_run;
+                    elt->current_owner = task->owner;
+                    apr_thread_mutex_unlock(me->lock);
+
+                    /* Run the task (or drop it if terminated already) */
+                    if (!me->terminated) {
+                        apr_thread_data_set(task, "apr_thread_pool_task",
+                                            NULL, t);
+                        task->func(t, task->param);
+                    }
+
+                    apr_thread_mutex_lock(me->lock);
+                    apr_pool_owner_set(me->pool, 0);
+                    APR_RING_INSERT_TAIL(me->recycled_tasks, task,
+                                         apr_thread_pool_task, link);
+                    elt->current_owner = NULL;
+                    if (elt->signal_work_done) {
+                        elt->signal_work_done = 0;
+                        apr_thread_cond_signal(me->work_done);
+                    }
+                } while (elt->state != TH_STOP);
+            }
             APR_RING_REMOVE(elt, link);
             --me->busy_cnt;
         }
@@ -353,7 +583,22 @@ static void *APR_THREAD_FUNC thread_pool_func(apr_thread_t * t, void *param)
         else
             wait = -1;
 
-        if (wait >= 0) {
+        if (me->queues) {
+            /* Either we see the tasks pushed in the meantime, or the pusher
+             * sees us sleeping (and signals more_work once we wait).
+             */
+            apr_atomic_inc32(&me->sleeping_cnt);
+            if (!apr_atomic_read32(&me->pending_cnt)) {
+                if (wait >= 0) {
+                    apr_thread_cond_timedwait(me->more_work, me->lock, wait);
+                }
+                else {
+                    apr_thread_cond_wait(me->more_work, me->lock);
+                }
+            }
+            apr_atomic_dec32(&me->sleeping_cnt);
+        }
+        else if (wait >= 0) {
             apr_thread_cond_timedwait(me->more_work, me->lock, wait);
         }
         else {
@@ -362,6 +607,10 @@ static void *APR_THREAD_FUNC thread_pool_func(apr_thread_t * t, void *param)
         apr_pool_owner_set(me->pool, 0);
     }
 
+#if APR_HAS_THREAD_LOCAL
+    current_queue = NULL;
+#endif
+
     /* Dead thread, to be joined */
     APR_RING_INSERT_TAIL(me->dead_thds, elt, apr_thread_list_elt, link);
     if (--me->thd_cnt == 0 && me->terminated) {
@@ -420,6 +669,15 @@ APR_DECLARE(apr_status_t) apr_thread_pool_create(apr_thread_pool_t ** me,
                                                  apr_size_t init_threads,
                                                  apr_size_t max_threads,
                                                  apr_pool_t * pool)
+{
+    return apr_thread_pool_create_ex(me, init_threads, max_threads, 0, pool);
+}
+
+APR_DECLARE(apr_status_t) apr_thread_pool_create_ex(apr_thread_pool_t ** me,
+                                                    apr_size_t init_threads,
+                                                    apr_size_t max_threads,
+                                                    apr_uint32_t flags,
+                                                    apr_pool_t * pool)
 {
     apr_thread_t *t;
     apr_status_t rv = APR_SUCCESS;
@@ -427,7 +685,7 @@ APR_DECLARE(apr_status_t) apr_thread_pool_create(apr_thread_pool_t ** me,
 
     *me = NULL;
 
-    rv = thread_pool_construct(&tp, init_threads, max_threads, pool);
+    rv = thread_pool_construct(&tp, init_threads, max_threads, flags, pool);
     if (APR_SUCCESS != rv)
         return rv;
     apr_pool_pre_cleanup_register(tp->pool, tp, thread_pool_cleanup);
@@ -604,6 +862,110 @@ static apr_status_t schedule_task(apr_thread_pool_t *me,
     return rv;
 }
 
+/*
+ * Queue the task to the current worker's queue if called from a task, or
+ * else to the next queue in turn. The pool's lock is only taken to allocate
+ * a task, or to wake up or create a thread.
+ */
+static apr_status_t queues_add_task(apr_thread_pool_t *me,
+                                    apr_thread_start_t func, void *param,
+                                    apr_byte_t priority, int push,
+                                    void *owner)
+{
+    apr_thread_pool_queue_t *q = NULL;
+    apr_thread_pool_task_t *t = NULL;
+    apr_size_t pending;
+    apr_thread_t *thd;
+    apr_status_t rv = APR_SUCCESS;
+
+    if (me->terminated) {
+        /* Let the caller know that we are done */
+        return APR_NOTFOUND;
+    }
+
+#if APR_HAS_THREAD_LOCAL
+    if (current_queue && current_queue->tp == me) {
+        q = current_queue;
+    }
+#endif
+    if (!q) {
+        q = &me->queues[apr_atomic_inc32(&me->queues_rr) % me->queues_cnt];
+    }
+
+    apr_thread_mutex_lock(q->lock);
+    if (!APR_RING_EMPTY(&q->recycled_tasks, apr_thread_pool_task, link)) {
+        t = APR_RING_FIRST(&q->recycled_tasks);
+        APR_RING_REMOVE(t, link);
+    }
+    apr_thread_mutex_unlock(q->lock);
+    if (NULL == t) {
+        apr_thread_mutex_lock(me->lock);
+        apr_pool_owner_set(me->pool, 0);
+        t = task_new(me, func, param, priority, owner, 0);
+        apr_thread_mutex_unlock(me->lock);
+        if (NULL == t) {
+            return APR_ENOMEM;
+        }
+    }
+    else {
+        APR_RING_ELEM_INIT(t, link);
+        t->func = func;
+        t->param = param;
+        t->owner = owner;
+        t->dispatch.priority = priority;
+    }
+
+    apr_thread_mutex_lock(q->lock);
+    if (push) {
+        APR_RING_INSERT_TAIL(&q->tasks[TASK_PRIORITY_SEG(t)], t,
+                             apr_thread_pool_task, link);
+    }
+    else {
+        APR_RING_INSERT_HEAD(&q->tasks[TASK_PRIORITY_SEG(t)], t,
+                             apr_thread_pool_task, link);
+    }
+    if (++q->task_cnt > q->tasks_high) {
+        q->tasks_high = q->task_cnt;
+    }
+    apr_thread_mutex_unlock(q->lock);
+
+    /* Statistics are not worth a lock */
+    pending = apr_atomic_inc32(&me->pending_cnt) + 1;
+    if (pending > me->tasks_high) {
+        me->tasks_high = pending;
+    }
+
+    if (apr_atomic_read32(&me->sleeping_cnt)) {
+        apr_thread_mutex_lock(me->lock);
+        apr_pool_owner_set(me->pool, 0);
+        apr_thread_cond_signal(me->more_work);
+        apr_thread_mutex_unlock(me->lock);
+    }
+    else if (0 == me->thd_cnt || (0 == me->idle_cnt
+                                  && me->thd_cnt < me->thd_max
+                                  && pending > me->threshold)) {
+        apr_thread_mutex_lock(me->lock);
+        apr_pool_owner_set(me->pool, 0);
+
+        /* Maintain dead threads */
+        join_dead_threads(me);
+
+        if (0 == me->thd_cnt || (0 == me->idle_cnt
+                                 && me->thd_cnt < me->thd_max)) {
+            rv = apr_thread_create(&thd, NULL, thread_pool_func, me, me->pool);
+            if (APR_SUCCESS == rv) {
+                ++me->thd_cnt;
+                if (me->thd_cnt > me->thd_high)
+                    me->thd_high = me->thd_cnt;
+            }
+        }
+        apr_thread_cond_signal(me->more_work);
+        apr_thread_mutex_unlock(me->lock);
+    }
+
+    return rv;
+}
+
 static apr_status_t add_task(apr_thread_pool_t *me, apr_thread_start_t func,
                              void *param, apr_byte_t priority, int push,
                              void *owner)
@@ -613,6 +975,10 @@ static apr_status_t add_task(apr_thread_pool_t *me, apr_thread_start_t func,
     apr_thread_t *thd;
     apr_status_t rv = APR_SUCCESS;
 
+    if (me->queues) {
+        return queues_add_task(me, func, param, priority, push, owner);
+    }
+
     apr_thread_mutex_lock(me->lock);
     apr_pool_owner_set(me->pool, 0);
 
@@ -745,6 +1111,36 @@ static apr_status_t remove_tasks(apr_thread_pool_t *me, void *owner)
     return APR_SUCCESS;
 }
 
+static void remove_queues_tasks(apr_thread_pool_t *me, void *owner)
+{
+    apr_thread_pool_task_t *t_loc;
+    apr_thread_pool_task_t *next;
+    apr_size_t i;
+    int seg;
+
+    for (i = 0; i < me->queues_cnt; i++) {
+        apr_thread_pool_queue_t *q = &me->queues[i];
+
+        apr_thread_mutex_lock(q->lock);
+        for (seg = 0; seg < TASK_PRIORITY_SEGS && q->task_cnt; seg++) {
+            t_loc = APR_RING_FIRST(&q->tasks[seg]);
+            while (t_loc != APR_RING_SENTINEL(&q->tasks[seg],
+                                              apr_thread_pool_task, link)) {
+                next = APR_RING_NEXT(t_loc, link);
+                if (!owner || t_loc->owner == owner) {
+                    --q->task_cnt;
+                    apr_atomic_dec32(&me->pending_cnt);
+                    APR_RING_REMOVE(t_loc, link);
+                    APR_RING_INSERT_TAIL(&q->recycled_tasks, t_loc,
+                                         apr_thread_pool_task, link);
+                }
+                t_loc = next;
+            }
+        }
+        apr_thread_mutex_unlock(q->lock);
+    }
+}
+
 /* Must be locked by the caller */
 static void wait_on_busy_threads(apr_thread_pool_t *me, void *owner)
 {
@@ -771,7 +1167,24 @@ static void wait_on_busy_threads(apr_thread_pool_t *me, void *owner)
 #endif
 #endif
 
-        elt->signal_work_done = 1;
+        if (me->queues) {
+            /* Workers don't hold the lock while running tasks, so make sure
+             * that this one is still running a task of this owner now that
+             * it knows to signal work_done.
+             */
+            void *current_owner;
+
+            apr_atomic_set32(&elt->signal_work_done, 1);
+            current_owner = apr_atomic_casptr(&elt->current_owner,
+                                              NULL, NULL);
+            if (owner ? owner != current_owner : !current_owner) {
+                elt = APR_RING_NEXT(elt, link);
+                continue;
+            }
+        }
+        else {
+            elt->signal_work_done = 1;
+        }
         apr_thread_cond_wait(me->work_done, me->lock);
         apr_pool_owner_set(me->pool, 0);
 
@@ -794,6 +1207,9 @@ APR_DECLARE(apr_status_t) apr_thread_pool_tasks_cancel(apr_thread_pool_t *me,
     if (me->task_cnt > 0) {
         rv = remove_tasks(me, owner);
     }
+    if (me->queues) {
+        remove_queues_tasks(me, owner);
+    }
     if (me->scheduled_task_cnt > 0) {
         rv = remove_scheduled_tasks(me, owner);
     }
@@ -807,6 +1223,9 @@ APR_DECLARE(apr_status_t) apr_thread_pool_tasks_cancel(apr_thread_pool_t *me,
 
 APR_DECLARE(apr_size_t) apr_thread_pool_tasks_count(apr_thread_pool_t *me)
 {
+    if (me->queues) {
+        return apr_atomic_read32(&me->pending_cnt);
+    }
     return me->task_cnt;
 }
 
@@ -834,7 +1253,48 @@ APR_DECLARE(apr_size_t) apr_thread_pool_idle_count(apr_thread_pool_t *me)
 APR_DECLARE(apr_size_t)
     apr_thread_pool_tasks_run_count(apr_thread_pool_t * me)
 {
-    return me->tasks_run;
+    apr_size_t i, n = me->tasks_run;
+
+    for (i = 0; i < me->queues_cnt; i++) {
+        n += me->queues[i].tasks_run;
+    }
+    return n;
+}
+
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_tasks_stolen_count(apr_thread_pool_t * me)
+{
+    apr_size_t i, n = 0;
+
+    for (i = 0; i < me->queues_cnt; i++) {
+        n += me->queues[i].tasks_stolen;
+    }
+    return n;
+}
+
+APR_DECLARE(apr_size_t) apr_thread_pool_queues_count(apr_thread_pool_t *me)
+{
+    return me->queues_cnt;
+}
+
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_queue_tasks_count(apr_thread_pool_t *me, apr_size_t n)
+{
+    return (n < me->queues_cnt) ? me->queues[n].task_cnt : 0;
+}
+
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_queue_tasks_high_count(apr_thread_pool_t *me,
+                                           apr_size_t n)
+{
+    return (n < me->queues_cnt) ? me->queues[n].tasks_high : 0;
+}
+
+APR_DECLARE(apr_size_t)
+    apr_thread_pool_queue_tasks_stolen_count(apr_thread_pool_t *me,
+                                             apr_size_t n)
+{
+    return (n < me->queues_cnt) ? me->queues[n].tasks_stolen : 0;
 }
 
 APR_DECLARE(apr_size_t)